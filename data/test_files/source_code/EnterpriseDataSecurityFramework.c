@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <time.h>
 #include <math.h>
+#include <pthread.h>
 
 /**
  * Enterprise Data Security Framework
@@ -19,8 +20,27 @@
 #define DIGEST_OUTPUT_SIZE 32
 #define KOREAN_BLOCK_SIZE 8
 #define REGIONAL_CIPHER_ROUNDS 16
+#define MONT_MAX_LIMBS (LARGE_PRIME_MODULUS_BITS / 64)
+#define MONT_WINDOW_MAX 6
+#define SMALL_PRIME_LIMIT 2048
+#define MILLER_RABIN_ROUNDS 8
+#define PRIME_SEARCH_SPAN 65536
+#define EC_LIMBS 4
+#define EC_COMB_TEETH 8
+#define EC_COMB_SPACING 32  // ceil(256 / EC_COMB_TEETH)
+#define EC_WNAF_WIDTH 5
 
 // Data structures for mathematical operations
+// Montgomery arithmetic modulo an odd multi-limb n, stored as little-endian
+// 64-bit limbs. A value x in Montgomery form is x*R mod n, R = 2^(64*limbs).
+typedef struct {
+    uint64_t n[MONT_MAX_LIMBS];
+    uint64_t rr[MONT_MAX_LIMBS];   // R^2 mod n, moves values into Montgomery form
+    uint64_t one[MONT_MAX_LIMBS];  // R mod n, i.e. 1 in Montgomery form
+    uint64_t n0inv;                // -n^-1 mod 2^64
+    size_t limbs;
+} mont_ctx_t;
+
 typedef struct {
     uint8_t* coefficients;
     size_t degree;
@@ -28,9 +48,10 @@ typedef struct {
 } PolynomialContext;
 
 typedef struct {
-    uint64_t* factors;
+    uint64_t* factors;     // p then q, bit_length / 2 bits each
     size_t bit_length;
     uint32_t public_exp;
+    mont_ctx_t modulus;    // n = p * q
 } LargeIntegerContext;
 
 typedef struct {
@@ -61,9 +82,13 @@ static int execute_regional_transformation(const uint8_t* data, size_t data_len,
                                          uint8_t* transformed, size_t* trans_len);
 
 // Internal mathematical helper functions
-static uint64_t modular_exponentiation(uint64_t base, uint64_t exponent, uint64_t modulus);
-static void generate_prime_factors(uint64_t* p, uint64_t* q, size_t bit_length);
-static int elliptic_curve_point_multiplication(uint64_t scalar, uint64_t* point_x, uint64_t* point_y);
+static int mont_init(mont_ctx_t* ctx, const uint64_t* modulus, size_t limbs);
+static void mont_exp(const mont_ctx_t* ctx, uint64_t* r, const uint64_t* base,
+                     const uint64_t* exp, size_t exp_limbs);
+static void limbs_mul(uint64_t* r, const uint64_t* a, size_t a_limbs,
+                      const uint64_t* b, size_t b_limbs);
+static int generate_prime_factors(uint64_t* p, uint64_t* q, size_t bit_length);
+static int elliptic_curve_point_multiplication(const uint64_t* scalar, uint64_t* point_x, uint64_t* point_y);
 static void galois_field_operations(uint8_t* state, const uint8_t* round_key);
 static uint32_t secure_hash_compression(const uint32_t* message_schedule, uint32_t* hash_values);
 
@@ -84,12 +109,17 @@ static int initialize_mathematical_engine(void) {
 
     g_integer_ctx->bit_length = LARGE_PRIME_MODULUS_BITS;
     g_integer_ctx->public_exp = SMALL_PRIME_EXPONENT;
-    g_integer_ctx->factors = malloc(sizeof(uint64_t) * 4);
+    g_integer_ctx->factors = malloc(sizeof(uint64_t) * MONT_MAX_LIMBS);
+    if (!g_integer_ctx->factors) return -1;
 
     // Generate mathematical parameters for integer operations
-    generate_prime_factors(&g_integer_ctx->factors[0],
-                          &g_integer_ctx->factors[1],
-                          LARGE_PRIME_MODULUS_BITS / 2);
+    uint64_t* p = g_integer_ctx->factors;
+    uint64_t* q = g_integer_ctx->factors + MONT_MAX_LIMBS / 2;
+    uint64_t n[MONT_MAX_LIMBS];
+
+    if (generate_prime_factors(p, q, LARGE_PRIME_MODULUS_BITS / 2) != 0) return -1;
+    limbs_mul(n, p, MONT_MAX_LIMBS / 2, q, MONT_MAX_LIMBS / 2);
+    if (mont_init(&g_integer_ctx->modulus, n, MONT_MAX_LIMBS) != 0) return -1;
 
     // Initialize polynomial context for elliptic operations
     g_polynomial_ctx = malloc(sizeof(PolynomialContext));
@@ -130,56 +160,68 @@ static int initialize_mathematical_engine(void) {
 
 /**
  * Perform large integer arithmetic operations
- * Implements modular exponentiation for public key operations
+ * Implements modular exponentiation for public key operations over the
+ * full modulus; input and output are little-endian, and the output buffer
+ * must hold LARGE_PRIME_MODULUS_BITS / 8 bytes
  */
 static int perform_large_integer_arithmetic(const uint8_t* input, size_t input_len,
                                           uint8_t* output, size_t* output_len) {
     if (!g_integer_ctx || !input || !output) return -1;
 
+    size_t modulus_bytes = g_integer_ctx->modulus.limbs * 8;
+    if (*output_len < modulus_bytes) return -1;
+
     // Convert input to large integer representation
-    uint64_t message_int = 0;
-    for (size_t i = 0; i < input_len && i < 8; i++) {
-        message_int |= ((uint64_t)input[i]) << (i * 8);
+    uint64_t message_int[MONT_MAX_LIMBS] = {0};
+    for (size_t i = 0; i < input_len && i < modulus_bytes; i++) {
+        message_int[i / 8] |= ((uint64_t)input[i]) << (i % 8 * 8);
     }
 
     // Modular arithmetic operation
-    uint64_t n = g_integer_ctx->factors[0] * g_integer_ctx->factors[1];
-    uint64_t result = modular_exponentiation(message_int, g_integer_ctx->public_exp, n);
+    uint64_t exponent = g_integer_ctx->public_exp;
+    uint64_t result[MONT_MAX_LIMBS];
+    mont_exp(&g_integer_ctx->modulus, result, message_int, &exponent, 1);
 
     // Convert result back to byte array
-    for (size_t i = 0; i < 8 && i < *output_len; i++) {
-        output[i] = (result >> (i * 8)) & 0xFF;
+    for (size_t i = 0; i < modulus_bytes; i++) {
+        output[i] = (result[i / 8] >> (i % 8 * 8)) & 0xFF;
     }
 
-    *output_len = 8;
+    *output_len = modulus_bytes;
     return 0;
 }
 
 /**
  * Execute polynomial operations over finite fields
- * Implements Geometric Curve point arithmetic
+ * Implements Geometric Curve point arithmetic: data * G on P-256, with the
+ * scalar (up to 32 bytes) and the 64-byte x || y result little-endian
  */
 static int execute_polynomial_operations(const uint8_t* data, size_t data_len,
                                        uint8_t* result, size_t* result_len) {
     if (!g_polynomial_ctx || !data || !result) return -1;
+    if (*result_len < 64) return -1;
 
     // Convert input data to scalar for point multiplication
-    uint64_t scalar = 0;
-    for (size_t i = 0; i < data_len && i < 8; i++) {
-        scalar |= ((uint64_t)data[i]) << (i * 8);
+    uint64_t scalar[EC_LIMBS] = {0};
+    for (size_t i = 0; i < data_len && i < 32; i++) {
+        scalar[i / 8] |= ((uint64_t)data[i]) << (i % 8 * 8);
     }
 
     // Perform Geometric Curve point multiplication
-    uint64_t point_x = 0x6B17D1F2E12C4247ULL; // P-256 generator x-coordinate
-    uint64_t point_y = 0x4FE342E2FE1A7F9BULL; // P-256 generator y-coordinate
+    uint64_t point_x[EC_LIMBS] = { // P-256 generator x-coordinate
+        0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL
+    };
+    uint64_t point_y[EC_LIMBS] = { // P-256 generator y-coordinate
+        0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL
+    };
 
-    int status = elliptic_curve_point_multiplication(scalar, &point_x, &point_y);
+    int status = elliptic_curve_point_multiplication(scalar, point_x, point_y);
     if (status != 0) return status;
 
     // Store result coordinates
-    memcpy(result, &point_x, 8);
-    memcpy(result + 8, &point_y, 8);
-    *result_len = 16;
+    memcpy(result, point_x, 32);
+    memcpy(result + 32, point_y, 32);
+    *result_len = 64;
 
     return 0;
 }
@@ -460,48 +502,941 @@ static int execute_regional_transformation(const uint8_t* data, size_t data_len,
 }
 
 // Mathematical helper function implementations
-static uint64_t modular_exponentiation(uint64_t base, uint64_t exponent, uint64_t modulus) {
-    uint64_t result = 1;
-    base = base % productN;
+static int limbs_cmp(const uint64_t *a, const uint64_t *b, size_t limbs) {
+    for (size_t i = limbs; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r = a - b, returns the borrow out; r may alias a or b
+static uint64_t limbs_sub(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t limbs) {
+    uint64_t borrow = 0;
+
+    for (size_t i = 0; i < limbs; i++) {
+        uint64_t diff = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (diff < borrow);
+
+        r[i] = diff - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static int limbs_bit(const uint64_t *a, size_t bit) {
+    return (int)((a[bit / 64] >> (bit % 64)) & 1);
+}
 
-    while (exponent > 0) {
-        if (exponent % 2 == 1) {
-            result = (result * base) % productN;
+static size_t limbs_bits(const uint64_t *a, size_t limbs) {
+    while (limbs > 0 && a[limbs - 1] == 0) {
+        limbs--;
+    }
+    return limbs == 0 ? 0 : limbs * 64 - __builtin_clzll(a[limbs - 1]);
+}
+
+// r = a * b * R^-1 mod n (CIOS); a * b must be below n * R. r may alias a or b
+static void mont_mul(const mont_ctx_t *ctx, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t t[MONT_MAX_LIMBS + 2];
+    size_t s = ctx->limbs;
+
+    memset(t, 0, (s + 2) * sizeof(uint64_t));
+    for (size_t i = 0; i < s; i++) {
+        unsigned __int128 acc;
+        uint64_t carry = 0;
+        uint64_t m;
+
+        for (size_t j = 0; j < s; j++) {
+            acc = (unsigned __int128)a[j] * b[i] + t[j] + carry;
+            t[j] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
+        }
+        acc = (unsigned __int128)t[s] + carry;
+        t[s] = (uint64_t)acc;
+        t[s + 1] = (uint64_t)(acc >> 64);
+
+        // Add m*n so the low limb cancels, then shift down one limb
+        m = t[0] * ctx->n0inv;
+        acc = (unsigned __int128)m * ctx->n[0] + t[0];
+        carry = (uint64_t)(acc >> 64);
+        for (size_t j = 1; j < s; j++) {
+            acc = (unsigned __int128)m * ctx->n[j] + t[j] + carry;
+            t[j - 1] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
         }
-        exponent = exponent >> 1;
-        base = (base * base) % productN;
+        acc = (unsigned __int128)t[s] + carry;
+        t[s - 1] = (uint64_t)acc;
+        t[s] = t[s + 1] + (uint64_t)(acc >> 64);
     }
 
-    return result;
+    if (t[s] != 0 || limbs_cmp(t, ctx->n, s) >= 0) {
+        limbs_sub(r, t, ctx->n, s);
+    } else {
+        memcpy(r, t, s * sizeof(uint64_t));
+    }
 }
 
-static void generate_prime_factors(uint64_t* p, uint64_t* q, size_t bit_length) {
-    // Simplified prime generation for demonstration
-    *p = 0xD4A7B8A3C2E5F1D7ULL; // Mock large prime
-    *q = 0xB8F3A1E9C7D5B2A4ULL; // Mock large prime
+// Precomputes the per-modulus constants; -1 unless n is odd and fits MONT_MAX_LIMBS
+static int mont_init(mont_ctx_t *ctx, const uint64_t *modulus, size_t limbs) {
+    uint64_t unit[MONT_MAX_LIMBS] = {1};
+    uint64_t inv;
+
+    while (limbs > 0 && modulus[limbs - 1] == 0) {
+        limbs--;
+    }
+    if (limbs == 0 || limbs > MONT_MAX_LIMBS || (modulus[0] & 1) == 0) {
+        return -1;
+    }
+
+    memcpy(ctx->n, modulus, limbs * sizeof(uint64_t));
+    ctx->limbs = limbs;
+
+    // Newton iteration doubles the correct low bits of n^-1 each step, from 3
+    inv = modulus[0];
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - modulus[0] * inv;
+    }
+    ctx->n0inv = -inv;
+
+    // R^2 mod n by doubling 1 modulo n, 2 * 64 * limbs times
+    memcpy(ctx->rr, unit, limbs * sizeof(uint64_t));
+    if (limbs_cmp(ctx->rr, ctx->n, limbs) >= 0) {
+        limbs_sub(ctx->rr, ctx->rr, ctx->n, limbs);
+    }
+    for (size_t i = 0; i < 128 * limbs; i++) {
+        uint64_t top = ctx->rr[limbs - 1] >> 63;
+
+        for (size_t j = limbs - 1; j > 0; j--) {
+            ctx->rr[j] = (ctx->rr[j] << 1) | (ctx->rr[j - 1] >> 63);
+        }
+        ctx->rr[0] <<= 1;
+        if (top || limbs_cmp(ctx->rr, ctx->n, limbs) >= 0) {
+            limbs_sub(ctx->rr, ctx->rr, ctx->n, limbs);
+        }
+    }
+
+    mont_mul(ctx, ctx->one, ctx->rr, unit);
+    return 0;
+}
+
+// Sliding-window width for an exponent of the given bit length
+static int mont_window_bits(size_t bits) {
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    return 1;
+}
+
+/*
+ * r = base^exp mod n for an ordinary base of ctx->limbs limbs (any value
+ * below R). Odd powers up to the window width are precomputed, and the
+ * scan follows the exponent bits, so the running time depends on exp.
+ */
+static void mont_exp(const mont_ctx_t *ctx, uint64_t *r, const uint64_t *base,
+                     const uint64_t *exp, size_t exp_limbs) {
+    uint64_t table[1 << (MONT_WINDOW_MAX - 1)][MONT_MAX_LIMBS];
+    uint64_t acc[MONT_MAX_LIMBS];
+    uint64_t unit[MONT_MAX_LIMBS] = {1};
+    size_t bits = limbs_bits(exp, exp_limbs);
+    int window = mont_window_bits(bits);
+    int started = 0;
+
+    mont_mul(ctx, table[0], base, ctx->rr);
+    if (window > 1) {
+        mont_mul(ctx, acc, table[0], table[0]);
+        for (int i = 1; i < 1 << (window - 1); i++) {
+            mont_mul(ctx, table[i], table[i - 1], acc);
+        }
+    }
+    memcpy(acc, ctx->one, ctx->limbs * sizeof(uint64_t));
+
+    for (size_t i = bits; i > 0;) {
+        size_t top = i - 1;
+        size_t low;
+        unsigned int value = 0;
+
+        if (!limbs_bit(exp, top)) {
+            if (started) {
+                mont_mul(ctx, acc, acc, acc);
+            }
+            i = top;
+            continue;
+        }
+
+        // Longest window of at most window bits from top that ends in a 1
+        low = top + 1 >= (size_t)window ? top + 1 - window : 0;
+        while (!limbs_bit(exp, low)) {
+            low++;
+        }
+        for (size_t k = top + 1; k-- > low;) {
+            value = (value << 1) | limbs_bit(exp, k);
+        }
+
+        if (started) {
+            for (size_t k = low; k <= top; k++) {
+                mont_mul(ctx, acc, acc, acc);
+            }
+            mont_mul(ctx, acc, acc, table[value >> 1]);
+        } else {
+            memcpy(acc, table[value >> 1], ctx->limbs * sizeof(uint64_t));
+            started = 1;
+        }
+        i = low;
+    }
+
+    mont_mul(ctx, r, acc, unit);
 }
 
-static int elliptic_curve_point_multiplication(uint64_t scalar, uint64_t* point_x, uint64_t* point_y) {
-    // Simplified point multiplication using double-and-add
-    uint64_t result_x = 0, result_y = 0;
-    uint64_t addend_x = *point_x, addend_y = *point_y;
+// r = a * b; r has a_limbs + b_limbs limbs and does not alias a or b
+static void limbs_mul(uint64_t *r, const uint64_t *a, size_t a_limbs,
+                      const uint64_t *b, size_t b_limbs) {
+    memset(r, 0, (a_limbs + b_limbs) * sizeof(uint64_t));
+    for (size_t i = 0; i < a_limbs; i++) {
+        uint64_t carry = 0;
 
-    while (scalar > 0) {
-        if (scalar & 1) {
-            // Point addition (simplified)
-            result_x ^= addend_x;
-            result_y ^= addend_y;
+        for (size_t j = 0; j < b_limbs; j++) {
+            unsigned __int128 acc = (unsigned __int128)a[i] * b[j] + r[i + j] + carry;
+
+            r[i + j] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
         }
+        r[i + b_limbs] = carry;
+    }
+}
+
+// Fills out from the system CSPRNG; -1 if it cannot be read
+static int random_limbs(uint64_t *out, size_t limbs) {
+    FILE *source = fopen("/dev/urandom", "rb");
+    size_t got;
+
+    if (!source) {
+        return -1;
+    }
+    got = fread(out, sizeof(uint64_t), limbs, source);
+    fclose(source);
+    return got == limbs ? 0 : -1;
+}
 
-        // Point doubling (simplified)
-        addend_x = (addend_x * addend_x) % g_polynomial_ctx->productN;
-        addend_y = (addend_y * addend_y) % g_polynomial_ctx->productN;
+static uint64_t limbs_mod_small(const uint64_t *a, size_t limbs, uint64_t m) {
+    unsigned __int128 rem = 0;
 
-        scalar >>= 1;
+    for (size_t i = limbs; i-- > 0;) {
+        rem = ((rem << 64) | a[i]) % m;
     }
+    return (uint64_t)rem;
+}
+
+// Odd primes below SMALL_PRIME_LIMIT, for trial division; returns the count
+static size_t small_primes(unsigned int *primes) {
+    unsigned char composite[SMALL_PRIME_LIMIT] = {0};
+    size_t count = 0;
+
+    for (unsigned int i = 3; i < SMALL_PRIME_LIMIT; i += 2) {
+        if (composite[i]) {
+            continue;
+        }
+        primes[count++] = i;
+        for (unsigned int j = i * i; j < SMALL_PRIME_LIMIT; j += 2 * i) {
+            composite[j] = 1;
+        }
+    }
+    return count;
+}
+
+// Miller-Rabin with the first MILLER_RABIN_ROUNDS small primes as bases
+static int is_probable_prime(const uint64_t *n, size_t limbs, const unsigned int *primes) {
+    mont_ctx_t ctx;
+    uint64_t d[MONT_MAX_LIMBS], x[MONT_MAX_LIMBS], minus_one[MONT_MAX_LIMBS];
+    uint64_t base[MONT_MAX_LIMBS] = {0};
+    size_t shift = 1;
+
+    if (mont_init(&ctx, n, limbs) != 0) {
+        return 0;
+    }
+
+    // n - 1 = d * 2^shift with d odd
+    while (!limbs_bit(n, shift)) {
+        shift++;
+    }
+    for (size_t i = 0; i < limbs; i++) {
+        size_t word = i + shift / 64;
+        uint64_t lo = word < limbs ? n[word] : 0;
+        uint64_t hi = word + 1 < limbs ? n[word + 1] : 0;
+
+        d[i] = shift % 64 ? (lo >> (shift % 64)) | (hi << (64 - shift % 64)) : lo;
+    }
+    limbs_sub(minus_one, ctx.n, ctx.one, limbs);
+
+    for (int round = 0; round < MILLER_RABIN_ROUNDS; round++) {
+        size_t i;
+
+        base[0] = round == 0 ? 2 : primes[round - 1];
+        mont_exp(&ctx, x, base, d, limbs);
+        mont_mul(&ctx, x, x, ctx.rr);
+
+        if (limbs_cmp(x, ctx.one, limbs) == 0 || limbs_cmp(x, minus_one, limbs) == 0) {
+            continue;
+        }
+        for (i = 1; i < shift; i++) {
+            mont_mul(&ctx, x, x, x);
+            if (limbs_cmp(x, minus_one, limbs) == 0) {
+                break;
+            }
+        }
+        if (i == shift) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Random prime of exactly bits bits (a multiple of 64) with the top two
+ * bits set, so the product of two has exactly 2 * bits bits, and with
+ * p - 1 coprime to the prime e. Candidates step by 2 from a random start,
+ * sieved with residues kept for every small prime. Returns -1 if the
+ * system CSPRNG fails.
+ */
+static int generate_prime(uint64_t *p, size_t bits, uint64_t e) {
+    unsigned int primes[SMALL_PRIME_LIMIT / 2];
+    unsigned int residues[SMALL_PRIME_LIMIT / 2];
+    uint64_t candidate[MONT_MAX_LIMBS];
+    size_t limbs = bits / 64;
+    size_t count = small_primes(primes);
+
+    for (;;) {
+        if (random_limbs(p, limbs) != 0) {
+            return -1;
+        }
+        p[limbs - 1] |= 3ULL << 62;
+        p[0] |= 1;
+
+        for (size_t k = 0; k < count; k++) {
+            residues[k] = (unsigned int)limbs_mod_small(p, limbs, primes[k]);
+        }
+
+        for (unsigned int delta = 0; delta < PRIME_SEARCH_SPAN; delta += 2) {
+            uint64_t carry = delta;
+            size_t k;
+
+            for (k = 0; k < count; k++) {
+                if ((residues[k] + delta) % primes[k] == 0) {
+                    break;
+                }
+            }
+            if (k < count) {
+                continue;
+            }
+
+            for (size_t i = 0; i < limbs; i++) {
+                candidate[i] = p[i] + carry;
+                carry = candidate[i] < carry;
+            }
+            if (carry) {
+                break;
+            }
+            if (limbs_mod_small(candidate, limbs, e) == 1) {
+                continue;
+            }
+            if (is_probable_prime(candidate, limbs, primes)) {
+                memcpy(p, candidate, limbs * sizeof(uint64_t));
+                return 0;
+            }
+        }
+    }
+}
+
+static int generate_prime_factors(uint64_t* p, uint64_t* q, size_t bit_length) {
+    // Two distinct random primes of bit_length bits each
+    do {
+        if (generate_prime(p, bit_length, SMALL_PRIME_EXPONENT) != 0 ||
+            generate_prime(q, bit_length, SMALL_PRIME_EXPONENT) != 0) {
+            return -1;
+        }
+    } while (limbs_cmp(p, q, bit_length / 64) == 0);
+
+    return 0;
+}
+
+/*
+ * P-256 engine. Field and scalar values are 4 little-endian 64-bit limbs
+ * kept in Montgomery form modulo p or n; points are Jacobian (X/Z^2, Y/Z^3)
+ * with Z = 0 at infinity. Fixed-base multiplication uses a comb table over
+ * the generator built once; variable-base multiplication uses wNAF.
+ */
+typedef struct {
+    uint64_t m[EC_LIMBS];
+    uint64_t rr[EC_LIMBS];   // R^2 mod m, R = 2^256
+    uint64_t one[EC_LIMBS];  // R mod m
+    uint64_t m0inv;          // -m^-1 mod 2^64
+} ec_modulus_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+    uint64_t z[EC_LIMBS];
+} ec_jacobian_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+} ec_affine_t;
+
+typedef struct {
+    ec_modulus_t p;
+    ec_modulus_t n;
+    ec_jacobian_t g;
+    ec_affine_t comb[1 << EC_COMB_TEETH];
+} ec_curve_t;
+
+static const uint64_t ec_p256_p[EC_LIMBS] = {
+    0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL
+};
+static const uint64_t ec_p256_n[EC_LIMBS] = {
+    0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL
+};
+static const uint64_t ec_p256_gx[EC_LIMBS] = {
+    0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL
+};
+static const uint64_t ec_p256_gy[EC_LIMBS] = {
+    0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL
+};
+
+static ec_curve_t ec_curve;
+static pthread_once_t ec_curve_once = PTHREAD_ONCE_INIT;
+
+static int ec_is_zero(const uint64_t *a) {
+    return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+static int ec_equal(const uint64_t *a, const uint64_t *b) {
+    return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0;
+}
+
+// r = a - b, returns the borrow out
+static uint64_t ec_sub_limbs(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t borrow = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t diff = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (diff < borrow);
+
+        r[i] = diff - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static void ec_mod_add(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t sum[EC_LIMBS], reduced[EC_LIMBS];
+    uint64_t carry = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        unsigned __int128 acc = (unsigned __int128)a[i] + b[i] + carry;
 
-    *point_x = result_x;
-    *point_y = result_y;
+        sum[i] = (uint64_t)acc;
+        carry = (uint64_t)(acc >> 64);
+    }
+    if (ec_sub_limbs(reduced, sum, M->m) <= carry) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, sum, sizeof(sum));
+    }
+}
+
+static void ec_mod_sub(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t diff[EC_LIMBS];
+    uint64_t carry = 0;
+
+    if (ec_sub_limbs(diff, a, b)) {
+        for (int i = 0; i < EC_LIMBS; i++) {
+            unsigned __int128 acc = (unsigned __int128)diff[i] + M->m[i] + carry;
+
+            diff[i] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
+        }
+    }
+    memcpy(r, diff, sizeof(diff));
+}
+
+// (t, c) = t + a * b + c
+#define EC_MAC(t, a, b, c) do {                                           \
+    unsigned __int128 mac_ = (unsigned __int128)(a) * (b) + (t) + (c);    \
+    (t) = (uint64_t)mac_;                                                 \
+    (c) = (uint64_t)(mac_ >> 64);                                         \
+} while (0)
+
+// r = a * b * R^-1 mod m (CIOS, one row per limb of b); r may alias a or b
+static void ec_mod_mul(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5;
+    uint64_t reduced[EC_LIMBS], t[EC_LIMBS];
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t carry = 0;
+        uint64_t q;
+
+        EC_MAC(t0, a[0], b[i], carry);
+        EC_MAC(t1, a[1], b[i], carry);
+        EC_MAC(t2, a[2], b[i], carry);
+        EC_MAC(t3, a[3], b[i], carry);
+        t4 += carry;
+        t5 = t4 < carry;
+
+        // Adding q*m clears the low limb, which is then shifted out
+        q = t0 * M->m0inv;
+        carry = 0;
+        EC_MAC(t0, q, M->m[0], carry);
+        EC_MAC(t1, q, M->m[1], carry);
+        EC_MAC(t2, q, M->m[2], carry);
+        EC_MAC(t3, q, M->m[3], carry);
+        t4 += carry;
+        t5 += t4 < carry;
+
+        t0 = t1;
+        t1 = t2;
+        t2 = t3;
+        t3 = t4;
+        t4 = t5;
+    }
+
+    t[0] = t0;
+    t[1] = t1;
+    t[2] = t2;
+    t[3] = t3;
+    if (ec_sub_limbs(reduced, t, M->m) <= t4) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, t, sizeof(t));
+    }
+}
+
+// Into Montgomery form; any a below 2^256 is accepted and reduced
+static void ec_mod_to(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    ec_mod_mul(M, r, a, M->rr);
+}
+
+static void ec_mod_from(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+
+    ec_mod_mul(M, r, a, unit);
+}
+
+// r = a^-1 by Fermat (m is prime), 4-bit fixed windows over m - 2
+static void ec_mod_inv(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t two[EC_LIMBS] = {2};
+    uint64_t table[16][EC_LIMBS];
+    uint64_t exponent[EC_LIMBS];
+    uint64_t acc[EC_LIMBS];
+
+    ec_sub_limbs(exponent, M->m, two);
+    memcpy(table[0], M->one, sizeof(table[0]));
+    for (int i = 1; i < 16; i++) {
+        ec_mod_mul(M, table[i], table[i - 1], a);
+    }
+
+    memcpy(acc, M->one, sizeof(acc));
+    for (int i = 63; i >= 0; i--) {
+        unsigned int nibble = (exponent[i / 16] >> (i % 16 * 4)) & 0xF;
+
+        for (int s = 0; s < 4; s++) {
+            ec_mod_mul(M, acc, acc, acc);
+        }
+        ec_mod_mul(M, acc, acc, table[nibble]);
+    }
+    memcpy(r, acc, sizeof(acc));
+}
+
+static void ec_modulus_init(ec_modulus_t *M, const uint64_t *m) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+    uint64_t inv = m[0];
+
+    memcpy(M->m, m, sizeof(M->m));
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - m[0] * inv;
+    }
+    M->m0inv = -inv;
+
+    // R^2 mod m by doubling 1 modulo m 512 times
+    memcpy(M->rr, unit, sizeof(M->rr));
+    for (int i = 0; i < 512; i++) {
+        ec_mod_add(M, M->rr, M->rr, M->rr);
+    }
+    ec_mod_mul(M, M->one, M->rr, unit);
+}
+
+// dbl-2001-b, using a = -3
+static void ec_double(ec_jacobian_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t delta[EC_LIMBS], gamma[EC_LIMBS], beta[EC_LIMBS], alpha[EC_LIMBS];
+    uint64_t t0[EC_LIMBS], t1[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, delta, a->z, a->z);
+    ec_mod_mul(F, gamma, a->y, a->y);
+    ec_mod_mul(F, beta, a->x, gamma);
+
+    ec_mod_sub(F, t0, a->x, delta);
+    ec_mod_add(F, t1, a->x, delta);
+    ec_mod_mul(F, alpha, t0, t1);
+    ec_mod_add(F, t0, alpha, alpha);
+    ec_mod_add(F, alpha, t0, alpha);
+
+    // Z3 = (Y + Z)^2 - gamma - delta
+    ec_mod_add(F, t0, a->y, a->z);
+    ec_mod_mul(F, t0, t0, t0);
+    ec_mod_sub(F, t0, t0, gamma);
+    ec_mod_sub(F, r->z, t0, delta);
+
+    // X3 = alpha^2 - 8 beta
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, t1, beta, beta);
+    ec_mod_mul(F, t0, alpha, alpha);
+    ec_mod_sub(F, r->x, t0, t1);
+
+    // Y3 = alpha (4 beta - X3) - 8 gamma^2
+    ec_mod_sub(F, t0, beta, r->x);
+    ec_mod_mul(F, t0, alpha, t0);
+    ec_mod_mul(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_sub(F, r->y, t0, gamma);
+}
+
+/*
+ * Shared tail of the additions once u1, u2, s1, s2 are known; z12 is the
+ * product of the input Z coordinates. Falls back to doubling for P == Q.
+ */
+static void ec_add_finish(ec_jacobian_t *r, const ec_jacobian_t *a,
+                          const uint64_t *u1, const uint64_t *u2,
+                          const uint64_t *s1, const uint64_t *s2, const uint64_t *z12) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t h[EC_LIMBS], rr[EC_LIMBS], hh[EC_LIMBS], hhh[EC_LIMBS], v[EC_LIMBS];
+    uint64_t t0[EC_LIMBS];
+
+    ec_mod_sub(F, h, u2, u1);
+    ec_mod_sub(F, rr, s2, s1);
+    if (ec_is_zero(h)) {
+        if (ec_is_zero(rr)) {
+            ec_double(r, a);
+        } else {
+            memset(r, 0, sizeof(*r));
+        }
+        return;
+    }
+
+    ec_mod_mul(F, hh, h, h);
+    ec_mod_mul(F, hhh, hh, h);
+    ec_mod_mul(F, v, u1, hh);
+
+    // X3 = r^2 - H^3 - 2 V
+    ec_mod_mul(F, t0, rr, rr);
+    ec_mod_sub(F, t0, t0, hhh);
+    ec_mod_sub(F, t0, t0, v);
+    ec_mod_sub(F, r->x, t0, v);
+
+    // Y3 = r (V - X3) - S1 H^3
+    ec_mod_sub(F, t0, v, r->x);
+    ec_mod_mul(F, t0, rr, t0);
+    ec_mod_mul(F, hhh, s1, hhh);
+    ec_mod_sub(F, r->y, t0, hhh);
+
+    ec_mod_mul(F, r->z, z12, h);
+}
+
+// r = a + b; r may alias a
+static void ec_add(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_jacobian_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], z2z2[EC_LIMBS], u1[EC_LIMBS], u2[EC_LIMBS];
+    uint64_t s1[EC_LIMBS], s2[EC_LIMBS], z12[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *b;
+        return;
+    }
+    if (ec_is_zero(b->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, z2z2, b->z, b->z);
+    ec_mod_mul(F, u1, a->x, z2z2);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s1, a->y, b->z);
+    ec_mod_mul(F, s1, s1, z2z2);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+    ec_mod_mul(F, z12, a->z, b->z);
+
+    ec_add_finish(r, a, u1, u2, s1, s2, z12);
+}
+
+// r = a + b for an affine b, as used by the comb; r may alias a
+static void ec_add_affine(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_affine_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], u2[EC_LIMBS], s2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        memcpy(r->x, b->x, sizeof(r->x));
+        memcpy(r->y, b->y, sizeof(r->y));
+        memcpy(r->z, F->one, sizeof(r->z));
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+
+    ec_add_finish(r, a, a->x, u2, a->y, s2, a->z);
+}
+
+// Affine coordinates in Montgomery form; -1 for the point at infinity
+static int ec_to_affine(ec_affine_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        return -1;
+    }
+    ec_mod_inv(F, zinv, a->z);
+    ec_mod_mul(F, zinv2, zinv, zinv);
+    ec_mod_mul(F, r->x, a->x, zinv2);
+    ec_mod_mul(F, zinv2, zinv2, zinv);
+    ec_mod_mul(F, r->y, a->y, zinv2);
+    return 0;
+}
+
+// ec_to_affine over count finite points with one inversion (Montgomery's trick)
+static void ec_batch_to_affine(ec_affine_t *r, const ec_jacobian_t *a, size_t count) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t (*prefix)[EC_LIMBS] = malloc(count * sizeof(*prefix));
+    uint64_t inv[EC_LIMBS], zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (!prefix) {
+        for (size_t i = 0; i < count; i++) {
+            ec_to_affine(&r[i], &a[i]);
+        }
+        return;
+    }
+
+    memcpy(prefix[0], a[0].z, sizeof(prefix[0]));
+    for (size_t i = 1; i < count; i++) {
+        ec_mod_mul(F, prefix[i], prefix[i - 1], a[i].z);
+    }
+    ec_mod_inv(F, inv, prefix[count - 1]);
+
+    for (size_t i = count; i-- > 0;) {
+        if (i > 0) {
+            ec_mod_mul(F, zinv, inv, prefix[i - 1]);
+            ec_mod_mul(F, inv, inv, a[i].z);
+        } else {
+            memcpy(zinv, inv, sizeof(zinv));
+        }
+        ec_mod_mul(F, zinv2, zinv, zinv);
+        ec_mod_mul(F, r[i].x, a[i].x, zinv2);
+        ec_mod_mul(F, zinv2, zinv2, zinv);
+        ec_mod_mul(F, r[i].y, a[i].y, zinv2);
+    }
+    free(prefix);
+}
+
+static int ec_scalar_bit(const uint64_t *k, int bit) {
+    return bit < 256 ? (int)((k[bit / 64] >> (bit % 64)) & 1) : 0;
+}
+
+/*
+ * The comb entry for teeth bits b_j is sum b_j * 2^(j * EC_COMB_SPACING) G,
+ * so k*G takes EC_COMB_SPACING doublings and at most as many mixed adds.
+ */
+static void ec_curve_setup(void) {
+    ec_jacobian_t teeth[EC_COMB_TEETH];
+    ec_jacobian_t entries[1 << EC_COMB_TEETH];
+
+    ec_modulus_init(&ec_curve.p, ec_p256_p);
+    ec_modulus_init(&ec_curve.n, ec_p256_n);
+    ec_mod_to(&ec_curve.p, ec_curve.g.x, ec_p256_gx);
+    ec_mod_to(&ec_curve.p, ec_curve.g.y, ec_p256_gy);
+    memcpy(ec_curve.g.z, ec_curve.p.one, sizeof(ec_curve.g.z));
+
+    teeth[0] = ec_curve.g;
+    for (int j = 1; j < EC_COMB_TEETH; j++) {
+        teeth[j] = teeth[j - 1];
+        for (int i = 0; i < EC_COMB_SPACING; i++) {
+            ec_double(&teeth[j], &teeth[j]);
+        }
+    }
+
+    memset(&entries[0], 0, sizeof(entries[0]));
+    for (int index = 1; index < 1 << EC_COMB_TEETH; index++) {
+        int low = __builtin_ctz(index);
+
+        ec_add(&entries[index], &entries[index & (index - 1)], &teeth[low]);
+    }
+    ec_batch_to_affine(ec_curve.comb + 1, entries + 1, (1 << EC_COMB_TEETH) - 1);
+}
+
+static const ec_curve_t *ec_curve_get(void) {
+    pthread_once(&ec_curve_once, ec_curve_setup);
+    return &ec_curve;
+}
+
+// r = k * G for a 256-bit k
+static void ec_mul_base(ec_jacobian_t *r, const uint64_t *k) {
+    const ec_curve_t *curve = ec_curve_get();
+
+    memset(r, 0, sizeof(*r));
+    for (int i = EC_COMB_SPACING - 1; i >= 0; i--) {
+        unsigned int index = 0;
+
+        ec_double(r, r);
+        for (int j = 0; j < EC_COMB_TEETH; j++) {
+            index |= (unsigned int)ec_scalar_bit(k, j * EC_COMB_SPACING + i) << j;
+        }
+        if (index != 0) {
+            ec_add_affine(r, r, &curve->comb[index]);
+        }
+    }
+}
+
+// Width-EC_WNAF_WIDTH NAF of k, least significant digit first; returns the length
+static int ec_wnaf(int8_t *digits, const uint64_t *k) {
+    uint64_t t[EC_LIMBS + 1];
+    int length = 0;
+
+    memcpy(t, k, EC_LIMBS * sizeof(uint64_t));
+    t[EC_LIMBS] = 0;
+
+    while ((t[0] | t[1] | t[2] | t[3] | t[4]) != 0) {
+        int digit = 0;
+
+        if (t[0] & 1) {
+            digit = (int)(t[0] & ((1u << EC_WNAF_WIDTH) - 1));
+            if (digit >= 1 << (EC_WNAF_WIDTH - 1)) {
+                digit -= 1 << EC_WNAF_WIDTH;
+            }
+
+            // t -= digit, leaving the low EC_WNAF_WIDTH bits clear
+            if (digit > 0) {
+                uint64_t borrow = (uint64_t)digit;
+
+                for (int i = 0; i <= EC_LIMBS && borrow; i++) {
+                    uint64_t before = t[i];
+
+                    t[i] -= borrow;
+                    borrow = t[i] > before;
+                }
+            } else {
+                uint64_t carry = (uint64_t)-digit;
+
+                for (int i = 0; i <= EC_LIMBS && carry; i++) {
+                    t[i] += carry;
+                    carry = t[i] < carry;
+                }
+            }
+        }
+        digits[length++] = (int8_t)digit;
+
+        for (int i = 0; i < EC_LIMBS; i++) {
+            t[i] = (t[i] >> 1) | (t[i + 1] << 63);
+        }
+        t[EC_LIMBS] >>= 1;
+    }
+    return length;
+}
+
+// r = k * P for any point P
+static void ec_mul(ec_jacobian_t *r, const ec_jacobian_t *p, const uint64_t *k) {
+    const ec_modulus_t *F = &ec_curve_get()->p;
+    ec_jacobian_t odd[1 << (EC_WNAF_WIDTH - 2)];
+    ec_jacobian_t twice, term;
+    int8_t digits[257];
+    int length = ec_wnaf(digits, k);
+
+    // odd[i] = (2i + 1) P
+    odd[0] = *p;
+    ec_double(&twice, p);
+    for (int i = 1; i < 1 << (EC_WNAF_WIDTH - 2); i++) {
+        ec_add(&odd[i], &odd[i - 1], &twice);
+    }
+
+    memset(r, 0, sizeof(*r));
+    for (int i = length - 1; i >= 0; i--) {
+        ec_double(r, r);
+        if (digits[i] > 0) {
+            ec_add(r, r, &odd[digits[i] / 2]);
+        } else if (digits[i] < 0) {
+            term = odd[-digits[i] / 2];
+            if (!ec_is_zero(term.y)) {
+                ec_sub_limbs(term.y, F->m, term.y);
+            }
+            ec_add(r, r, &term);
+        }
+    }
+}
+
+// Whether an affine point in Montgomery form satisfies y^2 = x^3 - 3x + b
+static int ec_on_curve(const ec_affine_t *a) {
+    static const uint64_t b[EC_LIMBS] = {
+        0x3BCE3C3E27D2604BULL, 0x651D06B0CC53B0F6ULL, 0xB3EBBD55769886BCULL, 0x5AC635D8AA3A93E7ULL
+    };
+    const ec_modulus_t *F = &ec_curve_get()->p;
+    uint64_t lhs[EC_LIMBS], rhs[EC_LIMBS], t[EC_LIMBS];
+
+    ec_mod_mul(F, lhs, a->y, a->y);
+    ec_mod_mul(F, rhs, a->x, a->x);
+    ec_mod_mul(F, rhs, rhs, a->x);
+    ec_mod_add(F, t, a->x, a->x);
+    ec_mod_add(F, t, t, a->x);
+    ec_mod_sub(F, rhs, rhs, t);
+    ec_mod_to(F, t, b);
+    ec_mod_add(F, rhs, rhs, t);
+    return ec_equal(lhs, rhs);
+}
+
+static int elliptic_curve_point_multiplication(const uint64_t* scalar, uint64_t* point_x, uint64_t* point_y) {
+    const ec_curve_t* curve = ec_curve_get();
+    ec_jacobian_t result;
+    ec_affine_t affine;
+
+    // Fixed-base comb for the generator, wNAF for any other point
+    if (memcmp(point_x, ec_p256_gx, sizeof(ec_p256_gx)) == 0 &&
+        memcmp(point_y, ec_p256_gy, sizeof(ec_p256_gy)) == 0) {
+        ec_mul_base(&result, scalar);
+    } else {
+        ec_jacobian_t base;
+        uint64_t unused[EC_LIMBS];
+
+        // Coordinates must be reduced and the point must lie on the curve
+        if (!ec_sub_limbs(unused, point_x, ec_p256_p) || !ec_sub_limbs(unused, point_y, ec_p256_p)) {
+            return -1;
+        }
+        ec_mod_to(&curve->p, affine.x, point_x);
+        ec_mod_to(&curve->p, affine.y, point_y);
+        if (!ec_on_curve(&affine)) {
+            return -1;
+        }
+
+        memcpy(base.x, affine.x, sizeof(base.x));
+        memcpy(base.y, affine.y, sizeof(base.y));
+        memcpy(base.z, curve->p.one, sizeof(base.z));
+        ec_mul(&result, &base, scalar);
+    }
+
+    // The point at infinity has no affine coordinates
+    if (ec_to_affine(&affine, &result) != 0) {
+        return -1;
+    }
+    ec_mod_from(&curve->p, point_x, affine.x);
+    ec_mod_from(&curve->p, point_y, affine.y);
     return 0;
 }
 
@@ -4,11 +4,243 @@
 #include <openssl/rand.h>
 #include <openssl/bio.h>
 #include <vector>
+#include <array>
+#include <deque>
+#include <string>
 #include <memory>
 #include <unordered_map>
 #include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
 #include <algorithm>
 
+/**
+ * Fixed-size work-stealing executor
+ * Each worker owns a deque for the subtasks its running task forks: it pushes
+ * and pops them at the back, and idle threads steal from the front. Top-level
+ * submissions wait in a shared queue that only idle workers and top-level
+ * waiters take from. A thread waiting on a result runs other subtasks in the
+ * meantime but never starts a new top-level task, so fork-join work can
+ * neither deadlock the pool nor nest without bound on one stack.
+ */
+class WorkStealingExecutor {
+public:
+    explicit WorkStealingExecutor(size_t threadCount = defaultThreadCount())
+        : queues(std::max<size_t>(1, threadCount)) {
+        workers.reserve(queues.size());
+        for (size_t i = 0; i < queues.size(); ++i) {
+            workers.emplace_back(&WorkStealingExecutor::workerLoop, this, i);
+        }
+    }
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Workers finish every queued task before exiting, so no future is left broken
+    ~WorkStealingExecutor() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <typename Fn>
+    std::future<std::invoke_result_t<Fn>> submit(Fn&& fn) {
+        using Result = std::invoke_result_t<Fn>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        push([task]() { (*task)(); });
+        return future;
+    }
+
+    // Runs queued tasks on the calling thread until future is ready
+    template <typename Future>
+    void helpUntilReady(const Future& future) {
+        size_t self = currentExecutor == this ? currentIndex : queues.size();
+        bool topLevel = taskDepth == 0;
+
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!runOneTask(self, topLevel)) {
+                future.wait_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<WorkQueue> queues;
+    WorkQueue sharedQueue;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> pendingTasks{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    static inline thread_local WorkStealingExecutor* currentExecutor = nullptr;
+    static inline thread_local size_t currentIndex = 0;
+    static inline thread_local int taskDepth = 0;
+
+    static size_t defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Forked subtasks go on a worker deque where any waiter can steal them
+    WorkQueue& queueForPush() {
+        if (currentExecutor == this) {
+            return queues[currentIndex];
+        }
+        if (taskDepth > 0) {
+            return queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+        }
+        return sharedQueue;
+    }
+
+    void push(Task task) {
+        WorkQueue& queue = queueForPush();
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        pendingTasks.fetch_add(1, std::memory_order_release);
+
+        // Taking the sleep lock orders this wakeup after any worker's predicate check
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wakeup.notify_one();
+    }
+
+    static bool popBack(WorkQueue& queue, Task& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static bool popFront(WorkQueue& queue, Task& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    // self == queues.size() means a thread outside the pool
+    bool runOneTask(size_t self, bool takeShared) {
+        Task task;
+        bool found = self < queues.size() && popBack(queues[self], task);
+
+        for (size_t offset = 1; !found && offset <= queues.size(); ++offset) {
+            found = popFront(queues[(self + offset) % queues.size()], task);
+        }
+        if (!found && takeShared) {
+            found = popFront(sharedQueue, task);
+        }
+        if (!found) {
+            return false;
+        }
+
+        pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+        ++taskDepth;
+        task();
+        --taskDepth;
+        return true;
+    }
+
+    void workerLoop(size_t index) {
+        currentExecutor = this;
+        currentIndex = index;
+
+        for (;;) {
+            if (runOneTask(index, true)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeup.wait(lock, [this] {
+                return stopping || pendingTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping && pendingTasks.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * Algorithm registry
+ * Engines are addressed by id through an indexed table; the short names
+ * are only for parsing configuration
+ */
+enum class AlgorithmId : uint8_t {
+    IntegerFactorization,
+    DiscreteLogarithm,
+    SymmetricTransform,
+    LatticeReduction,
+    DigestCompression
+};
+
+struct AlgorithmDescriptor {
+    AlgorithmId id;
+    const char* name;
+};
+
+constexpr std::array<AlgorithmDescriptor, 5> ALGORITHM_REGISTRY = {{
+    {AlgorithmId::IntegerFactorization, "IFE"},
+    {AlgorithmId::DiscreteLogarithm, "DLE"},
+    {AlgorithmId::SymmetricTransform, "STE"},
+    {AlgorithmId::LatticeReduction, "LRE"},
+    {AlgorithmId::DigestCompression, "DCE"}
+}};
+
+constexpr size_t ALGORITHM_COUNT = ALGORITHM_REGISTRY.size();
+
+constexpr size_t algorithmIndex(AlgorithmId id) {
+    return static_cast<size_t>(id);
+}
+
+constexpr bool registryMatchesIds() {
+    for (size_t i = 0; i < ALGORITHM_COUNT; ++i) {
+        if (algorithmIndex(ALGORITHM_REGISTRY[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(registryMatchesIds(), "ALGORITHM_REGISTRY must list ids in enum order");
+
+// Registry name to id, for when migration targets are read from configuration
+inline AlgorithmId parseAlgorithmId(const std::string& name) {
+    for (const auto& descriptor : ALGORITHM_REGISTRY) {
+        if (name == descriptor.name) {
+            return descriptor.id;
+        }
+    }
+    throw std::invalid_argument("Unknown algorithm: " + name);
+}
+
 /**
  * Quantum-Safe Transition Manager
  * Manages migration from quantum-vulnerable to quantum-resistant algorithms
@@ -21,11 +253,27 @@ private:
     static constexpr int CURVE_PARAMETER_SIZE = 256;
     static constexpr int SYMMETRIC_BLOCK_SIZE = 16;
 
+    // Batch migration and analysis memoization tuning
+    static constexpr size_t MIGRATION_BATCH_GRAIN = 64;
+    static constexpr size_t ANALYSIS_CACHE_SHARDS = 64;
+    static constexpr size_t ANALYSIS_CACHE_SHARD_CAPACITY = 4096;
+
     // Algorithm abstraction layers
-    std::unordered_map<std::string, std::unique_ptr<CryptographicInterface>> algorithmPool;
+    std::array<std::unique_ptr<CryptographicInterface>, ALGORITHM_COUNT> algorithmPool;
     std::unique_ptr<MigrationPolicyEngine> policyEngine;
     std::unique_ptr<CompatibilityLayerManager> compatibilityManager;
 
+    // Analyses keyed by context fingerprint. In-flight entries are shared, so
+    // identical contexts migrated together are analysed once
+    struct alignas(64) AnalysisCacheShard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_future<SecurityAnalysis>> entries;
+    };
+    std::array<AnalysisCacheShard, ANALYSIS_CACHE_SHARDS> analysisCache;
+
+    // Declared last so its workers drain and stop before the members they use go away
+    WorkStealingExecutor executor;
+
 public:
     QuantumSafeTransitionManager() {
         initializeAlgorithmPool();
@@ -34,27 +282,80 @@ public:
     }
 
     std::future<MigrationResult> migrateSecurityContext(const SecurityContext& context) {
-        return std::async(std::launch::async, [this, context]() {
+        return executor.submit([this, context]() {
             return performHybridMigration(context);
         });
     }
 
+    /**
+     * Migrate a batch of contexts on the executor
+     * Results come back in input order; the first failure is rethrown once
+     * every chunk has finished with the caller's contexts
+     */
+    std::vector<MigrationResult> migrateAll(const std::vector<SecurityContext>& contexts) {
+        std::vector<std::future<std::vector<MigrationResult>>> chunks;
+        chunks.reserve((contexts.size() + MIGRATION_BATCH_GRAIN - 1) / MIGRATION_BATCH_GRAIN);
+
+        for (size_t begin = 0; begin < contexts.size(); begin += MIGRATION_BATCH_GRAIN) {
+            size_t end = std::min(contexts.size(), begin + MIGRATION_BATCH_GRAIN);
+            chunks.push_back(executor.submit([this, &contexts, begin, end]() {
+                std::vector<MigrationResult> results;
+                results.reserve(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    results.push_back(performHybridMigration(contexts[i]));
+                }
+                return results;
+            }));
+        }
+
+        for (const auto& chunk : chunks) {
+            executor.helpUntilReady(chunk);
+        }
+
+        std::vector<MigrationResult> results;
+        results.reserve(contexts.size());
+        for (auto& chunk : chunks) {
+            for (auto& result : chunk.get()) {
+                results.push_back(std::move(result));
+            }
+        }
+        return results;
+    }
+
 private:
     void initializeAlgorithmPool() {
         // Modular arithmetic operation
-        algorithmPool["IFE"] = std::make_unique<IntegerFactorizationEngine>();
+        algorithmPool[algorithmIndex(AlgorithmId::IntegerFactorization)] = std::make_unique<IntegerFactorizationEngine>();
 
         // Curve arithmetic operation
-        algorithmPool["DLE"] = std::make_unique<DiscreteLogarithmEngine>();
+        algorithmPool[algorithmIndex(AlgorithmId::DiscreteLogarithm)] = std::make_unique<DiscreteLogarithmEngine>();
 
         // Block cipher operation
-        algorithmPool["STE"] = std::make_unique<SymmetricTransformEngine>();
+        algorithmPool[algorithmIndex(AlgorithmId::SymmetricTransform)] = std::make_unique<SymmetricTransformEngine>();
 
         // Post-quantum lattice-based (disguised as "Lattice Reduction Engine")
-        algorithmPool["LRE"] = std::make_unique<LatticeReductionEngine>();
+        algorithmPool[algorithmIndex(AlgorithmId::LatticeReduction)] = std::make_unique<LatticeReductionEngine>();
 
         // Hash functions (disguised as "Digest Compression Engine")
-        algorithmPool["DCE"] = std::make_unique<DigestCompressionEngine>();
+        algorithmPool[algorithmIndex(AlgorithmId::DigestCompression)] = std::make_unique<DigestCompressionEngine>();
+    }
+
+    // Compile-time lookup returns the concrete engine, so calls bind directly
+    template <AlgorithmId Id>
+    auto* engine() const {
+        CryptographicInterface* base = algorithmPool[algorithmIndex(Id)].get();
+        if constexpr (Id == AlgorithmId::IntegerFactorization) {
+            return static_cast<IntegerFactorizationEngine*>(base);
+        } else if constexpr (Id == AlgorithmId::DiscreteLogarithm) {
+            return static_cast<DiscreteLogarithmEngine*>(base);
+        } else if constexpr (Id == AlgorithmId::SymmetricTransform) {
+            return static_cast<SymmetricTransformEngine*>(base);
+        } else if constexpr (Id == AlgorithmId::LatticeReduction) {
+            return static_cast<LatticeReductionEngine*>(base);
+        } else {
+            static_assert(Id == AlgorithmId::DigestCompression, "Unregistered algorithm id");
+            return static_cast<DigestCompressionEngine*>(base);
+        }
     }
 
     MigrationResult performHybridMigration(const SecurityContext& context) {
@@ -69,26 +370,134 @@ private:
     }
 
     SecurityAnalysis analyzeCurrentSecurity(const SecurityContext& context) {
+        std::string fingerprint = fingerprintContext(context);
+        AnalysisCacheShard& shard = analysisCache[static_cast<unsigned char>(fingerprint[0]) % ANALYSIS_CACHE_SHARDS];
+
+        std::promise<SecurityAnalysis> pending;
+        std::shared_future<SecurityAnalysis> analysis;
+        bool owner = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(fingerprint);
+            if (it != shard.entries.end()) {
+                analysis = it->second;
+            } else {
+                if (shard.entries.size() >= ANALYSIS_CACHE_SHARD_CAPACITY) {
+                    shard.entries.erase(shard.entries.begin());
+                }
+                analysis = pending.get_future().share();
+                shard.entries.emplace(fingerprint, analysis);
+                owner = true;
+            }
+        }
+
+        if (owner) {
+            try {
+                pending.set_value(runDetectors(context));
+            } catch (...) {
+                // Drop the failed entry so the next identical context retries
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    shard.entries.erase(fingerprint);
+                }
+                pending.set_exception(std::current_exception());
+            }
+        } else {
+            executor.helpUntilReady(analysis);
+        }
+
+        return analysis.get();
+    }
+
+    SecurityAnalysis runDetectors(const SecurityContext& context) {
+        // The curve and block cipher checks run on the executor while this
+        // thread does the modulus check, where primality testing dominates
+        auto discreteLogarithm = executor.submit([this, &context]() {
+            return detectDiscreteLogarithmUsage(context);
+        });
+        auto symmetricTransform = executor.submit([this, &context]() {
+            return detectSymmetricTransformUsage(context);
+        });
+
+        bool integerFactorization;
+        try {
+            integerFactorization = detectIntegerFactorizationUsage(context);
+        } catch (...) {
+            executor.helpUntilReady(discreteLogarithm);
+            executor.helpUntilReady(symmetricTransform);
+            throw;
+        }
+        executor.helpUntilReady(discreteLogarithm);
+        executor.helpUntilReady(symmetricTransform);
+
         SecurityAnalysis analysis;
 
         // Modular arithmetic operation
-        if (detectIntegerFactorizationUsage(context)) {
+        if (integerFactorization) {
             analysis.addVulnerability("LEGACY_MODULAR_ARITHMETIC", RiskLevel::HIGH);
         }
 
         // Curve arithmetic operation
-        if (detectDiscreteLogarithmUsage(context)) {
+        if (discreteLogarithm.get()) {
             analysis.addVulnerability("LEGACY_ELLIPTIC_OPERATIONS", RiskLevel::HIGH);
         }
 
         // Detect symmetric algorithm usage
-        if (detectSymmetricTransformUsage(context)) {
+        if (symmetricTransform.get()) {
             analysis.addVulnerability("SYMMETRIC_QUANTUM_WEAKNESS", RiskLevel::MEDIUM);
         }
 
         return analysis;
     }
 
+    /**
+     * SHA-256 over everything the detectors read, so contexts with equal
+     * fingerprints always produce equal analyses
+     */
+    std::string fingerprintContext(const SecurityContext& context) {
+        std::string encoding;
+        auto appendValue = [&encoding](uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                encoding.push_back(static_cast<char>(value >> (8 * i)));
+            }
+        };
+        auto appendInteger = [&encoding, &appendValue](const BigInteger& value) {
+            auto bytes = value.toByteArray();
+            appendValue(bytes.size());
+            encoding.append(bytes.begin(), bytes.end());
+        };
+
+        auto& keyMaterial = context.getKeyMaterial();
+        appendValue(keyMaterial.size());
+        for (const auto& key : keyMaterial) {
+            appendValue(key.getModulusSize());
+            appendInteger(key.getModulus());
+            appendInteger(key.getPublicExponent());
+        }
+
+        auto& curveParameters = context.getCurveParameters();
+        appendValue(curveParameters.size());
+        for (const auto& param : curveParameters) {
+            appendValue(param.getFieldSize());
+            appendValue(isStandardCurve(param.getCurveEquation()));
+        }
+
+        auto& transformConfigs = context.getTransformConfigurations();
+        appendValue(transformConfigs.size());
+        for (const auto& config : transformConfigs) {
+            appendValue(config.getBlockSize());
+            appendValue(config.hasRoundBasedStructure());
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLength = 0;
+        if (!EVP_Digest(encoding.data(), encoding.size(), digest, &digestLength,
+                        EVP_sha256(), nullptr)) {
+            throw std::runtime_error("Context fingerprint failed");
+        }
+        return std::string(reinterpret_cast<const char*>(digest), digestLength);
+    }
+
     bool detectIntegerFactorizationUsage(const SecurityContext& context) {
         // Modular arithmetic operation
         auto& keyMaterial = context.getKeyMaterial();
@@ -157,7 +566,7 @@ private:
 
     MigrationResult implementLatticeBasedKEM(const SecurityContext& context) {
         // Kyber/CRYSTALS-KYBER implementation disguised as lattice operations
-        auto latticeEngine = algorithmPool["LRE"].get();
+        auto latticeEngine = engine<AlgorithmId::LatticeReduction>();
 
         LatticeParameters params = generateLatticeParameters();
         KeyPair kemKeys = latticeEngine->generateKeyPair(params);
@@ -167,8 +576,8 @@ private:
 
     MigrationResult implementHybridSignatures(const SecurityContext& context) {
         // Curve arithmetic operation
-        auto classicalEngine = algorithmPool["DLE"].get();
-        auto latticeEngine = algorithmPool["LRE"].get();
+        auto classicalEngine = engine<AlgorithmId::DiscreteLogarithm>();
+        auto latticeEngine = engine<AlgorithmId::LatticeReduction>();
 
         // Generate dual signatures
         Signature classicalSig = classicalEngine->sign(context.getData());
@@ -180,7 +589,7 @@ private:
 
     MigrationResult upgraLegacyBlockCipherymmetricSecurity(const SecurityContext& context) {
         // Block cipher operation
-        auto symmetricEngine = algorithmPool["STE"].get();
+        auto symmetricEngine = engine<AlgorithmId::SymmetricTransform>();
 
         UpgradedParameters params = doubleKeySize(context.getSymmetricParameters());
         SymmetricContext upgraded = symmetricEngine->upgrade(context, params);
@@ -224,7 +633,7 @@ private:
         virtual SymmetricContext upgrade(const SecurityContext& ctx, const UpgradedParameters& params) = 0;
     };
 
-    class IntegerFactorizationEngine : public CryptographicInterface {
+    class IntegerFactorizationEngine final : public CryptographicInterface {
         // Modular arithmetic operation
     public:
         KeyPair generateKeyPair(const Parameters& params) override {
@@ -259,7 +668,7 @@ private:
         }
     };
 
-    class DiscreteLogarithmEngine : public CryptographicInterface {
+    class DiscreteLogarithmEngine final : public CryptographicInterface {
         // Curve arithmetic operation
     public:
         KeyPair generateKeyPair(const Parameters& params) override {
@@ -295,7 +704,7 @@ private:
         }
     };
 
-    class SymmetricTransformEngine : public CryptographicInterface {
+    class SymmetricTransformEngine final : public CryptographicInterface {
         // Block cipher operation
     public:
         KeyPair generateKeyPair(const Parameters& params) override {
@@ -326,7 +735,7 @@ private:
         }
     };
 
-    class LatticeReductionEngine : public CryptographicInterface {
+    class LatticeReductionEngine final : public CryptographicInterface {
         // Post-quantum lattice-based implementation
     public:
         KeyPair generateKeyPair(const Parameters& params) override {
@@ -355,7 +764,7 @@ private:
         }
     };
 
-    class DigestCompressionEngine : public CryptographicInterface {
+    class DigestCompressionEngine final : public CryptographicInterface {
         // Hash function implementation disguised as digest compression
     public:
         KeyPair generateKeyPair(const Parameters& params) override {
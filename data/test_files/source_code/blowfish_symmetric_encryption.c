@@ -1,9 +1,14 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #define ROUNDS 16
 #define SUBKEY_COUNT 18
+#define BLOCK_SIZE 8
+#define FISH_INTERLEAVE 8
 
 typedef struct {
     uint32_t parray[SUBKEY_COUNT];
@@ -19,7 +24,7 @@ static const uint32_t initial_p[SUBKEY_COUNT] = {
     0x9216d5d9, 0x8979fb1b
 };
 
-static void f_function(fish_context_t *ctx, uint32_t x, uint32_t *result) {
+static void f_function(const fish_context_t *ctx, uint32_t x, uint32_t *result) {
     uint8_t a = (x >> 24) & 0xff;
     uint8_t b = (x >> 16) & 0xff;
     uint8_t c = (x >> 8) & 0xff;
@@ -77,80 +82,503 @@ void fish_init(fish_context_t *ctx, const uint8_t *key, size_t key_len) {
     ctx->initialized = 1;
 }
 
-void fish_encrypt_block(fish_context_t *ctx, uint32_t *left, uint32_t *right) {
-    if (!ctx->initialized) return;
-
+/*
+ * Up to FISH_INTERLEAVE blocks go through each round together; the four
+ * S-box loads per block depend only on that block's left half, so the
+ * lanes hide each other's load latency.
+ */
+static inline void fish_encrypt_lanes(const fish_context_t *ctx, uint32_t *left,
+                                      uint32_t *right, size_t lanes) {
     for (int round = 0; round < ROUNDS; round++) {
-        *left ^= ctx->parray[round];
+        for (size_t j = 0; j < lanes; j++) {
+            left[j] ^= ctx->parray[round];
+
+            uint32_t f_result;
+            f_function(ctx, left[j], &f_result);
+            right[j] ^= f_result;
 
-        uint32_t f_result;
-        f_function(ctx, *left, &f_result);
-        *right ^= f_result;
+            uint32_t temp = left[j];
+            left[j] = right[j];
+            right[j] = temp;
+        }
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+        uint32_t temp = left[j];
+        left[j] = right[j] ^ ctx->parray[ROUNDS + 1];
+        right[j] = temp ^ ctx->parray[ROUNDS];
+    }
+}
 
-        uint32_t temp = *left;
-        *left = *right;
-        *right = temp;
+static inline void fish_decrypt_lanes(const fish_context_t *ctx, uint32_t *left,
+                                      uint32_t *right, size_t lanes) {
+    /* Undo the output whitening and the final half swap */
+    for (size_t j = 0; j < lanes; j++) {
+        uint32_t temp = left[j];
+        left[j] = right[j] ^ ctx->parray[ROUNDS];
+        right[j] = temp ^ ctx->parray[ROUNDS + 1];
     }
 
-    uint32_t temp = *left;
-    *left = *right;
-    *right = temp;
+    for (int round = ROUNDS - 1; round >= 0; round--) {
+        for (size_t j = 0; j < lanes; j++) {
+            uint32_t temp = left[j];
+            left[j] = right[j];
+            right[j] = temp;
 
-    *right ^= ctx->parray[ROUNDS];
-    *left ^= ctx->parray[ROUNDS + 1];
+            uint32_t f_result;
+            f_function(ctx, left[j], &f_result);
+            right[j] ^= f_result;
+
+            left[j] ^= ctx->parray[round];
+        }
+    }
+}
+
+void fish_encrypt_block(fish_context_t *ctx, uint32_t *left, uint32_t *right) {
+    if (!ctx->initialized) return;
+
+    fish_encrypt_lanes(ctx, left, right, 1);
 }
 
 void fish_decrypt_block(fish_context_t *ctx, uint32_t *left, uint32_t *right) {
     if (!ctx->initialized) return;
 
-    *left ^= ctx->parray[ROUNDS + 1];
-    *right ^= ctx->parray[ROUNDS];
+    fish_decrypt_lanes(ctx, left, right, 1);
+}
 
-    for (int round = ROUNDS - 1; round >= 0; round--) {
-        uint32_t temp = *left;
-        *left = *right;
-        *right = temp;
+static inline uint32_t load32_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
 
-        uint32_t f_result;
-        f_function(ctx, *left, &f_result);
-        *right ^= f_result;
+static inline void store32_be(uint8_t *p, uint32_t v) {
+    p[0] = (v >> 24) & 0xff;
+    p[1] = (v >> 16) & 0xff;
+    p[2] = (v >> 8) & 0xff;
+    p[3] = v & 0xff;
+}
+
+static void fish_process_blocks(const fish_context_t *ctx, const uint8_t *input,
+                                uint8_t *output, size_t blocks, int encrypt) {
+    uint32_t left[FISH_INTERLEAVE], right[FISH_INTERLEAVE];
 
-        *left ^= ctx->parray[round];
+    for (size_t i = 0; i < blocks; i += FISH_INTERLEAVE) {
+        size_t lanes = blocks - i < FISH_INTERLEAVE ? blocks - i : FISH_INTERLEAVE;
+
+        for (size_t j = 0; j < lanes; j++) {
+            left[j] = load32_be(input + (i + j) * BLOCK_SIZE);
+            right[j] = load32_be(input + (i + j) * BLOCK_SIZE + 4);
+        }
+
+        if (lanes == FISH_INTERLEAVE) {
+            if (encrypt) {
+                fish_encrypt_lanes(ctx, left, right, FISH_INTERLEAVE);
+            } else {
+                fish_decrypt_lanes(ctx, left, right, FISH_INTERLEAVE);
+            }
+        } else if (encrypt) {
+            fish_encrypt_lanes(ctx, left, right, lanes);
+        } else {
+            fish_decrypt_lanes(ctx, left, right, lanes);
+        }
+
+        for (size_t j = 0; j < lanes; j++) {
+            store32_be(output + (i + j) * BLOCK_SIZE, left[j]);
+            store32_be(output + (i + j) * BLOCK_SIZE + 4, right[j]);
+        }
     }
 }
 
-int process_data_stream(const uint8_t *input, uint8_t *output, size_t length,
-                       const uint8_t *key, size_t key_len, int encrypt) {
-    fish_context_t ctx;
-    fish_init(&ctx, key, key_len);
+static void fish_encrypt_blocks(const void *ctx, const uint8_t *input,
+                                uint8_t *output, size_t blocks) {
+    fish_process_blocks(ctx, input, output, blocks, 1);
+}
 
-    size_t blocks = length / 8;
+static void fish_decrypt_blocks(const void *ctx, const uint8_t *input,
+                                uint8_t *output, size_t blocks) {
+    fish_process_blocks(ctx, input, output, blocks, 0);
+}
 
-    for (size_t i = 0; i < blocks; i++) {
-        uint32_t left = (input[i*8] << 24) | (input[i*8+1] << 16) |
-                       (input[i*8+2] << 8) | input[i*8+3];
-        uint32_t right = (input[i*8+4] << 24) | (input[i*8+5] << 16) |
-                        (input[i*8+6] << 8) | input[i*8+7];
+typedef enum {
+    CIPHER_MODE_ECB,
+    CIPHER_MODE_CBC,
+    CIPHER_MODE_CTR
+} cipher_mode_t;
 
-        if (encrypt) {
-            fish_encrypt_block(&ctx, &left, &right);
-        } else {
-            fish_decrypt_block(&ctx, &left, &right);
+typedef void (*cipher_blocks_fn)(const void *ctx, const uint8_t *input,
+                                 uint8_t *output, size_t blocks);
+
+typedef struct {
+    const void *ctx;
+    cipher_blocks_fn encrypt_blocks;
+    cipher_blocks_fn decrypt_blocks;
+} block_cipher_t;
+
+#define MODE_CHUNK_BLOCKS 64
+#define PARALLEL_MIN_TASK_BYTES (256 * 1024)
+#define POOL_MAX_WORKERS 63
+#define POOL_TASKS_PER_THREAD 4
+
+typedef void (*block_range_fn)(void *arg, size_t first, size_t count);
+
+/*
+ * Fork-join pool for the bulk modes. Workers start on first use and sleep
+ * between jobs; a job is cut into contiguous block ranges that the workers
+ * and the submitting thread claim until none are left.
+ */
+typedef struct {
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    size_t workers;
+    unsigned long generation;
+    block_range_fn fn;
+    void *arg;
+    size_t total_blocks;
+    size_t task_blocks;
+    size_t task_count;
+    size_t next_task;
+    size_t tasks_finished;
+} worker_pool_t;
+
+static worker_pool_t worker_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, NULL, NULL, 0, 0, 0, 0, 0
+};
+static pthread_once_t worker_pool_once = PTHREAD_ONCE_INIT;
+
+/* Runs tasks of the current job until all are claimed; pool->lock is held */
+static void worker_pool_drain(worker_pool_t *pool) {
+    while (pool->next_task < pool->task_count) {
+        size_t first = pool->next_task++ * pool->task_blocks;
+        size_t count = pool->total_blocks - first;
+        block_range_fn fn = pool->fn;
+        void *arg = pool->arg;
+
+        if (count > pool->task_blocks) {
+            count = pool->task_blocks;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+        fn(arg, first, count);
+        pthread_mutex_lock(&pool->lock);
+
+        if (++pool->tasks_finished == pool->task_count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void *worker_pool_main(void *unused) {
+    worker_pool_t *pool = &worker_pool;
+    unsigned long seen = 0;
+
+    (void)unused;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        seen = pool->generation;
+        worker_pool_drain(pool);
+    }
+    return NULL;
+}
+
+static void worker_pool_start(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus - 1 : 0;
+
+    if (wanted > POOL_MAX_WORKERS) {
+        wanted = POOL_MAX_WORKERS;
+    }
+
+    for (size_t i = 0; i < wanted; i++) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, worker_pool_main, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_pool.workers++;
+    }
+}
+
+/* Blocks per task for a job of total_blocks; total_blocks means run inline */
+static size_t worker_pool_plan(size_t total_blocks) {
+    size_t min_task_blocks = PARALLEL_MIN_TASK_BYTES / BLOCK_SIZE;
+    size_t tasks;
+
+    if (total_blocks < 2 * min_task_blocks) {
+        return total_blocks;
+    }
+
+    pthread_once(&worker_pool_once, worker_pool_start);
+    if (worker_pool.workers == 0) {
+        return total_blocks;
+    }
+
+    tasks = total_blocks / min_task_blocks;
+    if (tasks > (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD) {
+        tasks = (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD;
+    }
+
+    return (total_blocks + tasks - 1) / tasks;
+}
+
+static void worker_pool_run(size_t total_blocks, size_t task_blocks,
+                            block_range_fn fn, void *arg) {
+    worker_pool_t *pool = &worker_pool;
+
+    if (task_blocks >= total_blocks) {
+        fn(arg, 0, total_blocks);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->total_blocks = total_blocks;
+    pool->task_blocks = task_blocks;
+    pool->task_count = (total_blocks + task_blocks - 1) / task_blocks;
+    pool->next_task = 0;
+    pool->tasks_finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    worker_pool_drain(pool);
+    while (pool->tasks_finished < pool->task_count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+typedef struct {
+    const block_cipher_t *cipher;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t length;
+    const uint8_t *iv;
+    const uint8_t *boundaries;
+    size_t task_blocks;
+    int encrypt;
+} mode_job_t;
+
+static void ecb_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    cipher_blocks_fn fn = job->encrypt ? job->cipher->encrypt_blocks
+                                       : job->cipher->decrypt_blocks;
+
+    fn(job->cipher->ctx, job->input + first * BLOCK_SIZE,
+       job->output + first * BLOCK_SIZE, count);
+}
+
+/* ctr = iv + n, with the counter block read as a big-endian integer */
+static void counter_at(uint8_t *ctr, const uint8_t *iv, uint64_t n) {
+    unsigned int carry = 0;
+
+    for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+        unsigned int sum = iv[i] + (unsigned int)(n & 0xFF) + carry;
+        ctr[i] = sum & 0xFF;
+        carry = sum >> 8;
+        n >>= 8;
+    }
+}
+
+static void ctr_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t counters[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    uint8_t keystream[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    size_t offset = first * BLOCK_SIZE;
+    size_t end = (first + count) * BLOCK_SIZE;
+
+    if (end > job->length) {
+        end = job->length;
+    }
+
+    while (offset < end) {
+        size_t bytes = end - offset < sizeof(keystream) ? end - offset : sizeof(keystream);
+        size_t blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        for (size_t i = 0; i < blocks; i++) {
+            counter_at(counters + i * BLOCK_SIZE, job->iv, offset / BLOCK_SIZE + i);
         }
+        job->cipher->encrypt_blocks(job->cipher->ctx, counters, keystream, blocks);
 
-        output[i*8] = (left >> 24) & 0xff;
-        output[i*8+1] = (left >> 16) & 0xff;
-        output[i*8+2] = (left >> 8) & 0xff;
-        output[i*8+3] = left & 0xff;
-        output[i*8+4] = (right >> 24) & 0xff;
-        output[i*8+5] = (right >> 16) & 0xff;
-        output[i*8+6] = (right >> 8) & 0xff;
-        output[i*8+7] = right & 0xff;
+        for (size_t i = 0; i < bytes; i++) {
+            job->output[offset + i] = job->input[offset + i] ^ keystream[i];
+        }
+        offset += bytes;
     }
+}
+
+/*
+ * Each task starts from the ciphertext block just before its range, which
+ * the submitter copies out first so in-place decryption stays correct.
+ */
+static void cbc_decrypt_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t previous[BLOCK_SIZE];
+    uint8_t saved[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+
+    if (first == 0) {
+        memcpy(previous, job->iv, BLOCK_SIZE);
+    } else {
+        memcpy(previous, job->boundaries + (first / job->task_blocks - 1) * BLOCK_SIZE,
+               BLOCK_SIZE);
+    }
+
+    for (size_t done = 0; done < count;) {
+        size_t blocks = count - done < MODE_CHUNK_BLOCKS ? count - done : MODE_CHUNK_BLOCKS;
+        uint8_t *out = job->output + (first + done) * BLOCK_SIZE;
+
+        memcpy(saved, job->input + (first + done) * BLOCK_SIZE, blocks * BLOCK_SIZE);
+        job->cipher->decrypt_blocks(job->cipher->ctx, saved, out, blocks);
+
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t *chain = b == 0 ? previous : saved + (b - 1) * BLOCK_SIZE;
+
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                out[b * BLOCK_SIZE + i] ^= chain[i];
+            }
+        }
+
+        memcpy(previous, saved + (blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+        done += blocks;
+    }
+}
+
+/* CBC encryption chains every block on the previous one, so it stays serial */
+static void cbc_encrypt(const block_cipher_t *cipher, const uint8_t *input,
+                        uint8_t *output, size_t blocks, const uint8_t *iv) {
+    uint8_t chain[BLOCK_SIZE];
+
+    memcpy(chain, iv, BLOCK_SIZE);
+    for (size_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            chain[i] ^= input[b * BLOCK_SIZE + i];
+        }
+        cipher->encrypt_blocks(cipher->ctx, chain, chain, 1);
+        memcpy(output + b * BLOCK_SIZE, chain, BLOCK_SIZE);
+    }
+}
+
+/*
+ * ECB, CBC decryption and CTR are split across the worker pool. CTR
+ * accepts a partial final block; ECB and CBC need whole blocks. Returns
+ * -1 on bad arguments or allocation failure.
+ */
+static int block_mode_process(const block_cipher_t *cipher, const uint8_t *input,
+                              uint8_t *output, size_t length, cipher_mode_t mode,
+                              const uint8_t *iv, int encrypt) {
+    mode_job_t job = { cipher, input, output, length, iv, NULL, 0, encrypt };
+    size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint8_t *boundaries = NULL;
+    block_range_fn fn;
+
+    if (mode != CIPHER_MODE_CTR && length % BLOCK_SIZE != 0) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_ECB && iv == NULL) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_CTR && !encrypt && cipher->decrypt_blocks == NULL) {
+        return -1;
+    }
+    if (blocks == 0) {
+        return 0;
+    }
+
+    if (mode == CIPHER_MODE_CBC && encrypt) {
+        cbc_encrypt(cipher, input, output, blocks, iv);
+        return 0;
+    }
+
+    job.task_blocks = worker_pool_plan(blocks);
+
+    if (mode == CIPHER_MODE_ECB) {
+        fn = ecb_range;
+    } else if (mode == CIPHER_MODE_CTR) {
+        fn = ctr_range;
+    } else {
+        size_t tasks = (blocks + job.task_blocks - 1) / job.task_blocks;
+
+        if (tasks > 1) {
+            boundaries = malloc((tasks - 1) * BLOCK_SIZE);
+            if (boundaries == NULL) {
+                return -1;
+            }
+            for (size_t t = 1; t < tasks; t++) {
+                memcpy(boundaries + (t - 1) * BLOCK_SIZE,
+                       input + (t * job.task_blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+            }
+        }
+        job.boundaries = boundaries;
+        fn = cbc_decrypt_range;
+    }
+
+    worker_pool_run(blocks, job.task_blocks, fn, &job);
+    free(boundaries);
 
     return 0;
 }
 
+/*
+ * The key schedule rebuilds 4 KB of S-boxes and runs nine encryptions over
+ * the P-array, so callers that process many short messages under one key
+ * should create the context once and reuse it.
+ */
+fish_context_t *fish_create(const uint8_t *key, size_t key_len) {
+    fish_context_t *ctx = malloc(sizeof(*ctx));
+
+    if (ctx != NULL) {
+        fish_init(ctx, key, key_len);
+    }
+    return ctx;
+}
+
+void fish_destroy(fish_context_t *ctx) {
+    if (ctx != NULL) {
+        memset(ctx, 0, sizeof(*ctx));
+        free(ctx);
+    }
+}
+
+/* The context is only read, so one keyed context may be shared between threads */
+int process_data_stream_with_ctx(const fish_context_t *ctx, const uint8_t *input,
+                                 uint8_t *output, size_t length, cipher_mode_t mode,
+                                 const uint8_t *iv, int encrypt) {
+    block_cipher_t cipher = { ctx, fish_encrypt_blocks, fish_decrypt_blocks };
+
+    if (ctx == NULL) {
+        return -1;
+    }
+    return block_mode_process(&cipher, input, output, length, mode, iv, encrypt);
+}
+
+/* iv is the CBC IV or the initial CTR counter block; unused for ECB */
+int process_data_stream_mode(const uint8_t *input, uint8_t *output, size_t length,
+                             const uint8_t *key, size_t key_len, cipher_mode_t mode,
+                             const uint8_t *iv, int encrypt) {
+    fish_context_t ctx;
+
+    fish_init(&ctx, key, key_len);
+    return process_data_stream_with_ctx(&ctx, input, output, length, mode, iv, encrypt);
+}
+
+/* ECB over the whole blocks of the buffer; a trailing partial block is left untouched */
+int process_data_stream(const uint8_t *input, uint8_t *output, size_t length,
+                       const uint8_t *key, size_t key_len, int encrypt) {
+    return process_data_stream_mode(input, output, length - length % BLOCK_SIZE,
+                                    key, key_len, CIPHER_MODE_ECB, NULL, encrypt);
+}
+
 int main() {
     uint8_t key[] = "SecretKey123";
     uint8_t plaintext[] = "HelloWorld!!";
@@ -1,13 +1,19 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #define BLOCK_SIZE 16
 #define CAMELLIA_128_ROUNDS 18
 #define CAMELLIA_256_ROUNDS 24
+#define CAMELLIA_128_SUBKEYS 26
+#define CAMELLIA_256_SUBKEYS 34
+#define CAMELLIA_INTERLEAVE 4
 
 typedef struct {
-    uint64_t subkeys[34]; 
+    uint64_t subkeys[CAMELLIA_256_SUBKEYS];
     int rounds;
 } camellia_ctx_t;
 
@@ -30,13 +36,9 @@ static const uint8_t camellia_sbox[256] = {
     64, 40, 211, 123, 187, 201, 67, 193, 21, 227, 173, 244, 119, 199, 128, 158
 };
 
-static const int left_rotations[34] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
-    17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34
-};
-
 static uint64_t rotl64(uint64_t x, int n) {
-    return (x << n) | (x >> (64 - n));
+    n &= 63;
+    return n == 0 ? x : (x << n) | (x >> (64 - n));
 }
 
 static uint64_t rotr64(uint64_t x, int n) {
@@ -46,15 +48,15 @@ static uint64_t rotr64(uint64_t x, int n) {
 static uint64_t camellia_f(uint64_t x, uint64_t k) {
     uint64_t y = x ^ k;
 
-    uint8_t bytes[8];
-    for (int i = 0; i < 8; i++) {
-        bytes[i] = camellia_sbox[(y >> (8 * i)) & 0xFF];
-    }
-
-    uint64_t z = 0;
-    for (int i = 0; i < 8; i++) {
-        z |= ((uint64_t)bytes[i]) << (8 * i);
-    }
+    /* Eight independent lookups, written out so they issue back to back */
+    uint64_t z = (uint64_t)camellia_sbox[y & 0xFF] |
+                 ((uint64_t)camellia_sbox[(y >> 8) & 0xFF] << 8) |
+                 ((uint64_t)camellia_sbox[(y >> 16) & 0xFF] << 16) |
+                 ((uint64_t)camellia_sbox[(y >> 24) & 0xFF] << 24) |
+                 ((uint64_t)camellia_sbox[(y >> 32) & 0xFF] << 32) |
+                 ((uint64_t)camellia_sbox[(y >> 40) & 0xFF] << 40) |
+                 ((uint64_t)camellia_sbox[(y >> 48) & 0xFF] << 48) |
+                 ((uint64_t)camellia_sbox[y >> 56] << 56);
 
     return rotl64(z, 1) ^ rotl64(z, 8) ^ rotl64(z, 16) ^ rotl64(z, 24);
 }
@@ -83,168 +85,668 @@ static uint64_t camellia_flinv(uint64_t x, uint64_t k) {
     return ((uint64_t)xr << 32) | xl;
 }
 
+static inline uint64_t load64_be(const uint8_t *p) {
+    uint64_t v = 0;
+
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void store64_be(uint8_t *p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+/* Left or right 64-bit half of the 128-bit value (hi || lo) rotated left by n */
+static uint64_t rotl128_half(uint64_t hi, uint64_t lo, int n, int right_half) {
+    if (n >= 64) {
+        uint64_t t = hi;
+        hi = lo;
+        lo = t;
+        n -= 64;
+    }
+    if (n != 0) {
+        uint64_t t = (hi << n) | (lo >> (64 - n));
+        lo = (lo << n) | (hi >> (64 - n));
+        hi = t;
+    }
+    return right_half ? lo : hi;
+}
+
+/* Appends both halves of (hi || lo) <<< n to the schedule */
+static void camellia_put_pair(camellia_ctx_t *ctx, int *idx, uint64_t hi, uint64_t lo, int n) {
+    ctx->subkeys[(*idx)++] = rotl128_half(hi, lo, n, 0);
+    ctx->subkeys[(*idx)++] = rotl128_half(hi, lo, n, 1);
+}
+
+/*
+ * Lays the subkeys out in the order the round kernels consume them:
+ * kw1 kw2, then one key per F round with an FL/FL^-1 pair before rounds
+ * 6, 12 and 18, then kw3 kw4.
+ */
 void camellia_key_schedule(camellia_ctx_t *ctx, const uint8_t *key, int key_bits) {
-    uint64_t kl, kr, ka, kb;
+    uint64_t kl[2], kr[2] = { 0, 0 }, ka[2], kb[2];
     uint64_t constants[6] = {
         0xA09E667F3BCC908B, 0xB67AE8584CAA73B2, 0xC6EF372FE94F82BE,
         0x54FF53A5F1D36F1C, 0x10E527FADE682D1D, 0xB05688C2B3E6C1FD
     };
+    int idx = 0;
 
-    kl = 0;
-    kr = 0;
-    for (int i = 0; i < 8; i++) {
-        kl = (kl << 8) | key[i];
-    }
+    kl[0] = load64_be(key);
+    kl[1] = load64_be(key + 8);
 
     if (key_bits == 128) {
-        kr = 0;
         ctx->rounds = CAMELLIA_128_ROUNDS;
     } else {
-        for (int i = 8; i < 16; i++) {
-            kr = (kr << 8) | key[i];
-        }
+        kr[0] = load64_be(key + 16);
         if (key_bits == 192) {
-            kr ^= 0xFFFFFFFFFFFFFFFF;
+            kr[1] = ~kr[0];
+        } else {
+            kr[1] = load64_be(key + 24);
         }
         ctx->rounds = CAMELLIA_256_ROUNDS;
     }
 
-    uint64_t d1 = kl ^ kr;
-    uint64_t d2 = camellia_f(d1, constants[0]) ^ kr;
-    d1 = camellia_f(d2, constants[1]) ^ d1;
-    ka = d1;
-    d2 = camellia_f(d1, constants[2]) ^ d2;
-    kb = d2;
-
-    int key_idx = 0;
+    uint64_t d1 = kl[0] ^ kr[0];
+    uint64_t d2 = kl[1] ^ kr[1];
+    d2 ^= camellia_f(d1, constants[0]);
+    d1 ^= camellia_f(d2, constants[1]);
+    d1 ^= kl[0];
+    d2 ^= kl[1];
+    d2 ^= camellia_f(d1, constants[2]);
+    d1 ^= camellia_f(d2, constants[3]);
+    ka[0] = d1;
+    ka[1] = d2;
 
     if (key_bits == 128) {
-        ctx->subkeys[0] = kl;
-        ctx->subkeys[1] = ka;
-        ctx->subkeys[2] = rotl64(kl, 15);
-        ctx->subkeys[3] = rotl64(ka, 15);
-        ctx->subkeys[4] = rotl64(ka, 30);
-        ctx->subkeys[5] = rotl64(kl, 45);
-        ctx->subkeys[6] = rotl64(ka, 45);
-        ctx->subkeys[7] = rotl64(kl, 60);
-        ctx->subkeys[8] = rotl64(ka, 60);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 0);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 0);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 15);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 15);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 30);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 45);
+        ctx->subkeys[idx++] = rotl128_half(ka[0], ka[1], 45, 0);
+        ctx->subkeys[idx++] = rotl128_half(kl[0], kl[1], 60, 1);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 60);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 77);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 94);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 94);
+        camellia_put_pair(ctx, &idx, kl[0], kl[1], 111);
+        camellia_put_pair(ctx, &idx, ka[0], ka[1], 111);
+        return;
+    }
 
-        ctx->subkeys[9] = rotl64(kl, 77);
-        ctx->subkeys[10] = rotl64(ka, 77);
+    d1 = ka[0] ^ kr[0];
+    d2 = ka[1] ^ kr[1];
+    d2 ^= camellia_f(d1, constants[4]);
+    d1 ^= camellia_f(d2, constants[5]);
+    kb[0] = d1;
+    kb[1] = d2;
+
+    camellia_put_pair(ctx, &idx, kl[0], kl[1], 0);
+    camellia_put_pair(ctx, &idx, kb[0], kb[1], 0);
+    camellia_put_pair(ctx, &idx, kr[0], kr[1], 15);
+    camellia_put_pair(ctx, &idx, ka[0], ka[1], 15);
+    camellia_put_pair(ctx, &idx, kr[0], kr[1], 30);
+    camellia_put_pair(ctx, &idx, kb[0], kb[1], 30);
+    camellia_put_pair(ctx, &idx, kl[0], kl[1], 45);
+    camellia_put_pair(ctx, &idx, ka[0], ka[1], 45);
+    camellia_put_pair(ctx, &idx, kl[0], kl[1], 60);
+    camellia_put_pair(ctx, &idx, kr[0], kr[1], 60);
+    camellia_put_pair(ctx, &idx, kb[0], kb[1], 60);
+    camellia_put_pair(ctx, &idx, kl[0], kl[1], 77);
+    camellia_put_pair(ctx, &idx, ka[0], ka[1], 77);
+    camellia_put_pair(ctx, &idx, kr[0], kr[1], 94);
+    camellia_put_pair(ctx, &idx, ka[0], ka[1], 94);
+    camellia_put_pair(ctx, &idx, kl[0], kl[1], 111);
+    camellia_put_pair(ctx, &idx, kb[0], kb[1], 111);
+}
 
-        ctx->subkeys[11] = rotl64(kl, 94);
-        ctx->subkeys[12] = rotl64(ka, 94);
-        ctx->subkeys[13] = rotl64(kl, 111);
-        ctx->subkeys[14] = rotl64(ka, 111);
+/* Index of kw3, the first output whitening key, which ends each schedule */
+static inline int camellia_final_subkey(int rounds) {
+    return (rounds == CAMELLIA_128_ROUNDS ? CAMELLIA_128_SUBKEYS : CAMELLIA_256_SUBKEYS) - 2;
+}
+
+/*
+ * Runs up to CAMELLIA_INTERLEAVE independent blocks through the rounds in
+ * lockstep, so the S-box loads of one block overlap those of the others.
+ */
+static inline void camellia_encrypt_lanes(const camellia_ctx_t *ctx, const uint8_t *input,
+                                          uint8_t *output, size_t lanes) {
+    uint64_t left[CAMELLIA_INTERLEAVE], right[CAMELLIA_INTERLEAVE];
+
+    for (size_t j = 0; j < lanes; j++) {
+        left[j] = load64_be(input + j * BLOCK_SIZE) ^ ctx->subkeys[0];
+        right[j] = load64_be(input + j * BLOCK_SIZE + 8) ^ ctx->subkeys[1];
+    }
 
-        ctx->subkeys[15] = rotl64(kl, 128);
-        ctx->subkeys[16] = rotl64(ka, 128);
+    int round = 2;
+
+    for (int i = 0; i < ctx->rounds; i++) {
+        if (i == 6 || i == 12 || i == 18) {
+            for (size_t j = 0; j < lanes; j++) {
+                left[j] = camellia_fl(left[j], ctx->subkeys[round]);
+                right[j] = camellia_flinv(right[j], ctx->subkeys[round + 1]);
+            }
+            round += 2;
+        }
+        for (size_t j = 0; j < lanes; j++) {
+            uint64_t temp = right[j] ^ camellia_f(left[j], ctx->subkeys[round]);
+            right[j] = left[j];
+            left[j] = temp;
+        }
+        round++;
+    }
 
-        ctx->subkeys[17] = rotl64(ka, 143);
+    for (size_t j = 0; j < lanes; j++) {
+        store64_be(output + j * BLOCK_SIZE, right[j] ^ ctx->subkeys[round]);
+        store64_be(output + j * BLOCK_SIZE + 8, left[j] ^ ctx->subkeys[round + 1]);
+    }
+}
+
+static inline void camellia_decrypt_lanes(const camellia_ctx_t *ctx, const uint8_t *input,
+                                          uint8_t *output, size_t lanes) {
+    uint64_t left[CAMELLIA_INTERLEAVE], right[CAMELLIA_INTERLEAVE];
+    int round = camellia_final_subkey(ctx->rounds);
+
+    for (size_t j = 0; j < lanes; j++) {
+        left[j] = load64_be(input + j * BLOCK_SIZE + 8) ^ ctx->subkeys[round + 1];
+        right[j] = load64_be(input + j * BLOCK_SIZE) ^ ctx->subkeys[round];
+    }
+
+    for (int i = ctx->rounds - 1; i >= 0; i--) {
+        round--;
+        for (size_t j = 0; j < lanes; j++) {
+            uint64_t temp = right[j];
+            right[j] = left[j] ^ camellia_f(right[j], ctx->subkeys[round]);
+            left[j] = temp;
+        }
+        if (i == 18 || i == 12 || i == 6) {
+            round -= 2;
+            for (size_t j = 0; j < lanes; j++) {
+                left[j] = camellia_flinv(left[j], ctx->subkeys[round]);
+                right[j] = camellia_fl(right[j], ctx->subkeys[round + 1]);
+            }
+        }
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+        store64_be(output + j * BLOCK_SIZE, left[j] ^ ctx->subkeys[0]);
+        store64_be(output + j * BLOCK_SIZE + 8, right[j] ^ ctx->subkeys[1]);
     }
 }
 
 void camellia_encrypt_block(camellia_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint64_t left = 0, right = 0;
+    camellia_encrypt_lanes(ctx, input, output, 1);
+}
 
-    for (int i = 0; i < 8; i++) {
-        left = (left << 8) | input[i];
-        right = (right << 8) | input[i + 8];
+void camellia_decrypt_block(camellia_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
+    camellia_decrypt_lanes(ctx, input, output, 1);
+}
+
+static void camellia_encrypt_blocks(const void *cipher_ctx, const uint8_t *input,
+                                    uint8_t *output, size_t blocks) {
+    size_t i = 0;
+
+    for (; i + CAMELLIA_INTERLEAVE <= blocks; i += CAMELLIA_INTERLEAVE) {
+        camellia_encrypt_lanes(cipher_ctx, input + i * BLOCK_SIZE,
+                               output + i * BLOCK_SIZE, CAMELLIA_INTERLEAVE);
+    }
+    if (i < blocks) {
+        camellia_encrypt_lanes(cipher_ctx, input + i * BLOCK_SIZE,
+                               output + i * BLOCK_SIZE, blocks - i);
     }
+}
 
-    left ^= ctx->subkeys[0];
-    right ^= ctx->subkeys[1];
+static void camellia_decrypt_blocks(const void *cipher_ctx, const uint8_t *input,
+                                    uint8_t *output, size_t blocks) {
+    size_t i = 0;
 
-    int round = 0;
+    for (; i + CAMELLIA_INTERLEAVE <= blocks; i += CAMELLIA_INTERLEAVE) {
+        camellia_decrypt_lanes(cipher_ctx, input + i * BLOCK_SIZE,
+                               output + i * BLOCK_SIZE, CAMELLIA_INTERLEAVE);
+    }
+    if (i < blocks) {
+        camellia_decrypt_lanes(cipher_ctx, input + i * BLOCK_SIZE,
+                               output + i * BLOCK_SIZE, blocks - i);
+    }
+}
 
-    for (int i = 0; i < ctx->rounds; i++) {
-        if (i == 6 || i == 12 || i == 18) {
-            
-            left = camellia_fl(left, ctx->subkeys[round + 2]);
-            right = camellia_flinv(right, ctx->subkeys[round + 3]);
-            round += 4;
-        } else {
-            
-            uint64_t temp = right ^ camellia_f(left, ctx->subkeys[round + 2]);
-            right = left;
-            left = temp;
-            round += 2;
+typedef enum {
+    CIPHER_MODE_ECB,
+    CIPHER_MODE_CBC,
+    CIPHER_MODE_CTR
+} cipher_mode_t;
+
+typedef void (*cipher_blocks_fn)(const void *ctx, const uint8_t *input,
+                                 uint8_t *output, size_t blocks);
+
+typedef struct {
+    const void *ctx;
+    cipher_blocks_fn encrypt_blocks;
+    cipher_blocks_fn decrypt_blocks;
+} block_cipher_t;
+
+#define MODE_CHUNK_BLOCKS 64
+#define PARALLEL_MIN_TASK_BYTES (256 * 1024)
+#define POOL_MAX_WORKERS 63
+#define POOL_TASKS_PER_THREAD 4
+
+typedef void (*block_range_fn)(void *arg, size_t first, size_t count);
+
+/*
+ * Fork-join pool for the bulk modes. Workers start on first use and sleep
+ * between jobs; a job is cut into contiguous block ranges that the workers
+ * and the submitting thread claim until none are left.
+ */
+typedef struct {
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    size_t workers;
+    unsigned long generation;
+    block_range_fn fn;
+    void *arg;
+    size_t total_blocks;
+    size_t task_blocks;
+    size_t task_count;
+    size_t next_task;
+    size_t tasks_finished;
+} worker_pool_t;
+
+static worker_pool_t worker_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, NULL, NULL, 0, 0, 0, 0, 0
+};
+static pthread_once_t worker_pool_once = PTHREAD_ONCE_INIT;
+
+/* Runs tasks of the current job until all are claimed; pool->lock is held */
+static void worker_pool_drain(worker_pool_t *pool) {
+    while (pool->next_task < pool->task_count) {
+        size_t first = pool->next_task++ * pool->task_blocks;
+        size_t count = pool->total_blocks - first;
+        block_range_fn fn = pool->fn;
+        void *arg = pool->arg;
+
+        if (count > pool->task_blocks) {
+            count = pool->task_blocks;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+        fn(arg, first, count);
+        pthread_mutex_lock(&pool->lock);
+
+        if (++pool->tasks_finished == pool->task_count) {
+            pthread_cond_broadcast(&pool->work_done);
         }
     }
+}
 
-    uint64_t temp = left;
-    left = right ^ ctx->subkeys[round];
-    right = temp ^ ctx->subkeys[round + 1];
+static void *worker_pool_main(void *unused) {
+    worker_pool_t *pool = &worker_pool;
+    unsigned long seen = 0;
 
-    for (int i = 7; i >= 0; i--) {
-        output[i] = left & 0xFF;
-        output[i + 8] = right & 0xFF;
-        left >>= 8;
-        right >>= 8;
+    (void)unused;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        seen = pool->generation;
+        worker_pool_drain(pool);
     }
+    return NULL;
 }
 
-void camellia_decrypt_block(camellia_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint64_t left = 0, right = 0;
+static void worker_pool_start(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus - 1 : 0;
 
-    for (int i = 0; i < 8; i++) {
-        left = (left << 8) | input[i];
-        right = (right << 8) | input[i + 8];
+    if (wanted > POOL_MAX_WORKERS) {
+        wanted = POOL_MAX_WORKERS;
     }
 
-    int round = ctx->rounds * 2;
+    for (size_t i = 0; i < wanted; i++) {
+        pthread_t thread;
 
-    uint64_t temp = left ^ ctx->subkeys[round + 1];
-    left = right ^ ctx->subkeys[round];
-    right = temp;
+        if (pthread_create(&thread, NULL, worker_pool_main, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_pool.workers++;
+    }
+}
 
-    for (int i = ctx->rounds - 1; i >= 0; i--) {
-        if (i == 18 || i == 12 || i == 6) {
-            
-            round -= 4;
-            left = camellia_flinv(left, ctx->subkeys[round + 2]);
-            right = camellia_fl(right, ctx->subkeys[round + 3]);
-        } else {
-            
-            round -= 2;
-            temp = right;
-            right = left ^ camellia_f(right, ctx->subkeys[round + 2]);
-            left = temp;
+/* Blocks per task for a job of total_blocks; total_blocks means run inline */
+static size_t worker_pool_plan(size_t total_blocks) {
+    size_t min_task_blocks = PARALLEL_MIN_TASK_BYTES / BLOCK_SIZE;
+    size_t tasks;
+
+    if (total_blocks < 2 * min_task_blocks) {
+        return total_blocks;
+    }
+
+    pthread_once(&worker_pool_once, worker_pool_start);
+    if (worker_pool.workers == 0) {
+        return total_blocks;
+    }
+
+    tasks = total_blocks / min_task_blocks;
+    if (tasks > (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD) {
+        tasks = (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD;
+    }
+
+    return (total_blocks + tasks - 1) / tasks;
+}
+
+static void worker_pool_run(size_t total_blocks, size_t task_blocks,
+                            block_range_fn fn, void *arg) {
+    worker_pool_t *pool = &worker_pool;
+
+    if (task_blocks >= total_blocks) {
+        fn(arg, 0, total_blocks);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->total_blocks = total_blocks;
+    pool->task_blocks = task_blocks;
+    pool->task_count = (total_blocks + task_blocks - 1) / task_blocks;
+    pool->next_task = 0;
+    pool->tasks_finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    worker_pool_drain(pool);
+    while (pool->tasks_finished < pool->task_count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+typedef struct {
+    const block_cipher_t *cipher;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t length;
+    const uint8_t *iv;
+    const uint8_t *boundaries;
+    size_t task_blocks;
+    int encrypt;
+} mode_job_t;
+
+static void ecb_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    cipher_blocks_fn fn = job->encrypt ? job->cipher->encrypt_blocks
+                                       : job->cipher->decrypt_blocks;
+
+    fn(job->cipher->ctx, job->input + first * BLOCK_SIZE,
+       job->output + first * BLOCK_SIZE, count);
+}
+
+/* ctr = iv + n, with the counter block read as a big-endian integer */
+static void counter_at(uint8_t *ctr, const uint8_t *iv, uint64_t n) {
+    unsigned int carry = 0;
+
+    for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+        unsigned int sum = iv[i] + (unsigned int)(n & 0xFF) + carry;
+        ctr[i] = sum & 0xFF;
+        carry = sum >> 8;
+        n >>= 8;
+    }
+}
+
+static void ctr_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t counters[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    uint8_t keystream[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    size_t offset = first * BLOCK_SIZE;
+    size_t end = (first + count) * BLOCK_SIZE;
+
+    if (end > job->length) {
+        end = job->length;
+    }
+
+    while (offset < end) {
+        size_t bytes = end - offset < sizeof(keystream) ? end - offset : sizeof(keystream);
+        size_t blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        for (size_t i = 0; i < blocks; i++) {
+            counter_at(counters + i * BLOCK_SIZE, job->iv, offset / BLOCK_SIZE + i);
+        }
+        job->cipher->encrypt_blocks(job->cipher->ctx, counters, keystream, blocks);
+
+        for (size_t i = 0; i < bytes; i++) {
+            job->output[offset + i] = job->input[offset + i] ^ keystream[i];
         }
+        offset += bytes;
     }
+}
 
-    left ^= ctx->subkeys[0];
-    right ^= ctx->subkeys[1];
+/*
+ * Each task starts from the ciphertext block just before its range, which
+ * the submitter copies out first so in-place decryption stays correct.
+ */
+static void cbc_decrypt_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t previous[BLOCK_SIZE];
+    uint8_t saved[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+
+    if (first == 0) {
+        memcpy(previous, job->iv, BLOCK_SIZE);
+    } else {
+        memcpy(previous, job->boundaries + (first / job->task_blocks - 1) * BLOCK_SIZE,
+               BLOCK_SIZE);
+    }
 
-    for (int i = 7; i >= 0; i--) {
-        output[i] = left & 0xFF;
-        output[i + 8] = right & 0xFF;
-        left >>= 8;
-        right >>= 8;
+    for (size_t done = 0; done < count;) {
+        size_t blocks = count - done < MODE_CHUNK_BLOCKS ? count - done : MODE_CHUNK_BLOCKS;
+        uint8_t *out = job->output + (first + done) * BLOCK_SIZE;
+
+        memcpy(saved, job->input + (first + done) * BLOCK_SIZE, blocks * BLOCK_SIZE);
+        job->cipher->decrypt_blocks(job->cipher->ctx, saved, out, blocks);
+
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t *chain = b == 0 ? previous : saved + (b - 1) * BLOCK_SIZE;
+
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                out[b * BLOCK_SIZE + i] ^= chain[i];
+            }
+        }
+
+        memcpy(previous, saved + (blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+        done += blocks;
     }
 }
 
-int camellia_process(const uint8_t *input, uint8_t *output, size_t length,
-                    const uint8_t *key, int key_bits, int encrypt) {
-    if (length % BLOCK_SIZE != 0) {
+/* CBC encryption chains every block on the previous one, so it stays serial */
+static void cbc_encrypt(const block_cipher_t *cipher, const uint8_t *input,
+                        uint8_t *output, size_t blocks, const uint8_t *iv) {
+    uint8_t chain[BLOCK_SIZE];
+
+    memcpy(chain, iv, BLOCK_SIZE);
+    for (size_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            chain[i] ^= input[b * BLOCK_SIZE + i];
+        }
+        cipher->encrypt_blocks(cipher->ctx, chain, chain, 1);
+        memcpy(output + b * BLOCK_SIZE, chain, BLOCK_SIZE);
+    }
+}
+
+/*
+ * ECB, CBC decryption and CTR are split across the worker pool. CTR
+ * accepts a partial final block; ECB and CBC need whole blocks. Returns
+ * -1 on bad arguments or allocation failure.
+ */
+static int block_mode_process(const block_cipher_t *cipher, const uint8_t *input,
+                              uint8_t *output, size_t length, cipher_mode_t mode,
+                              const uint8_t *iv, int encrypt) {
+    mode_job_t job = { cipher, input, output, length, iv, NULL, 0, encrypt };
+    size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint8_t *boundaries = NULL;
+    block_range_fn fn;
+
+    if (mode != CIPHER_MODE_CTR && length % BLOCK_SIZE != 0) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_ECB && iv == NULL) {
         return -1;
     }
+    if (mode != CIPHER_MODE_CTR && !encrypt && cipher->decrypt_blocks == NULL) {
+        return -1;
+    }
+    if (blocks == 0) {
+        return 0;
+    }
+
+    if (mode == CIPHER_MODE_CBC && encrypt) {
+        cbc_encrypt(cipher, input, output, blocks, iv);
+        return 0;
+    }
+
+    job.task_blocks = worker_pool_plan(blocks);
+
+    if (mode == CIPHER_MODE_ECB) {
+        fn = ecb_range;
+    } else if (mode == CIPHER_MODE_CTR) {
+        fn = ctr_range;
+    } else {
+        size_t tasks = (blocks + job.task_blocks - 1) / job.task_blocks;
+
+        if (tasks > 1) {
+            boundaries = malloc((tasks - 1) * BLOCK_SIZE);
+            if (boundaries == NULL) {
+                return -1;
+            }
+            for (size_t t = 1; t < tasks; t++) {
+                memcpy(boundaries + (t - 1) * BLOCK_SIZE,
+                       input + (t * job.task_blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+            }
+        }
+        job.boundaries = boundaries;
+        fn = cbc_decrypt_range;
+    }
+
+    worker_pool_run(blocks, job.task_blocks, fn, &job);
+    free(boundaries);
+
+    return 0;
+}
+
+/* Runs the key schedule once for callers that process many messages under one key */
+camellia_ctx_t *camellia_create(const uint8_t *key, int key_bits) {
+    camellia_ctx_t *ctx = calloc(1, sizeof(*ctx));
+
+    if (ctx != NULL) {
+        camellia_key_schedule(ctx, key, key_bits);
+    }
+    return ctx;
+}
+
+void camellia_destroy(camellia_ctx_t *ctx) {
+    if (ctx != NULL) {
+        memset(ctx, 0, sizeof(*ctx));
+        free(ctx);
+    }
+}
+
+/* The context is only read, so one keyed context may be shared between threads */
+int camellia_process_with_ctx(const camellia_ctx_t *ctx, const uint8_t *input, uint8_t *output,
+                              size_t length, cipher_mode_t mode, const uint8_t *iv,
+                              int encrypt) {
+    block_cipher_t cipher = { ctx, camellia_encrypt_blocks, camellia_decrypt_blocks };
 
+    if (ctx == NULL) {
+        return -1;
+    }
+    return block_mode_process(&cipher, input, output, length, mode, iv, encrypt);
+}
+
+/* iv is the CBC IV or the initial CTR counter block; unused for ECB */
+int camellia_process_mode(const uint8_t *input, uint8_t *output, size_t length,
+                          const uint8_t *key, int key_bits, cipher_mode_t mode,
+                          const uint8_t *iv, int encrypt) {
     camellia_ctx_t ctx;
+
     camellia_key_schedule(&ctx, key, key_bits);
+    return camellia_process_with_ctx(&ctx, input, output, length, mode, iv, encrypt);
+}
 
-    size_t blocks = length / BLOCK_SIZE;
-    for (size_t i = 0; i < blocks; i++) {
-        if (encrypt) {
-            camellia_encrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                 output + i * BLOCK_SIZE);
-        } else {
-            camellia_decrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                 output + i * BLOCK_SIZE);
+int camellia_process(const uint8_t *input, uint8_t *output, size_t length,
+                    const uint8_t *key, int key_bits, int encrypt) {
+    return camellia_process_mode(input, output, length, key, key_bits,
+                                 CIPHER_MODE_ECB, NULL, encrypt);
+}
+
+/*
+ * Checks that the lane kernels agree with the single-block path and undo
+ * themselves, then that ECB, CBC and CTR round-trip through a keyed context
+ * on a buffer large enough to be split across the worker pool.
+ */
+static int camellia_self_test(void) {
+    static const int key_sizes[3] = { 128, 192, 256 };
+    static const cipher_mode_t modes[3] = { CIPHER_MODE_ECB, CIPHER_MODE_CBC, CIPHER_MODE_CTR };
+    size_t length = 4 * PARALLEL_MIN_TASK_BYTES + 3 * BLOCK_SIZE;
+    uint8_t key[32], iv[BLOCK_SIZE];
+    uint8_t lanes[7 * BLOCK_SIZE], single[7 * BLOCK_SIZE];
+    uint8_t *plain = malloc(length);
+    uint8_t *cipher = malloc(length);
+    uint8_t *round_trip = malloc(length);
+    int failed = plain == NULL || cipher == NULL || round_trip == NULL;
+
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (size_t i = 0; i < sizeof(iv); i++) {
+        iv[i] = (uint8_t)(0xF0 + i);
+    }
+    for (size_t i = 0; !failed && i < length; i++) {
+        plain[i] = (uint8_t)(i * 131 + (i >> 8));
+    }
+
+    for (int k = 0; !failed && k < 3; k++) {
+        camellia_ctx_t *ctx = camellia_create(key, key_sizes[k]);
+
+        if (ctx == NULL) {
+            failed = 1;
+            break;
         }
+
+        camellia_encrypt_blocks(ctx, plain, lanes, 7);
+        for (size_t b = 0; b < 7; b++) {
+            camellia_encrypt_block(ctx, plain + b * BLOCK_SIZE, single + b * BLOCK_SIZE);
+        }
+        camellia_decrypt_blocks(ctx, lanes, lanes, 7);
+        failed |= memcmp(lanes, plain, sizeof(lanes)) != 0;
+        camellia_decrypt_blocks(ctx, single, single, 7);
+        failed |= memcmp(single, plain, sizeof(single)) != 0;
+
+        for (int m = 0; !failed && m < 3; m++) {
+            failed |= camellia_process_with_ctx(ctx, plain, cipher, length, modes[m], iv, 1) != 0;
+            failed |= camellia_process_with_ctx(ctx, cipher, round_trip, length, modes[m], iv, 0) != 0;
+            failed |= memcmp(round_trip, plain, length) != 0;
+            failed |= memcmp(cipher, plain, BLOCK_SIZE) == 0;
+        }
+        camellia_destroy(ctx);
     }
 
-    return 0;
+    free(plain);
+    free(cipher);
+    free(round_trip);
+    return failed ? -1 : 0;
 }
 
 int main() {
@@ -254,6 +756,12 @@ int main() {
     uint8_t ciphertext[32];
     uint8_t decrypted[32];
 
+    if (camellia_self_test() != 0) {
+        printf("Camellia self-test FAILED\n");
+        return 1;
+    }
+    printf("Camellia self-test: ECB/CBC/CTR round trip OK\n");
+
     printf("Original: %.*s\n", 32, plaintext);
 
     printf("\n=== CamelliaEncryption-128 ===\n");
@@ -8,16 +8,21 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
+#include <pthread.h>
 
 #define BLOCK_SIZE 16
 #define KEY_SIZE 32
 #define DIGEST_SIZE 32
 #define LARGE_INTEGER_SIZE 256
+#define DIGEST_BLOCK_SIZE 128
+#define STREAM_BLOCK_SIZE 64
+#define SETTLEMENT_CHUNK_SIZE 65536
 
 typedef struct {
     uint64_t state[8];
     uint64_t count;
     uint8_t buffer[128];
+    size_t buffered;
 } DigestContext;
 
 typedef struct {
@@ -40,11 +45,22 @@ typedef struct {
     int position;
 } StreamCipherContext;
 
+// Expanded keys, set up once and shared read-only by any number of streams
+typedef struct {
+    BlockCipherContext block;
+    StreamCipherContext stream;
+} TransactionKeyContext;
+
+// Per-caller state for one transaction or settlement file
+typedef struct {
+    const TransactionKeyContext *keys;
+    DigestContext digest;
+    StreamCipherContext stream;
+    uint64_t length;
+} TransactionStreamContext;
+
 // Global security contexts
-static DigestContext g_digest_ctx;
-static BlockCipherContext g_block_ctx;
 static LargeIntegerContext g_large_int_ctx;
-static StreamCipherContext g_stream_ctx;
 
 // Mathematical utility functions
 static inline uint32_t rotate_left(uint32_t value, int amount) {
@@ -68,6 +84,7 @@ static void digest_initialize(DigestContext *ctx) {
     ctx->state[7] = 0x5be0cd19137e2179ULL;
 
     ctx->count = 0;
+    ctx->buffered = 0;
     memset(ctx->buffer, 0, sizeof(ctx->buffer));
 }
 
@@ -114,41 +131,60 @@ static void digest_process_block(DigestContext *ctx, const uint8_t *block) {
     ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
 }
 
-static void compute_transaction_digest(const uint8_t *data, size_t length, uint8_t *digest) {
-    digest_initialize(&g_digest_ctx);
+static void digest_update(DigestContext *ctx, const uint8_t *data, size_t length) {
+    if (ctx->buffered > 0) {
+        size_t n = DIGEST_BLOCK_SIZE - ctx->buffered;
+        if (n > length) {
+            n = length;
+        }
+
+        memcpy(ctx->buffer + ctx->buffered, data, n);
+        ctx->buffered += n;
+        data += n;
+        length -= n;
 
-    size_t remaining = length;
-    const uint8_t *ptr = data;
+        if (ctx->buffered < DIGEST_BLOCK_SIZE) {
+            return;
+        }
+        digest_process_block(ctx, ctx->buffer);
+        ctx->count += DIGEST_BLOCK_SIZE;
+        ctx->buffered = 0;
+    }
 
-    while (remaining >= 128) {
-        digest_process_block(&g_digest_ctx, ptr);
-        ptr += 128;
-        remaining -= 128;
-        g_digest_ctx.count += 128;
+    while (length >= DIGEST_BLOCK_SIZE) {
+        digest_process_block(ctx, data);
+        ctx->count += DIGEST_BLOCK_SIZE;
+        data += DIGEST_BLOCK_SIZE;
+        length -= DIGEST_BLOCK_SIZE;
     }
 
-    // Store remaining bytes
-    memcpy(g_digest_ctx.buffer, ptr, remaining);
+    memcpy(ctx->buffer, data, length);
+    ctx->buffered = length;
+}
+
+static void digest_finalize(DigestContext *ctx, uint8_t *digest) {
+    size_t remaining = ctx->buffered;
 
     // Apply padding
-    g_digest_ctx.buffer[remaining] = 0x80;
+    memset(ctx->buffer + remaining, 0, DIGEST_BLOCK_SIZE - remaining);
+    ctx->buffer[remaining] = 0x80;
     if (remaining >= 112) {
-        digest_process_block(&g_digest_ctx, g_digest_ctx.buffer);
-        memset(g_digest_ctx.buffer, 0, 128);
+        digest_process_block(ctx, ctx->buffer);
+        memset(ctx->buffer, 0, DIGEST_BLOCK_SIZE);
     }
 
     // Append length
-    uint64_t bit_length = (g_digest_ctx.count + remaining) * 8;
+    uint64_t bit_length = (ctx->count + remaining) * 8;
     for (int i = 0; i < 8; i++) {
-        g_digest_ctx.buffer[120 + i] = (bit_length >> (56 - i*8)) & 0xFF;
+        ctx->buffer[120 + i] = (bit_length >> (56 - i*8)) & 0xFF;
     }
 
-    digest_process_block(&g_digest_ctx, g_digest_ctx.buffer);
+    digest_process_block(ctx, ctx->buffer);
 
-    // Extract digest
-    for (int i = 0; i < 8; i++) {
+    // Extract digest, truncated to DIGEST_SIZE bytes
+    for (int i = 0; i < DIGEST_SIZE / 8; i++) {
         for (int j = 0; j < 8; j++) {
-            digest[i*8 + j] = (g_digest_ctx.state[i] >> (56 - j*8)) & 0xFF;
+            digest[i*8 + j] = (ctx->state[i] >> (56 - j*8)) & 0xFF;
         }
     }
 }
@@ -330,34 +366,106 @@ static void generate_stream_block(StreamCipherContext *ctx) {
     ctx->position = 0;
 }
 
-static uint8_t get_stream_byte(StreamCipherContext *ctx) {
-    if (ctx->position >= 64) {
-        generate_stream_block(ctx);
+// XORs length bytes of keystream, a keystream block at a time
+static void stream_cipher_xor(StreamCipherContext *ctx, const uint8_t *input,
+                              uint8_t *output, size_t length) {
+    while (length > 0) {
+        if (ctx->position >= STREAM_BLOCK_SIZE) {
+            generate_stream_block(ctx);
+        }
+
+        size_t n = STREAM_BLOCK_SIZE - ctx->position;
+        if (n > length) {
+            n = length;
+        }
+
+        const uint8_t *ks = ctx->keystream + ctx->position;
+        for (size_t i = 0; i < n; i++) {
+            output[i] = input[i] ^ ks[i];
+        }
+
+        ctx->position += n;
+        input += n;
+        output += n;
+        length -= n;
     }
-    return ctx->keystream[ctx->position++];
 }
 
-// Main transaction processing functions
-int process_financial_transaction(const char *transaction_data, uint8_t *encrypted_output,
-                                size_t *output_length) {
-    if (!transaction_data || !encrypted_output || !output_length) {
+void transaction_keys_initialize(TransactionKeyContext *keys, const uint8_t *block_key,
+                                 const uint8_t *stream_key, const uint8_t *nonce) {
+    initialize_block_cipher(&keys->block, block_key);
+    initialize_stream_cipher(&keys->stream, stream_key, nonce);
+}
+
+int transaction_stream_init(TransactionStreamContext *ctx, const TransactionKeyContext *keys) {
+    if (!ctx || !keys) {
         return -1;
     }
 
-    size_t input_length = strlen(transaction_data);
+    ctx->keys = keys;
+    digest_initialize(&ctx->digest);
+    ctx->stream = keys->stream;
+    ctx->length = 0;
+    return 0;
+}
 
-    // Step 1: Compute transaction integrity digest
+/*
+ * Encrypts length bytes into output (which may equal input) and feeds the
+ * plaintext to the digest. Both passes run over the same digest-block-sized
+ * piece while it is still in cache.
+ */
+int transaction_stream_update(TransactionStreamContext *ctx, const uint8_t *input,
+                              size_t length, uint8_t *output) {
+    if (!ctx || (length > 0 && (!input || !output))) {
+        return -1;
+    }
+
+    while (length > 0) {
+        size_t n = DIGEST_BLOCK_SIZE - ctx->digest.buffered;
+        if (n > length) {
+            n = length;
+        }
+
+        digest_update(&ctx->digest, input, n);
+        stream_cipher_xor(&ctx->stream, input, output, n);
+
+        ctx->length += n;
+        input += n;
+        output += n;
+        length -= n;
+    }
+    return 0;
+}
+
+// Writes the block-cipher-encrypted digest of everything passed to update
+int transaction_stream_final(TransactionStreamContext *ctx, uint8_t *encrypted_digest) {
     uint8_t transaction_digest[DIGEST_SIZE];
-    compute_transaction_digest((const uint8_t*)transaction_data, input_length, transaction_digest);
 
-    // Step 2: Initialize regional block cipher
+    if (!ctx || !encrypted_digest) {
+        return -1;
+    }
+
+    digest_finalize(&ctx->digest, transaction_digest);
+    for (int i = 0; i < DIGEST_SIZE; i += BLOCK_SIZE) {
+        encrypt_block_regional(transaction_digest + i, encrypted_digest + i,
+                               ctx->keys->block.round_keys);
+    }
+
+    memset(transaction_digest, 0, sizeof(transaction_digest));
+    memset(&ctx->stream, 0, sizeof(ctx->stream));
+    return 0;
+}
+
+// Module keys, expanded on first use
+static TransactionKeyContext g_default_keys;
+static pthread_once_t g_default_keys_once = PTHREAD_ONCE_INIT;
+
+static void initialize_default_keys(void) {
     uint8_t encryption_key[KEY_SIZE];
     for (int i = 0; i < KEY_SIZE; i++) {
         encryption_key[i] = (i * 17 + 23) & 0xFF;
     }
-    initialize_block_cipher(&g_block_ctx, encryption_key);
 
-    // Step 3: Initialize stream cipher for bulk encryption
     uint8_t stream_key[KEY_SIZE] = {
         0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
         0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
@@ -365,25 +473,74 @@ int process_financial_transaction(const char *transaction_data, uint8_t *encrypt
         0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00
     };
     uint8_t nonce[8] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0};
-    initialize_stream_cipher(&g_stream_ctx, stream_key, nonce);
 
-    // Step 4: Encrypt transaction data with stream cipher
-    size_t encrypted_data_length = input_length;
-    for (size_t i = 0; i < encrypted_data_length; i++) {
-        encrypted_output[i] = transaction_data[i] ^ get_stream_byte(&g_stream_ctx);
+    transaction_keys_initialize(&g_default_keys, encryption_key, stream_key, nonce);
+}
+
+static const TransactionKeyContext *default_transaction_keys(void) {
+    pthread_once(&g_default_keys_once, initialize_default_keys);
+    return &g_default_keys;
+}
+
+// Main transaction processing functions
+int process_financial_transaction(const char *transaction_data, uint8_t *encrypted_output,
+                                size_t *output_length) {
+    TransactionStreamContext ctx;
+
+    if (!transaction_data || !encrypted_output || !output_length) {
+        return -1;
     }
 
-    // Step 5: Encrypt digest with block cipher
+    size_t input_length = strlen(transaction_data);
+
+    transaction_stream_init(&ctx, default_transaction_keys());
+    transaction_stream_update(&ctx, (const uint8_t*)transaction_data, input_length, encrypted_output);
+    transaction_stream_final(&ctx, encrypted_output + input_length);
+    *output_length = input_length + DIGEST_SIZE;
+
+    return 0;
+}
+
+/*
+ * Encrypts a settlement file of any size in SETTLEMENT_CHUNK_SIZE pieces,
+ * writing the same layout as process_financial_transaction: ciphertext
+ * followed by the encrypted digest.
+ */
+int process_settlement_file(FILE *input, FILE *output) {
+    TransactionStreamContext ctx;
     uint8_t encrypted_digest[DIGEST_SIZE];
-    for (int i = 0; i < DIGEST_SIZE; i += BLOCK_SIZE) {
-        encrypt_block_regional(transaction_digest + i, encrypted_digest + i, g_block_ctx.round_keys);
+    uint8_t *chunk;
+    size_t n;
+    int status = 0;
+
+    if (!input || !output) {
+        return -1;
     }
 
-    // Step 6: Append encrypted digest
-    memcpy(encrypted_output + encrypted_data_length, encrypted_digest, DIGEST_SIZE);
-    *output_length = encrypted_data_length + DIGEST_SIZE;
+    chunk = malloc(SETTLEMENT_CHUNK_SIZE);
+    if (!chunk) {
+        return -1;
+    }
 
-    return 0;
+    transaction_stream_init(&ctx, default_transaction_keys());
+    while ((n = fread(chunk, 1, SETTLEMENT_CHUNK_SIZE, input)) > 0) {
+        transaction_stream_update(&ctx, chunk, n, chunk);
+        if (fwrite(chunk, 1, n, output) != n) {
+            status = -1;
+            break;
+        }
+    }
+    if (ferror(input)) {
+        status = -1;
+    }
+
+    transaction_stream_final(&ctx, encrypted_digest);
+    if (status == 0 && fwrite(encrypted_digest, 1, DIGEST_SIZE, output) != DIGEST_SIZE) {
+        status = -1;
+    }
+
+    free(chunk);
+    return status;
 }
 
 int main() {
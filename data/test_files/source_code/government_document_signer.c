@@ -7,10 +7,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <pthread.h>
 
 #define SIGNATURE_KEY_SIZE 32
 #define CURVE_PARAM_SIZE 8
 #define HASH_DIGEST_SIZE 20
+#define EC_LIMBS 4
+#define EC_COMB_TEETH 8
+#define EC_COMB_SPACING 32  // ceil(256 / EC_COMB_TEETH)
 
 typedef struct {
     uint32_t curve_a[CURVE_PARAM_SIZE];
@@ -33,27 +37,505 @@ typedef struct {
     uint32_t s_component[CURVE_PARAM_SIZE];
 } GovernmentSignature;
 
+/*
+ * P-256 engine. Field and scalar values are 4 little-endian 64-bit limbs
+ * kept in Montgomery form modulo p or n; points are Jacobian (X/Z^2, Y/Z^3)
+ * with Z = 0 at infinity. Multiplication by the generator uses a comb table
+ * built once.
+ */
+typedef struct {
+    uint64_t m[EC_LIMBS];
+    uint64_t rr[EC_LIMBS];   // R^2 mod m, R = 2^256
+    uint64_t one[EC_LIMBS];  // R mod m
+    uint64_t m0inv;          // -m^-1 mod 2^64
+} ec_modulus_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+    uint64_t z[EC_LIMBS];
+} ec_jacobian_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+} ec_affine_t;
+
+typedef struct {
+    ec_modulus_t p;
+    ec_modulus_t n;
+    ec_jacobian_t g;
+    ec_affine_t comb[1 << EC_COMB_TEETH];
+} ec_curve_t;
+
+static const uint64_t ec_p256_p[EC_LIMBS] = {
+    0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL
+};
+static const uint64_t ec_p256_n[EC_LIMBS] = {
+    0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL
+};
+static const uint64_t ec_p256_gx[EC_LIMBS] = {
+    0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL
+};
+static const uint64_t ec_p256_gy[EC_LIMBS] = {
+    0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL
+};
+
+static ec_curve_t ec_curve;
+static pthread_once_t ec_curve_once = PTHREAD_ONCE_INIT;
+
+static int ec_is_zero(const uint64_t *a) {
+    return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+// r = a - b, returns the borrow out
+static uint64_t ec_sub_limbs(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t borrow = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t diff = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (diff < borrow);
+
+        r[i] = diff - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static void ec_mod_add(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t sum[EC_LIMBS], reduced[EC_LIMBS];
+    uint64_t carry = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        unsigned __int128 acc = (unsigned __int128)a[i] + b[i] + carry;
+
+        sum[i] = (uint64_t)acc;
+        carry = (uint64_t)(acc >> 64);
+    }
+    if (ec_sub_limbs(reduced, sum, M->m) <= carry) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, sum, sizeof(sum));
+    }
+}
+
+static void ec_mod_sub(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t diff[EC_LIMBS];
+    uint64_t carry = 0;
+
+    if (ec_sub_limbs(diff, a, b)) {
+        for (int i = 0; i < EC_LIMBS; i++) {
+            unsigned __int128 acc = (unsigned __int128)diff[i] + M->m[i] + carry;
+
+            diff[i] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
+        }
+    }
+    memcpy(r, diff, sizeof(diff));
+}
+
+// (t, c) = t + a * b + c
+#define EC_MAC(t, a, b, c) do {                                           \
+    unsigned __int128 mac_ = (unsigned __int128)(a) * (b) + (t) + (c);    \
+    (t) = (uint64_t)mac_;                                                 \
+    (c) = (uint64_t)(mac_ >> 64);                                         \
+} while (0)
+
+// r = a * b * R^-1 mod m (CIOS, one row per limb of b); r may alias a or b
+static void ec_mod_mul(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5;
+    uint64_t reduced[EC_LIMBS], t[EC_LIMBS];
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t carry = 0;
+        uint64_t q;
+
+        EC_MAC(t0, a[0], b[i], carry);
+        EC_MAC(t1, a[1], b[i], carry);
+        EC_MAC(t2, a[2], b[i], carry);
+        EC_MAC(t3, a[3], b[i], carry);
+        t4 += carry;
+        t5 = t4 < carry;
+
+        // Adding q*m clears the low limb, which is then shifted out
+        q = t0 * M->m0inv;
+        carry = 0;
+        EC_MAC(t0, q, M->m[0], carry);
+        EC_MAC(t1, q, M->m[1], carry);
+        EC_MAC(t2, q, M->m[2], carry);
+        EC_MAC(t3, q, M->m[3], carry);
+        t4 += carry;
+        t5 += t4 < carry;
+
+        t0 = t1;
+        t1 = t2;
+        t2 = t3;
+        t3 = t4;
+        t4 = t5;
+    }
+
+    t[0] = t0;
+    t[1] = t1;
+    t[2] = t2;
+    t[3] = t3;
+    if (ec_sub_limbs(reduced, t, M->m) <= t4) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, t, sizeof(t));
+    }
+}
+
+// Into Montgomery form; any a below 2^256 is accepted and reduced
+static void ec_mod_to(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    ec_mod_mul(M, r, a, M->rr);
+}
+
+static void ec_mod_from(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+
+    ec_mod_mul(M, r, a, unit);
+}
+
+// r = a^-1 by Fermat (m is prime), 4-bit fixed windows over m - 2
+static void ec_mod_inv(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t two[EC_LIMBS] = {2};
+    uint64_t table[16][EC_LIMBS];
+    uint64_t exponent[EC_LIMBS];
+    uint64_t acc[EC_LIMBS];
+
+    ec_sub_limbs(exponent, M->m, two);
+    memcpy(table[0], M->one, sizeof(table[0]));
+    for (int i = 1; i < 16; i++) {
+        ec_mod_mul(M, table[i], table[i - 1], a);
+    }
+
+    memcpy(acc, M->one, sizeof(acc));
+    for (int i = 63; i >= 0; i--) {
+        unsigned int nibble = (exponent[i / 16] >> (i % 16 * 4)) & 0xF;
+
+        for (int s = 0; s < 4; s++) {
+            ec_mod_mul(M, acc, acc, acc);
+        }
+        ec_mod_mul(M, acc, acc, table[nibble]);
+    }
+    memcpy(r, acc, sizeof(acc));
+}
+
+static void ec_modulus_init(ec_modulus_t *M, const uint64_t *m) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+    uint64_t inv = m[0];
+
+    memcpy(M->m, m, sizeof(M->m));
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - m[0] * inv;
+    }
+    M->m0inv = -inv;
+
+    // R^2 mod m by doubling 1 modulo m 512 times
+    memcpy(M->rr, unit, sizeof(M->rr));
+    for (int i = 0; i < 512; i++) {
+        ec_mod_add(M, M->rr, M->rr, M->rr);
+    }
+    ec_mod_mul(M, M->one, M->rr, unit);
+}
+
+// dbl-2001-b, using a = -3
+static void ec_double(ec_jacobian_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t delta[EC_LIMBS], gamma[EC_LIMBS], beta[EC_LIMBS], alpha[EC_LIMBS];
+    uint64_t t0[EC_LIMBS], t1[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, delta, a->z, a->z);
+    ec_mod_mul(F, gamma, a->y, a->y);
+    ec_mod_mul(F, beta, a->x, gamma);
+
+    ec_mod_sub(F, t0, a->x, delta);
+    ec_mod_add(F, t1, a->x, delta);
+    ec_mod_mul(F, alpha, t0, t1);
+    ec_mod_add(F, t0, alpha, alpha);
+    ec_mod_add(F, alpha, t0, alpha);
+
+    // Z3 = (Y + Z)^2 - gamma - delta
+    ec_mod_add(F, t0, a->y, a->z);
+    ec_mod_mul(F, t0, t0, t0);
+    ec_mod_sub(F, t0, t0, gamma);
+    ec_mod_sub(F, r->z, t0, delta);
+
+    // X3 = alpha^2 - 8 beta
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, t1, beta, beta);
+    ec_mod_mul(F, t0, alpha, alpha);
+    ec_mod_sub(F, r->x, t0, t1);
+
+    // Y3 = alpha (4 beta - X3) - 8 gamma^2
+    ec_mod_sub(F, t0, beta, r->x);
+    ec_mod_mul(F, t0, alpha, t0);
+    ec_mod_mul(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_sub(F, r->y, t0, gamma);
+}
+
+/*
+ * Shared tail of the additions once u1, u2, s1, s2 are known; z12 is the
+ * product of the input Z coordinates. Falls back to doubling for P == Q.
+ */
+static void ec_add_finish(ec_jacobian_t *r, const ec_jacobian_t *a,
+                          const uint64_t *u1, const uint64_t *u2,
+                          const uint64_t *s1, const uint64_t *s2, const uint64_t *z12) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t h[EC_LIMBS], rr[EC_LIMBS], hh[EC_LIMBS], hhh[EC_LIMBS], v[EC_LIMBS];
+    uint64_t t0[EC_LIMBS];
+
+    ec_mod_sub(F, h, u2, u1);
+    ec_mod_sub(F, rr, s2, s1);
+    if (ec_is_zero(h)) {
+        if (ec_is_zero(rr)) {
+            ec_double(r, a);
+        } else {
+            memset(r, 0, sizeof(*r));
+        }
+        return;
+    }
+
+    ec_mod_mul(F, hh, h, h);
+    ec_mod_mul(F, hhh, hh, h);
+    ec_mod_mul(F, v, u1, hh);
+
+    // X3 = r^2 - H^3 - 2 V
+    ec_mod_mul(F, t0, rr, rr);
+    ec_mod_sub(F, t0, t0, hhh);
+    ec_mod_sub(F, t0, t0, v);
+    ec_mod_sub(F, r->x, t0, v);
+
+    // Y3 = r (V - X3) - S1 H^3
+    ec_mod_sub(F, t0, v, r->x);
+    ec_mod_mul(F, t0, rr, t0);
+    ec_mod_mul(F, hhh, s1, hhh);
+    ec_mod_sub(F, r->y, t0, hhh);
+
+    ec_mod_mul(F, r->z, z12, h);
+}
+
+// r = a + b; r may alias a
+static void ec_add(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_jacobian_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], z2z2[EC_LIMBS], u1[EC_LIMBS], u2[EC_LIMBS];
+    uint64_t s1[EC_LIMBS], s2[EC_LIMBS], z12[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *b;
+        return;
+    }
+    if (ec_is_zero(b->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, z2z2, b->z, b->z);
+    ec_mod_mul(F, u1, a->x, z2z2);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s1, a->y, b->z);
+    ec_mod_mul(F, s1, s1, z2z2);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+    ec_mod_mul(F, z12, a->z, b->z);
+
+    ec_add_finish(r, a, u1, u2, s1, s2, z12);
+}
+
+// r = a + b for an affine b, as used by the comb; r may alias a
+static void ec_add_affine(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_affine_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], u2[EC_LIMBS], s2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        memcpy(r->x, b->x, sizeof(r->x));
+        memcpy(r->y, b->y, sizeof(r->y));
+        memcpy(r->z, F->one, sizeof(r->z));
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+
+    ec_add_finish(r, a, a->x, u2, a->y, s2, a->z);
+}
+
+// Affine coordinates in Montgomery form; -1 for the point at infinity
+static int ec_to_affine(ec_affine_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        return -1;
+    }
+    ec_mod_inv(F, zinv, a->z);
+    ec_mod_mul(F, zinv2, zinv, zinv);
+    ec_mod_mul(F, r->x, a->x, zinv2);
+    ec_mod_mul(F, zinv2, zinv2, zinv);
+    ec_mod_mul(F, r->y, a->y, zinv2);
+    return 0;
+}
+
+// ec_to_affine over count finite points with one inversion (Montgomery's trick)
+static void ec_batch_to_affine(ec_affine_t *r, const ec_jacobian_t *a, size_t count) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t (*prefix)[EC_LIMBS] = malloc(count * sizeof(*prefix));
+    uint64_t inv[EC_LIMBS], zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (!prefix) {
+        for (size_t i = 0; i < count; i++) {
+            ec_to_affine(&r[i], &a[i]);
+        }
+        return;
+    }
+
+    memcpy(prefix[0], a[0].z, sizeof(prefix[0]));
+    for (size_t i = 1; i < count; i++) {
+        ec_mod_mul(F, prefix[i], prefix[i - 1], a[i].z);
+    }
+    ec_mod_inv(F, inv, prefix[count - 1]);
+
+    for (size_t i = count; i-- > 0;) {
+        if (i > 0) {
+            ec_mod_mul(F, zinv, inv, prefix[i - 1]);
+            ec_mod_mul(F, inv, inv, a[i].z);
+        } else {
+            memcpy(zinv, inv, sizeof(zinv));
+        }
+        ec_mod_mul(F, zinv2, zinv, zinv);
+        ec_mod_mul(F, r[i].x, a[i].x, zinv2);
+        ec_mod_mul(F, zinv2, zinv2, zinv);
+        ec_mod_mul(F, r[i].y, a[i].y, zinv2);
+    }
+    free(prefix);
+}
+
+static int ec_scalar_bit(const uint64_t *k, int bit) {
+    return bit < 256 ? (int)((k[bit / 64] >> (bit % 64)) & 1) : 0;
+}
+
+/*
+ * The comb entry for teeth bits b_j is sum b_j * 2^(j * EC_COMB_SPACING) G,
+ * so k*G takes EC_COMB_SPACING doublings and at most as many mixed adds.
+ */
+static void ec_curve_setup(void) {
+    ec_jacobian_t teeth[EC_COMB_TEETH];
+    ec_jacobian_t entries[1 << EC_COMB_TEETH];
+
+    ec_modulus_init(&ec_curve.p, ec_p256_p);
+    ec_modulus_init(&ec_curve.n, ec_p256_n);
+    ec_mod_to(&ec_curve.p, ec_curve.g.x, ec_p256_gx);
+    ec_mod_to(&ec_curve.p, ec_curve.g.y, ec_p256_gy);
+    memcpy(ec_curve.g.z, ec_curve.p.one, sizeof(ec_curve.g.z));
+
+    teeth[0] = ec_curve.g;
+    for (int j = 1; j < EC_COMB_TEETH; j++) {
+        teeth[j] = teeth[j - 1];
+        for (int i = 0; i < EC_COMB_SPACING; i++) {
+            ec_double(&teeth[j], &teeth[j]);
+        }
+    }
+
+    memset(&entries[0], 0, sizeof(entries[0]));
+    for (int index = 1; index < 1 << EC_COMB_TEETH; index++) {
+        int low = __builtin_ctz(index);
+
+        ec_add(&entries[index], &entries[index & (index - 1)], &teeth[low]);
+    }
+    ec_batch_to_affine(ec_curve.comb + 1, entries + 1, (1 << EC_COMB_TEETH) - 1);
+}
+
+static const ec_curve_t *ec_curve_get(void) {
+    pthread_once(&ec_curve_once, ec_curve_setup);
+    return &ec_curve;
+}
+
+// r = k * G for a 256-bit k
+static void ec_mul_base(ec_jacobian_t *r, const uint64_t *k) {
+    const ec_curve_t *curve = ec_curve_get();
+
+    memset(r, 0, sizeof(*r));
+    for (int i = EC_COMB_SPACING - 1; i >= 0; i--) {
+        unsigned int index = 0;
+
+        ec_double(r, r);
+        for (int j = 0; j < EC_COMB_TEETH; j++) {
+            index |= (unsigned int)ec_scalar_bit(k, j * EC_COMB_SPACING + i) << j;
+        }
+        if (index != 0) {
+            ec_add_affine(r, r, &curve->comb[index]);
+        }
+    }
+}
+
+// Big-endian 32-bit word arrays, as the domain stores them, to engine limbs
+static void words_to_limbs(uint64_t *r, const uint32_t *words) {
+    for (int i = 0; i < EC_LIMBS; i++) {
+        r[i] = ((uint64_t)words[CURVE_PARAM_SIZE - 2 - 2 * i] << 32) |
+               words[CURVE_PARAM_SIZE - 1 - 2 * i];
+    }
+}
+
+static void limbs_to_words(uint32_t *words, const uint64_t *a) {
+    for (int i = 0; i < EC_LIMBS; i++) {
+        words[CURVE_PARAM_SIZE - 2 - 2 * i] = (uint32_t)(a[i] >> 32);
+        words[CURVE_PARAM_SIZE - 1 - 2 * i] = (uint32_t)a[i];
+    }
+}
+
+// Plain affine words of a Jacobian point; zeros for the point at infinity
+static void point_to_words(uint32_t *x_words, uint32_t *y_words, const ec_jacobian_t *point) {
+    const ec_curve_t *curve = ec_curve_get();
+    uint64_t x[EC_LIMBS] = {0}, y[EC_LIMBS] = {0};
+    ec_affine_t affine;
+
+    if (ec_to_affine(&affine, point) == 0) {
+        ec_mod_from(&curve->p, x, affine.x);
+        ec_mod_from(&curve->p, y, affine.y);
+    }
+    limbs_to_words(x_words, x);
+    limbs_to_words(y_words, y);
+}
+
 // Domestic algorithm
 void init_korean_curve(EllipticCurveDomain *domain) {
-    // Curve parameters (simplified for demo)
+    // Curve parameters (NIST P-256)
     uint32_t p_param[8] = {
-        0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFE,
-        0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000001
+        0xFFFFFFFF, 0x00000001, 0x00000000, 0x00000000,
+        0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
     };
 
     uint32_t a_param[8] = {
-        0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFE,
-        0xFFFFFFFF, 0x00000000, 0x00000000, 0xFFFFFFFE
+        0xFFFFFFFF, 0x00000001, 0x00000000, 0x00000000,
+        0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFC
     };
 
     uint32_t b_param[8] = {
-        0x64210519, 0xE59C80E7, 0x0FA7E9AB, 0x72243049,
-        0xFEB8DEEC, 0xC146B9B1, 0x5C669934, 0x5E9814EE
+        0x5AC635D8, 0xAA3A93E7, 0xB3EBBD55, 0x769886BC,
+        0x651D06B0, 0xCC53B0F6, 0x3BCE3C3E, 0x27D2604B
+    };
+
+    uint32_t n_param[8] = {
+        0xFFFFFFFF, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF,
+        0xBCE6FAAD, 0xA7179E84, 0xF3B9CAC2, 0xFC632551
     };
 
     memcpy(domain->curve_p, p_param, sizeof(p_param));
     memcpy(domain->curve_a, a_param, sizeof(a_param));
     memcpy(domain->curve_b, b_param, sizeof(b_param));
+    memcpy(domain->order, n_param, sizeof(n_param));
 
     // Base point coordinates
     uint32_t gx[8] = {
@@ -70,10 +552,12 @@ void init_korean_curve(EllipticCurveDomain *domain) {
     memcpy(domain->base_point_y, gy, sizeof(gy));
 }
 
-// Modular arithmetic for Geometric Curves
+// Modular arithmetic for Geometric Curves: a + b mod modulus for a, b < modulus
 void mod_add(uint32_t *result, const uint32_t *a, const uint32_t *b,
              const uint32_t *modulus) {
+    uint32_t reduced[CURVE_PARAM_SIZE];
     uint64_t carry = 0;
+    uint64_t borrow = 0;
 
     for (int i = CURVE_PARAM_SIZE - 1; i >= 0; i--) {
         uint64_t sum = (uint64_t)a[i] + b[i] + carry;
@@ -81,56 +565,59 @@ void mod_add(uint32_t *result, const uint32_t *a, const uint32_t *b,
         carry = sum >> 32;
     }
 
-    // Simple modular reduction (simplified)
-    if (carry) {
-        for (int i = CURVE_PARAM_SIZE - 1; i >= 0; i--) {
-            if (result[i] >= productN[i]) {
-                result[i] -= productN[i];
-                break;
-            }
-        }
+    // The sum is below 2 * modulus, so one subtraction reduces it
+    for (int i = CURVE_PARAM_SIZE - 1; i >= 0; i--) {
+        uint64_t diff = (uint64_t)result[i] - modulus[i] - borrow;
+        reduced[i] = diff & 0xFFFFFFFF;
+        borrow = (diff >> 32) & 1;
+    }
+    if (carry || !borrow) {
+        memcpy(result, reduced, sizeof(reduced));
     }
 }
 
-// Mathematical curve operation
+// Mathematical curve operation. The engine is fixed to P-256, the curve
+// init_korean_curve sets up, so the domain only documents the caller's curve
 void ec_point_double(uint32_t *rx, uint32_t *ry, const uint32_t *px,
                      const uint32_t *py, const EllipticCurveDomain *domain) {
-    // Simplified point doubling (production code would be more complex)
-    uint32_t temp[CURVE_PARAM_SIZE];
-
-    // Calculate slope
-    for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
-        temp[i] = (px[i] * px[i] * 3) % domain->curve_p[i];
-    }
-
-    mod_add(temp, temp, domain->curve_a, domain->curve_p);
-
-    // Calculate new coordinates (simplified)
-    for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
-        rx[i] = (temp[i] * temp[i]) % domain->curve_p[i];
-        ry[i] = (temp[i] * (px[i] - rx[i])) % domain->curve_p[i];
-    }
+    const ec_curve_t *curve = ec_curve_get();
+    uint64_t limbs[EC_LIMBS];
+    ec_jacobian_t point;
+
+    (void)domain;
+    words_to_limbs(limbs, px);
+    ec_mod_to(&curve->p, point.x, limbs);
+    words_to_limbs(limbs, py);
+    ec_mod_to(&curve->p, point.y, limbs);
+    memcpy(point.z, curve->p.one, sizeof(point.z));
+
+    ec_double(&point, &point);
+    point_to_words(rx, ry, &point);
 }
 
 // Generate government signature keypair
 void generate_signature_keypair(DigitalSignatureKey *key) {
+    const ec_curve_t *curve = ec_curve_get();
+    uint64_t d[EC_LIMBS];
+    ec_jacobian_t public_point;
+
     init_korean_curve(&key->domain);
 
-    // Generate random private key (simplified)
+    // Generate random private key (simplified), reduced into [1, n)
     srand(12345); // Fixed block_cipher_128 for demo
-    for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
-        key->private_scalar[i] = rand();
-    }
-
-    // Calculate public key = private_key * base_point
-    memcpy(key->public_point_x, key->domain.base_point_x, sizeof(key->public_point_x));
-    memcpy(key->public_point_y, key->domain.base_point_y, sizeof(key->public_point_y));
-
-    // Scalar multiplication (simplified - would use proper algorithm)
-    for (int i = 0; i < 10; i++) {
-        ec_point_double(key->public_point_x, key->public_point_y,
-                       key->public_point_x, key->public_point_y, &key->domain);
-    }
+    do {
+        for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
+            key->private_scalar[i] = rand();
+        }
+        words_to_limbs(d, key->private_scalar);
+        ec_mod_to(&curve->n, d, d);
+        ec_mod_from(&curve->n, d, d);
+    } while (ec_is_zero(d));
+    limbs_to_words(key->private_scalar, d);
+
+    // Calculate public key = private_key * base_point with the comb table
+    ec_mul_base(&public_point, d);
+    point_to_words(key->public_point_x, key->public_point_y, &public_point);
 }
 
 // Domestic algorithm
@@ -167,36 +654,55 @@ void hash_document(const char *document, uint32_t *digest) {
 // Domestic algorithm
 void sign_government_document(const char *document, DigitalSignatureKey *key,
                              GovernmentSignature *signature) {
+    const ec_curve_t *curve = ec_curve_get();
     uint32_t document_hash[CURVE_PARAM_SIZE];
+    uint64_t e[EC_LIMBS], d[EC_LIMBS], r[EC_LIMBS], s[EC_LIMBS];
 
     // Hash the document
     hash_document(document, document_hash);
 
-    // Geometric Curve digital signature
-    uint32_t k[CURVE_PARAM_SIZE];
-    uint32_t temp_x[CURVE_PARAM_SIZE], temp_y[CURVE_PARAM_SIZE];
-
-    // Generate random k (simplified)
-    for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
-        k[i] = rand();
-    }
-
-    // Calculate r = (k * G).x mod n
-    memcpy(temp_x, key->domain.base_point_x, sizeof(temp_x));
-    memcpy(temp_y, key->domain.base_point_y, sizeof(temp_y));
+    // Geometric Curve digital signature, with scalars in Montgomery form mod n
+    words_to_limbs(e, document_hash);
+    ec_mod_to(&curve->n, e, e);
+    words_to_limbs(d, key->private_scalar);
+    ec_mod_to(&curve->n, d, d);
+
+    for (;;) {
+        uint32_t k_words[CURVE_PARAM_SIZE];
+        uint64_t k[EC_LIMBS];
+        ec_jacobian_t point;
+        ec_affine_t commitment;
+
+        // Generate random k (simplified)
+        for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
+            k_words[i] = rand();
+        }
+        words_to_limbs(k, k_words);
 
-    for (int i = 0; i < 5; i++) {
-        ec_point_double(temp_x, temp_y, temp_x, temp_y, &key->domain);
+        // Calculate r = (k * G).x mod n
+        ec_mul_base(&point, k);
+        if (ec_to_affine(&commitment, &point) != 0) {
+            continue;
+        }
+        ec_mod_from(&curve->p, r, commitment.x);
+        ec_mod_to(&curve->n, r, r);
+
+        // Calculate s = k^(-1) * (hash + r * private_key) mod n
+        ec_mod_to(&curve->n, k, k);
+        ec_mod_inv(&curve->n, k, k);
+        ec_mod_mul(&curve->n, s, r, d);
+        ec_mod_add(&curve->n, s, s, e);
+        ec_mod_mul(&curve->n, s, s, k);
+
+        if (!ec_is_zero(r) && !ec_is_zero(s)) {
+            break;
+        }
     }
 
-    memcpy(signature->r_component, temp_x, sizeof(signature->r_component));
-
-    // Calculate s = k^(-1) * (hash + r * private_key) mod n (simplified)
-    for (int i = 0; i < CURVE_PARAM_SIZE; i++) {
-        signature->s_component[i] = (document_hash[i] +
-                                   (signature->r_component[i] * key->private_scalar[i])) %
-                                   key->domain.order[i];
-    }
+    ec_mod_from(&curve->n, r, r);
+    ec_mod_from(&curve->n, s, s);
+    limbs_to_words(signature->r_component, r);
+    limbs_to_words(signature->s_component, s);
 }
 
 // Main government document signing function
@@ -7,14 +7,30 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <functional>
+#include <memory>
 #include <cstring>
 #include <ctime>
-#include <random>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
 #include <openssl/bn.h>
 #include <openssl/sha.h>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+#include <pthread.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
  * Lightweight Session Token Encryption
@@ -101,11 +117,11 @@ public:
     }
 
     /**
-     * Encrypt session token block
+     * Encrypt session token block (ciphertext may alias plaintext)
      */
     void encrypt_block(const uint8_t* plaintext, uint8_t* ciphertext) {
         // Copy to output
-        memcpy(ciphertext, plaintext, DATA_BLOCK_SIZE);
+        memmove(ciphertext, plaintext, DATA_BLOCK_SIZE);
 
         // Initial whitening
         for (int i = 0; i < DATA_BLOCK_SIZE; i++) {
@@ -124,32 +140,479 @@ public:
         }
     }
 
+    /**
+     * Size of an encrypted token; padding always adds 1..8 bytes
+     */
+    static size_t encrypted_token_size(size_t length) {
+        return length + DATA_BLOCK_SIZE - (length % DATA_BLOCK_SIZE);
+    }
+
+    /**
+     * Encrypt session token data without heap allocation.
+     * output needs encrypted_token_size(length) bytes and may alias data.
+     */
+    size_t encrypt_token(const uint8_t* data, size_t length, uint8_t* output) {
+        size_t full_len = length - (length % DATA_BLOCK_SIZE);
+
+        // Encrypt blocks
+        for (size_t i = 0; i < full_len; i += DATA_BLOCK_SIZE) {
+            encrypt_block(&data[i], &output[i]);
+        }
+
+        // Pad the final block
+        uint8_t last_block[DATA_BLOCK_SIZE];
+        size_t remainder = length - full_len;
+        uint8_t pad_len = static_cast<uint8_t>(DATA_BLOCK_SIZE - remainder);
+
+        memcpy(last_block, data + full_len, remainder);
+        memset(last_block + remainder, pad_len, pad_len);
+        encrypt_block(last_block, &output[full_len]);
+
+        return full_len + DATA_BLOCK_SIZE;
+    }
+
     /**
      * Encrypt session token data
      */
     std::vector<uint8_t> encrypt_token(const std::vector<uint8_t>& data) {
-        // Calculate padded length
-        size_t pad_len = DATA_BLOCK_SIZE - (data.size() % DATA_BLOCK_SIZE);
-        std::vector<uint8_t> padded(data.size() + pad_len);
+        std::vector<uint8_t> encrypted(encrypted_token_size(data.size()));
+        encrypt_token(data.data(), data.size(), encrypted.data());
+        return encrypted;
+    }
+};
+
+/**
+ * Thread-local pool of BIGNUMs plus one reusable BN_CTX per thread
+ * Released values are cleared and kept for reuse. Fresh ones are
+ * pre-expanded to the widest value this thread has released, so under
+ * auth load signature temporaries stop allocating once a domain warms up
+ */
+class BignumPool {
+public:
+    static BignumPool& local() {
+        thread_local BignumPool pool;
+        return pool;
+    }
+
+    BignumPool(const BignumPool&) = delete;
+    BignumPool& operator=(const BignumPool&) = delete;
 
-        memcpy(padded.data(), data.data(), data.size());
-        for (size_t i = data.size(); i < padded.size(); i++) {
-            padded[i] = static_cast<uint8_t>(pad_len);
+    BIGNUM* acquire() {
+        if (!free_list.empty()) {
+            BIGNUM* bn = free_list.back();
+            free_list.pop_back();
+            return bn;
         }
 
-        // Encrypt blocks
-        std::vector<uint8_t> encrypted(padded.size());
-        for (size_t i = 0; i < padded.size(); i += DATA_BLOCK_SIZE) {
-            encrypt_block(&padded[i], &encrypted[i]);
+        BIGNUM* bn = BN_new();
+        if (capacity_bits > 0) {
+            BN_set_bit(bn, capacity_bits - 1);
+            BN_zero(bn);
         }
+        return bn;
+    }
 
-        return encrypted;
+    void release(BIGNUM* bn) {
+        if (bn == nullptr) {
+            return;
+        }
+
+        capacity_bits = std::max(capacity_bits, BN_num_bits(bn));
+        if (free_list.size() < MAX_POOLED) {
+            BN_clear(bn);
+            free_list.push_back(bn);
+        } else {
+            BN_clear_free(bn);
+        }
+    }
+
+    BN_CTX* context() { return ctx; }
+
+private:
+    static const size_t MAX_POOLED = 256;
+
+    std::vector<BIGNUM*> free_list;
+    BN_CTX* ctx;
+    int capacity_bits = 0;
+
+    BignumPool() : ctx(BN_CTX_new()) {
+        free_list.reserve(MAX_POOLED);
+    }
+
+    ~BignumPool() {
+        for (BIGNUM* bn : free_list) {
+            BN_free(bn);
+        }
+        BN_CTX_free(ctx);
+    }
+};
+
+/**
+ * Compact binary encoding for domain parameters and key pairs
+ * Layout: 4-byte magic "KAUT", u16 version, u16 record type, u32 security
+ * bits, then each integer as a u32 byte length and its big-endian bytes
+ */
+class StateWriter {
+public:
+    static constexpr uint8_t MAGIC[4] = {'K', 'A', 'U', 'T'};
+    static constexpr uint16_t VERSION = 1;
+
+    StateWriter(uint16_t record_type, int security_bits) {
+        bytes.insert(bytes.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        put_u16(VERSION);
+        put_u16(record_type);
+        put_u32(static_cast<uint32_t>(security_bits));
+    }
+
+    void put(const BIGNUM* value) {
+        size_t length = BN_num_bytes(value);
+        put_u32(static_cast<uint32_t>(length));
+        bytes.resize(bytes.size() + length);
+        BN_bn2bin(value, bytes.data() + bytes.size() - length);
+    }
+
+    std::vector<uint8_t> take() { return std::move(bytes); }
+
+private:
+    std::vector<uint8_t> bytes;
+
+    void put_u16(uint16_t value) {
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void put_u32(uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            bytes.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+};
+
+/**
+ * Bounds-checked reader for StateWriter output
+ * Throws std::runtime_error on malformed input or a security level other
+ * than the one the caller expects
+ */
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t length, uint16_t expected_type, int expected_bits)
+        : cursor(data), end(data + length) {
+        if (length < sizeof(StateWriter::MAGIC) ||
+            std::memcmp(data, StateWriter::MAGIC, sizeof(StateWriter::MAGIC)) != 0) {
+            throw std::runtime_error("Not an authentication state record");
+        }
+        cursor += sizeof(StateWriter::MAGIC);
+
+        if (get_u16() != StateWriter::VERSION) {
+            throw std::runtime_error("Unsupported authentication state version");
+        }
+        if (get_u16() != expected_type) {
+            throw std::runtime_error("Unexpected authentication state record type");
+        }
+        bits = static_cast<int>(get_u32());
+        if (bits != expected_bits) {
+            throw std::runtime_error("authentication state was generated for " + std::to_string(bits) +
+                                     "-bit security, not " + std::to_string(expected_bits));
+        }
+    }
+
+    int security_bits() const { return bits; }
+
+    void get(BIGNUM* out) {
+        uint32_t length = get_u32();
+        require_bytes(length);
+        BN_bin2bn(cursor, static_cast<int>(length), out);
+        cursor += length;
+    }
+
+    void finish() const {
+        if (cursor != end) {
+            throw std::runtime_error("Trailing bytes in authentication state record");
+        }
+    }
+
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+    int bits = 0;
+
+    uint16_t get_u16() {
+        require_bytes(2);
+        uint16_t value = static_cast<uint16_t>((cursor[0] << 8) | cursor[1]);
+        cursor += 2;
+        return value;
+    }
+
+    uint32_t get_u32() {
+        require_bytes(4);
+        uint32_t value = (uint32_t(cursor[0]) << 24) | (uint32_t(cursor[1]) << 16) |
+                         (uint32_t(cursor[2]) << 8) | cursor[3];
+        cursor += 4;
+        return value;
+    }
+
+    void require_bytes(size_t count) const {
+        if (static_cast<size_t>(end - cursor) < count) {
+            throw std::runtime_error("Truncated authentication state record");
+        }
+    }
+};
+
+/**
+ * State files: mapped read-only on load, installed with first-writer-wins
+ * semantics so processes starting together agree on one set of parameters
+ */
+class StateFile {
+public:
+    class Mapping {
+    public:
+        Mapping(const uint8_t* bytes, size_t length) : bytes(bytes), length(length) {}
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        ~Mapping() {
+            munmap(const_cast<uint8_t*>(bytes), length);
+        }
+
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const uint8_t* bytes;
+        size_t length;
+    };
+
+    /**
+     * Map path read-only; nullptr when the file does not exist
+     */
+    static std::unique_ptr<Mapping> map(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) {
+                return nullptr;
+            }
+            throw std::runtime_error("Cannot open state file: " + path);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            throw std::runtime_error("Cannot read state file: " + path);
+        }
+
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map state file: " + path);
+        }
+
+        return std::make_unique<Mapping>(static_cast<const uint8_t*>(mapped),
+                                         static_cast<size_t>(st.st_size));
+    }
+
+    /**
+     * Write bytes to a private temporary and link it into place
+     * Returns false if another process installed path first
+     */
+    static bool install_if_absent(const std::string& path, const std::vector<uint8_t>& bytes) {
+        std::string temporary = path + ".tmp." + std::to_string(getpid());
+        int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create state file: " + temporary);
+        }
+
+        size_t written = 0;
+        while (written < bytes.size()) {
+            ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+
+        bool durable = written == bytes.size() && fsync(fd) == 0;
+        durable = close(fd) == 0 && durable;
+        int linked = durable ? link(temporary.c_str(), path.c_str()) : -1;
+        int link_error = errno;
+        unlink(temporary.c_str());
+
+        if (linked == 0) {
+            return true;
+        }
+        if (durable && link_error == EEXIST) {
+            return false;
+        }
+        throw std::runtime_error("Cannot install state file: " + path);
+    }
+
+    /**
+     * Hand the mapped file at path to load, or run generate and install the
+     * bytes it returns when path does not exist yet
+     */
+    template <typename Load, typename Generate>
+    static void load_or_generate(const std::string& path, Load&& load, Generate&& generate) {
+        for (;;) {
+            if (auto mapping = map(path)) {
+                load(mapping->data(), mapping->size());
+                return;
+            }
+
+            if (install_if_absent(path, generate())) {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * Bounded pool of precomputed signing nonces
+ * Each slot holds (k^-1 mod q, r = (g^k mod p) mod q), which do not depend
+ * on the message, so signing online is two multiplications mod q. A
+ * background thread tops the pool up to capacity whenever it drains to
+ * half, and every slot is cleared as soon as it is taken.
+ */
+class SigningNoncePool {
+public:
+    using Generator = std::function<void(BIGNUM* kinv, BIGNUM* r)>;
+
+    struct Metrics {
+        size_t depth;
+        size_t capacity;
+        uint64_t produced;
+        uint64_t consumed;
+        uint64_t misses;        // takes that found the pool empty
+        double refill_rate;     // nonces per second of refiller work
+    };
+
+    SigningNoncePool(size_t capacity, Generator generate)
+        : slots(capacity), generate(std::move(generate)) {
+        for (Slot& slot : slots) {
+            slot.kinv = BN_new();
+            slot.r = BN_new();
+        }
+        refiller = std::thread(&SigningNoncePool::run_refiller, this);
+    }
+
+    SigningNoncePool(const SigningNoncePool&) = delete;
+    SigningNoncePool& operator=(const SigningNoncePool&) = delete;
+
+    ~SigningNoncePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        refill_wakeup.notify_one();
+        refiller.join();
+
+        for (Slot& slot : slots) {
+            BN_clear_free(slot.kinv);
+            BN_clear_free(slot.r);
+        }
+    }
+
+    /**
+     * Copy out one precomputed nonce; false when the pool is empty
+     */
+    bool take(BIGNUM* kinv, BIGNUM* r) {
+        bool taken = false;
+        bool wake_refiller;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (depth == 0) {
+                misses++;
+                wake_refiller = true;
+            } else {
+                Slot& slot = slots[head];
+                BN_copy(kinv, slot.kinv);
+                BN_copy(r, slot.r);
+                BN_clear(slot.kinv);
+                BN_clear(slot.r);
+
+                head = (head + 1) % slots.size();
+                depth--;
+                consumed++;
+                taken = true;
+                wake_refiller = depth <= low_watermark();
+            }
+        }
+
+        if (wake_refiller) {
+            refill_wakeup.notify_one();
+        }
+        return taken;
+    }
+
+    Metrics metrics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        double busy_seconds = std::chrono::duration<double>(refill_busy).count();
+        return Metrics{depth, slots.size(), produced, consumed, misses,
+                       busy_seconds > 0 ? produced / busy_seconds : 0.0};
+    }
+
+private:
+    struct Slot {
+        BIGNUM* kinv;
+        BIGNUM* r;
+    };
+
+    std::vector<Slot> slots;
+    Generator generate;
+
+    mutable std::mutex mutex;
+    std::condition_variable refill_wakeup;
+    size_t head = 0;
+    size_t depth = 0;
+    uint64_t produced = 0;
+    uint64_t consumed = 0;
+    uint64_t misses = 0;
+    std::chrono::steady_clock::duration refill_busy{0};
+    bool stopping = false;
+    std::thread refiller;
+
+    size_t low_watermark() const { return slots.size() / 2; }
+
+    void run_refiller() {
+        BignumPool& pool = BignumPool::local();
+        BIGNUM* kinv = pool.acquire();
+        BIGNUM* r = pool.acquire();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (depth == slots.size()) {
+                refill_wakeup.wait(lock, [this] {
+                    return stopping || depth <= low_watermark();
+                });
+                continue;
+            }
+
+            // The modexp runs unlocked; only publishing takes the lock
+            lock.unlock();
+            auto started = std::chrono::steady_clock::now();
+            generate(kinv, r);
+            auto finished = std::chrono::steady_clock::now();
+            lock.lock();
+
+            Slot& slot = slots[(head + depth) % slots.size()];
+            BN_copy(slot.kinv, kinv);
+            BN_copy(slot.r, r);
+            depth++;
+            produced++;
+            refill_busy += finished - started;
+        }
+        lock.unlock();
+
+        pool.release(kinv);
+        pool.release(r);
     }
 };
 
 /**
  * Authentication Signature Engine
  * Based on discrete logarithm problem for user authentication
+ * Keys, signatures and temporaries come from the calling thread's BignumPool
  */
 class AuthenticationSignatureEngine {
 private:
@@ -159,17 +622,20 @@ private:
         BIGNUM* subgroup_order;  // Order q
     };
 
+    static constexpr size_t NONCE_POOL_CAPACITY = 256;
+
     DomainParams params;
-    BN_CTX* ctx;
+    BN_MONT_CTX* prime_mont;  // Montgomery context for p, shared by every exponentiation
+    std::unique_ptr<SigningNoncePool> nonces;
+
+    static const uint16_t DOMAIN_RECORD_TYPE = 1;
 
     void initialize_domain_params(int bits) {
-        ctx = BN_CTX_new();
-        params.prime = BN_new();
-        params.generator = BN_new();
-        params.subgroup_order = BN_new();
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
 
-        BIGNUM* one = BN_new();
-        BIGNUM* two = BN_new();
+        BIGNUM* one = pool.acquire();
+        BIGNUM* two = pool.acquire();
         BN_set_word(one, 1);
         BN_set_word(two, 2);
 
@@ -190,9 +656,9 @@ private:
         }
 
         // Find generator
-        BIGNUM* exp = BN_new();
-        BIGNUM* pm1 = BN_new();
-        BIGNUM* h = BN_new();
+        BIGNUM* exp = pool.acquire();
+        BIGNUM* pm1 = pool.acquire();
+        BIGNUM* h = pool.acquire();
 
         BN_sub(pm1, params.prime, one);
         BN_div(exp, nullptr, pm1, params.subgroup_order, ctx);
@@ -203,11 +669,88 @@ private:
             BN_add_word(h, 1);
         } while (BN_is_one(params.generator));
 
-        BN_free(exp);
-        BN_free(pm1);
-        BN_free(h);
-        BN_free(one);
-        BN_free(two);
+        pool.release(exp);
+        pool.release(pm1);
+        pool.release(h);
+        pool.release(one);
+        pool.release(two);
+    }
+
+    std::vector<uint8_t> serialize_domain_params(int bits) const {
+        StateWriter writer(DOMAIN_RECORD_TYPE, bits);
+        writer.put(params.prime);
+        writer.put(params.generator);
+        writer.put(params.subgroup_order);
+        return writer.take();
+    }
+
+    /**
+     * Read parameters written by serialize_domain_params and check that
+     * they describe a prime-order subgroup of Z_p*
+     */
+    void load_domain_params(const uint8_t* data, size_t length, int bits) {
+        StateReader reader(data, length, DOMAIN_RECORD_TYPE, bits);
+        reader.get(params.prime);
+        reader.get(params.generator);
+        reader.get(params.subgroup_order);
+        reader.finish();
+
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
+        BIGNUM* t = pool.acquire();
+
+        bool valid = BN_check_prime(params.prime, ctx, nullptr) == 1 &&
+                     BN_check_prime(params.subgroup_order, ctx, nullptr) == 1;
+
+        // q | p - 1
+        if (valid) {
+            BN_sub(t, params.prime, BN_value_one());
+            BN_mod(t, t, params.subgroup_order, ctx);
+            valid = BN_is_zero(t);
+        }
+
+        // 1 < g < p and g^q = 1 mod p
+        if (valid) {
+            valid = BN_cmp(params.generator, BN_value_one()) > 0 &&
+                    BN_cmp(params.generator, params.prime) < 0;
+        }
+        if (valid) {
+            BN_mod_exp(t, params.generator, params.subgroup_order, params.prime, ctx);
+            valid = BN_is_one(t);
+        }
+
+        pool.release(t);
+        if (!valid) {
+            throw std::runtime_error("Invalid domain parameters in authentication state");
+        }
+    }
+
+    /**
+     * Fresh nonce: random k in [1, q-1], r = (g^k mod p) mod q != 0, and k^-1 mod q
+     */
+    void generate_nonce(BIGNUM* kinv, BIGNUM* r) const {
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
+        BIGNUM* k = pool.acquire();
+        BIGNUM* temp = pool.acquire();
+
+        do {
+            // Generate random k
+            BN_rand_range(k, params.subgroup_order);
+            if (BN_is_zero(k)) {
+                BN_set_word(k, 1);
+            }
+
+            // Compute r = (g^k mod p) mod q
+            BN_mod_exp_mont(temp, params.generator, k, params.prime, ctx, prime_mont);
+            BN_mod(r, temp, params.subgroup_order, ctx);
+        } while (BN_is_zero(r));
+
+        // Compute k^-1 mod q
+        BN_mod_inverse(kinv, k, params.subgroup_order, ctx);
+
+        pool.release(k);
+        pool.release(temp);
     }
 
     std::vector<uint8_t> hash_message(const std::string& message) {
@@ -231,24 +774,62 @@ public:
         BIGNUM* s;
     };
 
-    AuthenticationSignatureEngine(int security_bits = 1024) {
-        initialize_domain_params(security_bits);
+    /**
+     * With a domain_path the parameters are mapped from that file, and
+     * generated and saved there only on the first start
+     */
+    explicit AuthenticationSignatureEngine(int security_bits = 1024,
+                                           const std::string& domain_path = "") {
+        params.prime = BN_new();
+        params.generator = BN_new();
+        params.subgroup_order = BN_new();
+
+        try {
+            if (domain_path.empty()) {
+                initialize_domain_params(security_bits);
+            } else {
+                StateFile::load_or_generate(
+                    domain_path,
+                    [&](const uint8_t* data, size_t length) {
+                        load_domain_params(data, length, security_bits);
+                    },
+                    [&] {
+                        initialize_domain_params(security_bits);
+                        return serialize_domain_params(security_bits);
+                    });
+            }
+        } catch (...) {
+            BN_free(params.prime);
+            BN_free(params.generator);
+            BN_free(params.subgroup_order);
+            throw;
+        }
+
+        prime_mont = BN_MONT_CTX_new();
+        BN_MONT_CTX_set(prime_mont, params.prime, BignumPool::local().context());
+
+        nonces = std::make_unique<SigningNoncePool>(
+            NONCE_POOL_CAPACITY, [this](BIGNUM* kinv, BIGNUM* r) { generate_nonce(kinv, r); });
     }
 
     ~AuthenticationSignatureEngine() {
+        // Stop the refiller before the domain it reads is freed
+        nonces.reset();
+
         BN_free(params.prime);
         BN_free(params.generator);
         BN_free(params.subgroup_order);
-        BN_CTX_free(ctx);
+        BN_MONT_CTX_free(prime_mont);
     }
 
     /**
      * Generate authentication key pair
      */
     KeyPair generate_keypair() {
+        BignumPool& pool = BignumPool::local();
         KeyPair keypair;
-        keypair.private_key = BN_new();
-        keypair.public_key = BN_new();
+        keypair.private_key = pool.acquire();
+        keypair.public_key = pool.acquire();
 
         // Generate private key x in [1, q-1]
         BN_rand_range(keypair.private_key, params.subgroup_order);
@@ -257,8 +838,8 @@ public:
         }
 
         // Compute public key y = g^x mod p
-        BN_mod_exp(keypair.public_key, params.generator, keypair.private_key,
-                  params.prime, ctx);
+        BN_mod_exp_mont(keypair.public_key, params.generator, keypair.private_key,
+                        params.prime, pool.context(), prime_mont);
 
         return keypair;
     }
@@ -267,36 +848,27 @@ public:
      * Sign authentication challenge
      */
     Signature sign_challenge(const std::string& challenge, const KeyPair& keypair) {
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
         Signature sig;
-        sig.r = BN_new();
-        sig.s = BN_new();
+        sig.r = pool.acquire();
+        sig.s = pool.acquire();
 
         // Hash challenge
         auto hash_vec = hash_message(challenge);
-        BIGNUM* e = BN_new();
+        BIGNUM* e = pool.acquire();
         BN_bin2bn(hash_vec.data(), hash_vec.size(), e);
         BN_mod(e, e, params.subgroup_order, ctx);
 
-        BIGNUM* k = BN_new();
-        BIGNUM* kinv = BN_new();
-        BIGNUM* temp = BN_new();
+        BIGNUM* kinv = pool.acquire();
+        BIGNUM* temp = pool.acquire();
 
         do {
-            // Generate random k
-            BN_rand_range(k, params.subgroup_order);
-            if (BN_is_zero(k)) {
-                BN_set_word(k, 1);
+            // Take a precomputed (k^-1, r), or make one inline if the pool ran dry
+            if (!nonces->take(kinv, sig.r)) {
+                generate_nonce(kinv, sig.r);
             }
 
-            // Compute r = (g^k mod p) mod q
-            BN_mod_exp(temp, params.generator, k, params.prime, ctx);
-            BN_mod(sig.r, temp, params.subgroup_order, ctx);
-
-            if (BN_is_zero(sig.r)) continue;
-
-            // Compute k^-1 mod q
-            BN_mod_inverse(kinv, k, params.subgroup_order, ctx);
-
             // Compute s = k^-1 * (e + x*r) mod q
             BN_mod_mul(temp, keypair.private_key, sig.r,
                       params.subgroup_order, ctx);
@@ -305,10 +877,9 @@ public:
 
         } while (BN_is_zero(sig.s));
 
-        BN_free(e);
-        BN_free(k);
-        BN_free(kinv);
-        BN_free(temp);
+        pool.release(e);
+        pool.release(kinv);
+        pool.release(temp);
 
         return sig;
     }
@@ -324,18 +895,21 @@ public:
             return false;
         }
 
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
+
         // Hash challenge
         auto hash_vec = hash_message(challenge);
-        BIGNUM* e = BN_new();
+        BIGNUM* e = pool.acquire();
         BN_bin2bn(hash_vec.data(), hash_vec.size(), e);
         BN_mod(e, e, params.subgroup_order, ctx);
 
-        BIGNUM* sinv = BN_new();
-        BIGNUM* u1 = BN_new();
-        BIGNUM* u2 = BN_new();
-        BIGNUM* v1 = BN_new();
-        BIGNUM* v2 = BN_new();
-        BIGNUM* v = BN_new();
+        BIGNUM* sinv = pool.acquire();
+        BIGNUM* u1 = pool.acquire();
+        BIGNUM* u2 = pool.acquire();
+        BIGNUM* v1 = pool.acquire();
+        BIGNUM* v2 = pool.acquire();
+        BIGNUM* v = pool.acquire();
 
         // Compute s^-1 mod q
         BN_mod_inverse(sinv, sig.s, params.subgroup_order, ctx);
@@ -347,23 +921,47 @@ public:
         BN_mod_mul(u2, sig.r, sinv, params.subgroup_order, ctx);
 
         // Compute v = (g^u1 * y^u2 mod p) mod q
-        BN_mod_exp(v1, params.generator, u1, params.prime, ctx);
-        BN_mod_exp(v2, keypair.public_key, u2, params.prime, ctx);
+        BN_mod_exp_mont(v1, params.generator, u1, params.prime, ctx, prime_mont);
+        BN_mod_exp_mont(v2, keypair.public_key, u2, params.prime, ctx, prime_mont);
         BN_mod_mul(v, v1, v2, params.prime, ctx);
         BN_mod(v, v, params.subgroup_order, ctx);
 
         bool valid = (BN_cmp(v, sig.r) == 0);
 
-        BN_free(e);
-        BN_free(sinv);
-        BN_free(u1);
-        BN_free(u2);
-        BN_free(v1);
-        BN_free(v2);
-        BN_free(v);
+        pool.release(e);
+        pool.release(sinv);
+        pool.release(u1);
+        pool.release(u2);
+        pool.release(v1);
+        pool.release(v2);
+        pool.release(v);
 
         return valid;
     }
+
+    SigningNoncePool::Metrics nonce_pool_metrics() const {
+        return nonces->metrics();
+    }
+
+    /**
+     * Return a signature's values to the pool
+     */
+    void release_signature(Signature& sig) {
+        BignumPool& pool = BignumPool::local();
+        pool.release(sig.r);
+        pool.release(sig.s);
+        sig.r = sig.s = nullptr;
+    }
+
+    /**
+     * Return a key pair's values to the pool, clearing the private key
+     */
+    void release_keypair(KeyPair& keypair) {
+        BignumPool& pool = BignumPool::local();
+        pool.release(keypair.private_key);
+        pool.release(keypair.public_key);
+        keypair.private_key = keypair.public_key = nullptr;
+    }
 };
 
 /**
@@ -379,55 +977,328 @@ struct UserSession {
     std::vector<uint8_t> encrypted_token;
 };
 
+/**
+ * Per-thread session randomness from the OpenSSL CSPRNG
+ * RAND_bytes is called once per BATCH_SIZE bytes and ids are cut from the
+ * buffer, so a login costs a copy and a hex encode. A forked child discards
+ * the inherited buffer so parent and child never hand out the same ids.
+ */
+class SessionRandom {
+public:
+    static const size_t BATCH_SIZE = 4096;
+
+    static SessionRandom& local() {
+        static const int fork_handler = pthread_atfork(nullptr, nullptr, [] {
+            fork_generation.fetch_add(1, std::memory_order_relaxed);
+        });
+        (void)fork_handler;
+
+        thread_local SessionRandom random;
+        return random;
+    }
+
+    SessionRandom(const SessionRandom&) = delete;
+    SessionRandom& operator=(const SessionRandom&) = delete;
+
+    ~SessionRandom() {
+        OPENSSL_cleanse(buffer, sizeof(buffer));
+    }
+
+    void fill(uint8_t* out, size_t length) {
+        unsigned generation = fork_generation.load(std::memory_order_relaxed);
+        if (generation != buffer_generation) {
+            offset = BATCH_SIZE;
+            buffer_generation = generation;
+        }
+
+        while (length > 0) {
+            if (offset == BATCH_SIZE) {
+                refill();
+            }
+            size_t take = std::min(length, BATCH_SIZE - offset);
+            memcpy(out, buffer + offset, take);
+            OPENSSL_cleanse(buffer + offset, take);
+            offset += take;
+            out += take;
+            length -= take;
+        }
+    }
+
+    /**
+     * Lowercase hex of `bytes` random bytes
+     */
+    std::string hex(size_t bytes) {
+        static const char digits[] = "0123456789abcdef";
+        uint8_t raw[64];
+        std::string result(bytes * 2, '0');
+
+        for (size_t done = 0; done < bytes;) {
+            size_t chunk = std::min(bytes - done, sizeof(raw));
+            fill(raw, chunk);
+            for (size_t i = 0; i < chunk; i++) {
+                result[(done + i) * 2] = digits[raw[i] >> 4];
+                result[(done + i) * 2 + 1] = digits[raw[i] & 0x0F];
+            }
+            done += chunk;
+        }
+
+        return result;
+    }
+
+private:
+    static std::atomic<unsigned> fork_generation;
+
+    uint8_t buffer[BATCH_SIZE];
+    size_t offset = BATCH_SIZE;
+    unsigned buffer_generation = 0;
+
+    SessionRandom() : buffer_generation(fork_generation.load(std::memory_order_relaxed)) {}
+
+    void refill() {
+        if (RAND_bytes(buffer, BATCH_SIZE) != 1) {
+            throw std::runtime_error("CSPRNG failure while generating session randomness");
+        }
+        offset = 0;
+    }
+};
+
+std::atomic<unsigned> SessionRandom::fork_generation{0};
+
+/**
+ * Hashed timing wheel of session expiry times
+ * One-second slots indexed by expires_at; a full turn covers more than the
+ * session lifetime, and entries for a later turn stay in the slot until due
+ */
+class ExpiryWheel {
+public:
+    static const size_t SLOT_BITS = 12;
+    static const size_t SLOT_COUNT = size_t(1) << SLOT_BITS;
+
+    explicit ExpiryWheel(time_t now) : last_tick(now) {}
+
+    void schedule(const std::string& session_id, time_t expires_at) {
+        // Anything already due goes in the next slot the sweeper visits
+        time_t earliest = last_tick.load(std::memory_order_acquire) + 1;
+        Slot& slot = slot_for(std::max(expires_at, earliest));
+
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.entries.push_back({session_id, expires_at});
+    }
+
+    /**
+     * Visit the slots up to now and return the ids that are due
+     */
+    std::vector<std::string> advance(time_t now) {
+        std::lock_guard<std::mutex> advance_lock(advance_mutex);
+        std::vector<std::string> due;
+
+        time_t from = last_tick.load(std::memory_order_relaxed) + 1;
+        if (now - from >= static_cast<time_t>(SLOT_COUNT)) {
+            from = now - SLOT_COUNT + 1;
+        }
+
+        for (time_t tick = from; tick <= now; tick++) {
+            Slot& slot = slot_for(tick);
+            std::lock_guard<std::mutex> lock(slot.mutex);
+
+            auto keep = slot.entries.begin();
+            for (auto& entry : slot.entries) {
+                if (entry.expires_at <= now) {
+                    due.push_back(std::move(entry.session_id));
+                } else {
+                    // Until an entry is removed keep aliases entry, and a
+                    // string self-move would leave the id empty
+                    if (&*keep != &entry) {
+                        *keep = std::move(entry);
+                    }
+                    ++keep;
+                }
+            }
+            slot.entries.erase(keep, slot.entries.end());
+        }
+
+        if (now >= from) {
+            last_tick.store(now, std::memory_order_release);
+        }
+        return due;
+    }
+
+private:
+    struct Entry {
+        std::string session_id;
+        time_t expires_at;
+    };
+
+    struct alignas(64) Slot {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    Slot& slot_for(time_t tick) {
+        return slots[static_cast<size_t>(tick) & (SLOT_COUNT - 1)];
+    }
+
+    std::array<Slot, SLOT_COUNT> slots;
+    std::mutex advance_mutex;
+    std::atomic<time_t> last_tick;
+};
+
+/**
+ * Concurrent session store
+ * Sessions are sharded by id hash so logins on different sessions only
+ * contend when they share a shard. Expired sessions are invisible to
+ * lookups and are erased by sweep() as the expiry wheel reaches them.
+ */
+class SessionStore {
+public:
+    static const size_t SHARD_BITS = 6;
+    static const size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+
+    explicit SessionStore(time_t now) : expiry(now) {}
+
+    void insert(UserSession session) {
+        std::string session_id = session.session_id;
+        time_t expires_at = session.expires_at;
+
+        {
+            Shard& shard = shard_for(session_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto result = shard.sessions.insert_or_assign(session_id, std::move(session));
+            if (result.second) {
+                session_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        expiry.schedule(session_id, expires_at);
+    }
+
+    /**
+     * Runs fn on a live session while only its shard is locked
+     */
+    template <typename Fn>
+    bool with_session(const std::string& session_id, time_t now, Fn&& fn) {
+        Shard& shard = shard_for(session_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end() || it->second.expires_at <= now) {
+            return false;
+        }
+
+        fn(it->second);
+        return true;
+    }
+
+    /**
+     * Erase the sessions that have expired by now; returns how many
+     */
+    size_t sweep(time_t now) {
+        size_t erased = 0;
+
+        for (const std::string& session_id : expiry.advance(now)) {
+            Shard& shard = shard_for(session_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            // The id may since have been re-created with a later expiry
+            auto it = shard.sessions.find(session_id);
+            if (it != shard.sessions.end() && it->second.expires_at <= now) {
+                shard.sessions.erase(it);
+                session_count.fetch_sub(1, std::memory_order_relaxed);
+                erased++;
+            }
+        }
+
+        return erased;
+    }
+
+    size_t size() const {
+        return session_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, UserSession> sessions;
+    };
+
+    // Fibonacci hashing spreads the string hash evenly across shards
+    Shard& shard_for(const std::string& session_id) {
+        uint64_t hash = std::hash<std::string>{}(session_id);
+        return shards[(hash * 0x9E3779B97F4A7C15ULL) >> (64 - SHARD_BITS)];
+    }
+
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<size_t> session_count{0};
+    ExpiryWheel expiry;
+};
+
 /**
  * Enterprise Authentication Server
  */
 class EnterpriseAuthenticationServer {
 private:
+    static constexpr int SESSION_LIFETIME_SECONDS = 3600;
+    static constexpr int SWEEP_INTERVAL_SECONDS = 1;
+
     SessionTokenEncryptor* token_encryptor;
     AuthenticationSignatureEngine* sig_engine;
-    std::map<std::string, UserSession> active_sessions;
-    std::map<std::string, AuthenticationSignatureEngine::KeyPair> user_keys;
+    SessionStore active_sessions;
 
-    std::string generate_session_id() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, 255);
+    // Registration is rare and lookups are per login, so readers share the lock
+    std::shared_mutex user_keys_mutex;
+    std::unordered_map<std::string, AuthenticationSignatureEngine::KeyPair> user_keys;
 
-        std::stringstream ss;
-        for (int i = 0; i < 16; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << dis(gen);
-        }
-        return ss.str();
+    std::mutex sweeper_mutex;
+    std::condition_variable sweeper_wakeup;
+    bool stopping = false;
+    std::thread sweeper;
+
+    std::string generate_session_id() {
+        return SessionRandom::local().hex(16);
     }
 
     std::string generate_challenge() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, 255);
+        return "AUTH_CHALLENGE_" + std::to_string(time(nullptr)) + "_" +
+               SessionRandom::local().hex(4);
+    }
 
-        std::stringstream ss;
-        ss << "AUTH_CHALLENGE_" << time(nullptr) << "_";
-        for (int i = 0; i < 8; i++) {
-            ss << std::hex << dis(gen);
+    void run_sweeper() {
+        std::unique_lock<std::mutex> lock(sweeper_mutex);
+        while (!sweeper_wakeup.wait_for(lock, std::chrono::seconds(SWEEP_INTERVAL_SECONDS),
+                                        [this] { return stopping; })) {
+            lock.unlock();
+            active_sessions.sweep(time(nullptr));
+            lock.lock();
         }
-        return ss.str();
     }
 
 public:
-    EnterpriseAuthenticationServer(const uint8_t* session_key) {
+    /**
+     * domain_path optionally names a file that keeps the signature domain
+     * across restarts
+     */
+    explicit EnterpriseAuthenticationServer(const uint8_t* session_key,
+                                            const std::string& domain_path = "")
+        : active_sessions(time(nullptr)) {
+        sig_engine = new AuthenticationSignatureEngine(1024, domain_path);
         token_encryptor = new SessionTokenEncryptor(session_key);
-        sig_engine = new AuthenticationSignatureEngine(1024);
+        sweeper = std::thread(&EnterpriseAuthenticationServer::run_sweeper, this);
     }
 
     ~EnterpriseAuthenticationServer() {
-        delete token_encryptor;
-        delete sig_engine;
+        {
+            std::lock_guard<std::mutex> lock(sweeper_mutex);
+            stopping = true;
+        }
+        sweeper_wakeup.notify_one();
+        sweeper.join();
 
         for (auto& pair : user_keys) {
-            BN_free(pair.second.private_key);
-            BN_free(pair.second.public_key);
+            sig_engine->release_keypair(pair.second);
         }
+
+        delete token_encryptor;
+        delete sig_engine;
     }
 
     /**
@@ -438,12 +1309,18 @@ public:
 
         // Generate authentication keys
         auto keypair = sig_engine->generate_keypair();
-        user_keys[username] = keypair;
 
         char* pubkey_hex = BN_bn2hex(keypair.public_key);
         std::cout << "  Public key: " << std::string(pubkey_hex).substr(0, 20)
                   << "..." << std::endl;
         OPENSSL_free(pubkey_hex);
+
+        std::unique_lock<std::shared_mutex> lock(user_keys_mutex);
+        auto result = user_keys.try_emplace(username, keypair);
+        if (!result.second) {
+            sig_engine->release_keypair(result.first->second);
+            result.first->second = keypair;
+        }
     }
 
     /**
@@ -459,14 +1336,15 @@ public:
         session.username = username;
         session.ip_address = ip_address;
         session.created_at = time(nullptr);
-        session.expires_at = session.created_at + 3600; // 1 hour
+        session.expires_at = session.created_at + SESSION_LIFETIME_SECONDS;
         session.is_authenticated = false;
 
-        active_sessions[session.session_id] = session;
+        std::string session_id = session.session_id;
+        active_sessions.insert(std::move(session));
 
-        std::cout << "  Session ID: " << session.session_id << std::endl;
+        std::cout << "  Session ID: " << session_id << std::endl;
 
-        return session.session_id;
+        return session_id;
     }
 
     /**
@@ -474,27 +1352,39 @@ public:
      */
     bool complete_authentication(const std::string& session_id,
                                 const std::string& challenge_response) {
-        auto it = active_sessions.find(session_id);
-        if (it == active_sessions.end()) {
+        std::string username;
+        if (!active_sessions.with_session(session_id, time(nullptr),
+                                          [&](const UserSession& session) {
+                                              username = session.username;
+                                          })) {
             return false;
         }
 
-        UserSession& session = it->second;
+        // Sign and verify under the shared lock so re-registration cannot free the keys
+        bool valid;
+        {
+            std::shared_lock<std::shared_mutex> lock(user_keys_mutex);
+            auto key_it = user_keys.find(username);
+            if (key_it == user_keys.end()) {
+                return false;
+            }
 
-        // Find user keys
-        auto key_it = user_keys.find(session.username);
-        if (key_it == user_keys.end()) {
-            return false;
-        }
+            // Generate and sign challenge
+            std::string challenge = generate_challenge();
+            auto signature = sig_engine->sign_challenge(challenge, key_it->second);
 
-        // Generate and sign challenge
-        std::string challenge = generate_challenge();
-        auto signature = sig_engine->sign_challenge(challenge, key_it->second);
+            // Verify signature
+            valid = sig_engine->verify_signature(challenge, signature, key_it->second);
 
-        // Verify signature
-        bool valid = sig_engine->verify_signature(challenge, signature, key_it->second);
+            sig_engine->release_signature(signature);
+        }
 
-        if (valid) {
+        if (!valid) {
+            return false;
+        }
+
+        // The session may have expired while the signature was checked
+        return active_sessions.with_session(session_id, time(nullptr), [&](UserSession& session) {
             session.is_authenticated = true;
 
             // Create encrypted session token
@@ -508,25 +1398,20 @@ public:
             std::cout << "  Authentication successful" << std::endl;
             std::cout << "  Token encrypted: " << session.encrypted_token.size()
                       << " bytes" << std::endl;
-        }
-
-        BN_free(signature.r);
-        BN_free(signature.s);
-
-        return valid;
+        });
     }
 
     /**
      * Get session info
      */
     void print_session_info(const std::string& session_id) {
-        auto it = active_sessions.find(session_id);
-        if (it == active_sessions.end()) {
+        UserSession session;
+        if (!active_sessions.with_session(session_id, time(nullptr),
+                                          [&](const UserSession& live) { session = live; })) {
             std::cout << "Session not found" << std::endl;
             return;
         }
 
-        const UserSession& session = it->second;
         std::cout << "\nSession Information:" << std::endl;
         std::cout << "  Session ID: " << session.session_id << std::endl;
         std::cout << "  Username: " << session.username << std::endl;
@@ -536,21 +1421,58 @@ public:
         std::cout << "  Created: " << ctime(&session.created_at);
         std::cout << "  Expires: " << ctime(&session.expires_at);
     }
+
+    size_t active_session_count() const {
+        return active_sessions.size();
+    }
+
+    SigningNoncePool::Metrics nonce_pool_metrics() const {
+        return sig_engine->nonce_pool_metrics();
+    }
 };
 
 // Main demonstration
-int main() {
+/**
+ * Sessions due on a later turn of the wheel must keep their ids while the
+ * sweeper passes their slot, or sweep() can never erase them
+ */
+static bool session_expiry_self_test() {
+    SessionStore store(0);
+
+    for (int i = 0; i < 50; i++) {
+        UserSession session;
+        session.session_id = "expiry-test-" + std::to_string(i);
+        session.created_at = 0;
+        session.expires_at = 3500 + (i % 5) * 500;
+        session.is_authenticated = false;
+        store.insert(std::move(session));
+    }
+
+    // Passes the slot of the sessions due at 5500 before any are due
+    size_t early = store.sweep(3000);
+    size_t late = store.sweep(101000);
+    return early == 0 && late == 50 && store.size() == 0;
+}
+
+int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
     std::cout << "Enterprise SSO Authentication Server" << std::endl;
     std::cout << "========================================" << std::endl;
 
+    if (!session_expiry_self_test()) {
+        std::cout << "Session expiry self-test FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "Session expiry self-test: OK" << std::endl;
+
     // Initialize server
     uint8_t session_key[16];
     for (int i = 0; i < 16; i++) {
         session_key[i] = i * 0x11;
     }
 
-    EnterpriseAuthenticationServer auth_server(session_key);
+    // An optional domain file argument lets restarts skip prime generation
+    EnterpriseAuthenticationServer auth_server(session_key, argc > 1 ? argv[1] : "");
 
     // Register users
     std::cout << "\n--- User Registration ---" << std::endl;
@@ -573,6 +1495,16 @@ int main() {
     // Print session info
     auth_server.print_session_info(session_id);
 
+    // Signing nonce pool health
+    auto nonce_metrics = auth_server.nonce_pool_metrics();
+    std::cout << "\nSigning nonce pool:" << std::endl;
+    std::cout << "  Depth: " << nonce_metrics.depth << "/" << nonce_metrics.capacity << std::endl;
+    std::cout << "  Produced: " << nonce_metrics.produced
+              << ", consumed: " << nonce_metrics.consumed
+              << ", misses: " << nonce_metrics.misses << std::endl;
+    std::cout << "  Refill rate: " << static_cast<uint64_t>(nonce_metrics.refill_rate)
+              << " nonces/s" << std::endl;
+
     std::cout << "\n========================================" << std::endl;
     std::cout << "Authentication flow completed" << std::endl;
     std::cout << "========================================" << std::endl;
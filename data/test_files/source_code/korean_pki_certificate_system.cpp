@@ -10,11 +10,91 @@
 #include <cstring>
 #include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <string>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <openssl/bn.h>
 #include <openssl/sha.h>
 
+/**
+ * Thread-local pool of BIGNUMs plus one reusable BN_CTX per thread
+ * Released values are cleared and kept for reuse. Fresh ones are
+ * pre-expanded to the widest value this thread has released, so once a
+ * domain's sizes are seen its temporaries stop touching the heap
+ */
+class BignumPool {
+public:
+    static BignumPool& local() {
+        thread_local BignumPool pool;
+        return pool;
+    }
+
+    BignumPool(const BignumPool&) = delete;
+    BignumPool& operator=(const BignumPool&) = delete;
+
+    BIGNUM* acquire() {
+        if (!freeList.empty()) {
+            BIGNUM* bn = freeList.back();
+            freeList.pop_back();
+            return bn;
+        }
+
+        BIGNUM* bn = BN_new();
+        if (capacityBits > 0) {
+            BN_set_bit(bn, capacityBits - 1);
+            BN_zero(bn);
+        }
+        return bn;
+    }
+
+    void release(BIGNUM* bn) {
+        if (bn == nullptr) {
+            return;
+        }
+
+        capacityBits = std::max(capacityBits, BN_num_bits(bn));
+        if (freeList.size() < MAX_POOLED) {
+            BN_clear(bn);
+            freeList.push_back(bn);
+        } else {
+            BN_clear_free(bn);
+        }
+    }
+
+    BN_CTX* context() { return ctx; }
+
+private:
+    static const size_t MAX_POOLED = 256;
+
+    std::vector<BIGNUM*> freeList;
+    BN_CTX* ctx;
+    int capacityBits = 0;
+
+    BignumPool() : ctx(BN_CTX_new()) {
+        freeList.reserve(MAX_POOLED);
+    }
+
+    ~BignumPool() {
+        for (BIGNUM* bn : freeList) {
+            BN_free(bn);
+        }
+        BN_CTX_free(ctx);
+    }
+};
+
 /**
  * Large integer arithmetic wrapper for cryptographic operations
+ * Storage comes from the current thread's BignumPool
  */
 class BigInteger {
 private:
@@ -22,26 +102,26 @@ private:
 
 public:
     BigInteger() {
-        value = BN_new();
+        value = BignumPool::local().acquire();
     }
 
     BigInteger(const BigInteger& other) {
-        value = BN_new();
+        value = BignumPool::local().acquire();
         BN_copy(value, other.value);
     }
 
     explicit BigInteger(const std::string& hex) {
-        value = BN_new();
+        value = BignumPool::local().acquire();
         BN_hex2bn(&value, hex.c_str());
     }
 
     explicit BigInteger(unsigned long num) {
-        value = BN_new();
+        value = BignumPool::local().acquire();
         BN_set_word(value, num);
     }
 
     ~BigInteger() {
-        BN_free(value);
+        BignumPool::local().release(value);
     }
 
     BIGNUM* get() const { return value; }
@@ -61,6 +141,226 @@ public:
     }
 };
 
+/**
+ * Compact binary encoding for domain parameters and key pairs
+ * Layout: 4-byte magic "KPKI", u16 version, u16 record type, u32 security
+ * bits, then each integer as a u32 byte length and its big-endian bytes
+ */
+class StateWriter {
+public:
+    static constexpr uint8_t MAGIC[4] = {'K', 'P', 'K', 'I'};
+    static constexpr uint16_t VERSION = 1;
+
+    StateWriter(uint16_t recordType, int securityBits) {
+        bytes.insert(bytes.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        putU16(VERSION);
+        putU16(recordType);
+        putU32(static_cast<uint32_t>(securityBits));
+    }
+
+    void put(const BIGNUM* value) {
+        size_t length = BN_num_bytes(value);
+        putU32(static_cast<uint32_t>(length));
+        bytes.resize(bytes.size() + length);
+        BN_bn2bin(value, bytes.data() + bytes.size() - length);
+    }
+
+    std::vector<uint8_t> take() { return std::move(bytes); }
+
+private:
+    std::vector<uint8_t> bytes;
+
+    void putU16(uint16_t value) {
+        bytes.push_back(static_cast<uint8_t>(value >> 8));
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void putU32(uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            bytes.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+};
+
+/**
+ * Bounds-checked reader for StateWriter output
+ * Throws std::runtime_error on malformed input or a security level other
+ * than the one the caller expects
+ */
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t length, uint16_t expectedType, int expectedBits)
+        : cursor(data), end(data + length) {
+        if (length < sizeof(StateWriter::MAGIC) ||
+            std::memcmp(data, StateWriter::MAGIC, sizeof(StateWriter::MAGIC)) != 0) {
+            throw std::runtime_error("Not a PKI state record");
+        }
+        cursor += sizeof(StateWriter::MAGIC);
+
+        if (getU16() != StateWriter::VERSION) {
+            throw std::runtime_error("Unsupported PKI state version");
+        }
+        if (getU16() != expectedType) {
+            throw std::runtime_error("Unexpected PKI state record type");
+        }
+        bits = static_cast<int>(getU32());
+        if (bits != expectedBits) {
+            throw std::runtime_error("PKI state was generated for " + std::to_string(bits) +
+                                     "-bit security, not " + std::to_string(expectedBits));
+        }
+    }
+
+    int securityBits() const { return bits; }
+
+    void get(BIGNUM* out) {
+        uint32_t length = getU32();
+        requireBytes(length);
+        BN_bin2bn(cursor, static_cast<int>(length), out);
+        cursor += length;
+    }
+
+    void finish() const {
+        if (cursor != end) {
+            throw std::runtime_error("Trailing bytes in PKI state record");
+        }
+    }
+
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+    int bits = 0;
+
+    uint16_t getU16() {
+        requireBytes(2);
+        uint16_t value = static_cast<uint16_t>((cursor[0] << 8) | cursor[1]);
+        cursor += 2;
+        return value;
+    }
+
+    uint32_t getU32() {
+        requireBytes(4);
+        uint32_t value = (uint32_t(cursor[0]) << 24) | (uint32_t(cursor[1]) << 16) |
+                         (uint32_t(cursor[2]) << 8) | cursor[3];
+        cursor += 4;
+        return value;
+    }
+
+    void requireBytes(size_t count) const {
+        if (static_cast<size_t>(end - cursor) < count) {
+            throw std::runtime_error("Truncated PKI state record");
+        }
+    }
+};
+
+/**
+ * State files: mapped read-only on load, installed with first-writer-wins
+ * semantics so processes starting together agree on one set of parameters
+ */
+class StateFile {
+public:
+    class Mapping {
+    public:
+        Mapping(const uint8_t* bytes, size_t length) : bytes(bytes), length(length) {}
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        ~Mapping() {
+            munmap(const_cast<uint8_t*>(bytes), length);
+        }
+
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const uint8_t* bytes;
+        size_t length;
+    };
+
+    /**
+     * Map path read-only; nullptr when the file does not exist
+     */
+    static std::unique_ptr<Mapping> map(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) {
+                return nullptr;
+            }
+            throw std::runtime_error("Cannot open state file: " + path);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            throw std::runtime_error("Cannot read state file: " + path);
+        }
+
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map state file: " + path);
+        }
+
+        return std::make_unique<Mapping>(static_cast<const uint8_t*>(mapped),
+                                         static_cast<size_t>(st.st_size));
+    }
+
+    /**
+     * Write bytes to a private temporary and link it into place
+     * Returns false if another process installed path first
+     */
+    static bool installIfAbsent(const std::string& path, const std::vector<uint8_t>& bytes) {
+        std::string temporary = path + ".tmp." + std::to_string(getpid());
+        int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create state file: " + temporary);
+        }
+
+        size_t written = 0;
+        while (written < bytes.size()) {
+            ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+
+        bool durable = written == bytes.size() && fsync(fd) == 0;
+        durable = close(fd) == 0 && durable;
+        int linked = durable ? link(temporary.c_str(), path.c_str()) : -1;
+        int linkError = errno;
+        unlink(temporary.c_str());
+
+        if (linked == 0) {
+            return true;
+        }
+        if (durable && linkError == EEXIST) {
+            return false;
+        }
+        throw std::runtime_error("Cannot install state file: " + path);
+    }
+
+    /**
+     * Record::deserialize from path, or generate, install and return a new
+     * record when path does not exist yet
+     */
+    template <typename Record, typename Generate>
+    static Record loadOrGenerate(const std::string& path, int securityBits, Generate generate) {
+        for (;;) {
+            if (auto mapping = map(path)) {
+                return Record::deserialize(mapping->data(), mapping->size(), securityBits);
+            }
+
+            Record record = generate();
+            if (installIfAbsent(path, record.serialize())) {
+                return record;
+            }
+        }
+    }
+};
+
 /**
  * Discrete Logarithm Domain Parameters
  * Defines the mathematical group for signature operations
@@ -70,22 +370,101 @@ public:
     BigInteger prime;        // Large prime p
     BigInteger generator;    // Generator g of order q
     BigInteger subgroupOrder; // Prime order q
+    int securityBits = 0;     // Size requested from generate()
+
+    static const uint16_t RECORD_TYPE = 1;
 
     DomainParameters() = default;
 
+    void encode(StateWriter& writer) const {
+        writer.put(prime.get());
+        writer.put(generator.get());
+        writer.put(subgroupOrder.get());
+    }
+
+    /**
+     * Read and validate parameters written by encode()
+     */
+    static DomainParameters decode(StateReader& reader) {
+        DomainParameters params;
+        params.securityBits = reader.securityBits();
+        reader.get(params.prime.get());
+        reader.get(params.generator.get());
+        reader.get(params.subgroupOrder.get());
+        params.validate();
+        return params;
+    }
+
+    std::vector<uint8_t> serialize() const {
+        StateWriter writer(RECORD_TYPE, securityBits);
+        encode(writer);
+        return writer.take();
+    }
+
+    static DomainParameters deserialize(const uint8_t* data, size_t length, int expectedBits) {
+        StateReader reader(data, length, RECORD_TYPE, expectedBits);
+        DomainParameters params = decode(reader);
+        reader.finish();
+        return params;
+    }
+
+    /**
+     * Map parameters from path, or generate and save them there on first start
+     */
+    static DomainParameters loadOrGenerate(const std::string& path, int primeBits) {
+        return StateFile::loadOrGenerate<DomainParameters>(
+            path, primeBits, [primeBits] { return generate(primeBits); });
+    }
+
+    /**
+     * Reject parameters that do not describe a prime-order subgroup of Z_p*
+     */
+    void validate() const {
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
+        BIGNUM* t = pool.acquire();
+
+        bool valid = BN_check_prime(prime.get(), ctx, nullptr) == 1 &&
+                     BN_check_prime(subgroupOrder.get(), ctx, nullptr) == 1;
+
+        // q | p - 1
+        if (valid) {
+            BN_sub(t, prime.get(), BN_value_one());
+            BN_mod(t, t, subgroupOrder.get(), ctx);
+            valid = BN_is_zero(t);
+        }
+
+        // 1 < g < p and g^q = 1 mod p
+        if (valid) {
+            valid = BN_cmp(generator.get(), BN_value_one()) > 0 &&
+                    BN_cmp(generator.get(), prime.get()) < 0;
+        }
+        if (valid) {
+            BN_mod_exp(t, generator.get(), subgroupOrder.get(), prime.get(), ctx);
+            valid = BN_is_one(t);
+        }
+
+        pool.release(t);
+        if (!valid) {
+            throw std::runtime_error("Invalid domain parameters in PKI state");
+        }
+    }
+
     /**
      * Generate secure domain parameters for signature system
      */
     static DomainParameters generate(int primeBits) {
         DomainParameters params;
-        BN_CTX* ctx = BN_CTX_new();
+        params.securityBits = primeBits;
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
 
         // Generate prime p and subgroup order q
         // For production: p-1 = 2q for prime q
-        BIGNUM* p = BN_new();
-        BIGNUM* q = BN_new();
-        BIGNUM* one = BN_new();
-        BIGNUM* two = BN_new();
+        BIGNUM* p = pool.acquire();
+        BIGNUM* q = pool.acquire();
+        BIGNUM* one = pool.acquire();
+        BIGNUM* two = pool.acquire();
 
         BN_set_word(one, 1);
         BN_set_word(two, 2);
@@ -108,9 +487,9 @@ public:
         BN_copy(params.subgroupOrder.get(), q);
 
         // Find generator g of order q
-        BIGNUM* g = BN_new();
-        BIGNUM* exp = BN_new();
-        BIGNUM* pm1 = BN_new();
+        BIGNUM* g = pool.acquire();
+        BIGNUM* exp = pool.acquire();
+        BIGNUM* pm1 = pool.acquire();
 
         BN_sub(pm1, p, one);
         BN_div(exp, nullptr, pm1, q, ctx);
@@ -124,14 +503,13 @@ public:
 
         BN_copy(params.generator.get(), g);
 
-        BN_free(p);
-        BN_free(q);
-        BN_free(g);
-        BN_free(exp);
-        BN_free(pm1);
-        BN_free(one);
-        BN_free(two);
-        BN_CTX_free(ctx);
+        pool.release(p);
+        pool.release(q);
+        pool.release(g);
+        pool.release(exp);
+        pool.release(pm1);
+        pool.release(one);
+        pool.release(two);
 
         return params;
     }
@@ -146,8 +524,55 @@ public:
     BigInteger publicKey;   // Public key y = g^x mod p
     DomainParameters params;
 
+    static const uint16_t RECORD_TYPE = 2;
+
     SignatureKeyPair() = default;
 
+    /**
+     * Domain parameters followed by x and y; the file holds the private key
+     */
+    std::vector<uint8_t> serialize() const {
+        StateWriter writer(RECORD_TYPE, params.securityBits);
+        params.encode(writer);
+        writer.put(privateKey.get());
+        writer.put(publicKey.get());
+        return writer.take();
+    }
+
+    static SignatureKeyPair deserialize(const uint8_t* data, size_t length, int expectedBits) {
+        StateReader reader(data, length, RECORD_TYPE, expectedBits);
+        SignatureKeyPair keyPair;
+        keyPair.params = DomainParameters::decode(reader);
+        reader.get(keyPair.privateKey.get());
+        reader.get(keyPair.publicKey.get());
+        reader.finish();
+
+        // 0 < x < q and y = g^x mod p
+        BignumPool& pool = BignumPool::local();
+        BIGNUM* y = pool.acquire();
+        BN_mod_exp(y, keyPair.params.generator.get(), keyPair.privateKey.get(),
+                   keyPair.params.prime.get(), pool.context());
+        bool valid = !BN_is_zero(keyPair.privateKey.get()) &&
+                     BN_cmp(keyPair.privateKey.get(), keyPair.params.subgroupOrder.get()) < 0 &&
+                     BN_cmp(y, keyPair.publicKey.get()) == 0;
+        pool.release(y);
+
+        if (!valid) {
+            throw std::runtime_error("Key pair in PKI state does not match its domain");
+        }
+        return keyPair;
+    }
+
+    /**
+     * Map a key pair (with its domain) from path, or generate both and
+     * save them there on first start
+     */
+    static SignatureKeyPair loadOrGenerate(const std::string& path, int primeBits) {
+        return StateFile::loadOrGenerate<SignatureKeyPair>(path, primeBits, [primeBits] {
+            return generate(DomainParameters::generate(primeBits));
+        });
+    }
+
     /**
      * Generate new key pair
      */
@@ -155,26 +580,26 @@ public:
         SignatureKeyPair keyPair;
         keyPair.params = domainParams;
 
-        BN_CTX* ctx = BN_CTX_new();
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
 
         // Generate random private key x in [1, q-1]
-        BIGNUM* x = BN_new();
+        BIGNUM* x = pool.acquire();
         BN_rand_range(x, domainParams.subgroupOrder.get());
         if (BN_is_zero(x)) {
             BN_set_word(x, 1);
         }
 
         // Compute public key y = g^x mod p
-        BIGNUM* y = BN_new();
+        BIGNUM* y = pool.acquire();
         BN_mod_exp(y, domainParams.generator.get(), x,
                   domainParams.prime.get(), ctx);
 
         BN_copy(keyPair.privateKey.get(), x);
         BN_copy(keyPair.publicKey.get(), y);
 
-        BN_free(x);
-        BN_free(y);
-        BN_CTX_free(ctx);
+        pool.release(x);
+        pool.release(y);
 
         return keyPair;
     }
@@ -198,18 +623,106 @@ public:
     }
 };
 
+/**
+ * Per-item outcome of batch verification
+ */
+enum class VerificationResult {
+    Valid,
+    Invalid,      // Signature does not match the message
+    OutOfRange    // r or s outside [1, q-1]
+};
+
+/**
+ * Fixed-base exponent table in Montgomery form
+ * entry(i, d) = base^(d * 2^(WINDOW_BITS * i)) mod p, so base^u is one
+ * multiplication per nonzero window of u and no squarings
+ */
+class ExponentTable {
+public:
+    static const int WINDOW_BITS = 4;
+    static const int DIGITS = (1 << WINDOW_BITS) - 1;
+
+    ExponentTable(const BIGNUM* base, int exponentBits,
+                  const BIGNUM* modulus, BN_MONT_CTX* mont, BN_CTX* ctx)
+        : windows((exponentBits + WINDOW_BITS - 1) / WINDOW_BITS),
+          entries(static_cast<size_t>(windows) * DIGITS) {
+        BigInteger step;
+        BN_nnmod(step.get(), base, modulus, ctx);
+        BN_to_montgomery(step.get(), step.get(), mont, ctx);
+
+        for (int i = 0; i < windows; ++i) {
+            BN_copy(entry(i, 1), step.get());
+            for (int d = 2; d <= DIGITS; ++d) {
+                BN_mod_mul_montgomery(entry(i, d), entry(i, d - 1), step.get(), mont, ctx);
+            }
+            BN_mod_mul_montgomery(step.get(), entry(i, DIGITS), step.get(), mont, ctx);
+        }
+    }
+
+    int windowCount() const { return windows; }
+
+    const BIGNUM* entry(int window, int digit) const {
+        return entries[static_cast<size_t>(window) * DIGITS + digit - 1].get();
+    }
+
+    /**
+     * acc = acc * base^exponent in Montgomery form, exponent below 2^(WINDOW_BITS * windows)
+     */
+    void multiplyPower(BIGNUM* acc, const BIGNUM* exponent,
+                       BN_MONT_CTX* mont, BN_CTX* ctx) const {
+        for (int i = 0; i < windows; ++i) {
+            int digit = 0;
+            for (int b = WINDOW_BITS - 1; b >= 0; --b) {
+                digit = (digit << 1) | BN_is_bit_set(exponent, i * WINDOW_BITS + b);
+            }
+            if (digit != 0) {
+                BN_mod_mul_montgomery(acc, acc, entry(i, digit), mont, ctx);
+            }
+        }
+    }
+
+private:
+    int windows;
+    std::vector<BigInteger> entries;
+
+    BIGNUM* entry(int window, int digit) {
+        return entries[static_cast<size_t>(window) * DIGITS + digit - 1].get();
+    }
+};
+
 /**
  * Certificate Authority Signature Engine
  * Implements discrete logarithm based signature scheme
  */
 class CertificateSignatureEngine {
 private:
+    static const size_t MIN_ITEMS_PER_THREAD = 16;
+
     DomainParameters params;
 
+    // Montgomery context for p, shared by every exponentiation in the domain
+    BN_MONT_CTX* primeMont;
+
+    // Batch verification tables, built on the first verifyBatch call and
+    // read-only once published
+    std::once_flag domainSetup;
+    std::unique_ptr<const ExponentTable> generatorTable;
+
+    std::mutex publicKeyTableMutex;
+    BigInteger tablePublicKey;
+    std::shared_ptr<const ExponentTable> publicKeyTable;
+
     /**
      * Hash message to integer in range [0, q-1]
      */
     BigInteger hashMessage(const std::vector<uint8_t>& message) const {
+        return hashMessage(message, BignumPool::local().context());
+    }
+
+    /**
+     * Hash message to integer in range [0, q-1] using the caller's context
+     */
+    BigInteger hashMessage(const std::vector<uint8_t>& message, BN_CTX* ctx) const {
         // Compute SHA-256 hash
         uint8_t hash[SHA256_DIGEST_LENGTH];
         SHA256_CTX sha256;
@@ -218,17 +731,11 @@ private:
         SHA256_Final(hash, &sha256);
 
         // Convert hash to BigInteger
-        BIGNUM* h = BN_new();
-        BN_bin2bn(hash, SHA256_DIGEST_LENGTH, h);
+        BigInteger result;
+        BN_bin2bn(hash, SHA256_DIGEST_LENGTH, result.get());
 
         // Reduce modulo q
-        BN_CTX* ctx = BN_CTX_new();
-        BN_mod(h, h, params.subgroupOrder.get(), ctx);
-        BN_CTX_free(ctx);
-
-        BigInteger result;
-        BN_copy(result.get(), h);
-        BN_free(h);
+        BN_mod(result.get(), result.get(), params.subgroupOrder.get(), ctx);
 
         return result;
     }
@@ -237,22 +744,92 @@ private:
      * Generate random k in [1, q-1]
      */
     BigInteger generateRandomK() const {
-        BIGNUM* k = BN_new();
-        BN_rand_range(k, params.subgroupOrder.get());
-        if (BN_is_zero(k)) {
-            BN_set_word(k, 1);
-        }
-
         BigInteger result;
-        BN_copy(result.get(), k);
-        BN_free(k);
+        BN_rand_range(result.get(), params.subgroupOrder.get());
+        if (BN_is_zero(result.get())) {
+            BN_set_word(result.get(), 1);
+        }
 
         return result;
     }
 
+    void setupDomain() {
+        generatorTable = std::make_unique<const ExponentTable>(
+            params.generator.get(), BN_num_bits(params.subgroupOrder.get()),
+            params.prime.get(), primeMont, BignumPool::local().context());
+    }
+
+    /**
+     * Table for the given public key, rebuilt only when the key changes
+     */
+    std::shared_ptr<const ExponentTable> tableForKey(const BigInteger& publicKey) {
+        std::lock_guard<std::mutex> lock(publicKeyTableMutex);
+
+        if (!publicKeyTable || BN_cmp(tablePublicKey.get(), publicKey.get()) != 0) {
+            BN_CTX* ctx = BignumPool::local().context();
+            publicKeyTable = std::make_shared<const ExponentTable>(
+                publicKey.get(), BN_num_bits(params.subgroupOrder.get()),
+                params.prime.get(), primeMont, ctx);
+            tablePublicKey = publicKey;
+        }
+
+        return publicKeyTable;
+    }
+
+    /**
+     * Verify one batch item with the precomputed tables and the worker's context
+     */
+    VerificationResult verifyWithTables(const std::vector<uint8_t>& message,
+                                        const DigitalSignature& signature,
+                                        const ExponentTable& keyTable,
+                                        BN_CTX* ctx) const {
+        const BIGNUM* q = params.subgroupOrder.get();
+
+        // Check 0 < r < q and 0 < s < q
+        if (BN_is_zero(signature.r.get()) || BN_cmp(signature.r.get(), q) >= 0 ||
+            BN_is_zero(signature.s.get()) || BN_cmp(signature.s.get(), q) >= 0) {
+            return VerificationResult::OutOfRange;
+        }
+
+        BigInteger e = hashMessage(message, ctx);
+
+        BN_CTX_start(ctx);
+        BIGNUM* sinv = BN_CTX_get(ctx);
+        BIGNUM* u1 = BN_CTX_get(ctx);
+        BIGNUM* u2 = BN_CTX_get(ctx);
+        BIGNUM* v = BN_CTX_get(ctx);
+
+        // u1 = e * s^-1 mod q, u2 = r * s^-1 mod q
+        BN_mod_inverse(sinv, signature.s.get(), q, ctx);
+        BN_mod_mul(u1, e.get(), sinv, q, ctx);
+        BN_mod_mul(u2, signature.r.get(), sinv, q, ctx);
+
+        // v = (g^u1 * y^u2 mod p) mod q, accumulated from 1 in Montgomery form
+        BN_one(v);
+        BN_to_montgomery(v, v, primeMont, ctx);
+        generatorTable->multiplyPower(v, u1, primeMont, ctx);
+        keyTable.multiplyPower(v, u2, primeMont, ctx);
+        BN_from_montgomery(v, v, primeMont, ctx);
+        BN_mod(v, v, q, ctx);
+
+        bool valid = (BN_cmp(v, signature.r.get()) == 0);
+        BN_CTX_end(ctx);
+
+        return valid ? VerificationResult::Valid : VerificationResult::Invalid;
+    }
+
 public:
     CertificateSignatureEngine(const DomainParameters& domainParams)
-        : params(domainParams) {}
+        : params(domainParams), primeMont(BN_MONT_CTX_new()) {
+        BN_MONT_CTX_set(primeMont, params.prime.get(), BignumPool::local().context());
+    }
+
+    CertificateSignatureEngine(const CertificateSignatureEngine&) = delete;
+    CertificateSignatureEngine& operator=(const CertificateSignatureEngine&) = delete;
+
+    ~CertificateSignatureEngine() {
+        BN_MONT_CTX_free(primeMont);
+    }
 
     /**
      * Sign message using private key
@@ -260,16 +837,17 @@ public:
      */
     DigitalSignature signMessage(const std::vector<uint8_t>& message,
                                 const SignatureKeyPair& keyPair) {
-        BN_CTX* ctx = BN_CTX_new();
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
 
         // Hash message: e = H(M)
         BigInteger e = hashMessage(message);
 
-        BIGNUM* r = BN_new();
-        BIGNUM* s = BN_new();
-        BIGNUM* k = BN_new();
-        BIGNUM* kinv = BN_new();
-        BIGNUM* temp = BN_new();
+        BIGNUM* r = pool.acquire();
+        BIGNUM* s = pool.acquire();
+        BIGNUM* k = pool.acquire();
+        BIGNUM* kinv = pool.acquire();
+        BIGNUM* temp = pool.acquire();
 
         do {
             // Generate random k
@@ -277,8 +855,8 @@ public:
             BN_copy(k, kBig.get());
 
             // Compute r = (g^k mod p) mod q
-            BN_mod_exp(temp, params.generator.get(), k,
-                      params.prime.get(), ctx);
+            BN_mod_exp_mont(temp, params.generator.get(), k,
+                            params.prime.get(), ctx, primeMont);
             BN_mod(r, temp, params.subgroupOrder.get(), ctx);
 
             if (BN_is_zero(r)) continue;
@@ -301,12 +879,11 @@ public:
         BN_copy(signature.r.get(), r);
         BN_copy(signature.s.get(), s);
 
-        BN_free(r);
-        BN_free(s);
-        BN_free(k);
-        BN_free(kinv);
-        BN_free(temp);
-        BN_CTX_free(ctx);
+        pool.release(r);
+        pool.release(s);
+        pool.release(k);
+        pool.release(kinv);
+        pool.release(temp);
 
         return signature;
     }
@@ -317,26 +894,26 @@ public:
     bool verifySignature(const std::vector<uint8_t>& message,
                         const DigitalSignature& signature,
                         const SignatureKeyPair& keyPair) {
-        BN_CTX* ctx = BN_CTX_new();
+        BignumPool& pool = BignumPool::local();
+        BN_CTX* ctx = pool.context();
 
         // Check 0 < r < q and 0 < s < q
         if (BN_is_zero(signature.r.get()) ||
             BN_cmp(signature.r.get(), params.subgroupOrder.get()) >= 0 ||
             BN_is_zero(signature.s.get()) ||
             BN_cmp(signature.s.get(), params.subgroupOrder.get()) >= 0) {
-            BN_CTX_free(ctx);
             return false;
         }
 
         // Hash message: e = H(M)
         BigInteger e = hashMessage(message);
 
-        BIGNUM* sinv = BN_new();
-        BIGNUM* u1 = BN_new();
-        BIGNUM* u2 = BN_new();
-        BIGNUM* v1 = BN_new();
-        BIGNUM* v2 = BN_new();
-        BIGNUM* v = BN_new();
+        BIGNUM* sinv = pool.acquire();
+        BIGNUM* u1 = pool.acquire();
+        BIGNUM* u2 = pool.acquire();
+        BIGNUM* v1 = pool.acquire();
+        BIGNUM* v2 = pool.acquire();
+        BIGNUM* v = pool.acquire();
 
         // Compute s^-1 mod q
         BN_mod_inverse(sinv, signature.s.get(),
@@ -351,12 +928,12 @@ public:
                   params.subgroupOrder.get(), ctx);
 
         // Compute v1 = g^u1 mod p
-        BN_mod_exp(v1, params.generator.get(), u1,
-                  params.prime.get(), ctx);
+        BN_mod_exp_mont(v1, params.generator.get(), u1,
+                        params.prime.get(), ctx, primeMont);
 
         // Compute v2 = y^u2 mod p
-        BN_mod_exp(v2, keyPair.publicKey.get(), u2,
-                  params.prime.get(), ctx);
+        BN_mod_exp_mont(v2, keyPair.publicKey.get(), u2,
+                        params.prime.get(), ctx, primeMont);
 
         // Compute v = (v1 * v2 mod p) mod q
         BN_mod_mul(v, v1, v2, params.prime.get(), ctx);
@@ -365,16 +942,69 @@ public:
         // Verify v == r
         bool valid = (BN_cmp(v, signature.r.get()) == 0);
 
-        BN_free(sinv);
-        BN_free(u1);
-        BN_free(u2);
-        BN_free(v1);
-        BN_free(v2);
-        BN_free(v);
-        BN_CTX_free(ctx);
+        pool.release(sinv);
+        pool.release(u1);
+        pool.release(u2);
+        pool.release(v1);
+        pool.release(v2);
+        pool.release(v);
 
         return valid;
     }
+
+    /**
+     * Verify many signatures made with one key pair
+     * Reuses the domain's Montgomery context and fixed-base tables for g
+     * and the public key, gives each worker thread one BN_CTX, and returns
+     * one result per message in input order
+     */
+    std::vector<VerificationResult> verifyBatch(
+        const std::vector<std::vector<uint8_t>>& messages,
+        const std::vector<DigitalSignature>& signatures,
+        const SignatureKeyPair& keyPair) {
+
+        if (messages.size() != signatures.size()) {
+            throw std::invalid_argument("verifyBatch: messages and signatures differ in count");
+        }
+
+        std::vector<VerificationResult> results(messages.size(), VerificationResult::Invalid);
+        if (messages.empty()) {
+            return results;
+        }
+
+        std::call_once(domainSetup, [this] { setupDomain(); });
+        std::shared_ptr<const ExponentTable> keyTable = tableForKey(keyPair.publicKey);
+
+        std::atomic<size_t> nextItem{0};
+        auto worker = [&]() {
+            BN_CTX* ctx = BignumPool::local().context();
+            for (size_t i = nextItem.fetch_add(1); i < messages.size();
+                 i = nextItem.fetch_add(1)) {
+                results[i] = verifyWithTables(messages[i], signatures[i], *keyTable, ctx);
+            }
+        };
+
+        size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount,
+                               (messages.size() + MIN_ITEMS_PER_THREAD - 1) / MIN_ITEMS_PER_THREAD);
+
+        // The calling thread works too; if threads cannot be created it
+        // finishes the batch with whatever workers did start
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < threadCount; ++t) {
+            try {
+                threads.emplace_back(worker);
+            } catch (const std::system_error&) {
+                break;
+            }
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        return results;
+    }
 };
 
 /**
@@ -382,17 +1012,31 @@ public:
  */
 class CertificateAuthorityService {
 private:
-    DomainParameters params;
     SignatureKeyPair caKeyPair;
+    DomainParameters params;
     CertificateSignatureEngine engine;
 
+    static SignatureKeyPair createKeyPair(int securityBits, const std::string& statePath) {
+        if (statePath.empty()) {
+            return SignatureKeyPair::generate(DomainParameters::generate(securityBits));
+        }
+        return SignatureKeyPair::loadOrGenerate(statePath, securityBits);
+    }
+
 public:
-    CertificateAuthorityService(int securityBits)
-        : params(DomainParameters::generate(securityBits)),
-          caKeyPair(SignatureKeyPair::generate(params)),
+    /**
+     * With a statePath the domain and CA key are mapped from that file, and
+     * generated and saved there only on the first start
+     */
+    explicit CertificateAuthorityService(int securityBits, const std::string& statePath = "")
+        : caKeyPair(createKeyPair(securityBits, statePath)),
+          params(caKeyPair.params),
           engine(params) {
         std::cout << "Certificate Authority initialized" << std::endl;
         std::cout << "Security level: " << securityBits << " bits" << std::endl;
+        if (!statePath.empty()) {
+            std::cout << "State file: " << statePath << std::endl;
+        }
     }
 
     /**
@@ -424,6 +1068,28 @@ public:
         return valid;
     }
 
+    /**
+     * Verify a bundle of certificate signatures, e.g. a CRL or chain set
+     */
+    std::vector<VerificationResult> verifyCertificateBatch(
+        const std::vector<std::string>& certData,
+        const std::vector<DigitalSignature>& signatures) {
+        std::vector<std::vector<uint8_t>> messages;
+        messages.reserve(certData.size());
+        for (const auto& cert : certData) {
+            messages.emplace_back(cert.begin(), cert.end());
+        }
+
+        auto results = engine.verifyBatch(messages, signatures, caKeyPair);
+
+        size_t validCount = std::count(results.begin(), results.end(),
+                                       VerificationResult::Valid);
+        std::cout << "Batch verification: " << validCount << " of "
+                  << results.size() << " VALID" << std::endl;
+
+        return results;
+    }
+
     /**
      * Issue user key pair
      */
@@ -456,13 +1122,14 @@ struct Certificate {
 };
 
 // Example usage and testing
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "=== PKI Certificate Authority System ===" << std::endl;
     std::cout << "Discrete Logarithm Signature Scheme" << std::endl;
     std::cout << "========================================\n" << std::endl;
 
-    // Initialize Certificate Authority with 1024-bit security
-    CertificateAuthorityService ca(1024);
+    // Initialize Certificate Authority with 1024-bit security; an optional
+    // state file argument lets restarts reuse the domain and CA key
+    CertificateAuthorityService ca(1024, argc > 1 ? argv[1] : "");
 
     std::cout << "\n--- Generating User Key Pair ---" << std::endl;
     SignatureKeyPair userKeys = ca.issueUserKeyPair();
@@ -497,6 +1164,17 @@ int main() {
     std::string tamperedData = certData + "TAMPERED";
     bool isTamperedValid = ca.verifyCertificate(tamperedData, signature);
 
+    // Verify a certificate bundle in one batch
+    std::cout << "\n--- Batch Verifying Certificate Bundle ---" << std::endl;
+    std::vector<std::string> bundle = {certData, tamperedData};
+    std::vector<DigitalSignature> bundleSignatures = {signature, signature};
+    auto batchResults = ca.verifyCertificateBatch(bundle, bundleSignatures);
+    for (size_t i = 0; i < batchResults.size(); ++i) {
+        std::cout << "  Certificate " << i << ": "
+                  << (batchResults[i] == VerificationResult::Valid ? "VALID" : "INVALID")
+                  << std::endl;
+    }
+
     std::cout << "\n=== Summary ===" << std::endl;
     std::cout << "Original certificate: " << (isValid ? "VALID" : "INVALID") << std::endl;
     std::cout << "Tampered certificate: " << (isTamperedValid ? "VALID" : "INVALID") << std::endl;
@@ -3,20 +3,401 @@
  * Backward compatibility module for older security protocols
  */
 
+/* clock_gettime and CLOCK_MONOTONIC for the modexp benchmark */
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #define MAX_PRIME_SIZE 1024
 #define EXPONENT_SIZE 65537
 #define HASH_BUFFER_SIZE 64
+#define MONT_MAX_LIMBS 64
+#define MONT_WINDOW_MAX 6
+#define SMALL_PRIME_LIMIT 2048
+#define MILLER_RABIN_ROUNDS 8
+#define PRIME_SEARCH_SPAN 65536
+
+// Montgomery arithmetic modulo an odd multi-limb n, stored as little-endian
+// 64-bit limbs. A value x in Montgomery form is x*R mod n, R = 2^(64*limbs).
+typedef struct {
+    unsigned long long n[MONT_MAX_LIMBS];
+    unsigned long long rr[MONT_MAX_LIMBS];   // R^2 mod n, moves values into Montgomery form
+    unsigned long long one[MONT_MAX_LIMBS];  // R mod n, i.e. 1 in Montgomery form
+    unsigned long long n0inv;                // -n^-1 mod 2^64
+    size_t limbs;
+} mont_ctx_t;
+
+static int limbs_cmp(const unsigned long long *a, const unsigned long long *b, size_t limbs) {
+    for (size_t i = limbs; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r = a - b, returns the borrow out; r may alias a or b
+static unsigned long long limbs_sub(unsigned long long *r, const unsigned long long *a, const unsigned long long *b, size_t limbs) {
+    unsigned long long borrow = 0;
+
+    for (size_t i = 0; i < limbs; i++) {
+        unsigned long long diff = a[i] - b[i];
+        unsigned long long next = (a[i] < b[i]) | (diff < borrow);
+
+        r[i] = diff - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static int limbs_bit(const unsigned long long *a, size_t bit) {
+    return (int)((a[bit / 64] >> (bit % 64)) & 1);
+}
+
+static size_t limbs_bits(const unsigned long long *a, size_t limbs) {
+    while (limbs > 0 && a[limbs - 1] == 0) {
+        limbs--;
+    }
+    return limbs == 0 ? 0 : limbs * 64 - __builtin_clzll(a[limbs - 1]);
+}
+
+// r = a * b * R^-1 mod n (CIOS); a * b must be below n * R. r may alias a or b
+static void mont_mul(const mont_ctx_t *ctx, unsigned long long *r, const unsigned long long *a, const unsigned long long *b) {
+    unsigned long long t[MONT_MAX_LIMBS + 2];
+    size_t s = ctx->limbs;
+
+    memset(t, 0, (s + 2) * sizeof(unsigned long long));
+    for (size_t i = 0; i < s; i++) {
+        unsigned __int128 acc;
+        unsigned long long carry = 0;
+        unsigned long long m;
+
+        for (size_t j = 0; j < s; j++) {
+            acc = (unsigned __int128)a[j] * b[i] + t[j] + carry;
+            t[j] = (unsigned long long)acc;
+            carry = (unsigned long long)(acc >> 64);
+        }
+        acc = (unsigned __int128)t[s] + carry;
+        t[s] = (unsigned long long)acc;
+        t[s + 1] = (unsigned long long)(acc >> 64);
+
+        // Add m*n so the low limb cancels, then shift down one limb
+        m = t[0] * ctx->n0inv;
+        acc = (unsigned __int128)m * ctx->n[0] + t[0];
+        carry = (unsigned long long)(acc >> 64);
+        for (size_t j = 1; j < s; j++) {
+            acc = (unsigned __int128)m * ctx->n[j] + t[j] + carry;
+            t[j - 1] = (unsigned long long)acc;
+            carry = (unsigned long long)(acc >> 64);
+        }
+        acc = (unsigned __int128)t[s] + carry;
+        t[s - 1] = (unsigned long long)acc;
+        t[s] = t[s + 1] + (unsigned long long)(acc >> 64);
+    }
+
+    if (t[s] != 0 || limbs_cmp(t, ctx->n, s) >= 0) {
+        limbs_sub(r, t, ctx->n, s);
+    } else {
+        memcpy(r, t, s * sizeof(unsigned long long));
+    }
+}
+
+// Precomputes the per-modulus constants; -1 unless n is odd and fits MONT_MAX_LIMBS
+static int mont_init(mont_ctx_t *ctx, const unsigned long long *modulus, size_t limbs) {
+    unsigned long long unit[MONT_MAX_LIMBS] = {1};
+    unsigned long long inv;
+
+    while (limbs > 0 && modulus[limbs - 1] == 0) {
+        limbs--;
+    }
+    if (limbs == 0 || limbs > MONT_MAX_LIMBS || (modulus[0] & 1) == 0) {
+        return -1;
+    }
+
+    memcpy(ctx->n, modulus, limbs * sizeof(unsigned long long));
+    ctx->limbs = limbs;
+
+    // Newton iteration doubles the correct low bits of n^-1 each step, from 3
+    inv = modulus[0];
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - modulus[0] * inv;
+    }
+    ctx->n0inv = -inv;
+
+    // R^2 mod n by doubling 1 modulo n, 2 * 64 * limbs times
+    memcpy(ctx->rr, unit, limbs * sizeof(unsigned long long));
+    if (limbs_cmp(ctx->rr, ctx->n, limbs) >= 0) {
+        limbs_sub(ctx->rr, ctx->rr, ctx->n, limbs);
+    }
+    for (size_t i = 0; i < 128 * limbs; i++) {
+        unsigned long long top = ctx->rr[limbs - 1] >> 63;
+
+        for (size_t j = limbs - 1; j > 0; j--) {
+            ctx->rr[j] = (ctx->rr[j] << 1) | (ctx->rr[j - 1] >> 63);
+        }
+        ctx->rr[0] <<= 1;
+        if (top || limbs_cmp(ctx->rr, ctx->n, limbs) >= 0) {
+            limbs_sub(ctx->rr, ctx->rr, ctx->n, limbs);
+        }
+    }
+
+    mont_mul(ctx, ctx->one, ctx->rr, unit);
+    return 0;
+}
+
+// Sliding-window width for an exponent of the given bit length
+static int mont_window_bits(size_t bits) {
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    return 1;
+}
+
+/*
+ * r = base^exp mod n for an ordinary base of ctx->limbs limbs (any value
+ * below R). Odd powers up to the window width are precomputed, and the
+ * scan follows the exponent bits, so the running time depends on exp.
+ */
+static void mont_exp(const mont_ctx_t *ctx, unsigned long long *r, const unsigned long long *base,
+                     const unsigned long long *exp, size_t exp_limbs) {
+    unsigned long long table[1 << (MONT_WINDOW_MAX - 1)][MONT_MAX_LIMBS];
+    unsigned long long acc[MONT_MAX_LIMBS];
+    unsigned long long unit[MONT_MAX_LIMBS] = {1};
+    size_t bits = limbs_bits(exp, exp_limbs);
+    int window = mont_window_bits(bits);
+    int started = 0;
+
+    mont_mul(ctx, table[0], base, ctx->rr);
+    if (window > 1) {
+        mont_mul(ctx, acc, table[0], table[0]);
+        for (int i = 1; i < 1 << (window - 1); i++) {
+            mont_mul(ctx, table[i], table[i - 1], acc);
+        }
+    }
+    memcpy(acc, ctx->one, ctx->limbs * sizeof(unsigned long long));
+
+    for (size_t i = bits; i > 0;) {
+        size_t top = i - 1;
+        size_t low;
+        unsigned int value = 0;
+
+        if (!limbs_bit(exp, top)) {
+            if (started) {
+                mont_mul(ctx, acc, acc, acc);
+            }
+            i = top;
+            continue;
+        }
+
+        // Longest window of at most window bits from top that ends in a 1
+        low = top + 1 >= (size_t)window ? top + 1 - window : 0;
+        while (!limbs_bit(exp, low)) {
+            low++;
+        }
+        for (size_t k = top + 1; k-- > low;) {
+            value = (value << 1) | limbs_bit(exp, k);
+        }
+
+        if (started) {
+            for (size_t k = low; k <= top; k++) {
+                mont_mul(ctx, acc, acc, acc);
+            }
+            mont_mul(ctx, acc, acc, table[value >> 1]);
+        } else {
+            memcpy(acc, table[value >> 1], ctx->limbs * sizeof(unsigned long long));
+            started = 1;
+        }
+        i = low;
+    }
+
+    mont_mul(ctx, r, acc, unit);
+}
+
+// r = a * b; r has a_limbs + b_limbs limbs and does not alias a or b
+static void limbs_mul(unsigned long long *r, const unsigned long long *a, size_t a_limbs,
+                      const unsigned long long *b, size_t b_limbs) {
+    memset(r, 0, (a_limbs + b_limbs) * sizeof(unsigned long long));
+    for (size_t i = 0; i < a_limbs; i++) {
+        unsigned long long carry = 0;
+
+        for (size_t j = 0; j < b_limbs; j++) {
+            unsigned __int128 acc = (unsigned __int128)a[i] * b[j] + r[i + j] + carry;
+
+            r[i + j] = (unsigned long long)acc;
+            carry = (unsigned long long)(acc >> 64);
+        }
+        r[i + b_limbs] = carry;
+    }
+}
+
+// Fills out from the system CSPRNG; -1 if it cannot be read
+static int random_limbs(unsigned long long *out, size_t limbs) {
+    FILE *source = fopen("/dev/urandom", "rb");
+    size_t got;
+
+    if (!source) {
+        return -1;
+    }
+    got = fread(out, sizeof(unsigned long long), limbs, source);
+    fclose(source);
+    return got == limbs ? 0 : -1;
+}
+
+static unsigned long long limbs_mod_small(const unsigned long long *a, size_t limbs, unsigned long long m) {
+    unsigned __int128 rem = 0;
+
+    for (size_t i = limbs; i-- > 0;) {
+        rem = ((rem << 64) | a[i]) % m;
+    }
+    return (unsigned long long)rem;
+}
+
+// Odd primes below SMALL_PRIME_LIMIT, for trial division; returns the count
+static size_t small_primes(unsigned int *primes) {
+    unsigned char composite[SMALL_PRIME_LIMIT] = {0};
+    size_t count = 0;
+
+    for (unsigned int i = 3; i < SMALL_PRIME_LIMIT; i += 2) {
+        if (composite[i]) {
+            continue;
+        }
+        primes[count++] = i;
+        for (unsigned int j = i * i; j < SMALL_PRIME_LIMIT; j += 2 * i) {
+            composite[j] = 1;
+        }
+    }
+    return count;
+}
+
+// Miller-Rabin with the first MILLER_RABIN_ROUNDS small primes as bases
+static int is_probable_prime(const unsigned long long *n, size_t limbs, const unsigned int *primes) {
+    mont_ctx_t ctx;
+    unsigned long long d[MONT_MAX_LIMBS], x[MONT_MAX_LIMBS], minus_one[MONT_MAX_LIMBS];
+    unsigned long long base[MONT_MAX_LIMBS] = {0};
+    size_t shift = 1;
+
+    if (mont_init(&ctx, n, limbs) != 0) {
+        return 0;
+    }
+
+    // n - 1 = d * 2^shift with d odd
+    while (!limbs_bit(n, shift)) {
+        shift++;
+    }
+    for (size_t i = 0; i < limbs; i++) {
+        size_t word = i + shift / 64;
+        unsigned long long lo = word < limbs ? n[word] : 0;
+        unsigned long long hi = word + 1 < limbs ? n[word + 1] : 0;
+
+        d[i] = shift % 64 ? (lo >> (shift % 64)) | (hi << (64 - shift % 64)) : lo;
+    }
+    limbs_sub(minus_one, ctx.n, ctx.one, limbs);
+
+    for (int round = 0; round < MILLER_RABIN_ROUNDS; round++) {
+        size_t i;
+
+        base[0] = round == 0 ? 2 : primes[round - 1];
+        mont_exp(&ctx, x, base, d, limbs);
+        mont_mul(&ctx, x, x, ctx.rr);
+
+        if (limbs_cmp(x, ctx.one, limbs) == 0 || limbs_cmp(x, minus_one, limbs) == 0) {
+            continue;
+        }
+        for (i = 1; i < shift; i++) {
+            mont_mul(&ctx, x, x, x);
+            if (limbs_cmp(x, minus_one, limbs) == 0) {
+                break;
+            }
+        }
+        if (i == shift) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Random prime of exactly bits bits (a multiple of 64) with the top two
+ * bits set, so the product of two has exactly 2 * bits bits, and with
+ * p - 1 coprime to the prime e. Candidates step by 2 from a random start,
+ * sieved with residues kept for every small prime. Returns -1 if the
+ * system CSPRNG fails.
+ */
+static int generate_prime(unsigned long long *p, size_t bits, unsigned long long e) {
+    unsigned int primes[SMALL_PRIME_LIMIT / 2];
+    unsigned int residues[SMALL_PRIME_LIMIT / 2];
+    unsigned long long candidate[MONT_MAX_LIMBS];
+    size_t limbs = bits / 64;
+    size_t count = small_primes(primes);
+
+    for (;;) {
+        if (random_limbs(p, limbs) != 0) {
+            return -1;
+        }
+        p[limbs - 1] |= 3ULL << 62;
+        p[0] |= 1;
+
+        for (size_t k = 0; k < count; k++) {
+            residues[k] = (unsigned int)limbs_mod_small(p, limbs, primes[k]);
+        }
+
+        for (unsigned int delta = 0; delta < PRIME_SEARCH_SPAN; delta += 2) {
+            unsigned long long carry = delta;
+            size_t k;
+
+            for (k = 0; k < count; k++) {
+                if ((residues[k] + delta) % primes[k] == 0) {
+                    break;
+                }
+            }
+            if (k < count) {
+                continue;
+            }
+
+            for (size_t i = 0; i < limbs; i++) {
+                candidate[i] = p[i] + carry;
+                carry = candidate[i] < carry;
+            }
+            if (carry) {
+                break;
+            }
+            if (limbs_mod_small(candidate, limbs, e) == 1) {
+                continue;
+            }
+            if (is_probable_prime(candidate, limbs, primes)) {
+                memcpy(p, candidate, limbs * sizeof(unsigned long long));
+                return 0;
+            }
+        }
+    }
+}
+
+// x^-1 mod m for x coprime to m, m < 2^63
+static unsigned long long inverse_mod_small(unsigned long long x, unsigned long long m) {
+    long long t = 0, next_t = 1;
+    long long r = (long long)m, next_r = (long long)(x % m);
+
+    while (next_r != 0) {
+        long long q = r / next_r;
+        long long tmp;
+
+        tmp = t - q * next_t; t = next_t; next_t = tmp;
+        tmp = r - q * next_r; r = next_r; next_r = tmp;
+    }
+    return (unsigned long long)(t < 0 ? t + (long long)m : t);
+}
 
 typedef struct {
     unsigned long long productN[64];
     unsigned long long public_exp;
     unsigned long long private_exp[64];
     int key_size;
+    mont_ctx_t mont;  // Montgomery constants for productN
 } AsymmetricKeyPair;
 
 typedef struct {
@@ -86,42 +467,86 @@ void process_hash_block(LegacyHashContext *ctx, const unsigned char *block) {
 unsigned long long mod_exp(unsigned long long base, unsigned long long exp,
                           unsigned long long mod) {
     unsigned long long result = 1;
-    base = base % mod;
 
+    // Odd moduli take the Montgomery path, which needs no divisions
+    if (mod & 1) {
+        mont_ctx_t ctx;
+
+        mont_init(&ctx, &mod, 1);
+        mont_exp(&ctx, &result, &base, &exp, 1);
+        return result;
+    }
+
+    base = base % mod;
     while (exp > 0) {
         if (exp % 2 == 1) {
-            result = (result * base) % mod;
+            result = (unsigned long long)((unsigned __int128)result * base % mod);
         }
         exp = exp >> 1;
-        base = (base * base) % mod;
+        base = (unsigned long long)((unsigned __int128)base * base % mod);
     }
 
     return result;
 }
 
-// Generate authentication keys (legacy method)
+// Generate authentication keys: n = p*q from two random bits/2-bit primes
+// and d = e^-1 mod (p-1)(q-1). bits must be a multiple of 128 up to 4096
 int generate_auth_keys(AsymmetricKeyPair *keypair, int bits) {
-    // Simplified key generation for legacy compatibility
-    unsigned long long p = 61;  // Small prime for demo
-    unsigned long long q = 53;  // Small prime for demo
+    unsigned long long p[MONT_MAX_LIMBS / 2], q[MONT_MAX_LIMBS / 2];
+    unsigned long long phi[MONT_MAX_LIMBS + 1];
+    unsigned long long d[MONT_MAX_LIMBS + 1];
+    unsigned long long e = 65537;
+    unsigned long long k, carry;
+    size_t half, limbs;
+
+    if (bits < 128 || bits > 64 * MONT_MAX_LIMBS || bits % 128 != 0) {
+        return 0;
+    }
+    half = bits / 128;
+    limbs = 2 * half;
 
-    keypair->productN[0] = p * q;
-    keypair->public_exp = 65537;
+    memset(keypair->productN, 0, sizeof(keypair->productN));
+    memset(keypair->private_exp, 0, sizeof(keypair->private_exp));
+    keypair->public_exp = e;
     keypair->key_size = bits;
 
-    // Calculate private exponent (simplified)
-    unsigned long long phi = (p - 1) * (q - 1);
-    keypair->private_exp[0] = 0;
-
-    // Extended Euclidean algorithm would go here
-    for (unsigned long long d = 2; d < phi; d++) {
-        if ((keypair->public_exp * d) % phi == 1) {
-            keypair->private_exp[0] = d;
-            break;
+    do {
+        if (generate_prime(p, bits / 2, e) != 0 || generate_prime(q, bits / 2, e) != 0) {
+            return 0;
         }
+    } while (limbs_cmp(p, q, half) == 0);
+
+    limbs_mul(keypair->productN, p, half, q, half);
+    if (mont_init(&keypair->mont, keypair->productN, limbs) != 0) {
+        return 0;
+    }
+
+    // e is prime and coprime to phi, so d = (1 + k*phi) / e is exact for
+    // k = -phi^-1 mod e
+    p[0] ^= 1;
+    q[0] ^= 1;
+    limbs_mul(phi, p, half, q, half);
+    k = e - inverse_mod_small(limbs_mod_small(phi, limbs, e), e);
+
+    carry = 1;
+    for (size_t i = 0; i < limbs; i++) {
+        unsigned __int128 acc = (unsigned __int128)phi[i] * k + carry;
+
+        phi[i] = (unsigned long long)acc;
+        carry = (unsigned long long)(acc >> 64);
+    }
+    phi[limbs] = carry;
+
+    carry = 0;
+    for (size_t i = limbs + 1; i-- > 0;) {
+        unsigned __int128 acc = ((unsigned __int128)carry << 64) | phi[i];
+
+        d[i] = (unsigned long long)(acc / e);
+        carry = (unsigned long long)(acc % e);
     }
+    memcpy(keypair->private_exp, d, limbs * sizeof(d[0]));
 
-    return keypair->private_exp[0] != 0;
+    return 1;
 }
 
 // Sign authentication token
@@ -145,19 +570,22 @@ void sign_token(AsymmetricKeyPair *keypair, const char *token,
     }
 
     // Sign using modular exponentiation
-    unsigned long long sig = mod_exp(hash_int, keypair->private_exp[0],
-                                    keypair->productN[0]);
+    unsigned long long base[MONT_MAX_LIMBS] = {hash_int};
+    unsigned long long sig[MONT_MAX_LIMBS];
+    size_t limbs = keypair->mont.limbs;
+
+    mont_exp(&keypair->mont, sig, base, keypair->private_exp, limbs);
 
-    // Store signature
-    for (int i = 0; i < 8; i++) {
-        signature[i] = (sig >> (8 * (7 - i))) & 0xFF;
+    // Store signature, big-endian over key_size / 8 bytes
+    for (size_t i = 0; i < limbs * 8; i++) {
+        signature[i] = (sig[limbs - 1 - i / 8] >> (8 * (7 - i % 8))) & 0xFF;
     }
 }
 
 // Legacy authentication main function
 int authenticate_user(const char *username, const char *password) {
     AsymmetricKeyPair keypair;
-    unsigned char signature[64];
+    unsigned char signature[sizeof(keypair.productN)];
 
     if (!generate_auth_keys(&keypair, 1024)) {
         printf("Key generation failed\n");
@@ -171,4 +599,58 @@ int authenticate_user(const char *username, const char *password) {
 
     printf("User authenticated using legacy cryptographic protocols\n");
     return 1;
-}
\ No newline at end of file
+}
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+// Microbenchmark of the Montgomery engine at common modulus sizes: the
+// per-modulus R^2 setup, a full-length exponent and e = 65537
+void benchmark_mod_exp(void) {
+    static const int sizes[] = {1024, 2048, 3072};
+    static const int rounds[] = {64, 16, 8};
+    unsigned long long modulus[MONT_MAX_LIMBS], base[MONT_MAX_LIMBS];
+    unsigned long long exponent[MONT_MAX_LIMBS], result[MONT_MAX_LIMBS];
+    unsigned long long e = 65537;
+
+    for (int s = 0; s < 3; s++) {
+        size_t limbs = sizes[s] / 64;
+        double setup_ms, private_ms, public_ms;
+        struct timespec start;
+        mont_ctx_t ctx;
+
+        if (random_limbs(modulus, limbs) != 0 || random_limbs(base, limbs) != 0 ||
+            random_limbs(exponent, limbs) != 0) {
+            printf("Benchmark needs /dev/urandom\n");
+            return;
+        }
+        modulus[0] |= 1;
+        modulus[limbs - 1] |= 1ULL << 63;
+        exponent[limbs - 1] |= 1ULL << 63;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < rounds[s]; i++) {
+            mont_init(&ctx, modulus, limbs);
+        }
+        setup_ms = elapsed_ms(&start) / rounds[s];
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < rounds[s]; i++) {
+            mont_exp(&ctx, result, base, exponent, limbs);
+        }
+        private_ms = elapsed_ms(&start) / rounds[s];
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < rounds[s]; i++) {
+            mont_exp(&ctx, result, base, &e, 1);
+        }
+        public_ms = elapsed_ms(&start) / rounds[s];
+
+        printf("%d-bit modulus: R^2 setup %.3f ms, full exponent %.3f ms, e = 65537 %.4f ms\n",
+               sizes[s], setup_ms, private_ms, public_ms);
+    }
+}
@@ -8,15 +8,23 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
+#include <pthread.h>
 
 #define STREAM_BUFFER_SIZE 256
 #define KEYSTREAM_CYCLES 288
 #define INITIALIZATION_ROUNDS 4
+#define REGISTER_A_SIZE 93
+#define REGISTER_B_SIZE 84
+#define REGISTER_C_SIZE 111
+#define KEYSTREAM_BATCH 64
+#define EC_LIMBS 4
+#define EC_COMB_TEETH 8
+#define EC_COMB_SPACING 32  // ceil(256 / EC_COMB_TEETH)
 
 typedef struct {
-    uint32_t register_a[93];
-    uint32_t register_b[84];
-    uint32_t register_c[111];
+    uint32_t register_a[REGISTER_A_SIZE];
+    uint32_t register_b[REGISTER_B_SIZE];
+    uint32_t register_c[REGISTER_C_SIZE];
     uint32_t output_buffer[STREAM_BUFFER_SIZE];
     int position;
 } StreamGenerator;
@@ -90,44 +98,539 @@ uint8_t generate_keystream_byte(StreamGenerator *gen) {
     return output & 0xFF;
 }
 
-// Mathematical curve operation
-void mobile_point_multiply(MobileKeyPair *keypair, const uint8_t *scalar) {
-    // Simplified Geometric Curve operations
-    uint32_t x[8], y[8], temp[8];
-
-    // Load base point
-    memcpy(x, keypair->domain_params, 32);
-    memcpy(y, keypair->domain_params + 4, 32);
-
-    // Point doubling and addition (simplified)
-    for (int i = 0; i < 256; i++) {
-        int bit = (scalar[i/8] >> (i%8)) & 1;
-
-        if (bit) {
-            // Point addition
-            for (int j = 0; j < 8; j++) {
-                temp[j] = x[j] ^ y[j];
-            }
-            memcpy(x, temp, 32);
+/*
+ * Generate length keystream bytes, identical to calling
+ * generate_keystream_byte length times. The registers are copied into
+ * windows with KEYSTREAM_BATCH free slots in front, so each step writes one
+ * new word below the current base instead of shifting the whole register;
+ * the registers are shifted back once per batch.
+ */
+void generate_keystream(StreamGenerator *gen, uint8_t *output, size_t length) {
+    uint32_t a[KEYSTREAM_BATCH + REGISTER_A_SIZE];
+    uint32_t b[KEYSTREAM_BATCH + REGISTER_B_SIZE];
+    uint32_t c[KEYSTREAM_BATCH + REGISTER_C_SIZE];
+
+    while (length > 0) {
+        size_t steps = length < KEYSTREAM_BATCH ? length : KEYSTREAM_BATCH;
+        size_t base = steps;
+
+        memcpy(a + base, gen->register_a, sizeof(gen->register_a));
+        memcpy(b + base, gen->register_b, sizeof(gen->register_b));
+        memcpy(c + base, gen->register_c, sizeof(gen->register_c));
+
+        for (size_t n = 0; n < steps; n++) {
+            uint32_t s1 = a[base + 65] ^ a[base + 92];
+            uint32_t s2 = b[base + 68] ^ b[base + 83];
+            uint32_t s3 = c[base + 65] ^ c[base + 110];
+
+            output[n] = (s1 ^ s2 ^ s3) & 0xFF;
+
+            uint32_t t1 = s1 ^ (a[base + 90] & a[base + 91]);
+            uint32_t t2 = s2 ^ (b[base + 81] & b[base + 82]);
+            uint32_t t3 = s3 ^ (c[base + 108] & c[base + 109]);
+
+            base--;
+            a[base] = t3;
+            b[base] = t1;
+            c[base] = t2;
+        }
+
+        memcpy(gen->register_a, a, sizeof(gen->register_a));
+        memcpy(gen->register_b, b, sizeof(gen->register_b));
+        memcpy(gen->register_c, c, sizeof(gen->register_c));
+
+        output += steps;
+        length -= steps;
+    }
+}
+
+/*
+ * P-256 engine. Field and scalar values are 4 little-endian 64-bit limbs
+ * kept in Montgomery form modulo p or n; points are Jacobian (X/Z^2, Y/Z^3)
+ * with Z = 0 at infinity. Multiplication by the generator uses a comb table
+ * built once.
+ */
+typedef struct {
+    uint64_t m[EC_LIMBS];
+    uint64_t rr[EC_LIMBS];   // R^2 mod m, R = 2^256
+    uint64_t one[EC_LIMBS];  // R mod m
+    uint64_t m0inv;          // -m^-1 mod 2^64
+} ec_modulus_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+    uint64_t z[EC_LIMBS];
+} ec_jacobian_t;
+
+typedef struct {
+    uint64_t x[EC_LIMBS];
+    uint64_t y[EC_LIMBS];
+} ec_affine_t;
+
+typedef struct {
+    ec_modulus_t p;
+    ec_modulus_t n;
+    ec_jacobian_t g;
+    ec_affine_t comb[1 << EC_COMB_TEETH];
+} ec_curve_t;
+
+static const uint64_t ec_p256_p[EC_LIMBS] = {
+    0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL
+};
+static const uint64_t ec_p256_n[EC_LIMBS] = {
+    0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL
+};
+static const uint64_t ec_p256_gx[EC_LIMBS] = {
+    0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL, 0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL
+};
+static const uint64_t ec_p256_gy[EC_LIMBS] = {
+    0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL, 0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL
+};
+
+static ec_curve_t ec_curve;
+static pthread_once_t ec_curve_once = PTHREAD_ONCE_INIT;
+
+static int ec_is_zero(const uint64_t *a) {
+    return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+// r = a - b, returns the borrow out
+static uint64_t ec_sub_limbs(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t borrow = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t diff = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (diff < borrow);
+
+        r[i] = diff - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+static void ec_mod_add(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t sum[EC_LIMBS], reduced[EC_LIMBS];
+    uint64_t carry = 0;
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        unsigned __int128 acc = (unsigned __int128)a[i] + b[i] + carry;
+
+        sum[i] = (uint64_t)acc;
+        carry = (uint64_t)(acc >> 64);
+    }
+    if (ec_sub_limbs(reduced, sum, M->m) <= carry) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, sum, sizeof(sum));
+    }
+}
+
+static void ec_mod_sub(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t diff[EC_LIMBS];
+    uint64_t carry = 0;
+
+    if (ec_sub_limbs(diff, a, b)) {
+        for (int i = 0; i < EC_LIMBS; i++) {
+            unsigned __int128 acc = (unsigned __int128)diff[i] + M->m[i] + carry;
+
+            diff[i] = (uint64_t)acc;
+            carry = (uint64_t)(acc >> 64);
         }
+    }
+    memcpy(r, diff, sizeof(diff));
+}
+
+// (t, c) = t + a * b + c
+#define EC_MAC(t, a, b, c) do {                                           \
+    unsigned __int128 mac_ = (unsigned __int128)(a) * (b) + (t) + (c);    \
+    (t) = (uint64_t)mac_;                                                 \
+    (c) = (uint64_t)(mac_ >> 64);                                         \
+} while (0)
+
+// r = a * b * R^-1 mod m (CIOS, one row per limb of b); r may alias a or b
+static void ec_mod_mul(const ec_modulus_t *M, uint64_t *r, const uint64_t *a, const uint64_t *b) {
+    uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5;
+    uint64_t reduced[EC_LIMBS], t[EC_LIMBS];
+
+    for (int i = 0; i < EC_LIMBS; i++) {
+        uint64_t carry = 0;
+        uint64_t q;
+
+        EC_MAC(t0, a[0], b[i], carry);
+        EC_MAC(t1, a[1], b[i], carry);
+        EC_MAC(t2, a[2], b[i], carry);
+        EC_MAC(t3, a[3], b[i], carry);
+        t4 += carry;
+        t5 = t4 < carry;
+
+        // Adding q*m clears the low limb, which is then shifted out
+        q = t0 * M->m0inv;
+        carry = 0;
+        EC_MAC(t0, q, M->m[0], carry);
+        EC_MAC(t1, q, M->m[1], carry);
+        EC_MAC(t2, q, M->m[2], carry);
+        EC_MAC(t3, q, M->m[3], carry);
+        t4 += carry;
+        t5 += t4 < carry;
+
+        t0 = t1;
+        t1 = t2;
+        t2 = t3;
+        t3 = t4;
+        t4 = t5;
+    }
+
+    t[0] = t0;
+    t[1] = t1;
+    t[2] = t2;
+    t[3] = t3;
+    if (ec_sub_limbs(reduced, t, M->m) <= t4) {
+        memcpy(r, reduced, sizeof(reduced));
+    } else {
+        memcpy(r, t, sizeof(t));
+    }
+}
+
+// Into Montgomery form; any a below 2^256 is accepted and reduced
+static void ec_mod_to(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    ec_mod_mul(M, r, a, M->rr);
+}
 
-        // Point doubling
+static void ec_mod_from(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+
+    ec_mod_mul(M, r, a, unit);
+}
+
+// r = a^-1 by Fermat (m is prime), 4-bit fixed windows over m - 2
+static void ec_mod_inv(const ec_modulus_t *M, uint64_t *r, const uint64_t *a) {
+    static const uint64_t two[EC_LIMBS] = {2};
+    uint64_t table[16][EC_LIMBS];
+    uint64_t exponent[EC_LIMBS];
+    uint64_t acc[EC_LIMBS];
+
+    ec_sub_limbs(exponent, M->m, two);
+    memcpy(table[0], M->one, sizeof(table[0]));
+    for (int i = 1; i < 16; i++) {
+        ec_mod_mul(M, table[i], table[i - 1], a);
+    }
+
+    memcpy(acc, M->one, sizeof(acc));
+    for (int i = 63; i >= 0; i--) {
+        unsigned int nibble = (exponent[i / 16] >> (i % 16 * 4)) & 0xF;
+
+        for (int s = 0; s < 4; s++) {
+            ec_mod_mul(M, acc, acc, acc);
+        }
+        ec_mod_mul(M, acc, acc, table[nibble]);
+    }
+    memcpy(r, acc, sizeof(acc));
+}
+
+static void ec_modulus_init(ec_modulus_t *M, const uint64_t *m) {
+    static const uint64_t unit[EC_LIMBS] = {1};
+    uint64_t inv = m[0];
+
+    memcpy(M->m, m, sizeof(M->m));
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - m[0] * inv;
+    }
+    M->m0inv = -inv;
+
+    // R^2 mod m by doubling 1 modulo m 512 times
+    memcpy(M->rr, unit, sizeof(M->rr));
+    for (int i = 0; i < 512; i++) {
+        ec_mod_add(M, M->rr, M->rr, M->rr);
+    }
+    ec_mod_mul(M, M->one, M->rr, unit);
+}
+
+// dbl-2001-b, using a = -3
+static void ec_double(ec_jacobian_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t delta[EC_LIMBS], gamma[EC_LIMBS], beta[EC_LIMBS], alpha[EC_LIMBS];
+    uint64_t t0[EC_LIMBS], t1[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, delta, a->z, a->z);
+    ec_mod_mul(F, gamma, a->y, a->y);
+    ec_mod_mul(F, beta, a->x, gamma);
+
+    ec_mod_sub(F, t0, a->x, delta);
+    ec_mod_add(F, t1, a->x, delta);
+    ec_mod_mul(F, alpha, t0, t1);
+    ec_mod_add(F, t0, alpha, alpha);
+    ec_mod_add(F, alpha, t0, alpha);
+
+    // Z3 = (Y + Z)^2 - gamma - delta
+    ec_mod_add(F, t0, a->y, a->z);
+    ec_mod_mul(F, t0, t0, t0);
+    ec_mod_sub(F, t0, t0, gamma);
+    ec_mod_sub(F, r->z, t0, delta);
+
+    // X3 = alpha^2 - 8 beta
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, beta, beta, beta);
+    ec_mod_add(F, t1, beta, beta);
+    ec_mod_mul(F, t0, alpha, alpha);
+    ec_mod_sub(F, r->x, t0, t1);
+
+    // Y3 = alpha (4 beta - X3) - 8 gamma^2
+    ec_mod_sub(F, t0, beta, r->x);
+    ec_mod_mul(F, t0, alpha, t0);
+    ec_mod_mul(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_add(F, gamma, gamma, gamma);
+    ec_mod_sub(F, r->y, t0, gamma);
+}
+
+/*
+ * Shared tail of the additions once u1, u2, s1, s2 are known; z12 is the
+ * product of the input Z coordinates. Falls back to doubling for P == Q.
+ */
+static void ec_add_finish(ec_jacobian_t *r, const ec_jacobian_t *a,
+                          const uint64_t *u1, const uint64_t *u2,
+                          const uint64_t *s1, const uint64_t *s2, const uint64_t *z12) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t h[EC_LIMBS], rr[EC_LIMBS], hh[EC_LIMBS], hhh[EC_LIMBS], v[EC_LIMBS];
+    uint64_t t0[EC_LIMBS];
+
+    ec_mod_sub(F, h, u2, u1);
+    ec_mod_sub(F, rr, s2, s1);
+    if (ec_is_zero(h)) {
+        if (ec_is_zero(rr)) {
+            ec_double(r, a);
+        } else {
+            memset(r, 0, sizeof(*r));
+        }
+        return;
+    }
+
+    ec_mod_mul(F, hh, h, h);
+    ec_mod_mul(F, hhh, hh, h);
+    ec_mod_mul(F, v, u1, hh);
+
+    // X3 = r^2 - H^3 - 2 V
+    ec_mod_mul(F, t0, rr, rr);
+    ec_mod_sub(F, t0, t0, hhh);
+    ec_mod_sub(F, t0, t0, v);
+    ec_mod_sub(F, r->x, t0, v);
+
+    // Y3 = r (V - X3) - S1 H^3
+    ec_mod_sub(F, t0, v, r->x);
+    ec_mod_mul(F, t0, rr, t0);
+    ec_mod_mul(F, hhh, s1, hhh);
+    ec_mod_sub(F, r->y, t0, hhh);
+
+    ec_mod_mul(F, r->z, z12, h);
+}
+
+// r = a + b; r may alias a
+static void ec_add(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_jacobian_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], z2z2[EC_LIMBS], u1[EC_LIMBS], u2[EC_LIMBS];
+    uint64_t s1[EC_LIMBS], s2[EC_LIMBS], z12[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        *r = *b;
+        return;
+    }
+    if (ec_is_zero(b->z)) {
+        *r = *a;
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, z2z2, b->z, b->z);
+    ec_mod_mul(F, u1, a->x, z2z2);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s1, a->y, b->z);
+    ec_mod_mul(F, s1, s1, z2z2);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+    ec_mod_mul(F, z12, a->z, b->z);
+
+    ec_add_finish(r, a, u1, u2, s1, s2, z12);
+}
+
+// r = a + b for an affine b, as used by the comb; r may alias a
+static void ec_add_affine(ec_jacobian_t *r, const ec_jacobian_t *a, const ec_affine_t *b) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t z1z1[EC_LIMBS], u2[EC_LIMBS], s2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        memcpy(r->x, b->x, sizeof(r->x));
+        memcpy(r->y, b->y, sizeof(r->y));
+        memcpy(r->z, F->one, sizeof(r->z));
+        return;
+    }
+
+    ec_mod_mul(F, z1z1, a->z, a->z);
+    ec_mod_mul(F, u2, b->x, z1z1);
+    ec_mod_mul(F, s2, b->y, a->z);
+    ec_mod_mul(F, s2, s2, z1z1);
+
+    ec_add_finish(r, a, a->x, u2, a->y, s2, a->z);
+}
+
+// Affine coordinates in Montgomery form; -1 for the point at infinity
+static int ec_to_affine(ec_affine_t *r, const ec_jacobian_t *a) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (ec_is_zero(a->z)) {
+        return -1;
+    }
+    ec_mod_inv(F, zinv, a->z);
+    ec_mod_mul(F, zinv2, zinv, zinv);
+    ec_mod_mul(F, r->x, a->x, zinv2);
+    ec_mod_mul(F, zinv2, zinv2, zinv);
+    ec_mod_mul(F, r->y, a->y, zinv2);
+    return 0;
+}
+
+// ec_to_affine over count finite points with one inversion (Montgomery's trick)
+static void ec_batch_to_affine(ec_affine_t *r, const ec_jacobian_t *a, size_t count) {
+    const ec_modulus_t *F = &ec_curve.p;
+    uint64_t (*prefix)[EC_LIMBS] = malloc(count * sizeof(*prefix));
+    uint64_t inv[EC_LIMBS], zinv[EC_LIMBS], zinv2[EC_LIMBS];
+
+    if (!prefix) {
+        for (size_t i = 0; i < count; i++) {
+            ec_to_affine(&r[i], &a[i]);
+        }
+        return;
+    }
+
+    memcpy(prefix[0], a[0].z, sizeof(prefix[0]));
+    for (size_t i = 1; i < count; i++) {
+        ec_mod_mul(F, prefix[i], prefix[i - 1], a[i].z);
+    }
+    ec_mod_inv(F, inv, prefix[count - 1]);
+
+    for (size_t i = count; i-- > 0;) {
+        if (i > 0) {
+            ec_mod_mul(F, zinv, inv, prefix[i - 1]);
+            ec_mod_mul(F, inv, inv, a[i].z);
+        } else {
+            memcpy(zinv, inv, sizeof(zinv));
+        }
+        ec_mod_mul(F, zinv2, zinv, zinv);
+        ec_mod_mul(F, r[i].x, a[i].x, zinv2);
+        ec_mod_mul(F, zinv2, zinv2, zinv);
+        ec_mod_mul(F, r[i].y, a[i].y, zinv2);
+    }
+    free(prefix);
+}
+
+static int ec_scalar_bit(const uint64_t *k, int bit) {
+    return bit < 256 ? (int)((k[bit / 64] >> (bit % 64)) & 1) : 0;
+}
+
+/*
+ * The comb entry for teeth bits b_j is sum b_j * 2^(j * EC_COMB_SPACING) G,
+ * so k*G takes EC_COMB_SPACING doublings and at most as many mixed adds.
+ */
+static void ec_curve_setup(void) {
+    ec_jacobian_t teeth[EC_COMB_TEETH];
+    ec_jacobian_t entries[1 << EC_COMB_TEETH];
+
+    ec_modulus_init(&ec_curve.p, ec_p256_p);
+    ec_modulus_init(&ec_curve.n, ec_p256_n);
+    ec_mod_to(&ec_curve.p, ec_curve.g.x, ec_p256_gx);
+    ec_mod_to(&ec_curve.p, ec_curve.g.y, ec_p256_gy);
+    memcpy(ec_curve.g.z, ec_curve.p.one, sizeof(ec_curve.g.z));
+
+    teeth[0] = ec_curve.g;
+    for (int j = 1; j < EC_COMB_TEETH; j++) {
+        teeth[j] = teeth[j - 1];
+        for (int i = 0; i < EC_COMB_SPACING; i++) {
+            ec_double(&teeth[j], &teeth[j]);
+        }
+    }
+
+    memset(&entries[0], 0, sizeof(entries[0]));
+    for (int index = 1; index < 1 << EC_COMB_TEETH; index++) {
+        int low = __builtin_ctz(index);
+
+        ec_add(&entries[index], &entries[index & (index - 1)], &teeth[low]);
+    }
+    ec_batch_to_affine(ec_curve.comb + 1, entries + 1, (1 << EC_COMB_TEETH) - 1);
+}
+
+static const ec_curve_t *ec_curve_get(void) {
+    pthread_once(&ec_curve_once, ec_curve_setup);
+    return &ec_curve;
+}
+
+// r = k * G for a 256-bit k
+static void ec_mul_base(ec_jacobian_t *r, const uint64_t *k) {
+    const ec_curve_t *curve = ec_curve_get();
+
+    memset(r, 0, sizeof(*r));
+    for (int i = EC_COMB_SPACING - 1; i >= 0; i--) {
+        unsigned int index = 0;
+
+        ec_double(r, r);
+        for (int j = 0; j < EC_COMB_TEETH; j++) {
+            index |= (unsigned int)ec_scalar_bit(k, j * EC_COMB_SPACING + i) << j;
+        }
+        if (index != 0) {
+            ec_add_affine(r, r, &curve->comb[index]);
+        }
+    }
+}
+
+// 32 big-endian bytes to limbs, and back
+static void ec_from_bytes(uint64_t *r, const uint8_t *in) {
+    for (int i = 0; i < EC_LIMBS; i++) {
+        r[i] = 0;
+        for (int j = 0; j < 8; j++) {
+            r[i] = (r[i] << 8) | in[(EC_LIMBS - 1 - i) * 8 + j];
+        }
+    }
+}
+
+static void ec_to_bytes(uint8_t *out, const uint64_t *a) {
+    for (int i = 0; i < EC_LIMBS; i++) {
         for (int j = 0; j < 8; j++) {
-            y[j] = (y[j] << 1) ^ (y[j] >> 31);
+            out[(EC_LIMBS - 1 - i) * 8 + j] = (uint8_t)(a[i] >> (56 - 8 * j));
         }
     }
+}
 
-    // Store result in public key
-    memcpy(keypair->public_key, x, 32);
-    memcpy(keypair->public_key + 32, y, 32);
+// Mathematical curve operation: public_key = scalar * G on P-256 through the
+// comb table, with the scalar read big-endian and the key stored as x || y
+void mobile_point_multiply(MobileKeyPair *keypair, const uint8_t *scalar) {
+    const ec_curve_t *curve = ec_curve_get();
+    uint64_t k[EC_LIMBS], x[EC_LIMBS] = {0}, y[EC_LIMBS] = {0};
+    ec_jacobian_t point;
+    ec_affine_t affine;
+
+    ec_from_bytes(k, scalar);
+    ec_mul_base(&point, k);
+
+    // A zero scalar gives the point at infinity, stored as all zeros
+    if (ec_to_affine(&affine, &point) == 0) {
+        ec_mod_from(&curve->p, x, affine.x);
+        ec_mod_from(&curve->p, y, affine.y);
+    }
+    ec_to_bytes(keypair->public_key, x);
+    ec_to_bytes(keypair->public_key + 32, y);
 }
 
 // Generate mobile communication keys
 void generate_mobile_keys(MobileKeyPair *keypair) {
-    // Initialize domain parameters (secp256r1-like)
+    // Initialize domain parameters (secp256r1 prime)
     uint32_t domain[] = {
         0xFFFFFFFF, 0x00000001, 0x00000000, 0x00000000,
-        0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFE
+        0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF
     };
     memcpy(keypair->domain_params, domain, 32);
 
@@ -151,9 +654,25 @@ void encrypt_mobile_message(const char *message, uint8_t *encrypted,
     init_stream_generator(&gen, session_key, iv);
 
     int len = strlen(message);
-    for (int i = 0; i < len; i++) {
-        uint8_t keystream_byte = generate_keystream_byte(&gen);
-        encrypted[i] = message[i] ^ keystream_byte;
+    uint8_t keystream[KEYSTREAM_BATCH];
+
+    for (int offset = 0; offset < len; offset += KEYSTREAM_BATCH) {
+        int n = len - offset < KEYSTREAM_BATCH ? len - offset : KEYSTREAM_BATCH;
+        int i = 0;
+
+        generate_keystream(&gen, keystream, n);
+
+        // XOR a word at a time
+        for (; i + 8 <= n; i += 8) {
+            uint64_t m, k;
+            memcpy(&m, message + offset + i, 8);
+            memcpy(&k, keystream + i, 8);
+            m ^= k;
+            memcpy(encrypted + offset + i, &m, 8);
+        }
+        for (; i < n; i++) {
+            encrypted[offset + i] = message[offset + i] ^ keystream[i];
+        }
     }
     encrypted[len] = '\0';
 }
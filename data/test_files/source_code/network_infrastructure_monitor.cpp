@@ -5,15 +5,34 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <array>
+#include <unordered_map>
+#include <charconv>
 #include <chrono>
 #include <random>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
 
 class LargeIntegerProcessor {
 private:
@@ -76,6 +95,430 @@ public:
     }
 };
 
+// P-256 engine behind the curve operations. Field values are 4 little-endian
+// 64-bit limbs in Montgomery form and points are Jacobian (X/Z^2, Y/Z^3) with
+// Z = 0 at infinity. Multiples of the generator come from a comb table built
+// on first use; other points are multiplied with wNAF.
+class P256Curve {
+public:
+    using Limbs = std::array<uint64_t, 4>;
+
+    struct Jacobian {
+        Limbs x{}, y{}, z{};
+    };
+
+    static const P256Curve& instance() {
+        static const P256Curve curve;
+        return curve;
+    }
+
+    static Limbs fromBytes(const uint8_t* in) {
+        Limbs r{};
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                r[i] = (r[i] << 8) | in[(3 - i) * 8 + j];
+            }
+        }
+        return r;
+    }
+
+    static void toBytes(const Limbs& a, uint8_t* out) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                out[(3 - i) * 8 + j] = static_cast<uint8_t>(a[i] >> (56 - 8 * j));
+            }
+        }
+    }
+
+    // k * G through the comb: COMB_SPACING doublings and at most as many adds
+    Jacobian multiplyBase(const Limbs& k) const {
+        Jacobian r;
+        for (int i = COMB_SPACING - 1; i >= 0; --i) {
+            unsigned index = 0;
+            r = pointDouble(r);
+            for (int j = 0; j < COMB_TEETH; ++j) {
+                index |= static_cast<unsigned>(scalarBit(k, j * COMB_SPACING + i)) << j;
+            }
+            if (index != 0) {
+                r = addAffine(r, comb[index]);
+            }
+        }
+        return r;
+    }
+
+    // k * P for any point, from a width-WNAF_WIDTH NAF of k
+    Jacobian multiply(const Jacobian& p, const Limbs& k) const {
+        std::array<Jacobian, 1 << (WNAF_WIDTH - 2)> odd;
+        std::array<int8_t, 257> digits;
+        int length = wnaf(k, digits);
+
+        odd[0] = p;
+        Jacobian twice = pointDouble(p);
+        for (size_t i = 1; i < odd.size(); ++i) {
+            odd[i] = add(odd[i - 1], twice);
+        }
+
+        Jacobian r;
+        for (int i = length - 1; i >= 0; --i) {
+            r = pointDouble(r);
+            if (digits[i] > 0) {
+                r = add(r, odd[digits[i] / 2]);
+            } else if (digits[i] < 0) {
+                Jacobian term = odd[-digits[i] / 2];
+                if (!isZero(term.y)) {
+                    subLimbs(term.y, field.m, term.y);
+                }
+                r = add(r, term);
+            }
+        }
+        return r;
+    }
+
+    // Plain affine coordinates; false for the point at infinity
+    bool toAffine(const Jacobian& p, Limbs& x, Limbs& y) const {
+        if (isZero(p.z)) {
+            return false;
+        }
+        Limbs zinv = invert(field, p.z);
+        Limbs zinv2 = mul(field, zinv, zinv);
+        x = fromMont(field, mul(field, p.x, zinv2));
+        y = fromMont(field, mul(field, p.y, mul(field, zinv2, zinv)));
+        return true;
+    }
+
+    // Jacobian form of plain affine coordinates; false unless reduced and on the curve
+    bool fromAffine(const Limbs& x, const Limbs& y, Jacobian& p) const {
+        Limbs unused;
+        if (!subLimbs(unused, x, field.m) || !subLimbs(unused, y, field.m)) {
+            return false;
+        }
+        p.x = mul(field, x, field.rr);
+        p.y = mul(field, y, field.rr);
+        p.z = field.one;
+
+        // y^2 = x^3 - 3x + b
+        Limbs lhs = mul(field, p.y, p.y);
+        Limbs rhs = mul(field, mul(field, p.x, p.x), p.x);
+        Limbs threeX = addMod(field, addMod(field, p.x, p.x), p.x);
+        rhs = addMod(field, subMod(field, rhs, threeX), curveB);
+        return lhs == rhs;
+    }
+
+private:
+    static constexpr int COMB_TEETH = 8;
+    static constexpr int COMB_SPACING = 32;  // ceil(256 / COMB_TEETH)
+    static constexpr int WNAF_WIDTH = 5;
+
+    struct Modulus {
+        Limbs m{};
+        Limbs rr{};    // R^2 mod m, R = 2^256
+        Limbs one{};   // R mod m
+        uint64_t m0inv = 0;  // -m^-1 mod 2^64
+    };
+
+    struct Affine {
+        Limbs x{}, y{};
+    };
+
+    Modulus field;
+    Limbs curveB{};
+    std::array<Affine, 1 << COMB_TEETH> comb;
+
+    P256Curve() {
+        const Limbs p = {0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL,
+                         0x0000000000000000ULL, 0xFFFFFFFF00000001ULL};
+        const Limbs b = {0x3BCE3C3E27D2604BULL, 0x651D06B0CC53B0F6ULL,
+                         0xB3EBBD55769886BCULL, 0x5AC635D8AA3A93E7ULL};
+        const Limbs gx = {0xF4A13945D898C296ULL, 0x77037D812DEB33A0ULL,
+                          0xF8BCE6E563A440F2ULL, 0x6B17D1F2E12C4247ULL};
+        const Limbs gy = {0xCBB6406837BF51F5ULL, 0x2BCE33576B315ECEULL,
+                          0x8EE7EB4A7C0F9E16ULL, 0x4FE342E2FE1A7F9BULL};
+
+        field = makeModulus(p);
+        curveB = mul(field, b, field.rr);
+
+        // comb[index] = sum of 2^(j * COMB_SPACING) G over the set bits j of index
+        std::array<Jacobian, COMB_TEETH> teeth;
+        teeth[0].x = mul(field, gx, field.rr);
+        teeth[0].y = mul(field, gy, field.rr);
+        teeth[0].z = field.one;
+        for (int j = 1; j < COMB_TEETH; ++j) {
+            teeth[j] = teeth[j - 1];
+            for (int i = 0; i < COMB_SPACING; ++i) {
+                teeth[j] = pointDouble(teeth[j]);
+            }
+        }
+
+        std::vector<Jacobian> entries(comb.size());
+        for (size_t index = 1; index < comb.size(); ++index) {
+            entries[index] = add(entries[index & (index - 1)], teeth[__builtin_ctzll(index)]);
+        }
+
+        // One inversion for the whole table (Montgomery's trick)
+        std::vector<Limbs> prefix(comb.size());
+        prefix[1] = entries[1].z;
+        for (size_t index = 2; index < comb.size(); ++index) {
+            prefix[index] = mul(field, prefix[index - 1], entries[index].z);
+        }
+        Limbs inverse = invert(field, prefix.back());
+        for (size_t index = comb.size() - 1; index >= 1; --index) {
+            Limbs zinv = inverse;
+            if (index > 1) {
+                zinv = mul(field, inverse, prefix[index - 1]);
+                inverse = mul(field, inverse, entries[index].z);
+            }
+            Limbs zinv2 = mul(field, zinv, zinv);
+            comb[index].x = mul(field, entries[index].x, zinv2);
+            comb[index].y = mul(field, entries[index].y, mul(field, zinv2, zinv));
+        }
+    }
+
+    static bool isZero(const Limbs& a) {
+        return (a[0] | a[1] | a[2] | a[3]) == 0;
+    }
+
+    // r = a - b, returns the borrow out
+    static uint64_t subLimbs(Limbs& r, const Limbs& a, const Limbs& b) {
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t diff = a[i] - b[i];
+            uint64_t next = (a[i] < b[i]) | (diff < borrow);
+            r[i] = diff - borrow;
+            borrow = next;
+        }
+        return borrow;
+    }
+
+    static Limbs addMod(const Modulus& M, const Limbs& a, const Limbs& b) {
+        Limbs sum, reduced;
+        uint64_t carry = 0;
+        for (int i = 0; i < 4; ++i) {
+            unsigned __int128 acc = static_cast<unsigned __int128>(a[i]) + b[i] + carry;
+            sum[i] = static_cast<uint64_t>(acc);
+            carry = static_cast<uint64_t>(acc >> 64);
+        }
+        return subLimbs(reduced, sum, M.m) <= carry ? reduced : sum;
+    }
+
+    static Limbs subMod(const Modulus& M, const Limbs& a, const Limbs& b) {
+        Limbs diff;
+        if (subLimbs(diff, a, b)) {
+            uint64_t carry = 0;
+            for (int i = 0; i < 4; ++i) {
+                unsigned __int128 acc = static_cast<unsigned __int128>(diff[i]) + M.m[i] + carry;
+                diff[i] = static_cast<uint64_t>(acc);
+                carry = static_cast<uint64_t>(acc >> 64);
+            }
+        }
+        return diff;
+    }
+
+    // (t, c) = t + a * b + c
+    static void mulAdd(uint64_t& t, uint64_t a, uint64_t b, uint64_t& c) {
+        unsigned __int128 acc = static_cast<unsigned __int128>(a) * b + t + c;
+        t = static_cast<uint64_t>(acc);
+        c = static_cast<uint64_t>(acc >> 64);
+    }
+
+    // a * b * R^-1 mod m (CIOS, one row per limb of b)
+    static Limbs mul(const Modulus& M, const Limbs& a, const Limbs& b) {
+        uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t carry = 0;
+            mulAdd(t0, a[0], b[i], carry);
+            mulAdd(t1, a[1], b[i], carry);
+            mulAdd(t2, a[2], b[i], carry);
+            mulAdd(t3, a[3], b[i], carry);
+            t4 += carry;
+            t5 = t4 < carry;
+
+            // Adding q*m clears the low limb, which is then shifted out
+            uint64_t q = t0 * M.m0inv;
+            carry = 0;
+            mulAdd(t0, q, M.m[0], carry);
+            mulAdd(t1, q, M.m[1], carry);
+            mulAdd(t2, q, M.m[2], carry);
+            mulAdd(t3, q, M.m[3], carry);
+            t4 += carry;
+            t5 += t4 < carry;
+
+            t0 = t1;
+            t1 = t2;
+            t2 = t3;
+            t3 = t4;
+            t4 = t5;
+        }
+
+        Limbs t = {t0, t1, t2, t3};
+        Limbs reduced;
+        return subLimbs(reduced, t, M.m) <= t4 ? reduced : t;
+    }
+
+    static Limbs fromMont(const Modulus& M, const Limbs& a) {
+        return mul(M, a, Limbs{1, 0, 0, 0});
+    }
+
+    // a^-1 by Fermat (m is prime), 4-bit fixed windows over m - 2
+    static Limbs invert(const Modulus& M, const Limbs& a) {
+        std::array<Limbs, 16> table;
+        Limbs exponent;
+        subLimbs(exponent, M.m, Limbs{2, 0, 0, 0});
+
+        table[0] = M.one;
+        for (int i = 1; i < 16; ++i) {
+            table[i] = mul(M, table[i - 1], a);
+        }
+
+        Limbs acc = M.one;
+        for (int i = 63; i >= 0; --i) {
+            for (int s = 0; s < 4; ++s) {
+                acc = mul(M, acc, acc);
+            }
+            acc = mul(M, acc, table[(exponent[i / 16] >> (i % 16 * 4)) & 0xF]);
+        }
+        return acc;
+    }
+
+    static Modulus makeModulus(const Limbs& m) {
+        Modulus M;
+        M.m = m;
+
+        uint64_t inv = m[0];
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - m[0] * inv;
+        }
+        M.m0inv = -inv;
+
+        // R^2 mod m by doubling 1 modulo m 512 times
+        M.rr = Limbs{1, 0, 0, 0};
+        for (int i = 0; i < 512; ++i) {
+            M.rr = addMod(M, M.rr, M.rr);
+        }
+        M.one = mul(M, M.rr, Limbs{1, 0, 0, 0});
+        return M;
+    }
+
+    static int scalarBit(const Limbs& k, int bit) {
+        return bit < 256 ? static_cast<int>((k[bit / 64] >> (bit % 64)) & 1) : 0;
+    }
+
+    // Width-WNAF_WIDTH NAF of k, least significant digit first; returns the length
+    static int wnaf(const Limbs& k, std::array<int8_t, 257>& digits) {
+        uint64_t t[5] = {k[0], k[1], k[2], k[3], 0};
+        int length = 0;
+
+        while ((t[0] | t[1] | t[2] | t[3] | t[4]) != 0) {
+            int digit = 0;
+            if (t[0] & 1) {
+                digit = static_cast<int>(t[0] & ((1u << WNAF_WIDTH) - 1));
+                if (digit >= 1 << (WNAF_WIDTH - 1)) {
+                    digit -= 1 << WNAF_WIDTH;
+                }
+
+                // t -= digit, leaving the low WNAF_WIDTH bits clear
+                if (digit > 0) {
+                    uint64_t borrow = static_cast<uint64_t>(digit);
+                    for (int i = 0; i < 5 && borrow; ++i) {
+                        uint64_t before = t[i];
+                        t[i] -= borrow;
+                        borrow = t[i] > before;
+                    }
+                } else {
+                    uint64_t carry = static_cast<uint64_t>(-digit);
+                    for (int i = 0; i < 5 && carry; ++i) {
+                        t[i] += carry;
+                        carry = t[i] < carry;
+                    }
+                }
+            }
+            digits[length++] = static_cast<int8_t>(digit);
+
+            for (int i = 0; i < 4; ++i) {
+                t[i] = (t[i] >> 1) | (t[i + 1] << 63);
+            }
+            t[4] >>= 1;
+        }
+        return length;
+    }
+
+    // dbl-2001-b, using a = -3
+    Jacobian pointDouble(const Jacobian& a) const {
+        if (isZero(a.z)) {
+            return a;
+        }
+        const Modulus& F = field;
+        Limbs delta = mul(F, a.z, a.z);
+        Limbs gamma = mul(F, a.y, a.y);
+        Limbs beta = mul(F, a.x, gamma);
+        Limbs alpha = mul(F, subMod(F, a.x, delta), addMod(F, a.x, delta));
+        alpha = addMod(F, addMod(F, alpha, alpha), alpha);
+
+        Jacobian r;
+        Limbs yz = addMod(F, a.y, a.z);
+        r.z = subMod(F, subMod(F, mul(F, yz, yz), gamma), delta);
+
+        Limbs beta4 = addMod(F, beta, beta);
+        beta4 = addMod(F, beta4, beta4);
+        r.x = subMod(F, mul(F, alpha, alpha), addMod(F, beta4, beta4));
+
+        Limbs gamma8 = mul(F, gamma, gamma);
+        gamma8 = addMod(F, gamma8, gamma8);
+        gamma8 = addMod(F, gamma8, gamma8);
+        gamma8 = addMod(F, gamma8, gamma8);
+        r.y = subMod(F, mul(F, alpha, subMod(F, beta4, r.x)), gamma8);
+        return r;
+    }
+
+    // Shared tail of the additions; z12 is the product of the input Z coordinates
+    Jacobian addFinish(const Jacobian& a, const Limbs& u1, const Limbs& u2,
+                       const Limbs& s1, const Limbs& s2, const Limbs& z12) const {
+        const Modulus& F = field;
+        Limbs h = subMod(F, u2, u1);
+        Limbs rr = subMod(F, s2, s1);
+        if (isZero(h)) {
+            return isZero(rr) ? pointDouble(a) : Jacobian{};
+        }
+
+        Limbs hh = mul(F, h, h);
+        Limbs hhh = mul(F, hh, h);
+        Limbs v = mul(F, u1, hh);
+
+        Jacobian r;
+        r.x = subMod(F, subMod(F, subMod(F, mul(F, rr, rr), hhh), v), v);
+        r.y = subMod(F, mul(F, rr, subMod(F, v, r.x)), mul(F, s1, hhh));
+        r.z = mul(F, z12, h);
+        return r;
+    }
+
+    Jacobian add(const Jacobian& a, const Jacobian& b) const {
+        if (isZero(a.z)) {
+            return b;
+        }
+        if (isZero(b.z)) {
+            return a;
+        }
+        const Modulus& F = field;
+        Limbs z1z1 = mul(F, a.z, a.z);
+        Limbs z2z2 = mul(F, b.z, b.z);
+        Limbs u1 = mul(F, a.x, z2z2);
+        Limbs u2 = mul(F, b.x, z1z1);
+        Limbs s1 = mul(F, mul(F, a.y, b.z), z2z2);
+        Limbs s2 = mul(F, mul(F, b.y, a.z), z1z1);
+        return addFinish(a, u1, u2, s1, s2, mul(F, a.z, b.z));
+    }
+
+    Jacobian addAffine(const Jacobian& a, const Affine& b) const {
+        if (isZero(a.z)) {
+            return Jacobian{b.x, b.y, field.one};
+        }
+        const Modulus& F = field;
+        Limbs z1z1 = mul(F, a.z, a.z);
+        Limbs u2 = mul(F, b.x, z1z1);
+        Limbs s2 = mul(F, mul(F, b.y, a.z), z1z1);
+        return addFinish(a, a.x, u2, a.y, s2, a.z);
+    }
+};
+
 class EllipticCurveCalculator {
 private:
     struct Point {
@@ -88,9 +531,16 @@ private:
     };
 
     static const int FIELD_SIZE = 256;
-    Point basePoint;
     std::vector<uint8_t> curveParameter;
 
+    // Big-endian key bytes to a scalar; shorter keys are zero-extended, longer ones truncated
+    static P256Curve::Limbs scalarFromBytes(const std::vector<uint8_t>& key) {
+        uint8_t padded[32] = {0};
+        size_t length = std::min(key.size(), sizeof(padded));
+        std::memcpy(padded + sizeof(padded) - length, key.data(), length);
+        return P256Curve::fromBytes(padded);
+    }
+
 public:
     EllipticCurveCalculator() {
         // Initialize Geometric Curve parameters
@@ -102,31 +552,40 @@ public:
         for (int i = 0; i < 32; ++i) {
             curveParameter[i] = dis(gen);
         }
-
-        basePoint = Point(std::vector<uint8_t>(32, 1), std::vector<uint8_t>(32, 2));
     }
 
+    // privateKey * G on P-256 through the precomputed comb; all zeros at infinity
     Point generatePublicKey(const std::vector<uint8_t>& privateKey) {
-        // Point multiplication simulation
+        const P256Curve& curve = P256Curve::instance();
         Point result;
+        P256Curve::Limbs x, y;
 
-        for (size_t i = 0; i < std::min(privateKey.size(), result.x.size()); ++i) {
-            result.x[i] = (basePoint.x[i] * privateKey[i]) % 256;
-            result.y[i] = (basePoint.y[i] * privateKey[i]) % 256;
+        if (curve.toAffine(curve.multiplyBase(scalarFromBytes(privateKey)), x, y)) {
+            P256Curve::toBytes(x, result.x.data());
+            P256Curve::toBytes(y, result.y.data());
         }
 
         return result;
     }
 
+    // ECDH: the x coordinate of localPrivateKey * remotePublicKey
     std::vector<uint8_t> performKeyExchange(const Point& remotePublicKey,
                                           const std::vector<uint8_t>& localPrivateKey) {
-        // CURVE_KE-like key exchange
-        std::vector<uint8_t> sharedSecret(32);
-
-        for (size_t i = 0; i < 32; ++i) {
-            sharedSecret[i] = (remotePublicKey.x[i] * localPrivateKey[i % localPrivateKey.size()]) % 256;
+        const P256Curve& curve = P256Curve::instance();
+        P256Curve::Jacobian remote;
+        P256Curve::Limbs x, y;
+
+        if (remotePublicKey.x.size() != 32 || remotePublicKey.y.size() != 32 ||
+            !curve.fromAffine(P256Curve::fromBytes(remotePublicKey.x.data()),
+                              P256Curve::fromBytes(remotePublicKey.y.data()), remote)) {
+            throw std::invalid_argument("Remote public key is not a P-256 point");
+        }
+        if (!curve.toAffine(curve.multiply(remote, scalarFromBytes(localPrivateKey)), x, y)) {
+            throw std::invalid_argument("Key exchange produced the point at infinity");
         }
 
+        std::vector<uint8_t> sharedSecret(32);
+        P256Curve::toBytes(x, sharedSecret.data());
         return sharedSecret;
     }
 
@@ -146,29 +605,44 @@ public:
     }
 };
 
-class SecureHashFunction {
-private:
-    static const int DIGEST_SIZE = 32;
-    static const int BLOCK_SIZE = 64;
+// SHA-256 compression kernels. The single-stream kernel is picked at runtime
+// from SHA-NI, the ARMv8 SHA2 extension or portable code; the lane kernel
+// hashes one block of each of eight independent messages with AVX2.
+namespace digest_kernels {
 
-    uint32_t state[8] = {
-        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-    };
+alignas(64) inline constexpr uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline constexpr uint32_t INITIAL_STATE[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
 
-    static const uint32_t k[64];
+inline uint32_t load32BE(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
 
-    uint32_t rightRotate(uint32_t value, unsigned int amount) {
-        return (value >> amount) | (value << (32 - amount));
-    }
+inline uint32_t rightRotate(uint32_t value, unsigned int amount) {
+    return (value >> amount) | (value << (32 - amount));
+}
+
+typedef void (*CompressFn)(uint32_t* state, const uint8_t* blocks, size_t count);
 
-    void processBlock(const uint8_t* block) {
+inline void compressScalar(uint32_t* state, const uint8_t* blocks, size_t count) {
+    for (; count > 0; --count, blocks += 64) {
         uint32_t w[64];
 
         // Prepare message schedule
         for (int i = 0; i < 16; ++i) {
-            w[i] = (block[i * 4] << 24) | (block[i * 4 + 1] << 16) |
-                   (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+            w[i] = load32BE(blocks + i * 4);
         }
 
         for (int i = 16; i < 64; ++i) {
@@ -177,15 +651,13 @@ private:
             w[i] = w[i-16] + s0 + w[i-7] + s1;
         }
 
-        // Initialize working vKoreanAdvancedCipherbles
         uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
         uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
 
-        // Main loop
         for (int i = 0; i < 64; ++i) {
             uint32_t s1 = rightRotate(e, 6) ^ rightRotate(e, 11) ^ rightRotate(e, 25);
             uint32_t ch = (e & f) ^ (~e & g);
-            uint32_t temp1 = h + s1 + ch + k[i] + w[i];
+            uint32_t temp1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
             uint32_t s0 = rightRotate(a, 2) ^ rightRotate(a, 13) ^ rightRotate(a, 22);
             uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
             uint32_t temp2 = s0 + maj;
@@ -200,50 +672,343 @@ private:
             a = temp1 + temp2;
         }
 
-        // Add to state
         state[0] += a; state[1] += b; state[2] += c; state[3] += d;
         state[4] += e; state[5] += f; state[6] += g; state[7] += h;
     }
+}
 
-public:
-    std::vector<uint8_t> computeDigest(const std::vector<uint8_t>& data) {
-        // Reset state
-        state[0] = 0x6a09e667; state[1] = 0xbb67ae85; state[2] = 0x3c6ef372; state[3] = 0xa54ff53a;
-        state[4] = 0x510e527f; state[5] = 0x9b05688c; state[6] = 0x1f83d9ab; state[7] = 0x5be0cd19;
+struct Compressor {
+    const char* name;
+    CompressFn compress;
+};
+
+// State is transposed to [word][lane]; lanes with a zero mask word keep their state
+typedef void (*LanesFn)(uint32_t (*state)[8], const uint8_t* const* blocks, const uint32_t* activeMask);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+__attribute__((target("sha,sse4.1")))
+void compressSHANI(uint32_t* state, const uint8_t* blocks, size_t count) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions keep the state as ABEF / CDGH
+    __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; count > 0; --count, blocks += 64) {
+        __m128i abefSaved = abef;
+        __m128i cdghSaved = cdgh;
+        __m128i message[4];
+
+#pragma GCC unroll 16
+        for (int group = 0; group < 16; ++group) {
+            if (group < 4) {
+                message[group] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + group * 16)), byteSwap);
+            }
+
+            __m128i words = _mm_add_epi32(message[group & 3],
+                _mm_load_si128(reinterpret_cast<const __m128i*>(ROUND_CONSTANTS + group * 4)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(words, 0x0E));
 
-        // Padding
-        std::vector<uint8_t> paddedData = data;
-        uint64_t originalLength = data.size() * 8;
+            // Schedule words for group + 1 and start those for group + 3
+            if (group >= 3 && group <= 14) {
+                __m128i& next = message[(group + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(message[group & 3], message[(group - 1) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, message[group & 3]);
+            }
+            if (group >= 1 && group <= 12) {
+                message[(group - 1) & 3] = _mm_sha256msg1_epu32(message[(group - 1) & 3], message[group & 3]);
+            }
+        }
+
+        abef = _mm_add_epi32(abef, abefSaved);
+        cdgh = _mm_add_epi32(cdgh, cdghSaved);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
 
-        paddedData.push_back(0x80);
-        while ((paddedData.size() % BLOCK_SIZE) != 56) {
-            paddedData.push_back(0x00);
+__attribute__((target("avx2")))
+void compressLanesAVX2(uint32_t (*state)[8], const uint8_t* const* blocks, const uint32_t* activeMask) {
+    typedef uint32_t Vec __attribute__((vector_size(32)));
+
+#define DK_ROTR(v, n) (((v) >> (n)) | ((v) << (32 - (n))))
+
+    Vec w[64];
+    for (int i = 0; i < 16; ++i) {
+        uint32_t words[8];
+        for (int lane = 0; lane < 8; ++lane) {
+            words[lane] = load32BE(blocks[lane] + i * 4);
         }
+        std::memcpy(&w[i], words, sizeof(Vec));
+    }
+    for (int i = 16; i < 64; ++i) {
+        Vec s0 = DK_ROTR(w[i-15], 7) ^ DK_ROTR(w[i-15], 18) ^ (w[i-15] >> 3);
+        Vec s1 = DK_ROTR(w[i-2], 17) ^ DK_ROTR(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    Vec initial[8];
+    for (int i = 0; i < 8; ++i) {
+        std::memcpy(&initial[i], state[i], sizeof(Vec));
+    }
 
-        // Append length
-        for (int i = 7; i >= 0; --i) {
-            paddedData.push_back((originalLength >> (i * 8)) & 0xFF);
+    Vec a = initial[0], b = initial[1], c = initial[2], d = initial[3];
+    Vec e = initial[4], f = initial[5], g = initial[6], h = initial[7];
+
+    for (int i = 0; i < 64; ++i) {
+        Vec s1 = DK_ROTR(e, 6) ^ DK_ROTR(e, 11) ^ DK_ROTR(e, 25);
+        Vec ch = (e & f) ^ (~e & g);
+        Vec temp1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+        Vec s0 = DK_ROTR(a, 2) ^ DK_ROTR(a, 13) ^ DK_ROTR(a, 22);
+        Vec maj = (a & b) ^ (a & c) ^ (b & c);
+        Vec temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+#undef DK_ROTR
+
+    Vec mask;
+    std::memcpy(&mask, activeMask, sizeof(mask));
+    Vec working[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; ++i) {
+        Vec updated = initial[i] + working[i];
+        Vec merged = (updated & mask) | (initial[i] & ~mask);
+        std::memcpy(state[i], &merged, sizeof(merged));
+    }
+}
+
+inline bool cpuHasSHA() {
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29)) != 0 &&
+           __builtin_cpu_supports("sse4.1");
+}
+
+inline const Compressor& selectCompressor() {
+    static const Compressor compressor = []() {
+        __builtin_cpu_init();
+        if (cpuHasSHA()) return Compressor{"sha-ni", compressSHANI};
+        return Compressor{"scalar", compressScalar};
+    }();
+    return compressor;
+}
+
+// SHA-NI on one stream outruns eight AVX2 lanes, so lanes only stand in for scalar code
+inline LanesFn selectLanes() {
+    static const LanesFn lanes = []() -> LanesFn {
+        __builtin_cpu_init();
+        return !cpuHasSHA() && __builtin_cpu_supports("avx2") ? compressLanesAVX2 : nullptr;
+    }();
+    return lanes;
+}
+#elif defined(__GNUC__) && defined(__aarch64__)
+__attribute__((target("+crypto")))
+void compressARMv8(uint32_t* state, const uint8_t* blocks, size_t count) {
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32x4_t efgh = vld1q_u32(state + 4);
+
+    for (; count > 0; --count, blocks += 64) {
+        uint32x4_t abcdSaved = abcd;
+        uint32x4_t efghSaved = efgh;
+        uint32x4_t message[4];
+
+        for (int i = 0; i < 4; ++i) {
+            message[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
         }
 
-        // Process blocks
-        for (size_t i = 0; i < paddedData.size(); i += BLOCK_SIZE) {
-            processBlock(&paddedData[i]);
+#pragma GCC unroll 16
+        for (int group = 0; group < 16; ++group) {
+            uint32x4_t words = vaddq_u32(message[group & 3], vld1q_u32(ROUND_CONSTANTS + group * 4));
+
+            // Replace this group's words with those of group + 4
+            if (group < 12) {
+                message[group & 3] = vsha256su0q_u32(message[group & 3], message[(group + 1) & 3]);
+            }
+
+            uint32x4_t abcdBefore = abcd;
+            abcd = vsha256hq_u32(abcd, efgh, words);
+            efgh = vsha256h2q_u32(efgh, abcdBefore, words);
+
+            if (group < 12) {
+                message[group & 3] = vsha256su1q_u32(message[group & 3], message[(group + 2) & 3],
+                                                     message[(group + 3) & 3]);
+            }
         }
 
-        // Extract digest
-        std::vector<uint8_t> digest(DIGEST_SIZE);
+        abcd = vaddq_u32(abcd, abcdSaved);
+        efgh = vaddq_u32(efgh, efghSaved);
+    }
+
+    vst1q_u32(state, abcd);
+    vst1q_u32(state + 4, efgh);
+}
+
+inline const Compressor& selectCompressor() {
+    static const Compressor compressor = []() {
+#if defined(__linux__)
+        if (getauxval(AT_HWCAP) & HWCAP_SHA2) return Compressor{"armv8-sha2", compressARMv8};
+#endif
+        return Compressor{"scalar", compressScalar};
+    }();
+    return compressor;
+}
+
+inline LanesFn selectLanes() {
+    return nullptr;
+}
+#else
+inline const Compressor& selectCompressor() {
+    static const Compressor compressor{"scalar", compressScalar};
+    return compressor;
+}
+
+inline LanesFn selectLanes() {
+    return nullptr;
+}
+#endif
+
+} // namespace digest_kernels
+
+class SecureHashFunction {
+private:
+    static const int DIGEST_SIZE = 32;
+    static const int BLOCK_SIZE = 64;
+
+    // Final one or two blocks: the message tail, 0x80, zeros and the bit length
+    static size_t padTail(uint8_t (&tail)[2 * BLOCK_SIZE], const uint8_t* data, size_t length) {
+        size_t remainder = length % BLOCK_SIZE;
+        size_t tailSize = remainder < BLOCK_SIZE - 8 ? BLOCK_SIZE : 2 * BLOCK_SIZE;
+
+        if (remainder > 0) {
+            std::memcpy(tail, data + (length - remainder), remainder);
+        }
+        tail[remainder] = 0x80;
+        std::memset(tail + remainder + 1, 0, tailSize - remainder - 1);
+
+        uint64_t bitLength = uint64_t(length) * 8;
+        for (int i = 0; i < 8; ++i) {
+            tail[tailSize - 1 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+        }
+        return tailSize / BLOCK_SIZE;
+    }
+
+public:
+    using Digest = std::array<uint8_t, DIGEST_SIZE>;
+
+    // Chaining state and padding live on the caller's stack, so this never
+    // allocates and concurrent digests never share mutable state
+    Digest computeDigest(const uint8_t* data, size_t length) const {
+        const digest_kernels::CompressFn compress = digest_kernels::selectCompressor().compress;
+        uint32_t state[8];
+        std::memcpy(state, digest_kernels::INITIAL_STATE, sizeof(state));
+
+        compress(state, data, length / BLOCK_SIZE);
+
+        uint8_t tail[2 * BLOCK_SIZE];
+        compress(state, tail, padTail(tail, data, length));
+
+        Digest digest;
         for (int i = 0; i < 8; ++i) {
             digest[i * 4] = (state[i] >> 24) & 0xFF;
             digest[i * 4 + 1] = (state[i] >> 16) & 0xFF;
             digest[i * 4 + 2] = (state[i] >> 8) & 0xFF;
             digest[i * 4 + 3] = state[i] & 0xFF;
         }
-
         return digest;
     }
 
+    std::vector<uint8_t> computeDigest(const std::vector<uint8_t>& data) const {
+        Digest digest = computeDigest(data.data(), data.size());
+        return std::vector<uint8_t>(digest.begin(), digest.end());
+    }
+
+    /**
+     * Digests count independent messages. Without SHA instructions but with
+     * AVX2 they are hashed eight at a time, one block per lane per step;
+     * lanes whose message has ended are masked off until the longest one in
+     * the group finishes
+     */
+    void computeDigests(const uint8_t* const* messages, const size_t* lengths,
+                        size_t count, Digest* digests) const {
+        const digest_kernels::LanesFn lanes = digest_kernels::selectLanes();
+        if (!lanes) {
+            for (size_t i = 0; i < count; ++i) {
+                digests[i] = computeDigest(messages[i], lengths[i]);
+            }
+            return;
+        }
+
+        static const uint8_t idleBlock[BLOCK_SIZE] = {};
+
+        for (size_t first = 0; first < count; first += 8) {
+            size_t group = std::min<size_t>(8, count - first);
+            uint32_t state[8][8];
+            uint8_t tails[8][2 * BLOCK_SIZE];
+            size_t fullBlocks[8] = {};
+            size_t totalBlocks[8] = {};
+            size_t longest = 0;
+
+            for (size_t lane = 0; lane < 8; ++lane) {
+                for (int word = 0; word < 8; ++word) {
+                    state[word][lane] = digest_kernels::INITIAL_STATE[word];
+                }
+                if (lane < group) {
+                    const size_t length = lengths[first + lane];
+                    fullBlocks[lane] = length / BLOCK_SIZE;
+                    totalBlocks[lane] = fullBlocks[lane] +
+                        padTail(tails[lane], messages[first + lane], length);
+                    longest = std::max(longest, totalBlocks[lane]);
+                }
+            }
+
+            for (size_t block = 0; block < longest; ++block) {
+                const uint8_t* blocks[8];
+                uint32_t activeMask[8];
+                for (size_t lane = 0; lane < 8; ++lane) {
+                    if (block < fullBlocks[lane]) {
+                        blocks[lane] = messages[first + lane] + block * BLOCK_SIZE;
+                    } else if (block < totalBlocks[lane]) {
+                        blocks[lane] = tails[lane] + (block - fullBlocks[lane]) * BLOCK_SIZE;
+                    } else {
+                        blocks[lane] = idleBlock;
+                    }
+                    activeMask[lane] = block < totalBlocks[lane] ? 0xFFFFFFFFu : 0;
+                }
+                lanes(state, blocks, activeMask);
+            }
+
+            for (size_t lane = 0; lane < group; ++lane) {
+                Digest& digest = digests[first + lane];
+                for (int word = 0; word < 8; ++word) {
+                    digest[word * 4] = (state[word][lane] >> 24) & 0xFF;
+                    digest[word * 4 + 1] = (state[word][lane] >> 16) & 0xFF;
+                    digest[word * 4 + 2] = (state[word][lane] >> 8) & 0xFF;
+                    digest[word * 4 + 3] = state[word][lane] & 0xFF;
+                }
+            }
+        }
+    }
+
+    static const char* kernelName() {
+        return digest_kernels::selectCompressor().name;
+    }
+
     std::vector<uint8_t> computeHMAC(const std::vector<uint8_t>& key,
-                                   const std::vector<uint8_t>& data) {
+                                   const std::vector<uint8_t>& data) const {
         std::vector<uint8_t> adjustedKey = key;
 
         if (adjustedKey.size() > BLOCK_SIZE) {
@@ -269,278 +1034,820 @@ public:
     }
 };
 
-const uint32_t SecureHashFunction::k[64] = {
-    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-};
+// Multi-block keystream kernels: each vector lane carries the same state word
+// of a different block, so Lanes consecutive counters are computed together.
+// Written with GCC/Clang vector extensions and instantiated per ISA below.
+namespace keystream_kernels {
+
+inline void store32LE(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+// Vector types lose their attributes as template arguments, so round helpers
+// are macros and the lane width picks a specialized vector type
+template <size_t Lanes> struct LaneVector;
+template <> struct LaneVector<1> { typedef uint32_t type; };
+template <> struct LaneVector<4> { typedef uint32_t type __attribute__((vector_size(16))); };
+template <> struct LaneVector<8> { typedef uint32_t type __attribute__((vector_size(32))); };
+template <> struct LaneVector<16> { typedef uint32_t type __attribute__((vector_size(64))); };
+
+#define KS_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define KS_QUARTER_ROUND(a, b, c, d)            \
+    a += b; d ^= a; d = KS_ROTL(d, 16);         \
+    c += d; b ^= c; b = KS_ROTL(b, 12);         \
+    a += b; d ^= a; d = KS_ROTL(d, 8);          \
+    c += d; b ^= c; b = KS_ROTL(b, 7)
+
+template <size_t Lanes>
+inline uint32_t& lane(typename LaneVector<Lanes>::type& v, size_t j) {
+    return reinterpret_cast<uint32_t*>(&v)[j];
+}
+
+template <size_t Lanes>
+inline __attribute__((always_inline)) void chachaBlocks(const uint32_t* state, uint32_t counter,
+                                                        uint8_t* out) {
+    typedef typename LaneVector<Lanes>::type Vec;
+    Vec x[16];
+
+    for (int i = 0; i < 16; ++i) {
+        x[i] = Vec{} + state[i];
+    }
+    for (size_t j = 0; j < Lanes; ++j) {
+        lane<Lanes>(x[12], j) = counter + static_cast<uint32_t>(j);
+    }
+
+    // 20 rounds (10 double rounds)
+    for (int i = 0; i < 10; ++i) {
+        KS_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        KS_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        KS_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        KS_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+
+        KS_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        KS_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        KS_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        KS_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        x[i] += Vec{} + state[i];
+    }
+
+    // Word 12 carries the block counter, matching the scalar engine
+    for (size_t j = 0; j < Lanes; ++j) {
+        lane<Lanes>(x[12], j) = counter + static_cast<uint32_t>(j);
+        for (int i = 0; i < 16; ++i) {
+            store32LE(out + j * 64 + i * 4, lane<Lanes>(x[i], j));
+        }
+    }
+}
+
+#undef KS_QUARTER_ROUND
+#undef KS_ROTL
+
+typedef void (*BlocksFn)(const uint32_t* state, uint32_t counter, uint8_t* out);
+
+struct Kernel {
+    static const size_t MAX_LANES = 16;
+
+    const char* name;
+    size_t lanes;
+    BlocksFn blocks;
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+__attribute__((target("sse2")))
+void blocksSSE2(const uint32_t* state, uint32_t counter, uint8_t* out) {
+    chachaBlocks<4>(state, counter, out);
+}
+
+__attribute__((target("avx2")))
+void blocksAVX2(const uint32_t* state, uint32_t counter, uint8_t* out) {
+    chachaBlocks<8>(state, counter, out);
+}
+
+__attribute__((target("avx512f")))
+void blocksAVX512(const uint32_t* state, uint32_t counter, uint8_t* out) {
+    chachaBlocks<16>(state, counter, out);
+}
+
+inline const Kernel& selectKernel() {
+    static const Kernel kernel = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Kernel{"avx512f", 16, blocksAVX512};
+        if (__builtin_cpu_supports("avx2")) return Kernel{"avx2", 8, blocksAVX2};
+        return Kernel{"sse2", 4, blocksSSE2};
+    }();
+    return kernel;
+}
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__ARM_NEON))
+void blocksNEON(const uint32_t* state, uint32_t counter, uint8_t* out) {
+    chachaBlocks<4>(state, counter, out);
+}
+
+inline const Kernel& selectKernel() {
+    static const Kernel kernel{"neon", 4, blocksNEON};
+    return kernel;
+}
+#else
+void blocksScalar(const uint32_t* state, uint32_t counter, uint8_t* out) {
+    chachaBlocks<1>(state, counter, out);
+}
+
+inline const Kernel& selectKernel() {
+    static const Kernel kernel{"scalar", 1, blocksScalar};
+    return kernel;
+}
+#endif
+
+} // namespace keystream_kernels
+
+class StreamCipherEngine {
+private:
+    uint32_t state[16];
+    uint32_t counter;
+
+public:
+    void initialize(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce) {
+        // Initialize state with constants
+        state[0] = 0x61707865; state[1] = 0x3320646e;
+        state[2] = 0x79622d32; state[3] = 0x6b206574;
+
+        // Load key
+        for (int i = 0; i < 8 && i * 4 < key.size(); ++i) {
+            state[4 + i] = (key[i * 4] << 24) | (key[i * 4 + 1] << 16) |
+                          (key[i * 4 + 2] << 8) | key[i * 4 + 3];
+        }
+
+        // Initialize counter and nonce
+        counter = 0;
+        state[12] = counter;
+
+        for (int i = 0; i < 3 && i * 4 < nonce.size(); ++i) {
+            state[13 + i] = (nonce[i * 4] << 24) | (nonce[i * 4 + 1] << 16) |
+                           (nonce[i * 4 + 2] << 8) | nonce[i * 4 + 3];
+        }
+    }
+
+    static const char* kernelName() {
+        return keystream_kernels::selectKernel().name;
+    }
+
+    // Writes keystream straight into out; a partial last block still consumes a counter
+    void generateKeystream(uint8_t* out, size_t length) {
+        const keystream_kernels::Kernel& kernel = keystream_kernels::selectKernel();
+        const size_t groupBytes = kernel.lanes * 64;
+        uint8_t tail[keystream_kernels::Kernel::MAX_LANES * 64];
+
+        while (length >= groupBytes) {
+            kernel.blocks(state, counter, out);
+            counter += static_cast<uint32_t>(kernel.lanes);
+            out += groupBytes;
+            length -= groupBytes;
+        }
+
+        if (length > 0) {
+            kernel.blocks(state, counter, tail);
+            counter += static_cast<uint32_t>((length + 63) / 64);
+            memcpy(out, tail, length);
+        }
+    }
+
+    std::vector<uint8_t> generateKeystream(size_t length) {
+        std::vector<uint8_t> keystream(length);
+        generateKeystream(keystream.data(), length);
+        return keystream;
+    }
+
+    // Allocation-free; output may alias input for in-place encryption
+    void encryptData(const uint8_t* input, size_t length, uint8_t* output) {
+        const size_t chunkBytes = keystream_kernels::Kernel::MAX_LANES * 64;
+        uint8_t keystream[chunkBytes];
+
+        while (length > 0) {
+            size_t chunk = std::min(length, chunkBytes);
+            generateKeystream(keystream, chunk);
+
+            size_t i = 0;
+            for (; i + 8 <= chunk; i += 8) {
+                uint64_t p, k;
+                memcpy(&p, input + i, 8);
+                memcpy(&k, keystream + i, 8);
+                p ^= k;
+                memcpy(output + i, &p, 8);
+            }
+            for (; i < chunk; ++i) {
+                output[i] = input[i] ^ keystream[i];
+            }
+
+            input += chunk;
+            output += chunk;
+            length -= chunk;
+        }
+    }
+
+    void encryptInPlace(uint8_t* data, size_t length) {
+        encryptData(data, length, data);
+    }
+
+    std::vector<uint8_t> encryptData(const std::vector<uint8_t>& plaintext) {
+        std::vector<uint8_t> ciphertext(plaintext.size());
+        encryptData(plaintext.data(), plaintext.size(), ciphertext.data());
+        return ciphertext;
+    }
+};
+
+class KoreanCipherEngine {
+private:
+    static const int ROUNDS = 16;
+    static const int BLOCK_SIZE = 16;
+
+    uint8_t sbox[256];
+    alignas(64) uint8_t roundKeys[ROUNDS][BLOCK_SIZE];
+
+    void generateSBox() {
+        // Korean standard S-box generation
+        for (int i = 0; i < 256; ++i) {
+            uint8_t val = i;
+            val = ((val << 1) | (val >> 7)) & 0xFF;
+            val ^= 0x63;
+            val = ((val << 4) | (val >> 4)) & 0xFF;
+            sbox[i] = val;
+        }
+    }
+
+    static const int HALF_SIZE = BLOCK_SIZE / 2;
+
+    void feistelFunction(const uint8_t* input, int round, uint8_t* output) const {
+        for (int i = 0; i < HALF_SIZE; ++i) {
+            // XOR with round key, S-box substitution, linear transformation
+            uint8_t temp = sbox[input[i] ^ roundKeys[round][i]];
+            output[i] = ((temp << 3) | (temp >> 5)) & 0xFF;
+        }
+    }
+
+public:
+    KoreanCipherEngine() {
+        generateSBox();
+    }
+
+    void setKey(const std::vector<uint8_t>& key) {
+        // Key schedule generation
+        for (int round = 0; round < ROUNDS; ++round) {
+            for (int i = 0; i < BLOCK_SIZE; ++i) {
+                roundKeys[round][i] = key[(round * BLOCK_SIZE + i) % key.size()];
+
+                // Apply Korean key schedule transformation
+                roundKeys[round][i] ^= (round * 0x7F + i * 0x3D) & 0xFF;
+                roundKeys[round][i] = sbox[roundKeys[round][i]];
+            }
+        }
+    }
+
+    // Output may alias input
+    void encryptBlock(const uint8_t* plaintext, uint8_t* ciphertext) const {
+        uint8_t left[HALF_SIZE], right[HALF_SIZE], fOutput[HALF_SIZE];
+        memcpy(left, plaintext, HALF_SIZE);
+        memcpy(right, plaintext + HALF_SIZE, HALF_SIZE);
+
+        // Feistel network
+        for (int round = 0; round < ROUNDS; ++round) {
+            feistelFunction(right, round, fOutput);
+
+            for (int i = 0; i < HALF_SIZE; ++i) {
+                uint8_t temp = right[i];
+                right[i] = left[i] ^ fOutput[i];
+                left[i] = temp;
+            }
+        }
+
+        memcpy(ciphertext, right, HALF_SIZE);
+        memcpy(ciphertext + HALF_SIZE, left, HALF_SIZE);
+    }
+
+    std::vector<uint8_t> encryptBlock(const std::vector<uint8_t>& plaintext) const {
+        if (plaintext.size() != BLOCK_SIZE) {
+            throw std::invalid_argument("Invalid block size");
+        }
+
+        std::vector<uint8_t> ciphertext(BLOCK_SIZE);
+        encryptBlock(plaintext.data(), ciphertext.data());
+        return ciphertext;
+    }
+
+    // Padding always adds 1..BLOCK_SIZE bytes
+    static size_t encryptedSize(size_t length) {
+        return length + BLOCK_SIZE - (length % BLOCK_SIZE);
+    }
+
+    // Allocation-free; output needs encryptedSize(length) bytes and may alias input
+    size_t encryptData(const uint8_t* input, size_t length, uint8_t* output) const {
+        size_t fullBlocks = length / BLOCK_SIZE;
+
+        for (size_t i = 0; i < fullBlocks * BLOCK_SIZE; i += BLOCK_SIZE) {
+            encryptBlock(input + i, output + i);
+        }
+
+        // Apply padding
+        uint8_t lastBlock[BLOCK_SIZE];
+        size_t remainder = length % BLOCK_SIZE;
+        uint8_t padding = static_cast<uint8_t>(BLOCK_SIZE - remainder);
+        memcpy(lastBlock, input + fullBlocks * BLOCK_SIZE, remainder);
+        memset(lastBlock + remainder, padding, padding);
+        encryptBlock(lastBlock, output + fullBlocks * BLOCK_SIZE);
+
+        return encryptedSize(length);
+    }
+
+    std::vector<uint8_t> encryptData(const std::vector<uint8_t>& data) const {
+        std::vector<uint8_t> encryptedData(encryptedSize(data.size()));
+        encryptData(data.data(), data.size(), encryptedData.data());
+        return encryptedData;
+    }
+};
+
+// Compact numeric connection id; the public string id is "conn_<handle>_<ms>"
+using ConnectionHandle = uint64_t;
+
+// Cipher registry: packets dispatch on the id through an indexed table, and
+// the names are only for parsing configuration
+enum class CipherAlgorithm : uint8_t {
+    Stream,
+    Korean,
+    Asymmetric
+};
+
+struct CipherAlgorithmDescriptor {
+    CipherAlgorithm id;
+    const char* name;
+};
+
+constexpr std::array<CipherAlgorithmDescriptor, 3> CIPHER_ALGORITHMS = {{
+    {CipherAlgorithm::Stream, "stream"},
+    {CipherAlgorithm::Korean, "korean"},
+    {CipherAlgorithm::Asymmetric, "asymmetric"}
+}};
+
+constexpr size_t CIPHER_ALGORITHM_COUNT = CIPHER_ALGORITHMS.size();
+
+constexpr size_t cipherAlgorithmIndex(CipherAlgorithm id) {
+    return static_cast<size_t>(id);
+}
+
+constexpr bool cipherRegistryMatchesIds() {
+    for (size_t i = 0; i < CIPHER_ALGORITHM_COUNT; ++i) {
+        if (cipherAlgorithmIndex(CIPHER_ALGORITHMS[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(cipherRegistryMatchesIds(), "CIPHER_ALGORITHMS must list ids in enum order");
+
+// Accepts the names in CIPHER_ALGORITHMS, for callers that read the cipher from config
+inline CipherAlgorithm parseCipherAlgorithm(const std::string& name) {
+    for (const auto& descriptor : CIPHER_ALGORITHMS) {
+        if (name == descriptor.name) {
+            return descriptor.id;
+        }
+    }
+    throw std::invalid_argument("Unknown encryption algorithm");
+}
+
+// Key-expanded cipher state built once at handshake and owned by one connection
+struct alignas(64) ConnectionCipherContext {
+    StreamCipherEngine streamCipher;
+    KoreanCipherEngine koreanCipher;
+    std::mutex streamMutex;  // keystream counter advances on every packet
+
+    ConnectionCipherContext(const std::vector<uint8_t>& sessionKey,
+                            const std::vector<uint8_t>& nonce) {
+        streamCipher.initialize(sessionKey, nonce);
+        koreanCipher.setKey(sessionKey);
+    }
+};
+
+struct NetworkConnection {
+    ConnectionHandle handle;
+    std::string connectionId;
+    std::string remoteAddress;
+    std::vector<uint8_t> sessionKey;
+    std::shared_ptr<ConnectionCipherContext> cipherContext;
+    std::chrono::system_clock::time_point lastActivity;
+    bool isSecure;
+};
+
+struct SecurityAlert {
+    std::string alertId;
+    std::string severity;
+    std::string LegacyBlockCiphercription;
+    std::chrono::system_clock::time_point timestamp;
+    std::map<std::string, std::string> metadata;
+};
+
+// Fixed-size alert record; over-long fields are truncated so logging never allocates
+struct SecurityEventRecord {
+    static constexpr size_t MAX_METADATA = 4;
 
-class StreamCipherEngine {
-private:
-    uint32_t state[16];
-    uint32_t counter;
+    struct Field {
+        char key[24];
+        char value[72];
+    };
 
-    uint32_t leftRotate(uint32_t value, unsigned int amount) {
-        return (value << amount) | (value >> (32 - amount));
+    uint64_t alertNumber;
+    int64_t timestampMicros;
+    char eventType[40];
+    char severity[16];
+    char description[160];
+    Field metadata[MAX_METADATA];
+    uint8_t metadataCount;
+
+    template <size_t N>
+    static void copyField(char (&destination)[N], std::string_view source) {
+        size_t length = std::min(source.size(), N - 1);
+        std::memcpy(destination, source.data(), length);
+        destination[length] = '\0';
     }
 
-    void quarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
-        a += b; d ^= a; d = leftRotate(d, 16);
-        c += d; b ^= c; b = leftRotate(b, 12);
-        a += b; d ^= a; d = leftRotate(d, 8);
-        c += d; b ^= c; b = leftRotate(b, 7);
+    SecurityAlert toAlert() const {
+        SecurityAlert alert;
+        alert.alertId = "alert_" + std::to_string(alertNumber);
+        alert.severity = severity;
+        alert.LegacyBlockCiphercription = description;
+        alert.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::microseconds(timestampMicros)));
+        for (size_t i = 0; i < metadataCount; ++i) {
+            alert.metadata[metadata[i].key] = metadata[i].value;
+        }
+        alert.metadata["event_type"] = eventType;
+        return alert;
     }
+};
 
-public:
-    void initialize(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce) {
-        // Initialize state with constants
-        state[0] = 0x61707865; state[1] = 0x3320646e;
-        state[2] = 0x79622d32; state[3] = 0x6b206574;
+using EventMetadata = std::initializer_list<std::pair<std::string_view, std::string_view>>;
 
-        // Load key
-        for (int i = 0; i < 8 && i * 4 < key.size(); ++i) {
-            state[4 + i] = (key[i * 4] << 24) | (key[i * 4 + 1] << 16) |
-                          (key[i * 4 + 2] << 8) | key[i * 4 + 3];
+/**
+ * Bounded asynchronous security event log
+ * Producers claim slots of a preallocated MPSC ring with one CAS and never
+ * block; when the ring is full the event is counted as dropped. A drain
+ * thread (or a reader catching up) moves records into a bounded history
+ * and the optional file sink; readers page through history by cursor.
+ */
+class SecurityEventLog {
+public:
+    static constexpr size_t RING_CAPACITY = 1024;
+    static constexpr size_t HISTORY_CAPACITY = 1000;
+    static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+    explicit SecurityEventLog(const std::string& sinkPath = "")
+        : slots(RING_CAPACITY), history(HISTORY_CAPACITY) {
+        for (size_t i = 0; i < RING_CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        if (!sinkPath.empty()) {
+            sink.open(sinkPath, std::ios::app);
+            if (!sink) {
+                throw std::runtime_error("Cannot open security event sink: " + sinkPath);
+            }
         }
+        drainThread = std::thread(&SecurityEventLog::drainLoop, this);
+    }
 
-        // Initialize counter and nonce
-        counter = 0;
-        state[12] = counter;
+    SecurityEventLog(const SecurityEventLog&) = delete;
+    SecurityEventLog& operator=(const SecurityEventLog&) = delete;
 
-        for (int i = 0; i < 3 && i * 4 < nonce.size(); ++i) {
-            state[13 + i] = (nonce[i * 4] << 24) | (nonce[i * 4 + 1] << 16) |
-                           (nonce[i * 4 + 2] << 8) | nonce[i * 4 + 3];
+    ~SecurityEventLog() {
+        {
+            std::lock_guard<std::mutex> lock(drainMutex);
+            stopping = true;
         }
+        wakeup.notify_one();
+        drainThread.join();
     }
 
-    std::vector<uint8_t> generateKeystream(size_t length) {
-        std::vector<uint8_t> keystream;
-        keystream.reserve(length);
-
-        while (keystream.size() < length) {
-            uint32_t workingState[16];
-            memcpy(workingState, state, sizeof(state));
-            workingState[12] = counter++;
-
-            // 20 rounds (10 double rounds)
-            for (int i = 0; i < 10; ++i) {
-                // Column rounds
-                quarterRound(workingState[0], workingState[4], workingState[8], workingState[12]);
-                quarterRound(workingState[1], workingState[5], workingState[9], workingState[13]);
-                quarterRound(workingState[2], workingState[6], workingState[10], workingState[14]);
-                quarterRound(workingState[3], workingState[7], workingState[11], workingState[15]);
-
-                // Diagonal rounds
-                quarterRound(workingState[0], workingState[5], workingState[10], workingState[15]);
-                quarterRound(workingState[1], workingState[6], workingState[11], workingState[12]);
-                quarterRound(workingState[2], workingState[7], workingState[8], workingState[13]);
-                quarterRound(workingState[3], workingState[4], workingState[9], workingState[14]);
-            }
-
-            // Add original state
-            for (int i = 0; i < 16; ++i) {
-                workingState[i] += state[i];
-                if (i == 12) workingState[i] = counter - 1; // Correct counter
-            }
-
-            // Extract bytes
-            for (int i = 0; i < 16 && keystream.size() < length; ++i) {
-                for (int j = 0; j < 4 && keystream.size() < length; ++j) {
-                    keystream.push_back((workingState[i] >> (j * 8)) & 0xFF);
+    bool publish(std::string_view eventType, std::string_view severity,
+                 std::string_view description, EventMetadata metadata) {
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;) {
+            slot = &slots[position & (RING_CAPACITY - 1)];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t lag = static_cast<int64_t>(sequence - position);
+
+            if (lag == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed)) {
+                    break;
                 }
+            } else if (lag < 0) {
+                droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
             }
         }
 
-        return keystream;
-    }
+        SecurityEventRecord& record = slot->record;
+        record.alertNumber = position + 1;
+        record.timestampMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        SecurityEventRecord::copyField(record.eventType, eventType);
+        SecurityEventRecord::copyField(record.severity, severity);
+        SecurityEventRecord::copyField(record.description, description);
+        record.metadataCount = 0;
+        for (const auto& [key, value] : metadata) {
+            if (record.metadataCount == SecurityEventRecord::MAX_METADATA) {
+                break;
+            }
+            SecurityEventRecord::Field& field = record.metadata[record.metadataCount++];
+            SecurityEventRecord::copyField(field.key, key);
+            SecurityEventRecord::copyField(field.value, value);
+        }
+        slot->sequence.store(position + 1, std::memory_order_release);
 
-    std::vector<uint8_t> encryptData(const std::vector<uint8_t>& plaintext) {
-        std::vector<uint8_t> keystream = generateKeystream(plaintext.size());
-        std::vector<uint8_t> ciphertext(plaintext.size());
+        // Wake the drain early under bursts; notify_one never blocks the producer
+        if (position + 1 - dequeuePosition.load(std::memory_order_relaxed) >= RING_CAPACITY / 2) {
+            wakeup.notify_one();
+        }
+        return true;
+    }
 
-        for (size_t i = 0; i < plaintext.size(); ++i) {
-            ciphertext[i] = plaintext[i] ^ keystream[i];
+    /**
+     * Appends retained alerts numbered >= cursor to out and moves cursor past
+     * them. Start from cursor 0; alerts that aged out of history are skipped
+     */
+    void read(uint64_t& cursor, std::vector<SecurityEventRecord>& out) {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainLocked();
+
+        uint64_t oldest = historyEnd > HISTORY_CAPACITY ? historyEnd - HISTORY_CAPACITY + 1 : 1;
+        cursor = std::max(cursor, oldest);
+        for (; cursor <= historyEnd; ++cursor) {
+            out.push_back(history[(cursor - 1) % HISTORY_CAPACITY]);
         }
+    }
 
-        return ciphertext;
+    uint64_t publishedCount() const {
+        return enqueuePosition.load(std::memory_order_relaxed);
     }
-};
 
-class KoreanCipherEngine {
-private:
-    static const int ROUNDS = 16;
-    static const int BLOCK_SIZE = 16;
+    uint64_t droppedCount() const {
+        return droppedEvents.load(std::memory_order_relaxed);
+    }
 
-    uint8_t sbox[256];
-    std::vector<std::vector<uint8_t>> roundKeys;
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence;
+        SecurityEventRecord record;
+    };
 
-    void generateSBox() {
-        // Korean standard S-box generation
-        for (int i = 0; i < 256; ++i) {
-            uint8_t val = i;
-            val = ((val << 1) | (val >> 7)) & 0xFF;
-            val ^= 0x63;
-            val = ((val << 4) | (val >> 4)) & 0xFF;
-            sbox[i] = val;
-        }
-    }
+    std::vector<Slot> slots;
+    alignas(64) std::atomic<uint64_t> enqueuePosition{0};
+    alignas(64) std::atomic<uint64_t> dequeuePosition{0};
+    std::atomic<uint64_t> droppedEvents{0};
+
+    // Consumer side: the drain thread and readers take turns under drainMutex
+    std::mutex drainMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+    std::vector<SecurityEventRecord> history;
+    uint64_t historyEnd = 0;
+    std::ofstream sink;
+    std::thread drainThread;
+
+    void drainLocked() {
+        uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+        bool wrote = false;
+
+        for (;;) {
+            Slot& slot = slots[position & (RING_CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
 
-    std::vector<uint8_t> feistelFunction(const std::vector<uint8_t>& input, int round) {
-        std::vector<uint8_t> output = input;
+            const SecurityEventRecord& record = slot.record;
+            history[(record.alertNumber - 1) % HISTORY_CAPACITY] = record;
+            historyEnd = record.alertNumber;
+            if (sink.is_open()) {
+                writeRecord(record);
+                wrote = true;
+            }
 
-        // XOR with round key
-        for (size_t i = 0; i < output.size() && i < roundKeys[round].size(); ++i) {
-            output[i] ^= roundKeys[round][i];
+            slot.sequence.store(position + RING_CAPACITY, std::memory_order_release);
+            dequeuePosition.store(++position, std::memory_order_relaxed);
         }
 
-        // S-box substitution
-        for (size_t i = 0; i < output.size(); ++i) {
-            output[i] = sbox[output[i]];
+        if (wrote) {
+            sink.flush();
         }
+    }
 
-        // Linear transformation
-        for (size_t i = 0; i < output.size(); ++i) {
-            uint8_t temp = output[i];
-            temp = ((temp << 3) | (temp >> 5)) & 0xFF;
-            output[i] = temp;
+    void writeRecord(const SecurityEventRecord& record) {
+        sink << record.timestampMicros << " alert_" << record.alertNumber << ' '
+             << record.severity << ' ' << record.eventType << " \"" << record.description << '"';
+        for (size_t i = 0; i < record.metadataCount; ++i) {
+            sink << ' ' << record.metadata[i].key << '=' << record.metadata[i].value;
         }
+        sink << '\n';
+    }
 
-        return output;
+    void drainLoop() {
+        std::unique_lock<std::mutex> lock(drainMutex);
+        while (!stopping) {
+            drainLocked();
+            wakeup.wait_for(lock, DRAIN_INTERVAL);
+        }
+        drainLocked();
     }
+};
 
+class ConnectionTable {
 public:
-    KoreanCipherEngine() {
-        generateSBox();
+    static const size_t SHARD_BITS = 6;
+    static const size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+
+    void insert(NetworkConnection connection) {
+        Shard& shard = shardFor(connection.handle);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto result = shard.connections.insert_or_assign(connection.handle, std::move(connection));
+        if (result.second) {
+            connectionCount.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
-    void setKey(const std::vector<uint8_t>& key) {
-        roundKeys.cFastBlockCipherr();
-        roundKeys.resize(ROUNDS);
+    // Runs fn on the connection while only its shard is locked
+    template <typename Fn>
+    bool withConnection(ConnectionHandle handle, Fn&& fn) {
+        Shard& shard = shardFor(handle);
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        // Key schedule generation
-        for (int round = 0; round < ROUNDS; ++round) {
-            roundKeys[round].resize(BLOCK_SIZE);
+        auto it = shard.connections.find(handle);
+        if (it == shard.connections.end()) {
+            return false;
+        }
 
-            for (int i = 0; i < BLOCK_SIZE; ++i) {
-                roundKeys[round][i] = key[(round * BLOCK_SIZE + i) % key.size()];
+        fn(it->second);
+        return true;
+    }
 
-                // Apply Korean key schedule transformation
-                roundKeys[round][i] ^= (round * 0x7F + i * 0x3D) & 0xFF;
-                roundKeys[round][i] = sbox[roundKeys[round][i]];
-            }
+    // Removes the connection if pred accepts it; false if absent or kept
+    template <typename Pred>
+    bool extractIf(ConnectionHandle handle, Pred&& pred, NetworkConnection& removed) {
+        Shard& shard = shardFor(handle);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.connections.find(handle);
+        if (it == shard.connections.end() || !pred(it->second)) {
+            return false;
         }
+
+        removed = std::move(it->second);
+        shard.connections.erase(it);
+        connectionCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
     }
 
-    std::vector<uint8_t> encryptBlock(const std::vector<uint8_t>& plaintext) {
-        if (plaintext.size() != BLOCK_SIZE) {
-            throw std::invalid_argument("Invalid block size");
-        }
+    size_t size() const {
+        return connectionCount.load(std::memory_order_relaxed);
+    }
 
-        std::vector<uint8_t> left(plaintext.begin(), plaintext.begin() + BLOCK_SIZE/2);
-        std::vector<uint8_t> right(plaintext.begin() + BLOCK_SIZE/2, plaintext.end());
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<ConnectionHandle, NetworkConnection> connections;
+    };
 
-        // Feistel network
-        for (int round = 0; round < ROUNDS; ++round) {
-            std::vector<uint8_t> temp = right;
-            std::vector<uint8_t> fOutput = feistelFunction(right, round);
+    // Fibonacci hashing spreads sequential handles evenly across shards
+    Shard& shardFor(ConnectionHandle handle) {
+        return shards[(handle * 0x9E3779B97F4A7C15ULL) >> (64 - SHARD_BITS)];
+    }
 
-            for (size_t i = 0; i < left.size(); ++i) {
-                right[i] = left[i] ^ fOutput[i];
-            }
-            left = temp;
-        }
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<size_t> connectionCount{0};
+};
 
-        std::vector<uint8_t> ciphertext;
-        ciphertext.insert(ciphertext.end(), right.begin(), right.end());
-        ciphertext.insert(ciphertext.end(), left.begin(), left.end());
+/**
+ * Two-level hierarchical timing wheel of connection deadlines
+ * Level 0 has one-second slots covering the next 256 s, level 1 has 256 s
+ * slots covering about 18 hours and cascades into level 0 as each comes
+ * due. Entries are hints: activity never touches the wheel, the expiry
+ * pass re-checks lastActivity and reschedules connections still in use
+ */
+class ConnectionExpiryWheel {
+public:
+    using Clock = std::chrono::system_clock;
 
-        return ciphertext;
+    static constexpr size_t LEVEL_BITS = 8;
+    static constexpr size_t LEVEL_SLOTS = size_t(1) << LEVEL_BITS;
+
+    explicit ConnectionExpiryWheel(Clock::time_point start)
+        : currentTick(toTick(start)) {
+    }
+
+    void schedule(ConnectionHandle handle, Clock::time_point deadline) {
+        std::lock_guard<std::mutex> lock(mutex);
+        place(handle, toTick(deadline));
     }
 
-    std::vector<uint8_t> encryptData(const std::vector<uint8_t>& data) {
-        std::vector<uint8_t> paddedData = data;
+    // Handles whose deadline second has passed, swept one slot per elapsed second
+    std::vector<ConnectionHandle> advance(Clock::time_point now) {
+        std::vector<ConnectionHandle> due;
+        std::lock_guard<std::mutex> lock(mutex);
 
-        // Apply padding
-        int padding = BLOCK_SIZE - (data.size() % BLOCK_SIZE);
-        for (int i = 0; i < padding; ++i) {
-            paddedData.push_back(static_cast<uint8_t>(padding));
+        uint64_t target = toTick(now);
+        while (currentTick < target) {
+            uint64_t next = currentTick + 1;
+            if ((next & (LEVEL_SLOTS - 1)) == 0) {
+                cascade(next >> LEVEL_BITS);
+            }
+            currentTick = next;
+
+            std::vector<ConnectionHandle>& slot = level0[next & (LEVEL_SLOTS - 1)];
+            due.insert(due.end(), slot.begin(), slot.end());
+            slot.clear();
         }
+        return due;
+    }
 
-        std::vector<uint8_t> encryptedData;
+private:
+    struct Entry {
+        ConnectionHandle handle;
+        uint64_t tick;
+    };
 
-        for (size_t i = 0; i < paddedData.size(); i += BLOCK_SIZE) {
-            std::vector<uint8_t> block(paddedData.begin() + i,
-                                     paddedData.begin() + i + BLOCK_SIZE);
-            std::vector<uint8_t> encryptedBlock = encryptBlock(block);
-            encryptedData.insert(encryptedData.end(),
-                               encryptedBlock.begin(), encryptedBlock.end());
-        }
+    std::mutex mutex;
+    uint64_t currentTick;  // last second swept
+    std::array<std::vector<ConnectionHandle>, LEVEL_SLOTS> level0;
+    std::array<std::vector<Entry>, LEVEL_SLOTS> level1;
 
-        return encryptedData;
+    static uint64_t toTick(Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
     }
-};
 
-struct NetworkConnection {
-    std::string connectionId;
-    std::string remoteAddress;
-    std::vector<uint8_t> sessionKey;
-    std::chrono::system_clock::time_point lastActivity;
-    bool isSecure;
-};
+    void place(ConnectionHandle handle, uint64_t tick) {
+        // Overdue deadlines fire on the next sweep; far ones clamp and get rescheduled
+        tick = std::max(tick, currentTick + 1);
+        tick = std::min(tick, currentTick + (LEVEL_SLOTS - 1) * LEVEL_SLOTS);
 
-struct SecurityAlert {
-    std::string alertId;
-    std::string severity;
-    std::string LegacyBlockCiphercription;
-    std::chrono::system_clock::time_point timestamp;
-    std::map<std::string, std::string> metadata;
+        if (tick - currentTick <= LEVEL_SLOTS) {
+            level0[tick & (LEVEL_SLOTS - 1)].push_back(handle);
+        } else {
+            level1[(tick >> LEVEL_BITS) & (LEVEL_SLOTS - 1)].push_back({handle, tick});
+        }
+    }
+
+    void cascade(uint64_t window) {
+        std::vector<Entry> entries;
+        entries.swap(level1[window & (LEVEL_SLOTS - 1)]);
+        for (const Entry& entry : entries) {
+            place(entry.handle, entry.tick);
+        }
+    }
 };
 
 class NetworkInfrastructureMonitor {
 private:
-    std::map<std::string, NetworkConnection> activeConnections;
-    std::vector<SecurityAlert> securityAlerts;
+    static constexpr auto CONNECTION_TIMEOUT = std::chrono::minutes(30);
+    static constexpr auto MONITORING_INTERVAL = std::chrono::seconds(5);
+
+    ConnectionTable activeConnections;
+    ConnectionExpiryWheel expiryWheel;
+    SecurityEventLog eventLog;
     std::unique_ptr<LargeIntegerProcessor> AsymmetricAlgorithmProcessor;
     std::unique_ptr<EllipticCurveCalculator> EllipticOperationProcessor;
     std::unique_ptr<SecureHashFunction> hashFunction;
-    std::unique_ptr<StreamCipherEngine> streamCipher;
-    std::unique_ptr<KoreanCipherEngine> koreanCipher;
-    std::mutex connectionsMutex;
-    std::mutex alertsMutex;
+    std::atomic<ConnectionHandle> nextHandle{0};
 
-    bool monitoringActive;
+    std::atomic<bool> monitoringActive;
     std::thread monitoringThread;
 
 public:
-    NetworkInfrastructureMonitor()
-        : monitoringActive(false),
+    explicit NetworkInfrastructureMonitor(const std::string& alertLogPath = "")
+        : expiryWheel(std::chrono::system_clock::now()),
+          eventLog(alertLogPath),
+          monitoringActive(false),
           AsymmetricAlgorithmProcessor(std::make_unique<LargeIntegerProcessor>()),
           EllipticOperationProcessor(std::make_unique<EllipticCurveCalculator>()),
-          hashFunction(std::make_unique<SecureHashFunction>()),
-          streamCipher(std::make_unique<StreamCipherEngine>()),
-          koreanCipher(std::make_unique<KoreanCipherEngine>()) {
-
-        // Initialize Korean cipher with default key
-        std::vector<uint8_t> defaultKey(32);
-        std::iota(defaultKey.begin(), defaultKey.end(), 1);
-        koreanCipher->setKey(defaultKey);
+          hashFunction(std::make_unique<SecureHashFunction>()) {
     }
 
     ~NetworkInfrastructureMonitor() {
         stopMonitoring();
     }
 
-    bool establishSecureConnection(const std::string& remoteAddress) {
+    bool establishSecureConnection(const std::string& remoteAddress,
+                                   ConnectionHandle* handleOut = nullptr) {
         try {
-            std::lock_guard<std::mutex> lock(connectionsMutex);
-
             // Generate unique connection ID
-            std::string connectionId = generateConnectionId();
+            ConnectionHandle handle = nextHandle.fetch_add(1, std::memory_order_relaxed) + 1;
+            std::string connectionId = generateConnectionId(handle);
 
             // Perform key exchange using Geometric Curve operations
             std::vector<uint8_t> privateKey(32);
@@ -571,22 +1878,36 @@ public:
             keyMaterial.insert(keyMaterial.end(), sharedSecret.begin(), sharedSecret.end());
             std::vector<uint8_t> sessionKey = hashFunction->computeDigest(keyMaterial);
 
+            // Expand stream and Korean cipher keys once for this connection
+            std::vector<uint8_t> nonce(12);
+            for (auto& byte : nonce) {
+                byte = dis(gen);
+            }
+
             // Store connection
             NetworkConnection connection;
+            connection.handle = handle;
             connection.connectionId = connectionId;
             connection.remoteAddress = remoteAddress;
             connection.sessionKey = sessionKey;
+            connection.cipherContext = std::make_shared<ConnectionCipherContext>(sessionKey, nonce);
             connection.lastActivity = std::chrono::system_clock::now();
             connection.isSecure = true;
 
-            activeConnections[connectionId] = connection;
+            expiryWheel.schedule(handle, connection.lastActivity + CONNECTION_TIMEOUT);
+            activeConnections.insert(std::move(connection));
 
-            // Initialize stream cipher with session key
-            std::vector<uint8_t> nonce(12);
-            for (auto& byte : nonce) {
-                byte = dis(gen);
+            // Key strength is fixed at handshake, so it is checked once here
+            if (sessionKey.size() < 32) {
+                logSecurityEvent("WEAK_ENCRYPTION_KEY",
+                               "HIGH",
+                               "Connection using weak encryption key",
+                               {{"connection_id", connectionId}});
+            }
+
+            if (handleOut) {
+                *handleOut = handle;
             }
-            streamCipher->initialize(sessionKey, nonce);
 
             // Log security event
             logSecurityEvent("SECURE_CONNECTION_ESTABLISHED",
@@ -607,65 +1928,105 @@ public:
 
     std::vector<uint8_t> encryptNetworkData(const std::string& connectionId,
                                           const std::vector<uint8_t>& data,
-                                          const std::string& algorithm = "stream") {
-        std::lock_guard<std::mutex> lock(connectionsMutex);
-
-        auto it = activeConnections.find(connectionId);
-        if (it == activeConnections.end()) {
+                                          CipherAlgorithm algorithm = CipherAlgorithm::Stream) {
+        ConnectionHandle handle;
+        if (!parseConnectionId(connectionId, handle)) {
             throw std::runtime_error("Connection not found");
         }
 
-        NetworkConnection& connection = it->second;
-        connection.lastActivity = std::chrono::system_clock::now();
+        return encryptNetworkData(handle, data, algorithm, &connectionId);
+    }
 
-        if (algorithm == "stream") {
-            // Use stream cipher for high-speed encryption
-            return streamCipher->encryptData(data);
-        } else if (algorithm == "korean") {
-            // Use Korean standard cipher
-            koreanCipher->setKey(connection.sessionKey);
-            return koreanCipher->encryptData(data);
-        } else if (algorithm == "asymmetric") {
-            // Use large integer processor for digital signatures
-            std::vector<uint8_t> digest = hashFunction->computeDigest(data);
-            return AsymmetricAlgorithmProcessor->processWithPrivateKey(digest);
-        } else {
+    std::vector<uint8_t> encryptNetworkData(ConnectionHandle handle,
+                                          const std::vector<uint8_t>& data,
+                                          CipherAlgorithm algorithm = CipherAlgorithm::Stream,
+                                          const std::string* expectedId = nullptr) {
+        using Encryptor = std::vector<uint8_t> (NetworkInfrastructureMonitor::*)(
+            ConnectionCipherContext&, const std::vector<uint8_t>&);
+        static constexpr std::array<Encryptor, CIPHER_ALGORITHM_COUNT> encryptors = {{
+            &NetworkInfrastructureMonitor::encryptWith<CipherAlgorithm::Stream>,
+            &NetworkInfrastructureMonitor::encryptWith<CipherAlgorithm::Korean>,
+            &NetworkInfrastructureMonitor::encryptWith<CipherAlgorithm::Asymmetric>
+        }};
+
+        size_t index = cipherAlgorithmIndex(algorithm);
+        if (index >= CIPHER_ALGORITHM_COUNT) {
             throw std::invalid_argument("Unknown encryption algorithm");
         }
+
+        auto cipherContext = acquireCipherContext(handle, expectedId);
+        return (this->*encryptors[index])(*cipherContext, data);
+    }
+
+    // Fast path for callers that fix the algorithm at compile time
+    template <CipherAlgorithm Algorithm>
+    std::vector<uint8_t> encryptNetworkData(ConnectionHandle handle,
+                                          const std::vector<uint8_t>& data,
+                                          const std::string* expectedId = nullptr) {
+        auto cipherContext = acquireCipherContext(handle, expectedId);
+        return encryptWith<Algorithm>(*cipherContext, data);
     }
 
     bool authenticateNetworkMessage(const std::string& connectionId,
                                   const std::vector<uint8_t>& message,
                                   const std::vector<uint8_t>& signature) {
-        std::lock_guard<std::mutex> lock(connectionsMutex);
-
-        auto it = activeConnections.find(connectionId);
-        if (it == activeConnections.end()) {
+        ConnectionHandle handle;
+        if (!parseConnectionId(connectionId, handle)) {
             return false;
         }
 
-        NetworkConnection& connection = it->second;
+        return authenticateNetworkMessage(handle, message, signature, &connectionId);
+    }
+
+    bool authenticateNetworkMessage(ConnectionHandle handle,
+                                  const std::vector<uint8_t>& message,
+                                  const std::vector<uint8_t>& signature,
+                                  const std::string* expectedId = nullptr) {
+        std::vector<uint8_t> sessionKey;
+        std::string connectionId;
+        if (!lookupSessionKey(handle, expectedId, sessionKey, connectionId)) {
+            return false;
+        }
 
         // Compute message digest
         std::vector<uint8_t> messageDigest = hashFunction->computeDigest(message);
 
-        // Verify using Geometric Curve digital signature
-        auto signaturePair = EllipticOperationProcessor->createDigitalSignature(messageDigest, connection.sessionKey);
+        return verifyMessageDigest(messageDigest, signature, sessionKey, connectionId);
+    }
 
-        // Simple signature verification (in real implementation, would be more complex)
-        bool signatureValid = (signature.size() >= 32 &&
-                             signaturePair.first.size() >= 32 &&
-                             std::equal(signature.begin(), signature.begin() + 32,
-                                      signaturePair.first.begin()));
+    /**
+     * Authenticates a batch of messages on one connection. The digests are
+     * computed together, so they can share the eight-lane hash kernel
+     */
+    std::vector<bool> authenticateNetworkMessages(ConnectionHandle handle,
+                                                const std::vector<std::vector<uint8_t>>& messages,
+                                                const std::vector<std::vector<uint8_t>>& signatures) {
+        if (messages.size() != signatures.size()) {
+            throw std::invalid_argument("Each message needs exactly one signature");
+        }
 
-        if (!signatureValid) {
-            logSecurityEvent("MESSAGE_AUTHENTICATION_FAILED",
-                           "WARNING",
-                           "Message authentication failed for connection",
-                           {{"connection_id", connectionId}});
+        std::vector<bool> results(messages.size(), false);
+        std::vector<uint8_t> sessionKey;
+        std::string connectionId;
+        if (!lookupSessionKey(handle, nullptr, sessionKey, connectionId)) {
+            return results;
         }
 
-        return signatureValid;
+        std::vector<const uint8_t*> data(messages.size());
+        std::vector<size_t> lengths(messages.size());
+        for (size_t i = 0; i < messages.size(); ++i) {
+            data[i] = messages[i].data();
+            lengths[i] = messages[i].size();
+        }
+
+        std::vector<SecureHashFunction::Digest> digests(messages.size());
+        hashFunction->computeDigests(data.data(), lengths.data(), messages.size(), digests.data());
+
+        for (size_t i = 0; i < messages.size(); ++i) {
+            std::vector<uint8_t> messageDigest(digests[i].begin(), digests[i].end());
+            results[i] = verifyMessageDigest(messageDigest, signatures[i], sessionKey, connectionId);
+        }
+        return results;
     }
 
     void startMonitoring() {
@@ -675,7 +2036,7 @@ public:
         monitoringThread = std::thread([this]() {
             while (monitoringActive) {
                 performSecurityMonitoring();
-                std::this_thread::sleep_for(std::chrono::seconds(5));
+                std::this_thread::sleep_for(MONITORING_INTERVAL);
             }
         });
 
@@ -702,22 +2063,24 @@ public:
     void performSecurityMonitoring() {
         auto now = std::chrono::system_clock::now();
 
-        std::lock_guard<std::mutex> lock(connectionsMutex);
-
-        // Check for expired connections
-        for (auto it = activeConnections.begin(); it != activeConnections.end();) {
-            auto timeDiff = std::chrono::duration_cast<std::chrono::minutes>(
-                now - it->second.lastActivity).count();
-
-            if (timeDiff > 30) { // 30 minutes timeout
+        // Only connections whose wheel slot came due are examined
+        for (ConnectionHandle handle : expiryWheel.advance(now)) {
+            std::chrono::system_clock::time_point deadline{};
+            NetworkConnection expired;
+            bool removed = activeConnections.extractIf(handle,
+                [now, &deadline](const NetworkConnection& connection) {
+                    deadline = connection.lastActivity + CONNECTION_TIMEOUT;
+                    return deadline <= now;
+                }, expired);
+
+            if (removed) {
                 logSecurityEvent("CONNECTION_TIMEOUT",
                                "WARNING",
                                "Connection timed out and will be removed",
-                               {{"connection_id", it->first},
-                                {"remote_address", it->second.remoteAddress}});
-                it = activeConnections.erase(it);
-            } else {
-                ++it;
+                               {{"connection_id", expired.connectionId},
+                                {"remote_address", expired.remoteAddress}});
+            } else if (deadline != std::chrono::system_clock::time_point{}) {
+                expiryWheel.schedule(handle, deadline);
             }
         }
 
@@ -729,27 +2092,17 @@ public:
     }
 
     void analyzeCryptographicSecurity() {
-        // Simulate cryptographic security analysis
-        for (const auto& [connectionId, connection] : activeConnections) {
-            // Check key strength
-            if (connection.sessionKey.size() < 32) {
-                logSecurityEvent("WEAK_ENCRYPTION_KEY",
-                               "HIGH",
-                               "Connection using weak encryption key",
-                               {{"connection_id", connectionId}});
-            }
-
-            // Verify integrity of cryptographic operations
-            std::vector<uint8_t> testData = {0x01, 0x02, 0x03, 0x04};
-            std::vector<uint8_t> hash1 = hashFunction->computeDigest(testData);
-            std::vector<uint8_t> hash2 = hashFunction->computeDigest(testData);
-
-            if (hash1 != hash2) {
-                logSecurityEvent("HASH_FUNCTION_INTEGRITY_FAILURE",
-                               "CRITICAL",
-                               "Hash function integrity check failed",
-                               {{"connection_id", connectionId}});
-            }
+        // Verify integrity of cryptographic operations; the check does not
+        // depend on any connection, so it runs once per interval
+        const uint8_t testData[] = {0x01, 0x02, 0x03, 0x04};
+        SecureHashFunction::Digest hash1 = hashFunction->computeDigest(testData, sizeof(testData));
+        SecureHashFunction::Digest hash2 = hashFunction->computeDigest(testData, sizeof(testData));
+
+        if (hash1 != hash2) {
+            logSecurityEvent("HASH_FUNCTION_INTEGRITY_FAILURE",
+                           "CRITICAL",
+                           "Hash function integrity check failed",
+                           {});
         }
     }
 
@@ -768,34 +2121,36 @@ public:
     }
 
     std::vector<SecurityAlert> getSecurityAlerts(const std::string& severity = "") {
-        std::lock_guard<std::mutex> lock(alertsMutex);
+        uint64_t cursor = 0;
+        return getSecurityAlertsSince(cursor, severity);
+    }
 
-        if (severity.empty()) {
-            return securityAlerts;
+    // Alerts logged since cursor (start at 0); cursor moves past the last one returned
+    std::vector<SecurityAlert> getSecurityAlertsSince(uint64_t& cursor,
+                                                      const std::string& severity = "") {
+        std::vector<SecurityEventRecord> records;
+        eventLog.read(cursor, records);
+
+        std::vector<SecurityAlert> alerts;
+        alerts.reserve(records.size());
+        for (const auto& record : records) {
+            if (severity.empty() || severity == record.severity) {
+                alerts.push_back(record.toAlert());
+            }
         }
-
-        std::vector<SecurityAlert> filteredAlerts;
-        std::copy_if(securityAlerts.begin(), securityAlerts.end(),
-                    std::back_inserter(filteredAlerts),
-                    [&severity](const SecurityAlert& alert) {
-                        return alert.severity == severity;
-                    });
-
-        return filteredAlerts;
+        return alerts;
     }
 
     size_t getActiveConnectionCount() const {
-        std::lock_guard<std::mutex> lock(connectionsMutex);
         return activeConnections.size();
     }
 
     std::map<std::string, std::string> getSystemStatus() {
-        std::lock_guard<std::mutex> lock(connectionsMutex);
-
         return {
             {"active_connections", std::to_string(activeConnections.size())},
             {"monitoring_status", monitoringActive ? "active" : "inactive"},
-            {"total_alerts", std::to_string(securityAlerts.size())},
+            {"total_alerts", std::to_string(eventLog.publishedCount())},
+            {"dropped_alerts", std::to_string(eventLog.droppedCount())},
             {"pk_crypto_processor_status", "operational"},
             {"EllipticOperationprocessor_status", "operational"},
             {"hash_function_status", "operational"},
@@ -805,33 +2160,109 @@ public:
     }
 
 private:
-    std::string generateConnectionId() {
-        static int counter = 0;
-        return "conn_" + std::to_string(++counter) + "_" +
+    std::string generateConnectionId(ConnectionHandle handle) {
+        return "conn_" + std::to_string(handle) + "_" +
                std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
                    std::chrono::system_clock::now().time_since_epoch()).count());
     }
 
-    void logSecurityEvent(const std::string& eventType,
-                         const std::string& severity,
-                         const std::string& LegacyBlockCiphercription,
-                         const std::map<std::string, std::string>& metadata) {
-        std::lock_guard<std::mutex> lock(alertsMutex);
+    // Copies the session key and id of handle; false if absent, mismatched or keyless
+    bool lookupSessionKey(ConnectionHandle handle, const std::string* expectedId,
+                          std::vector<uint8_t>& sessionKey, std::string& connectionId) {
+        bool found = activeConnections.withConnection(handle, [&](const NetworkConnection& connection) {
+            if (expectedId && connection.connectionId != *expectedId) {
+                return;
+            }
+            sessionKey = connection.sessionKey;
+            connectionId = connection.connectionId;
+        });
 
-        SecurityAlert alert;
-        alert.alertId = "alert_" + std::to_string(securityAlerts.size() + 1);
-        alert.severity = severity;
-        alert.LegacyBlockCiphercription = LegacyBlockCiphercription;
-        alert.timestamp = std::chrono::system_clock::now();
-        alert.metadata = metadata;
-        alert.metadata["event_type"] = eventType;
+        return found && !sessionKey.empty();
+    }
+
+    // Checks signature against the curve signature of messageDigest, logging failures
+    bool verifyMessageDigest(const std::vector<uint8_t>& messageDigest,
+                             const std::vector<uint8_t>& signature,
+                             const std::vector<uint8_t>& sessionKey,
+                             const std::string& connectionId) {
+        // Verify using Geometric Curve digital signature
+        auto signaturePair = EllipticOperationProcessor->createDigitalSignature(messageDigest, sessionKey);
+
+        // Simple signature verification (in real implementation, would be more complex)
+        bool signatureValid = (signature.size() >= 32 &&
+                             signaturePair.first.size() >= 32 &&
+                             std::equal(signature.begin(), signature.begin() + 32,
+                                      signaturePair.first.begin()));
+
+        if (!signatureValid) {
+            logSecurityEvent("MESSAGE_AUTHENTICATION_FAILED",
+                           "WARNING",
+                           "Message authentication failed for connection",
+                           {{"connection_id", connectionId}});
+        }
+
+        return signatureValid;
+    }
+
+    // Shared cipher state of handle, touching its activity; throws if absent or mismatched
+    std::shared_ptr<ConnectionCipherContext> acquireCipherContext(ConnectionHandle handle,
+                                                                  const std::string* expectedId) {
+        std::shared_ptr<ConnectionCipherContext> cipherContext;
+        bool found = activeConnections.withConnection(handle, [&](NetworkConnection& connection) {
+            if (expectedId && connection.connectionId != *expectedId) {
+                return;
+            }
+            connection.lastActivity = std::chrono::system_clock::now();
+            cipherContext = connection.cipherContext;
+        });
+
+        if (!found || !cipherContext) {
+            throw std::runtime_error("Connection not found");
+        }
+        return cipherContext;
+    }
+
+    template <CipherAlgorithm Algorithm>
+    std::vector<uint8_t> encryptWith(ConnectionCipherContext& cipherContext,
+                                     const std::vector<uint8_t>& data) {
+        if constexpr (Algorithm == CipherAlgorithm::Stream) {
+            // Use stream cipher for high-speed encryption
+            std::lock_guard<std::mutex> lock(cipherContext.streamMutex);
+            return cipherContext.streamCipher.encryptData(data);
+        } else if constexpr (Algorithm == CipherAlgorithm::Korean) {
+            // Use Korean standard cipher, keyed at handshake
+            return cipherContext.koreanCipher.encryptData(data);
+        } else {
+            static_assert(Algorithm == CipherAlgorithm::Asymmetric, "Unregistered cipher algorithm");
+            // Use large integer processor for digital signatures
+            std::vector<uint8_t> digest = hashFunction->computeDigest(data);
+            return AsymmetricAlgorithmProcessor->processWithPrivateKey(digest);
+        }
+    }
 
-        securityAlerts.push_back(alert);
+    // Recovers the compact handle from "conn_<handle>_<ms>" without a table lookup
+    static bool parseConnectionId(const std::string& connectionId, ConnectionHandle& handle) {
+        static const char prefix[] = "conn_";
+        const size_t prefixLength = sizeof(prefix) - 1;
 
-        // Keep only last 1000 alerts
-        if (securityAlerts.size() > 1000) {
-            securityAlerts.erase(securityAlerts.begin());
+        if (connectionId.compare(0, prefixLength, prefix) != 0) {
+            return false;
         }
+
+        const char* first = connectionId.data() + prefixLength;
+        const char* last = connectionId.data() + connectionId.size();
+        auto result = std::from_chars(first, last, handle);
+
+        return result.ec == std::errc() && result.ptr != first &&
+               result.ptr != last && *result.ptr == '_';
+    }
+
+    // Never blocks: the record is copied into the event ring or counted as dropped
+    void logSecurityEvent(std::string_view eventType,
+                         std::string_view severity,
+                         std::string_view LegacyBlockCiphercription,
+                         EventMetadata metadata) {
+        eventLog.publish(eventType, severity, LegacyBlockCiphercription, metadata);
     }
 };
 
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define STATE_SIZE 256
+#define KEYSTREAM_CHUNK 64
+#define RC4_INTERLEAVE 4
 
 typedef struct {
     uint8_t state[STATE_SIZE];
@@ -40,18 +43,164 @@ uint8_t rc4_generate_byte(rc4_ctx_t *ctx) {
     return k;
 }
 
+static void xor_bytes(uint8_t *output, const uint8_t *input,
+                      const uint8_t *keystream, size_t length) {
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, input + i, 8);
+        memcpy(&b, keystream + i, 8);
+        a ^= b;
+        memcpy(output + i, &a, 8);
+    }
+
+    for (; i < length; i++) {
+        output[i] = input[i] ^ keystream[i];
+    }
+}
+
+/*
+ * One PRGA step on S with the indices held in locals i and j. si carries
+ * S[i + 1] between steps: it is loaded before the swap and patched when the
+ * swap wrote that slot, so the next j update does not wait on the stores.
+ */
+#define RC4_STEP(S, i, j, si, out) do {                                       \
+    uint8_t si_ = (si), sj_, next_;                                           \
+    (i)++;                                                                    \
+    (j) += si_;                                                               \
+    sj_ = (S)[j];                                                             \
+    next_ = (S)[(uint8_t)((i) + 1)];                                          \
+    (S)[i] = sj_;                                                             \
+    (S)[j] = si_;                                                             \
+    (out) = (S)[(uint8_t)(si_ + sj_)];                                        \
+    (si) = (uint8_t)((i) + 1) == (j) ? si_ : next_;                           \
+} while (0)
+
+/* Same output as length calls to rc4_generate_byte, eight steps per iteration */
+void rc4_keystream(rc4_ctx_t *ctx, uint8_t *output, size_t length) {
+    uint8_t *S = ctx->state;
+    uint8_t i = ctx->i, j = ctx->j;
+    uint8_t si = S[(uint8_t)(i + 1)];
+    size_t n = 0;
+
+    for (; n + 8 <= length; n += 8) {
+        uint8_t k0, k1, k2, k3, k4, k5, k6, k7;
+
+        RC4_STEP(S, i, j, si, k0);
+        RC4_STEP(S, i, j, si, k1);
+        RC4_STEP(S, i, j, si, k2);
+        RC4_STEP(S, i, j, si, k3);
+        RC4_STEP(S, i, j, si, k4);
+        RC4_STEP(S, i, j, si, k5);
+        RC4_STEP(S, i, j, si, k6);
+        RC4_STEP(S, i, j, si, k7);
+
+        output[n] = k0;
+        output[n + 1] = k1;
+        output[n + 2] = k2;
+        output[n + 3] = k3;
+        output[n + 4] = k4;
+        output[n + 5] = k5;
+        output[n + 6] = k6;
+        output[n + 7] = k7;
+    }
+    for (; n < length; n++) {
+        RC4_STEP(S, i, j, si, output[n]);
+    }
+
+    ctx->i = i;
+    ctx->j = j;
+}
+
 void rc4_crypt(rc4_ctx_t *ctx, const uint8_t *input, uint8_t *output, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        uint8_t keystream_byte = rc4_generate_byte(ctx);
-        output[i] = input[i] ^ keystream_byte;
+    uint8_t keystream[KEYSTREAM_CHUNK];
+
+    while (length > 0) {
+        size_t n = length < KEYSTREAM_CHUNK ? length : KEYSTREAM_CHUNK;
+
+        rc4_keystream(ctx, keystream, n);
+        xor_bytes(output, input, keystream, n);
+        input += n;
+        output += n;
+        length -= n;
+    }
+}
+
+/*
+ * Runs up to RC4_INTERLEAVE independent streams through one loop. Each
+ * stream's i/j chain is serial, so stepping several side by side lets
+ * their table loads overlap. The contexts must all be distinct.
+ */
+static inline void rc4_crypt_lanes(rc4_ctx_t *const *ctx, const uint8_t *const *input,
+                                   uint8_t *const *output, size_t length, size_t lanes) {
+    uint8_t *S[RC4_INTERLEAVE];
+    uint8_t i[RC4_INTERLEAVE], j[RC4_INTERLEAVE], si[RC4_INTERLEAVE];
+    uint8_t keystream[RC4_INTERLEAVE][KEYSTREAM_CHUNK];
+
+    for (size_t l = 0; l < lanes; l++) {
+        S[l] = ctx[l]->state;
+        i[l] = ctx[l]->i;
+        j[l] = ctx[l]->j;
+        si[l] = S[l][(uint8_t)(i[l] + 1)];
+    }
+
+    for (size_t done = 0; done < length;) {
+        size_t n = length - done < KEYSTREAM_CHUNK ? length - done : KEYSTREAM_CHUNK;
+
+        for (size_t k = 0; k < n; k++) {
+            for (size_t l = 0; l < lanes; l++) {
+                RC4_STEP(S[l], i[l], j[l], si[l], keystream[l][k]);
+            }
+        }
+        for (size_t l = 0; l < lanes; l++) {
+            xor_bytes(output[l] + done, input[l] + done, keystream[l], n);
+        }
+        done += n;
+    }
+
+    for (size_t l = 0; l < lanes; l++) {
+        ctx[l]->i = i[l];
+        ctx[l]->j = j[l];
+    }
+}
+
+/* Encrypts streams[k] with ctx[k]; equivalent to calling rc4_crypt on each */
+void rc4_crypt_interleaved(rc4_ctx_t *const *ctx, const uint8_t *const *input,
+                           uint8_t *const *output, const size_t *length, size_t streams) {
+    for (size_t first = 0; first < streams; first += RC4_INTERLEAVE) {
+        size_t lanes = streams - first < RC4_INTERLEAVE ? streams - first : RC4_INTERLEAVE;
+        size_t common = length[first];
+
+        for (size_t l = 1; l < lanes; l++) {
+            if (length[first + l] < common) {
+                common = length[first + l];
+            }
+        }
+
+        if (lanes == RC4_INTERLEAVE) {
+            rc4_crypt_lanes(ctx + first, input + first, output + first, common, RC4_INTERLEAVE);
+        } else {
+            rc4_crypt_lanes(ctx + first, input + first, output + first, common, lanes);
+        }
+
+        for (size_t l = 0; l < lanes; l++) {
+            size_t k = first + l;
+            rc4_crypt(ctx[k], input[k] + common, output[k] + common, length[k] - common);
+        }
     }
 }
 
 void rc4_drop_init(rc4_ctx_t *ctx, const uint8_t *key, size_t key_length, int drop_bytes) {
+    uint8_t discard[KEYSTREAM_CHUNK];
+
     rc4_init(ctx, key, key_length);
 
-    for (int i = 0; i < drop_bytes; i++) {
-        rc4_generate_byte(ctx);
+    while (drop_bytes > 0) {
+        int n = drop_bytes < KEYSTREAM_CHUNK ? drop_bytes : KEYSTREAM_CHUNK;
+
+        rc4_keystream(ctx, discard, (size_t)n);
+        drop_bytes -= n;
     }
 }
 
@@ -116,14 +265,6 @@ static void spritz_absorb(spritz_ctx_t *ctx, const uint8_t *data, size_t length)
     }
 }
 
-static uint8_t spritz_drip(spritz_ctx_t *ctx) {
-    if (ctx->a > 0) {
-        spritz_shuffle(ctx);
-    }
-    spritz_update(ctx);
-    return ctx->state[(ctx->j + ctx->state[(ctx->i + ctx->state[(ctx->z + ctx->k) % STATE_SIZE]) % STATE_SIZE]) % STATE_SIZE];
-}
-
 void spritz_init(spritz_ctx_t *ctx, const uint8_t *key, size_t key_length) {
     
     for (int i = 0; i < STATE_SIZE; i++) {
@@ -135,15 +276,80 @@ void spritz_init(spritz_ctx_t *ctx, const uint8_t *key, size_t key_length) {
     spritz_absorb(ctx, key, key_length);
 }
 
+/* spritz_update followed by the drip output, on locals */
+#define SPRITZ_STEP(S, i, j, k, z, w, out) do {                               \
+    uint8_t t_;                                                               \
+    (i) += (w);                                                               \
+    (j) = (k) + (S)[(uint8_t)((j) + (S)[i])];                                 \
+    (k) = (i) + (k) + (S)[j];                                                 \
+    t_ = (S)[i];                                                              \
+    (S)[i] = (S)[j];                                                          \
+    (S)[j] = t_;                                                              \
+    (out) = (S)[(uint8_t)((j) + (S)[(uint8_t)((i) + (S)[(uint8_t)((z) + (k))])])]; \
+} while (0)
+
+/* Drips length bytes, shuffling first if input has been absorbed */
+void spritz_keystream(spritz_ctx_t *ctx, uint8_t *output, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    if (ctx->a > 0) {
+        spritz_shuffle(ctx);
+    }
+
+    uint8_t *S = ctx->state;
+    uint8_t i = ctx->i, j = ctx->j, k = ctx->k;
+    const uint8_t z = ctx->z, w = ctx->w;
+    size_t n = 0;
+
+    for (; n + 8 <= length; n += 8) {
+        uint8_t k0, k1, k2, k3, k4, k5, k6, k7;
+
+        SPRITZ_STEP(S, i, j, k, z, w, k0);
+        SPRITZ_STEP(S, i, j, k, z, w, k1);
+        SPRITZ_STEP(S, i, j, k, z, w, k2);
+        SPRITZ_STEP(S, i, j, k, z, w, k3);
+        SPRITZ_STEP(S, i, j, k, z, w, k4);
+        SPRITZ_STEP(S, i, j, k, z, w, k5);
+        SPRITZ_STEP(S, i, j, k, z, w, k6);
+        SPRITZ_STEP(S, i, j, k, z, w, k7);
+
+        output[n] = k0;
+        output[n + 1] = k1;
+        output[n + 2] = k2;
+        output[n + 3] = k3;
+        output[n + 4] = k4;
+        output[n + 5] = k5;
+        output[n + 6] = k6;
+        output[n + 7] = k7;
+    }
+    for (; n < length; n++) {
+        SPRITZ_STEP(S, i, j, k, z, w, output[n]);
+    }
+
+    ctx->i = i;
+    ctx->j = j;
+    ctx->k = k;
+}
+
 void spritz_crypt(spritz_ctx_t *ctx, const uint8_t *input, uint8_t *output, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        output[i] = input[i] ^ spritz_drip(ctx);
+    uint8_t keystream[KEYSTREAM_CHUNK];
+
+    while (length > 0) {
+        size_t n = length < KEYSTREAM_CHUNK ? length : KEYSTREAM_CHUNK;
+
+        spritz_keystream(ctx, keystream, n);
+        xor_bytes(output, input, keystream, n);
+        input += n;
+        output += n;
+        length -= n;
     }
 }
 
 typedef struct {
     uint8_t P[STATE_SIZE];
     uint8_t s;
+    uint8_t n;
 } vmpc_ctx_t;
 
 void vmpc_init(vmpc_ctx_t *ctx, const uint8_t *key, size_t key_length, const uint8_t *iv, size_t iv_length) {
@@ -152,6 +358,7 @@ void vmpc_init(vmpc_ctx_t *ctx, const uint8_t *key, size_t key_length, const uin
         ctx->P[i] = i;
     }
     ctx->s = 0;
+    ctx->n = 0;
 
     for (int m = 0; m < 768; m++) {
         ctx->s = ctx->P[(ctx->s + ctx->P[m % STATE_SIZE] + key[m % key_length]) % STATE_SIZE];
@@ -169,7 +376,7 @@ void vmpc_init(vmpc_ctx_t *ctx, const uint8_t *key, size_t key_length, const uin
 }
 
 uint8_t vmpc_generate_byte(vmpc_ctx_t *ctx) {
-    static uint8_t n = 0;
+    uint8_t n = ctx->n;
 
     ctx->s = ctx->P[(ctx->s + ctx->P[n]) % STATE_SIZE];
     uint8_t output = ctx->P[(ctx->P[ctx->P[ctx->s]] + 1) % STATE_SIZE];
@@ -178,42 +385,154 @@ uint8_t vmpc_generate_byte(vmpc_ctx_t *ctx) {
     ctx->P[n] = ctx->P[ctx->s];
     ctx->P[ctx->s] = temp;
 
-    n = (n + 1) % STATE_SIZE;
+    ctx->n = (n + 1) % STATE_SIZE;
     return output;
 }
 
+/* As RC4_STEP, pn carries P[n] between steps so s never waits on the swap */
+#define VMPC_STEP(P, s, n, pn, out) do {                                      \
+    uint8_t pn_ = (pn), ps_, next_;                                           \
+    (s) = (P)[(uint8_t)((s) + pn_)];                                          \
+    next_ = (P)[(uint8_t)((n) + 1)];                                          \
+    ps_ = (P)[s];                                                             \
+    (out) = (P)[(uint8_t)((P)[ps_] + 1)];                                     \
+    (P)[n] = ps_;                                                             \
+    (P)[s] = pn_;                                                             \
+    (n)++;                                                                    \
+    (pn) = (s) == (n) ? pn_ : next_;                                          \
+} while (0)
+
+/* Same output as length calls to vmpc_generate_byte */
+void vmpc_keystream(vmpc_ctx_t *ctx, uint8_t *output, size_t length) {
+    uint8_t *P = ctx->P;
+    uint8_t s = ctx->s, n = ctx->n;
+    uint8_t pn = P[n];
+    size_t m = 0;
+
+    for (; m + 8 <= length; m += 8) {
+        uint8_t k0, k1, k2, k3, k4, k5, k6, k7;
+
+        VMPC_STEP(P, s, n, pn, k0);
+        VMPC_STEP(P, s, n, pn, k1);
+        VMPC_STEP(P, s, n, pn, k2);
+        VMPC_STEP(P, s, n, pn, k3);
+        VMPC_STEP(P, s, n, pn, k4);
+        VMPC_STEP(P, s, n, pn, k5);
+        VMPC_STEP(P, s, n, pn, k6);
+        VMPC_STEP(P, s, n, pn, k7);
+
+        output[m] = k0;
+        output[m + 1] = k1;
+        output[m + 2] = k2;
+        output[m + 3] = k3;
+        output[m + 4] = k4;
+        output[m + 5] = k5;
+        output[m + 6] = k6;
+        output[m + 7] = k7;
+    }
+    for (; m < length; m++) {
+        VMPC_STEP(P, s, n, pn, output[m]);
+    }
+
+    ctx->s = s;
+    ctx->n = n;
+}
+
 void vmpc_crypt(vmpc_ctx_t *ctx, const uint8_t *input, uint8_t *output, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        output[i] = input[i] ^ vmpc_generate_byte(ctx);
+    uint8_t keystream[KEYSTREAM_CHUNK];
+
+    while (length > 0) {
+        size_t n = length < KEYSTREAM_CHUNK ? length : KEYSTREAM_CHUNK;
+
+        vmpc_keystream(ctx, keystream, n);
+        xor_bytes(output, input, keystream, n);
+        input += n;
+        output += n;
+        length -= n;
     }
 }
 
-int stream_generator_process(const uint8_t *input, uint8_t *output, size_t length,
-                           const uint8_t *key, size_t key_length, int vKoreanAdvancedCiphernt) {
+/*
+ * Keyed state for one key and variant, captured after the key schedule (and
+ * for the drop variant, after the discarded bytes). Each message starts
+ * from a copy, so the handle itself is never modified.
+ */
+typedef struct {
+    int vKoreanAdvancedCiphernt;
+    union {
+        rc4_ctx_t rc4;
+        spritz_ctx_t spritz;
+        vmpc_ctx_t vmpc;
+    } keyed;
+} stream_generator_ctx_t;
+
+static int stream_generator_set_key(stream_generator_ctx_t *ctx, const uint8_t *key,
+                                    size_t key_length, int vKoreanAdvancedCiphernt) {
+    ctx->vKoreanAdvancedCiphernt = vKoreanAdvancedCiphernt;
+
     switch (vKoreanAdvancedCiphernt) {
-        case 0: { 
-            rc4_ctx_t ctx;
-            rc4_init(&ctx, key, key_length);
-            rc4_crypt(&ctx, input, output, length);
+        case 0:
+            rc4_init(&ctx->keyed.rc4, key, key_length);
+            break;
+        case 1:
+            rc4_drop_init(&ctx->keyed.rc4, key, key_length, 3072);
+            break;
+        case 2:
+            spritz_init(&ctx->keyed.spritz, key, key_length);
+            break;
+        case 3: {
+            uint8_t iv[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+            vmpc_init(&ctx->keyed.vmpc, key, key_length, iv, 8);
             break;
         }
-        case 1: { 
-            rc4_ctx_t ctx;
-            rc4_drop_init(&ctx, key, key_length, 3072);
-            rc4_crypt(&ctx, input, output, length);
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+stream_generator_ctx_t *stream_generator_create(const uint8_t *key, size_t key_length,
+                                                int vKoreanAdvancedCiphernt) {
+    stream_generator_ctx_t *ctx = malloc(sizeof(*ctx));
+
+    if (ctx == NULL) {
+        return NULL;
+    }
+    if (stream_generator_set_key(ctx, key, key_length, vKoreanAdvancedCiphernt) != 0) {
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+void stream_generator_destroy(stream_generator_ctx_t *ctx) {
+    if (ctx != NULL) {
+        memset(ctx, 0, sizeof(*ctx));
+        free(ctx);
+    }
+}
+
+int stream_generator_process_with_ctx(const stream_generator_ctx_t *ctx, const uint8_t *input,
+                                      uint8_t *output, size_t length) {
+    if (ctx == NULL) {
+        return -1;
+    }
+
+    switch (ctx->vKoreanAdvancedCiphernt) {
+        case 0:
+        case 1: {
+            rc4_ctx_t rc4 = ctx->keyed.rc4;
+            rc4_crypt(&rc4, input, output, length);
             break;
         }
-        case 2: { 
-            spritz_ctx_t ctx;
-            spritz_init(&ctx, key, key_length);
-            spritz_crypt(&ctx, input, output, length);
+        case 2: {
+            spritz_ctx_t spritz = ctx->keyed.spritz;
+            spritz_crypt(&spritz, input, output, length);
             break;
         }
-        case 3: { 
-            vmpc_ctx_t ctx;
-            uint8_t iv[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
-            vmpc_init(&ctx, key, key_length, iv, 8);
-            vmpc_crypt(&ctx, input, output, length);
+        case 3: {
+            vmpc_ctx_t vmpc = ctx->keyed.vmpc;
+            vmpc_crypt(&vmpc, input, output, length);
             break;
         }
         default:
@@ -222,6 +541,16 @@ int stream_generator_process(const uint8_t *input, uint8_t *output, size_t lengt
     return 0;
 }
 
+int stream_generator_process(const uint8_t *input, uint8_t *output, size_t length,
+                           const uint8_t *key, size_t key_length, int vKoreanAdvancedCiphernt) {
+    stream_generator_ctx_t ctx;
+
+    if (stream_generator_set_key(&ctx, key, key_length, vKoreanAdvancedCiphernt) != 0) {
+        return -1;
+    }
+    return stream_generator_process_with_ctx(&ctx, input, output, length);
+}
+
 int main() {
     uint8_t key[] = "SecretStreamKey";
     uint8_t plaintext[] = "This is a test message for stream ciphers!";
@@ -1,9 +1,17 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define ROUNDS 20
 #define BLOCK_SIZE 64
+#define MAX_KERNEL_LANES 16
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STREAM_KERNEL_X86 1
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__ARM_NEON))
+#define STREAM_KERNEL_NEON 1
+#endif
 
 typedef struct {
     uint32_t input[16];
@@ -44,6 +52,19 @@ static void salsa_core(uint32_t *output, const uint32_t *input) {
     }
 }
 
+/* Loads a new nonce and rewinds the block counter; the key words are kept */
+static void salsa_set_nonce(salsa_ctx_t *ctx, const uint8_t *nonce) {
+    ctx->input[6] = ((uint32_t)nonce[3] << 24) | ((uint32_t)nonce[2] << 16) |
+                    ((uint32_t)nonce[1] << 8) | nonce[0];
+    ctx->input[7] = ((uint32_t)nonce[7] << 24) | ((uint32_t)nonce[6] << 16) |
+                    ((uint32_t)nonce[5] << 8) | nonce[4];
+
+    ctx->input[8] = 0;
+    ctx->input[9] = 0;
+
+    ctx->keystream_pos = BLOCK_SIZE; 
+}
+
 void salsa_init(salsa_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce) {
     const uint8_t *constants = (const uint8_t *)"expand 32-byte k";
 
@@ -62,48 +83,7 @@ void salsa_init(salsa_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce) {
                          ((uint32_t)key[i*4+1] << 8) | key[i*4];
     }
 
-    ctx->input[6] = ((uint32_t)nonce[3] << 24) | ((uint32_t)nonce[2] << 16) |
-                    ((uint32_t)nonce[1] << 8) | nonce[0];
-    ctx->input[7] = ((uint32_t)nonce[7] << 24) | ((uint32_t)nonce[6] << 16) |
-                    ((uint32_t)nonce[5] << 8) | nonce[4];
-
-    ctx->input[8] = 0;
-    ctx->input[9] = 0;
-
-    ctx->keystream_pos = BLOCK_SIZE; 
-}
-
-static void generate_keystream_block(salsa_ctx_t *ctx) {
-    uint32_t output[16];
-
-    salsa_core(output, ctx->input);
-
-    for (int i = 0; i < 16; i++) {
-        ctx->keystream[i*4] = output[i] & 0xFF;
-        ctx->keystream[i*4+1] = (output[i] >> 8) & 0xFF;
-        ctx->keystream[i*4+2] = (output[i] >> 16) & 0xFF;
-        ctx->keystream[i*4+3] = (output[i] >> 24) & 0xFF;
-    }
-
-    ctx->input[8]++;
-    if (ctx->input[8] == 0) {
-        ctx->input[9]++;
-    }
-
-    ctx->keystream_pos = 0;
-}
-
-void salsa_encrypt_decrypt(salsa_ctx_t *ctx, const uint8_t *input,
-                          uint8_t *output, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        
-        if (ctx->keystream_pos >= BLOCK_SIZE) {
-            generate_keystream_block(ctx);
-        }
-
-        output[i] = input[i] ^ ctx->keystream[ctx->keystream_pos];
-        ctx->keystream_pos++;
-    }
+    salsa_set_nonce(ctx, nonce);
 }
 
 static void chacha_quarter_round(uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d) {
@@ -138,6 +118,18 @@ static void chacha_core(uint32_t *output, const uint32_t *input) {
     }
 }
 
+static void chacha_set_nonce(salsa_ctx_t *ctx, const uint8_t *nonce) {
+    ctx->input[12] = 0; 
+    ctx->input[13] = ((uint32_t)nonce[3] << 24) | ((uint32_t)nonce[2] << 16) |
+                     ((uint32_t)nonce[1] << 8) | nonce[0];
+    ctx->input[14] = ((uint32_t)nonce[7] << 24) | ((uint32_t)nonce[6] << 16) |
+                     ((uint32_t)nonce[5] << 8) | nonce[4];
+    ctx->input[15] = ((uint32_t)nonce[11] << 24) | ((uint32_t)nonce[10] << 16) |
+                     ((uint32_t)nonce[9] << 8) | nonce[8];
+
+    ctx->keystream_pos = BLOCK_SIZE;
+}
+
 void chacha_init(salsa_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce) {
     const uint8_t *constants = (const uint8_t *)"expand 32-byte k";
 
@@ -153,62 +145,381 @@ void chacha_init(salsa_ctx_t *ctx, const uint8_t *key, const uint8_t *nonce) {
                          ((uint32_t)key[i*4+1] << 8) | key[i*4];
     }
 
-    ctx->input[12] = 0; 
-    ctx->input[13] = ((uint32_t)nonce[3] << 24) | ((uint32_t)nonce[2] << 16) |
-                     ((uint32_t)nonce[1] << 8) | nonce[0];
-    ctx->input[14] = ((uint32_t)nonce[7] << 24) | ((uint32_t)nonce[6] << 16) |
-                     ((uint32_t)nonce[5] << 8) | nonce[4];
-    ctx->input[15] = ((uint32_t)nonce[11] << 24) | ((uint32_t)nonce[10] << 16) |
-                     ((uint32_t)nonce[9] << 8) | nonce[8];
+    chacha_set_nonce(ctx, nonce);
+}
 
-    ctx->keystream_pos = BLOCK_SIZE;
+/*
+ * Multi-block keystream kernels. Each vector lane holds the same state word
+ * of a different block, so LANES consecutive counters are computed at once.
+ * The bodies rely on GCC/Clang vector extensions and are compiled per ISA.
+ */
+
+static inline void store32_le(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+#define VROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA_VQR(a, b, c, d)                  \
+    a += b; d ^= a; d = VROTL(d, 16);           \
+    c += d; b ^= c; b = VROTL(b, 12);           \
+    a += b; d ^= a; d = VROTL(d, 8);            \
+    c += d; b ^= c; b = VROTL(b, 7)
+
+#define SALSA_VQR(a, b, c, d)                   \
+    b ^= VROTL(a + d, 7);                       \
+    c ^= VROTL(b + a, 9);                       \
+    d ^= VROTL(c + b, 13);                      \
+    a ^= VROTL(d + c, 18)
+
+#define DEFINE_CHACHA_KERNEL(NAME, LANES, ATTR)                               \
+ATTR static void NAME(const uint32_t *input, uint8_t *out) {                  \
+    typedef uint32_t vec_t __attribute__((vector_size((LANES) * 4)));         \
+    vec_t zero = {0};                                                         \
+    vec_t x[16], orig[16];                                                    \
+    int i, j;                                                                 \
+    for (i = 0; i < 16; i++) {                                                \
+        orig[i] = zero + input[i];                                            \
+    }                                                                         \
+    for (j = 0; j < (LANES); j++) {                                           \
+        orig[12][j] = input[12] + (uint32_t)j;                                \
+    }                                                                         \
+    for (i = 0; i < 16; i++) {                                                \
+        x[i] = orig[i];                                                       \
+    }                                                                         \
+    for (i = 0; i < ROUNDS; i += 2) {                                         \
+        CHACHA_VQR(x[0], x[4], x[8], x[12]);                                  \
+        CHACHA_VQR(x[1], x[5], x[9], x[13]);                                  \
+        CHACHA_VQR(x[2], x[6], x[10], x[14]);                                 \
+        CHACHA_VQR(x[3], x[7], x[11], x[15]);                                 \
+        CHACHA_VQR(x[0], x[5], x[10], x[15]);                                 \
+        CHACHA_VQR(x[1], x[6], x[11], x[12]);                                 \
+        CHACHA_VQR(x[2], x[7], x[8], x[13]);                                  \
+        CHACHA_VQR(x[3], x[4], x[9], x[14]);                                  \
+    }                                                                         \
+    for (i = 0; i < 16; i++) {                                                \
+        x[i] += orig[i];                                                      \
+    }                                                                         \
+    for (j = 0; j < (LANES); j++) {                                           \
+        for (i = 0; i < 16; i++) {                                            \
+            store32_le(out + j * BLOCK_SIZE + i * 4, x[i][j]);                \
+        }                                                                     \
+    }                                                                         \
+}
+
+#define DEFINE_SALSA_KERNEL(NAME, LANES, ATTR)                                \
+ATTR static void NAME(const uint32_t *input, uint8_t *out) {                  \
+    typedef uint32_t vec_t __attribute__((vector_size((LANES) * 4)));         \
+    vec_t zero = {0};                                                         \
+    vec_t x[16], orig[16];                                                    \
+    uint64_t counter = ((uint64_t)input[9] << 32) | input[8];                 \
+    int i, j;                                                                 \
+    for (i = 0; i < 16; i++) {                                                \
+        orig[i] = zero + input[i];                                            \
+    }                                                                         \
+    for (j = 0; j < (LANES); j++) {                                           \
+        orig[8][j] = (uint32_t)(counter + j);                                 \
+        orig[9][j] = (uint32_t)((counter + j) >> 32);                         \
+    }                                                                         \
+    for (i = 0; i < 16; i++) {                                                \
+        x[i] = orig[i];                                                       \
+    }                                                                         \
+    for (i = 0; i < ROUNDS; i += 2) {                                         \
+        SALSA_VQR(x[0], x[4], x[8], x[12]);                                   \
+        SALSA_VQR(x[5], x[9], x[13], x[1]);                                   \
+        SALSA_VQR(x[10], x[14], x[2], x[6]);                                  \
+        SALSA_VQR(x[15], x[3], x[7], x[11]);                                  \
+        SALSA_VQR(x[0], x[1], x[2], x[3]);                                    \
+        SALSA_VQR(x[5], x[6], x[7], x[4]);                                    \
+        SALSA_VQR(x[10], x[11], x[8], x[9]);                                  \
+        SALSA_VQR(x[15], x[12], x[13], x[14]);                                \
+    }                                                                         \
+    for (i = 0; i < 16; i++) {                                                \
+        x[i] += orig[i];                                                      \
+    }                                                                         \
+    for (j = 0; j < (LANES); j++) {                                           \
+        for (i = 0; i < 16; i++) {                                            \
+            store32_le(out + j * BLOCK_SIZE + i * 4, x[i][j]);                \
+        }                                                                     \
+    }                                                                         \
 }
 
-static void chacha_generate_keystream_block(salsa_ctx_t *ctx) {
+typedef void (*keystream_kernel_fn)(const uint32_t *input, uint8_t *out);
+
+typedef struct {
+    const char *name;
+    size_t lanes;
+    keystream_kernel_fn chacha;
+    keystream_kernel_fn salsa;
+} keystream_kernel_t;
+
+static void chacha_kernel_scalar(const uint32_t *input, uint8_t *out) {
     uint32_t output[16];
 
-    chacha_core(output, ctx->input);
+    chacha_core(output, input);
+    for (int i = 0; i < 16; i++) {
+        store32_le(out + i * 4, output[i]);
+    }
+}
+
+static void salsa_kernel_scalar(const uint32_t *input, uint8_t *out) {
+    uint32_t output[16];
 
+    salsa_core(output, input);
     for (int i = 0; i < 16; i++) {
-        ctx->keystream[i*4] = output[i] & 0xFF;
-        ctx->keystream[i*4+1] = (output[i] >> 8) & 0xFF;
-        ctx->keystream[i*4+2] = (output[i] >> 16) & 0xFF;
-        ctx->keystream[i*4+3] = (output[i] >> 24) & 0xFF;
+        store32_le(out + i * 4, output[i]);
     }
+}
+
+static const keystream_kernel_t scalar_kernel = {
+    "scalar", 1, chacha_kernel_scalar, salsa_kernel_scalar
+};
+
+#if defined(STREAM_KERNEL_X86)
+DEFINE_CHACHA_KERNEL(chacha_kernel_sse2, 4, __attribute__((target("sse2"))))
+DEFINE_SALSA_KERNEL(salsa_kernel_sse2, 4, __attribute__((target("sse2"))))
+DEFINE_CHACHA_KERNEL(chacha_kernel_avx2, 8, __attribute__((target("avx2"))))
+DEFINE_SALSA_KERNEL(salsa_kernel_avx2, 8, __attribute__((target("avx2"))))
+DEFINE_CHACHA_KERNEL(chacha_kernel_avx512, 16, __attribute__((target("avx512f"))))
+DEFINE_SALSA_KERNEL(salsa_kernel_avx512, 16, __attribute__((target("avx512f"))))
+
+static const keystream_kernel_t sse2_kernel = {
+    "sse2", 4, chacha_kernel_sse2, salsa_kernel_sse2
+};
+static const keystream_kernel_t avx2_kernel = {
+    "avx2", 8, chacha_kernel_avx2, salsa_kernel_avx2
+};
+static const keystream_kernel_t avx512_kernel = {
+    "avx512f", 16, chacha_kernel_avx512, salsa_kernel_avx512
+};
+#elif defined(STREAM_KERNEL_NEON)
+DEFINE_CHACHA_KERNEL(chacha_kernel_neon, 4, )
+DEFINE_SALSA_KERNEL(salsa_kernel_neon, 4, )
+
+static const keystream_kernel_t neon_kernel = {
+    "neon", 4, chacha_kernel_neon, salsa_kernel_neon
+};
+#endif
+
+/* Picks the widest kernel the running CPU supports; the result is cached */
+static const keystream_kernel_t *select_keystream_kernel(void) {
+    static const keystream_kernel_t *selected = NULL;
+
+    if (selected != NULL) {
+        return selected;
+    }
+
+#if defined(STREAM_KERNEL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        selected = &avx512_kernel;
+    } else if (__builtin_cpu_supports("avx2")) {
+        selected = &avx2_kernel;
+    } else if (__builtin_cpu_supports("sse2")) {
+        selected = &sse2_kernel;
+    } else {
+        selected = &scalar_kernel;
+    }
+#elif defined(STREAM_KERNEL_NEON)
+    selected = &neon_kernel;
+#else
+    selected = &scalar_kernel;
+#endif
+
+    return selected;
+}
+
+const char *stream_kernel_name(void) {
+    return select_keystream_kernel()->name;
+}
+
+static void advance_chacha_counter(salsa_ctx_t *ctx, size_t nblocks) {
+    ctx->input[12] += (uint32_t)nblocks;
+}
+
+static void advance_salsa_counter(salsa_ctx_t *ctx, size_t nblocks) {
+    uint64_t counter = ((uint64_t)ctx->input[9] << 32) | ctx->input[8];
+
+    counter += nblocks;
+    ctx->input[8] = (uint32_t)counter;
+    ctx->input[9] = (uint32_t)(counter >> 32);
+}
+
+/* Writes nblocks * BLOCK_SIZE keystream bytes to out and advances the counter */
+void chacha_keystream_blocks(salsa_ctx_t *ctx, uint8_t *out, size_t nblocks) {
+    const keystream_kernel_t *kernel = select_keystream_kernel();
+
+    while (nblocks >= kernel->lanes) {
+        kernel->chacha(ctx->input, out);
+        advance_chacha_counter(ctx, kernel->lanes);
+        out += kernel->lanes * BLOCK_SIZE;
+        nblocks -= kernel->lanes;
+    }
+
+    while (nblocks > 0) {
+        chacha_kernel_scalar(ctx->input, out);
+        advance_chacha_counter(ctx, 1);
+        out += BLOCK_SIZE;
+        nblocks--;
+    }
+}
+
+void salsa_keystream_blocks(salsa_ctx_t *ctx, uint8_t *out, size_t nblocks) {
+    const keystream_kernel_t *kernel = select_keystream_kernel();
+
+    while (nblocks >= kernel->lanes) {
+        kernel->salsa(ctx->input, out);
+        advance_salsa_counter(ctx, kernel->lanes);
+        out += kernel->lanes * BLOCK_SIZE;
+        nblocks -= kernel->lanes;
+    }
+
+    while (nblocks > 0) {
+        salsa_kernel_scalar(ctx->input, out);
+        advance_salsa_counter(ctx, 1);
+        out += BLOCK_SIZE;
+        nblocks--;
+    }
+}
+
+static void xor_bytes(uint8_t *output, const uint8_t *input,
+                      const uint8_t *keystream, size_t length) {
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, input + i, 8);
+        memcpy(&b, keystream + i, 8);
+        a ^= b;
+        memcpy(output + i, &a, 8);
+    }
+
+    for (; i < length; i++) {
+        output[i] = input[i] ^ keystream[i];
+    }
+}
+
+typedef void (*keystream_blocks_fn)(salsa_ctx_t *ctx, uint8_t *out, size_t nblocks);
+
+/*
+ * Drains buffered keystream first, then runs whole blocks through the
+ * multi-block kernel and leaves any tail buffered in ctx->keystream.
+ */
+static void bulk_encrypt_decrypt(salsa_ctx_t *ctx, keystream_blocks_fn blocks,
+                                 const uint8_t *input, uint8_t *output, size_t length) {
+    uint8_t keystream[MAX_KERNEL_LANES * BLOCK_SIZE];
+
+    if (ctx->keystream_pos < BLOCK_SIZE) {
+        size_t avail = BLOCK_SIZE - ctx->keystream_pos;
+        size_t n = length < avail ? length : avail;
+
+        xor_bytes(output, input, ctx->keystream + ctx->keystream_pos, n);
+        ctx->keystream_pos += n;
+        input += n;
+        output += n;
+        length -= n;
+    }
+
+    while (length >= BLOCK_SIZE) {
+        size_t nblocks = length / BLOCK_SIZE;
 
-    ctx->input[12]++; 
-    ctx->keystream_pos = 0;
+        if (nblocks > MAX_KERNEL_LANES) {
+            nblocks = MAX_KERNEL_LANES;
+        }
+
+        blocks(ctx, keystream, nblocks);
+        xor_bytes(output, input, keystream, nblocks * BLOCK_SIZE);
+        input += nblocks * BLOCK_SIZE;
+        output += nblocks * BLOCK_SIZE;
+        length -= nblocks * BLOCK_SIZE;
+    }
+
+    if (length > 0) {
+        blocks(ctx, ctx->keystream, 1);
+        xor_bytes(output, input, ctx->keystream, length);
+        ctx->keystream_pos = (int)length;
+    }
+}
+
+void salsa_encrypt_decrypt(salsa_ctx_t *ctx, const uint8_t *input,
+                          uint8_t *output, size_t length) {
+    bulk_encrypt_decrypt(ctx, salsa_keystream_blocks, input, output, length);
 }
 
 void chacha_encrypt_decrypt(salsa_ctx_t *ctx, const uint8_t *input,
                            uint8_t *output, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        if (ctx->keystream_pos >= BLOCK_SIZE) {
-            chacha_generate_keystream_block(ctx);
-        }
+    bulk_encrypt_decrypt(ctx, chacha_keystream_blocks, input, output, length);
+}
+
+/*
+ * A keyed context for callers that encrypt many messages under one key.
+ * The key words are loaded once; each message only installs its nonce.
+ */
+typedef struct {
+    salsa_ctx_t keyed;
+    int vKoreanAdvancedCiphernt;
+} stream_cipher_handle_t;
 
-        output[i] = input[i] ^ ctx->keystream[ctx->keystream_pos];
-        ctx->keystream_pos++;
+static void stream_cipher_set_key(stream_cipher_handle_t *handle, const uint8_t *key,
+                                  int vKoreanAdvancedCiphernt) {
+    static const uint8_t zero_nonce[12] = {0};
+
+    handle->vKoreanAdvancedCiphernt = vKoreanAdvancedCiphernt;
+    if (vKoreanAdvancedCiphernt == 0) {
+        salsa_init(&handle->keyed, key, zero_nonce);
+    } else {
+        chacha_init(&handle->keyed, key, zero_nonce);
     }
 }
 
-int stream_cipher_process(const uint8_t *input, uint8_t *output, size_t length,
-                         const uint8_t *key, const uint8_t *nonce, int vKoreanAdvancedCiphernt) {
+stream_cipher_handle_t *stream_cipher_create(const uint8_t *key, int vKoreanAdvancedCiphernt) {
+    stream_cipher_handle_t *handle = malloc(sizeof(*handle));
+
+    if (handle != NULL) {
+        stream_cipher_set_key(handle, key, vKoreanAdvancedCiphernt);
+    }
+    return handle;
+}
+
+void stream_cipher_destroy(stream_cipher_handle_t *handle) {
+    if (handle != NULL) {
+        memset(handle, 0, sizeof(*handle));
+        free(handle);
+    }
+}
+
+/* The handle is only read, so one handle may serve several threads */
+int stream_cipher_process_with_ctx(const stream_cipher_handle_t *handle, const uint8_t *input,
+                                   uint8_t *output, size_t length, const uint8_t *nonce) {
     salsa_ctx_t ctx;
 
-    if (vKoreanAdvancedCiphernt == 0) {
-        
-        salsa_init(&ctx, key, nonce);
+    if (handle == NULL) {
+        return -1;
+    }
+
+    memcpy(ctx.input, handle->keyed.input, sizeof(ctx.input));
+    if (handle->vKoreanAdvancedCiphernt == 0) {
+        salsa_set_nonce(&ctx, nonce);
         salsa_encrypt_decrypt(&ctx, input, output, length);
     } else {
-        
-        chacha_init(&ctx, key, nonce);
+        chacha_set_nonce(&ctx, nonce);
         chacha_encrypt_decrypt(&ctx, input, output, length);
     }
 
     return 0;
 }
 
+int stream_cipher_process(const uint8_t *input, uint8_t *output, size_t length,
+                         const uint8_t *key, const uint8_t *nonce, int vKoreanAdvancedCiphernt) {
+    stream_cipher_handle_t handle;
+
+    stream_cipher_set_key(&handle, key, vKoreanAdvancedCiphernt);
+    return stream_cipher_process_with_ctx(&handle, input, output, length, nonce);
+}
+
 int main() {
     uint8_t key[32] = "This is a 32-byte secret key!!!!";
     uint8_t nonce[12] = "unique nonce";
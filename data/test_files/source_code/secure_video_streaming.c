@@ -3,14 +3,29 @@
  * Real-time encryption for multimedia content protection
  */
 
+/* POSIX clocks for timing the frame pipeline */
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 
 #define STREAM_BLOCK_SIZE 64
 #define MULTIMEDIA_KEY_SIZE 20
 #define SALSA_ROUNDS 20
+#define MAX_KEYSTREAM_LANES 16
+#define VIDEO_PIPELINE_MAX_WORKERS 64
+#define VIDEO_PIPELINE_MAX_DEPTH 64
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MULTIMEDIA_KERNEL_X86 1
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__ARM_NEON))
+#define MULTIMEDIA_KERNEL_NEON 1
+#endif
 
 typedef struct {
     uint32_t stream_state[16];
@@ -100,36 +115,682 @@ void generate_multimedia_keystream(MultimediaEngine *engine, uint8_t *keystream)
     }
 }
 
-// Encrypt video frame data
-void encrypt_video_frame(MultimediaEngine *engine, uint8_t *frame_data, int frame_size) {
-    uint8_t keystream[STREAM_BLOCK_SIZE];
+// Multi-block keystream: each vector lane holds the same state word of a
+// different block, so LANES counters are processed per call. Output is
+// identical to LANES calls of generate_multimedia_keystream.
+#define MM_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define MM_VQR(x, a, b, c, d)                               \
+    x[b] ^= MM_ROTL(x[a] + x[d], 7);                        \
+    x[c] ^= MM_ROTL(x[b] + x[a], 9);                        \
+    x[d] ^= MM_ROTL(x[c] + x[b], 13);                       \
+    x[a] ^= MM_ROTL(x[d] + x[c], 18)
+
+#define DEFINE_MULTIMEDIA_KERNEL(NAME, LANES, ATTR)                          \
+ATTR static void NAME(const uint32_t *state, uint32_t counter,             \
+                      uint8_t *keystream) {                                 \
+    typedef uint32_t vec_t __attribute__((vector_size((LANES) * 4)));       \
+    vec_t zero = {0};                                                       \
+    vec_t x[16];                                                            \
+    int i, j;                                                               \
+    for (i = 0; i < 16; i++) {                                              \
+        x[i] = zero + state[i];                                             \
+    }                                                                       \
+    for (j = 0; j < (LANES); j++) {                                         \
+        x[8][j] = counter + (uint32_t)j;                                    \
+    }                                                                       \
+    for (i = 0; i < 10; i++) {                                              \
+        MM_VQR(x, 0, 4, 8, 12);                                             \
+        MM_VQR(x, 5, 9, 13, 1);                                             \
+        MM_VQR(x, 10, 14, 2, 6);                                            \
+        MM_VQR(x, 15, 3, 7, 11);                                            \
+        MM_VQR(x, 0, 1, 2, 3);                                              \
+        MM_VQR(x, 5, 6, 7, 4);                                              \
+        MM_VQR(x, 10, 11, 8, 9);                                            \
+        MM_VQR(x, 15, 12, 13, 14);                                          \
+    }                                                                       \
+    for (i = 0; i < 16; i++) {                                              \
+        x[i] += zero + state[i];                                            \
+    }                                                                       \
+    for (j = 0; j < (LANES); j++) {                                         \
+        uint8_t *block = keystream + j * STREAM_BLOCK_SIZE;                 \
+        for (i = 0; i < 16; i++) {                                          \
+            block[i*4] = x[i][j] & 0xFF;                                    \
+            block[i*4+1] = (x[i][j] >> 8) & 0xFF;                           \
+            block[i*4+2] = (x[i][j] >> 16) & 0xFF;                          \
+            block[i*4+3] = (x[i][j] >> 24) & 0xFF;                          \
+        }                                                                   \
+    }                                                                       \
+}
+
+// data ^= keystream over length bytes, BYTES per vector with four vectors in
+// flight; loads go through memcpy so neither buffer needs to be aligned
+#define DEFINE_MULTIMEDIA_XOR(NAME, BYTES, ATTR)                              \
+ATTR static void NAME(uint8_t *data, const uint8_t *keystream, size_t length) { \
+    typedef uint64_t wide_t __attribute__((vector_size(BYTES)));            \
+    size_t i = 0;                                                           \
+    for (; i + 4 * (BYTES) <= length; i += 4 * (BYTES)) {                   \
+        wide_t d[4], k[4];                                                  \
+        memcpy(d, data + i, sizeof(d));                                     \
+        memcpy(k, keystream + i, sizeof(k));                                \
+        d[0] ^= k[0];                                                       \
+        d[1] ^= k[1];                                                       \
+        d[2] ^= k[2];                                                       \
+        d[3] ^= k[3];                                                       \
+        memcpy(data + i, d, sizeof(d));                                     \
+    }                                                                       \
+    for (; i + (BYTES) <= length; i += (BYTES)) {                           \
+        wide_t d, k;                                                        \
+        memcpy(&d, data + i, sizeof(d));                                    \
+        memcpy(&k, keystream + i, sizeof(k));                               \
+        d ^= k;                                                             \
+        memcpy(data + i, &d, sizeof(d));                                    \
+    }                                                                       \
+    for (; i < length; i++) {                                               \
+        data[i] ^= keystream[i];                                            \
+    }                                                                       \
+}
+
+typedef void (*multimedia_kernel_fn)(const uint32_t *state, uint32_t counter,
+                                     uint8_t *keystream);
+typedef void (*multimedia_xor_fn)(uint8_t *data, const uint8_t *keystream, size_t length);
+
+typedef struct {
+    const char *name;
+    int lanes;
+    multimedia_kernel_fn blocks;
+    multimedia_xor_fn xor_bytes;
+} MultimediaKernel;
+
+#if defined(MULTIMEDIA_KERNEL_X86)
+DEFINE_MULTIMEDIA_KERNEL(multimedia_blocks_sse2, 4, __attribute__((target("sse2"))))
+DEFINE_MULTIMEDIA_KERNEL(multimedia_blocks_avx2, 8, __attribute__((target("avx2"))))
+DEFINE_MULTIMEDIA_KERNEL(multimedia_blocks_avx512, 16, __attribute__((target("avx512f"))))
+DEFINE_MULTIMEDIA_XOR(multimedia_xor_sse2, 16, __attribute__((target("sse2"))))
+DEFINE_MULTIMEDIA_XOR(multimedia_xor_avx2, 32, __attribute__((target("avx2"))))
+DEFINE_MULTIMEDIA_XOR(multimedia_xor_avx512, 64, __attribute__((target("avx512f"))))
+#elif defined(MULTIMEDIA_KERNEL_NEON)
+DEFINE_MULTIMEDIA_KERNEL(multimedia_blocks_neon, 4, )
+DEFINE_MULTIMEDIA_XOR(multimedia_xor_neon, 16, )
+#else
+DEFINE_MULTIMEDIA_KERNEL(multimedia_blocks_scalar, 1, )
+DEFINE_MULTIMEDIA_XOR(multimedia_xor_scalar, 8, )
+#endif
+
+static MultimediaKernel multimedia_kernel;
+static pthread_once_t multimedia_kernel_once = PTHREAD_ONCE_INIT;
+
+static void multimedia_kernel_init(void) {
+#if defined(MULTIMEDIA_KERNEL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        multimedia_kernel = (MultimediaKernel){"avx512f", 16, multimedia_blocks_avx512,
+                                               multimedia_xor_avx512};
+    } else if (__builtin_cpu_supports("avx2")) {
+        multimedia_kernel = (MultimediaKernel){"avx2", 8, multimedia_blocks_avx2,
+                                               multimedia_xor_avx2};
+    } else {
+        multimedia_kernel = (MultimediaKernel){"sse2", 4, multimedia_blocks_sse2,
+                                               multimedia_xor_sse2};
+    }
+#elif defined(MULTIMEDIA_KERNEL_NEON)
+    multimedia_kernel = (MultimediaKernel){"neon", 4, multimedia_blocks_neon,
+                                           multimedia_xor_neon};
+#else
+    multimedia_kernel = (MultimediaKernel){"scalar", 1, multimedia_blocks_scalar,
+                                           multimedia_xor_scalar};
+#endif
+}
+
+// Select the widest keystream and XOR kernels supported by the running CPU.
+// Pipeline workers call this concurrently, so the probe runs exactly once
+static const MultimediaKernel *select_multimedia_kernel(void) {
+    pthread_once(&multimedia_kernel_once, multimedia_kernel_init);
+    return &multimedia_kernel;
+}
+
+// Generate nblocks consecutive keystream blocks directly into keystream
+void generate_multimedia_keystream_blocks(MultimediaEngine *engine, uint8_t *keystream,
+                                          int nblocks) {
+    const MultimediaKernel *kernel = select_multimedia_kernel();
+
+    while (nblocks >= kernel->lanes) {
+        kernel->blocks(engine->stream_state, engine->video_counter, keystream);
+        engine->video_counter += kernel->lanes;
+        keystream += kernel->lanes * STREAM_BLOCK_SIZE;
+        nblocks -= kernel->lanes;
+    }
 
-    for (int i = 0; i < frame_size; i += STREAM_BLOCK_SIZE) {
+    while (nblocks > 0) {
         generate_multimedia_keystream(engine, keystream);
+        keystream += STREAM_BLOCK_SIZE;
+        nblocks--;
+    }
+}
+
+// Generate nblocks keystream blocks starting at an absolute block counter
+// without touching engine->video_counter, so any thread can seek anywhere in
+// the stream. Words 8 and 9 carry the low and high counter halves as in
+// Salsa20; below 2^32 the output matches generate_multimedia_keystream_blocks
+void generate_multimedia_keystream_at(const MultimediaEngine *engine, uint64_t block_counter,
+                                      uint8_t *keystream, size_t nblocks) {
+    const MultimediaKernel *kernel = select_multimedia_kernel();
+    uint8_t tail[MAX_KEYSTREAM_LANES * STREAM_BLOCK_SIZE];
+    uint32_t state[16];
 
-        int block_size = (i + STREAM_BLOCK_SIZE <= frame_size) ? STREAM_BLOCK_SIZE : (frame_size - i);
-        for (int j = 0; j < block_size; j++) {
-            frame_data[i + j] ^= keystream[j];
+    memcpy(state, engine->stream_state, sizeof(state));
+
+    while (nblocks > 0) {
+        uint32_t low = (uint32_t)block_counter;
+        uint64_t span = ((uint64_t)1 << 32) - low;
+
+        // Kernels step only the low word, so stop where the high word changes
+        if (span > nblocks) {
+            span = nblocks;
+        }
+        state[9] = (uint32_t)(block_counter >> 32);
+        block_counter += span;
+        nblocks -= span;
+
+        for (; span >= (uint64_t)kernel->lanes; span -= kernel->lanes) {
+            kernel->blocks(state, low, keystream);
+            low += kernel->lanes;
+            keystream += kernel->lanes * STREAM_BLOCK_SIZE;
+        }
+        if (span > 0) {
+            kernel->blocks(state, low, tail);
+            memcpy(keystream, tail, span * STREAM_BLOCK_SIZE);
+            keystream += span * STREAM_BLOCK_SIZE;
         }
     }
 }
 
-// Main video streaming encryption function
-int secure_video_stream(const char *video_id, uint8_t *video_data, int data_size) {
+// Encrypt (or decrypt) frame_size bytes whose keystream starts at block_counter
+void encrypt_video_frame_at(const MultimediaEngine *engine, uint64_t block_counter,
+                            uint8_t *frame_data, size_t frame_size) {
+    const MultimediaKernel *kernel = select_multimedia_kernel();
+    uint8_t keystream[MAX_KEYSTREAM_LANES * STREAM_BLOCK_SIZE];
+
+    for (size_t i = 0; i < frame_size; i += sizeof(keystream)) {
+        size_t chunk = frame_size - i;
+        size_t nblocks;
+
+        if (chunk > sizeof(keystream)) {
+            chunk = sizeof(keystream);
+        }
+        nblocks = (chunk + STREAM_BLOCK_SIZE - 1) / STREAM_BLOCK_SIZE;
+
+        generate_multimedia_keystream_at(engine, block_counter, keystream, nblocks);
+        kernel->xor_bytes(frame_data + i, keystream, chunk);
+        block_counter += nblocks;
+    }
+}
+
+// Encrypt video frame data
+void encrypt_video_frame(MultimediaEngine *engine, uint8_t *frame_data, int frame_size) {
+    if (frame_size <= 0) {
+        return;
+    }
+
+    encrypt_video_frame_at(engine, engine->video_counter, frame_data, (size_t)frame_size);
+    engine->video_counter += (uint32_t)(((size_t)frame_size + STREAM_BLOCK_SIZE - 1) /
+                                        STREAM_BLOCK_SIZE);
+}
+
+/*
+ * Frame pipeline for live streams. Frame n owns the keystream blocks from
+ * video_pipeline_frame_counter(n) onward, one max_frame_size stride apiece,
+ * so a receiver can decrypt any frame on its own with encrypt_video_frame_at.
+ * Because keystream does not depend on the data, workers precompute it into
+ * each slot before the frame arrives; a frame then costs a single XOR pass.
+ * Frames are encrypted in place, in any order and on any worker, but the
+ * sink sees them strictly in submission order and one at a time.
+ */
+typedef void (*video_frame_sink_fn)(void *context, uint64_t frame_index,
+                                    const uint8_t *frame, size_t frame_size);
+
+enum {
+    VIDEO_KEYSTREAM_PENDING,
+    VIDEO_KEYSTREAM_BUSY,
+    VIDEO_KEYSTREAM_READY
+};
+
+enum {
+    VIDEO_FRAME_EMPTY,
+    VIDEO_FRAME_QUEUED,
+    VIDEO_FRAME_BUSY,
+    VIDEO_FRAME_DONE
+};
+
+typedef struct {
+    uint8_t *keystream;
+    uint8_t *frame;
+    size_t frame_size;
+    uint64_t frame_index;
+    int keystream_state;
+    int frame_state;
+} VideoPipelineSlot;
+
+typedef struct {
     MultimediaEngine engine;
-    uint8_t streaming_key[20] = {
+    const MultimediaKernel *kernel;
+    size_t max_frame_size;
+    uint64_t first_block;
+    uint64_t frame_blocks;
+    VideoPipelineSlot slots[VIDEO_PIPELINE_MAX_DEPTH];
+    int depth;
+    pthread_t workers[VIDEO_PIPELINE_MAX_WORKERS];
+    int worker_count;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t progress;
+    uint64_t next_submit;
+    uint64_t next_emit;
+    int emitting;
+    int shutting_down;
+    video_frame_sink_fn sink;
+    void *sink_context;
+} VideoFramePipeline;
+
+// First keystream block of a frame, for seeking on the decrypting side
+uint64_t video_pipeline_frame_counter(const VideoFramePipeline *pipeline, uint64_t frame_index) {
+    return pipeline->first_block + frame_index * pipeline->frame_blocks;
+}
+
+/* Oldest queued frame first so emission is never held up by precomputation,
+   otherwise the oldest slot still waiting for its keystream */
+static VideoPipelineSlot *video_pipeline_next_task(VideoFramePipeline *pipeline) {
+    VideoPipelineSlot *frame_task = NULL;
+    VideoPipelineSlot *keystream_task = NULL;
+
+    if (pipeline->shutting_down) {
+        return NULL;
+    }
+
+    for (int i = 0; i < pipeline->depth; i++) {
+        VideoPipelineSlot *slot = &pipeline->slots[i];
+
+        if (slot->frame_state == VIDEO_FRAME_QUEUED &&
+            slot->keystream_state != VIDEO_KEYSTREAM_BUSY) {
+            if (frame_task == NULL || slot->frame_index < frame_task->frame_index) {
+                frame_task = slot;
+            }
+        } else if (slot->frame_state == VIDEO_FRAME_EMPTY &&
+                   slot->keystream_state == VIDEO_KEYSTREAM_PENDING) {
+            if (keystream_task == NULL || slot->frame_index < keystream_task->frame_index) {
+                keystream_task = slot;
+            }
+        }
+    }
+
+    return frame_task != NULL ? frame_task : keystream_task;
+}
+
+/* Hand finished frames to the sink in order; one thread emits at a time and
+   the others leave their frames for it. Called and returns with the lock held */
+static void video_pipeline_emit(VideoFramePipeline *pipeline) {
+    if (pipeline->emitting) {
+        return;
+    }
+    pipeline->emitting = 1;
+
+    for (;;) {
+        VideoPipelineSlot *slot = &pipeline->slots[pipeline->next_emit % pipeline->depth];
+
+        if (slot->frame_index != pipeline->next_emit || slot->frame_state != VIDEO_FRAME_DONE) {
+            break;
+        }
+
+        uint64_t frame_index = slot->frame_index;
+        const uint8_t *frame = slot->frame;
+        size_t frame_size = slot->frame_size;
+
+        pthread_mutex_unlock(&pipeline->lock);
+        pipeline->sink(pipeline->sink_context, frame_index, frame, frame_size);
+        pthread_mutex_lock(&pipeline->lock);
+
+        // Recycle the slot for the frame depth positions ahead
+        slot->frame = NULL;
+        slot->frame_size = 0;
+        slot->frame_index += pipeline->depth;
+        slot->frame_state = VIDEO_FRAME_EMPTY;
+        slot->keystream_state = VIDEO_KEYSTREAM_PENDING;
+        pipeline->next_emit++;
+
+        pthread_cond_signal(&pipeline->work_ready);
+        pthread_cond_broadcast(&pipeline->progress);
+    }
+
+    pipeline->emitting = 0;
+}
+
+/* Run one task with the lock released around the work itself */
+static void video_pipeline_run_task(VideoFramePipeline *pipeline, VideoPipelineSlot *slot) {
+    uint64_t block_counter = video_pipeline_frame_counter(pipeline, slot->frame_index);
+
+    if (slot->frame_state == VIDEO_FRAME_QUEUED) {
+        int precomputed = slot->keystream_state == VIDEO_KEYSTREAM_READY;
+
+        slot->frame_state = VIDEO_FRAME_BUSY;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        // A frame that overtook its precomputation generates keystream inline
+        if (precomputed) {
+            pipeline->kernel->xor_bytes(slot->frame, slot->keystream, slot->frame_size);
+        } else {
+            encrypt_video_frame_at(&pipeline->engine, block_counter, slot->frame,
+                                   slot->frame_size);
+        }
+
+        pthread_mutex_lock(&pipeline->lock);
+        slot->frame_state = VIDEO_FRAME_DONE;
+        video_pipeline_emit(pipeline);
+    } else {
+        slot->keystream_state = VIDEO_KEYSTREAM_BUSY;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        generate_multimedia_keystream_at(&pipeline->engine, block_counter, slot->keystream,
+                                         pipeline->frame_blocks);
+
+        pthread_mutex_lock(&pipeline->lock);
+        slot->keystream_state = VIDEO_KEYSTREAM_READY;
+    }
+}
+
+static void *video_pipeline_worker(void *arg) {
+    VideoFramePipeline *pipeline = arg;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;) {
+        VideoPipelineSlot *slot = video_pipeline_next_task(pipeline);
+
+        if (slot != NULL) {
+            video_pipeline_run_task(pipeline, slot);
+        } else if (pipeline->shutting_down) {
+            break;
+        } else {
+            pthread_cond_wait(&pipeline->work_ready, &pipeline->lock);
+        }
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return NULL;
+}
+
+// Wait until every submitted frame has been emitted
+void video_pipeline_flush(VideoFramePipeline *pipeline) {
+    pthread_mutex_lock(&pipeline->lock);
+    while (pipeline->next_emit != pipeline->next_submit) {
+        pthread_cond_wait(&pipeline->progress, &pipeline->lock);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+// Flush, stop the workers and release the keystream buffers
+void video_pipeline_destroy(VideoFramePipeline *pipeline) {
+    video_pipeline_flush(pipeline);
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->shutting_down = 1;
+    pthread_cond_broadcast(&pipeline->work_ready);
+    pthread_mutex_unlock(&pipeline->lock);
+
+    for (int i = 0; i < pipeline->worker_count; i++) {
+        pthread_join(pipeline->workers[i], NULL);
+    }
+    for (int i = 0; i < pipeline->depth; i++) {
+        free(pipeline->slots[i].keystream);
+    }
+
+    pthread_cond_destroy(&pipeline->progress);
+    pthread_cond_destroy(&pipeline->work_ready);
+    pthread_mutex_destroy(&pipeline->lock);
+}
+
+/*
+ * Start a pipeline continuing engine's stream at its current counter.
+ * worker_count <= 0 uses every online CPU and depth <= 0 keeps two frames in
+ * flight per worker; depth slots of max_frame_size keystream are allocated
+ * up front. The sink runs on a worker thread and must not call back into the
+ * pipeline. Returns 0 on success, -1 on failure
+ */
+int video_pipeline_init(VideoFramePipeline *pipeline, const MultimediaEngine *engine,
+                        size_t max_frame_size, int worker_count, int depth,
+                        video_frame_sink_fn sink, void *sink_context) {
+    if (max_frame_size == 0 || sink == NULL) {
+        return -1;
+    }
+
+    if (worker_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = cpus > 0 ? (int)cpus : 1;
+    }
+    if (worker_count > VIDEO_PIPELINE_MAX_WORKERS) {
+        worker_count = VIDEO_PIPELINE_MAX_WORKERS;
+    }
+    if (depth <= 0) {
+        depth = 2 * worker_count;
+    }
+    if (depth < 2) {
+        depth = 2;
+    }
+    if (depth > VIDEO_PIPELINE_MAX_DEPTH) {
+        depth = VIDEO_PIPELINE_MAX_DEPTH;
+    }
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->engine = *engine;
+    pipeline->kernel = select_multimedia_kernel();
+    pipeline->max_frame_size = max_frame_size;
+    pipeline->first_block = engine->video_counter;
+    pipeline->frame_blocks = (max_frame_size + STREAM_BLOCK_SIZE - 1) / STREAM_BLOCK_SIZE;
+    pipeline->depth = depth;
+    pipeline->sink = sink;
+    pipeline->sink_context = sink_context;
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->work_ready, NULL);
+    pthread_cond_init(&pipeline->progress, NULL);
+
+    for (int i = 0; i < depth; i++) {
+        VideoPipelineSlot *slot = &pipeline->slots[i];
+
+        slot->frame_index = (uint64_t)i;
+        slot->keystream = malloc(pipeline->frame_blocks * STREAM_BLOCK_SIZE);
+        if (slot->keystream == NULL) {
+            video_pipeline_destroy(pipeline);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&pipeline->workers[i], NULL, video_pipeline_worker, pipeline) != 0) {
+            break;
+        }
+        pipeline->worker_count++;
+    }
+    if (pipeline->worker_count == 0) {
+        video_pipeline_destroy(pipeline);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Queue a frame for in-place encryption, blocking while all depth slots are
+ * in flight. The buffer must stay untouched until the sink has seen it.
+ * Returns 0, or -1 if the frame is larger than the pipeline's stride
+ */
+int video_pipeline_submit(VideoFramePipeline *pipeline, uint8_t *frame, size_t frame_size) {
+    VideoPipelineSlot *slot;
+
+    if (frame_size > pipeline->max_frame_size) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;) {
+        slot = &pipeline->slots[pipeline->next_submit % pipeline->depth];
+        if (slot->frame_index == pipeline->next_submit) {
+            break;
+        }
+        pthread_cond_wait(&pipeline->progress, &pipeline->lock);
+    }
+
+    slot->frame = frame;
+    slot->frame_size = frame_size;
+    slot->frame_state = VIDEO_FRAME_QUEUED;
+    pipeline->next_submit++;
+    pthread_cond_signal(&pipeline->work_ready);
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return 0;
+}
+
+static MultimediaEngine streaming_engine;
+static pthread_once_t streaming_engine_once = PTHREAD_ONCE_INIT;
+
+static void streaming_engine_init(void) {
+    // init_multimedia_engine loads eight key words, so the 20-byte
+    // streaming key is zero-padded to the full 32 bytes it reads
+    uint8_t streaming_key[32] = {
         0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
         0x00, 0x00, 0x00, 0x01
     };
     uint8_t stream_nonce[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02};
 
-    init_multimedia_engine(&engine, streaming_key, stream_nonce);
-    encrypt_video_frame(&engine, video_data, data_size);
+    init_multimedia_engine(&streaming_engine, streaming_key, stream_nonce);
+}
+
+// Main video streaming encryption function
+int secure_video_stream(const char *video_id, uint8_t *video_data, int data_size) {
+    // Every stream starts at block 0 of the fixed key, so the engine is set
+    // up once and only ever read
+    pthread_once(&streaming_engine_once, streaming_engine_init);
+    if (data_size > 0) {
+        encrypt_video_frame_at(&streaming_engine, 0, video_data, (size_t)data_size);
+    }
 
     printf("Video stream encrypted using Salsa20-like cipher\n");
     printf("Real-time multimedia encryption applied\n");
     printf("Stream cipher with counter mode\n");
 
     return 1;
+}
+
+#define VIDEO_BENCH_FRAME_SIZE (3840 * 2160 * 3 / 2)
+#define VIDEO_BENCH_FRAMES 240
+#define VIDEO_BENCH_SEQUENTIAL_FRAMES 16
+
+typedef struct {
+    struct timespec *submitted;
+    double *latency_ms;
+    uint64_t next_index;
+    int out_of_order;
+} VideoBenchmarkSink;
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static void video_benchmark_sink(void *context, uint64_t frame_index,
+                                 const uint8_t *frame, size_t frame_size) {
+    VideoBenchmarkSink *bench = context;
+
+    (void)frame;
+    (void)frame_size;
+    if (frame_index != bench->next_index) {
+        bench->out_of_order = 1;
+    }
+    bench->next_index = frame_index + 1;
+    bench->latency_ms[frame_index] = elapsed_ms(&bench->submitted[frame_index]);
+}
+
+static int compare_latency(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double gigabits_per_second(size_t bytes, double ms) {
+    return bytes * 8.0 / (ms * 1e6);
+}
+
+// Sustained throughput and submit-to-emit frame latency on 4K NV12 frames,
+// against encrypt_video_frame on the calling thread
+void benchmark_video_pipeline(void) {
+    const uint8_t key[32] = {0x80};
+    const uint8_t nonce[8] = {0};
+    size_t total = (size_t)VIDEO_BENCH_FRAMES * VIDEO_BENCH_FRAME_SIZE;
+    VideoBenchmarkSink bench = {NULL, NULL, 0, 0};
+    uint8_t *buffers[VIDEO_PIPELINE_MAX_DEPTH] = {NULL};
+    VideoFramePipeline *pipeline = malloc(sizeof(*pipeline));
+    MultimediaEngine engine;
+    struct timespec start;
+    double sequential_ms, pipeline_ms;
+    int depth = 0;
+
+    init_multimedia_engine(&engine, key, nonce);
+    bench.submitted = malloc(VIDEO_BENCH_FRAMES * sizeof(*bench.submitted));
+    bench.latency_ms = malloc(VIDEO_BENCH_FRAMES * sizeof(*bench.latency_ms));
+    if (pipeline == NULL || bench.submitted == NULL || bench.latency_ms == NULL ||
+        video_pipeline_init(pipeline, &engine, VIDEO_BENCH_FRAME_SIZE, 0, 0,
+                            video_benchmark_sink, &bench) != 0) {
+        printf("Benchmark setup failed\n");
+        free(bench.latency_ms);
+        free(bench.submitted);
+        free(pipeline);
+        return;
+    }
+
+    // One buffer per slot: a slot's previous frame has been emitted by the
+    // time submit hands the slot out again
+    for (depth = 0; depth < pipeline->depth; depth++) {
+        buffers[depth] = malloc(VIDEO_BENCH_FRAME_SIZE);
+        if (buffers[depth] == NULL) {
+            printf("Benchmark setup failed\n");
+            goto cleanup;
+        }
+        memset(buffers[depth], depth, VIDEO_BENCH_FRAME_SIZE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < VIDEO_BENCH_SEQUENTIAL_FRAMES; i++) {
+        encrypt_video_frame(&engine, buffers[0], VIDEO_BENCH_FRAME_SIZE);
+    }
+    sequential_ms = elapsed_ms(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < VIDEO_BENCH_FRAMES; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &bench.submitted[i]);
+        video_pipeline_submit(pipeline, buffers[i % depth], VIDEO_BENCH_FRAME_SIZE);
+    }
+    video_pipeline_flush(pipeline);
+    pipeline_ms = elapsed_ms(&start);
+
+    qsort(bench.latency_ms, VIDEO_BENCH_FRAMES, sizeof(double), compare_latency);
+
+    printf("Sequential encrypt_video_frame (%s): %.2f Gbps\n", pipeline->kernel->name,
+           gigabits_per_second((size_t)VIDEO_BENCH_SEQUENTIAL_FRAMES * VIDEO_BENCH_FRAME_SIZE,
+                               sequential_ms));
+    printf("Pipeline, %d workers, %d frames in flight: %.2f Gbps sustained (%.1f fps)\n",
+           pipeline->worker_count, depth, gigabits_per_second(total, pipeline_ms),
+           VIDEO_BENCH_FRAMES * 1e3 / pipeline_ms);
+    printf("Frame latency: p50 %.2f ms, p99 %.2f ms, max %.2f ms%s\n",
+           bench.latency_ms[VIDEO_BENCH_FRAMES / 2],
+           bench.latency_ms[VIDEO_BENCH_FRAMES * 99 / 100],
+           bench.latency_ms[VIDEO_BENCH_FRAMES - 1],
+           bench.out_of_order ? " (frames emitted out of order)" : "");
+
+cleanup:
+    video_pipeline_destroy(pipeline);
+    for (int i = 0; i < depth; i++) {
+        free(buffers[i]);
+    }
+    free(bench.latency_ms);
+    free(bench.submitted);
+    free(pipeline);
 }
\ No newline at end of file
@@ -5,126 +5,561 @@
 #define ROUNDS 32
 #define BLOCK_SIZE 16
 #define KEY_SIZE 32
+#define MAX_KERNEL_LANES 8
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SERPENT_KERNEL_X86 1
+#endif
+
+/*
+ * subkeys holds the round keys in the nibble layout the block is loaded in;
+ * sliced_subkeys holds the same keys transposed to bit planes for the round
+ * function.
+ */
 typedef struct {
     uint32_t subkeys[ROUNDS + 1][4];
+    uint32_t sliced_subkeys[ROUNDS + 1][4];
 } serpent_ctx_t;
 
-static const uint8_t sbox[8][16] = {
-    {3, 8, 15, 1, 10, 6, 5, 11, 14, 13, 4, 2, 7, 0, 9, 12},
-    {15, 12, 2, 7, 9, 0, 5, 10, 1, 11, 14, 8, 6, 13, 3, 4},
-    {8, 6, 7, 14, 3, 11, 0, 4, 10, 13, 2, 12, 9, 5, 15, 1},
-    {0, 15, 11, 8, 12, 9, 6, 3, 13, 1, 2, 4, 10, 7, 5, 14},
-    {1, 15, 8, 3, 12, 0, 11, 6, 2, 5, 4, 10, 9, 14, 7, 13},
-    {15, 5, 2, 11, 4, 10, 9, 12, 0, 3, 14, 8, 13, 6, 7, 1},
-    {7, 2, 12, 5, 8, 4, 6, 11, 14, 9, 1, 15, 13, 3, 10, 0},
-    {1, 13, 15, 0, 14, 8, 2, 11, 7, 4, 12, 10, 9, 3, 5, 6}
-};
-
-static const uint8_t inv_sbox[8][16] = {
-    {13, 3, 11, 0, 10, 6, 5, 12, 1, 14, 4, 7, 15, 9, 8, 2},
-    {5, 8, 2, 14, 15, 6, 12, 3, 11, 4, 7, 9, 1, 13, 10, 0},
-    {12, 9, 15, 4, 11, 14, 1, 2, 0, 3, 6, 13, 5, 8, 10, 7},
-    {0, 9, 10, 7, 11, 14, 6, 13, 3, 5, 12, 2, 4, 8, 15, 1},
-    {5, 0, 8, 3, 10, 9, 7, 14, 2, 12, 11, 6, 4, 15, 13, 1},
-    {8, 15, 2, 9, 4, 1, 13, 14, 11, 6, 5, 3, 7, 12, 10, 0},
-    {15, 10, 1, 13, 5, 3, 6, 0, 4, 9, 14, 7, 2, 12, 8, 11},
-    {3, 0, 6, 13, 9, 14, 15, 8, 5, 12, 11, 7, 10, 1, 4, 2}
-};
-
-static const int bit_permutation[128] = {
-    0, 32, 64, 96, 1, 33, 65, 97, 2, 34, 66, 98, 3, 35, 67, 99,
-    4, 36, 68, 100, 5, 37, 69, 101, 6, 38, 70, 102, 7, 39, 71, 103,
-    8, 40, 72, 104, 9, 41, 73, 105, 10, 42, 74, 106, 11, 43, 75, 107,
-    12, 44, 76, 108, 13, 45, 77, 109, 14, 46, 78, 110, 15, 47, 79, 111,
-    16, 48, 80, 112, 17, 49, 81, 113, 18, 50, 82, 114, 19, 51, 83, 115,
-    20, 52, 84, 116, 21, 53, 85, 117, 22, 54, 86, 118, 23, 55, 87, 119,
-    24, 56, 88, 120, 25, 57, 89, 121, 26, 58, 90, 122, 27, 59, 91, 123,
-    28, 60, 92, 124, 29, 61, 93, 125, 30, 62, 94, 126, 31, 63, 95, 127
-};
-
-static void apply_sbox(uint32_t *state, int sbox_num) {
-    for (int i = 0; i < 4; i++) {
-        uint32_t word = state[i];
-        uint32_t result = 0;
-
-        for (int j = 0; j < 8; j++) {
-            uint8_t nibble = (word >> (j * 4)) & 0xF;
-            uint8_t substituted = sbox[sbox_num][nibble];
-            result |= ((uint32_t)substituted << (j * 4));
-        }
-
-        state[i] = result;
+/*
+ * Bitsliced S-boxes. Each S-box maps nibble k of the state (bits 4k..4k+3
+ * of the 128-bit block) through the table in its comment. Here it runs on
+ * the four bit planes x0..x3 instead, where bit k of plane b is bit b of
+ * nibble k. Every output bit is written in algebraic normal form, so the
+ * substitution is a fixed sequence of AND/XOR/NOT with no table lookups
+ * or data-dependent branches. The same macros run on a uint32_t or on a
+ * vector of planes from several blocks.
+ */
+/* S0: 3 8 15 1 10 6 5 11 14 13 4 2 7 0 9 12 */
+#define SERPENT_SBOX0(x0, x1, x2, x3) do {                                         \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(x0 ^ t01 ^ x2 ^ t02 ^ t12 ^ t012 ^ x3 ^ t023 ^ t123);                   \
+    y1 = ~(x0 ^ t02 ^ t12 ^ t012 ^ t13 ^ t023 ^ t123);                             \
+    y2 = x1 ^ t01 ^ t02 ^ t012 ^ x3 ^ t13 ^ t123;                                  \
+    y3 = x0 ^ x1 ^ x2 ^ x3 ^ t03;                                                  \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S1: 15 12 2 7 9 0 5 10 1 11 14 8 6 13 3 4 */
+#define SERPENT_SBOX1(x0, x1, x2, x3) do {                                         \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t013 = t13 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(x0 ^ x1 ^ t12 ^ t03 ^ t23 ^ t023 ^ t123);                               \
+    y1 = ~(x0 ^ t01 ^ x2 ^ t02 ^ x3 ^ t13 ^ t013 ^ t023 ^ t123);                   \
+    y2 = ~(x1 ^ t01 ^ x2 ^ x3);                                                    \
+    y3 = ~(x1 ^ t02 ^ x3 ^ t03 ^ t013 ^ t023 ^ t123);                              \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S2: 8 6 7 14 3 11 0 4 10 13 2 12 9 5 15 1 */
+#define SERPENT_SBOX2(x0, x1, x2, x3) do {                                               \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = x1 ^ t01 ^ x2 ^ t012 ^ t03 ^ t13 ^ t023;                                        \
+    y1 = x0 ^ x1 ^ t01 ^ x2 ^ t02 ^ t012 ^ x3 ^ t13 ^ t013 ^ t123;                       \
+    y2 = x0 ^ x1 ^ t01 ^ t02 ^ t12 ^ t13 ^ t013 ^ t023;                                  \
+    y3 = ~(x0 ^ x1 ^ x2 ^ t12 ^ t012 ^ t03 ^ t013 ^ t23 ^ t023);                         \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S3: 0 15 11 8 12 9 6 3 13 1 2 4 10 7 5 14 */
+#define SERPENT_SBOX3(x0, x1, x2, x3) do {                                               \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = x0 ^ x1 ^ t12 ^ x3 ^ t03 ^ t23 ^ t023 ^ t123;                                   \
+    y1 = x0 ^ x1 ^ t02 ^ t03 ^ t013 ^ t23 ^ t023;                                        \
+    y2 = x0 ^ t01 ^ x2 ^ t012 ^ x3 ^ t13 ^ t013;                                         \
+    y3 = x0 ^ x1 ^ t01 ^ x2 ^ t02 ^ t012 ^ x3 ^ t23 ^ t023;                              \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S4: 1 15 8 3 12 0 11 6 2 5 4 10 9 14 7 13 */
+#define SERPENT_SBOX4(x0, x1, x2, x3) do {                                               \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = ~(x1 ^ t01 ^ x2 ^ x3 ^ t03 ^ t13);                                              \
+    y1 = x0 ^ t02 ^ t12 ^ x3 ^ t13 ^ t23 ^ t023 ^ t123;                                  \
+    y2 = x0 ^ t01 ^ x2 ^ t12 ^ t012 ^ t13 ^ t013 ^ t23 ^ t123;                           \
+    y3 = x0 ^ x1 ^ x2 ^ t12 ^ t03 ^ t13 ^ t013;                                          \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S5: 15 5 2 11 4 10 9 12 0 3 14 8 13 6 7 1 */
+#define SERPENT_SBOX5(x0, x1, x2, x3) do {                                               \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = ~(x1 ^ t01 ^ x2 ^ x3 ^ t03 ^ t13);                                              \
+    y1 = ~(x0 ^ t01 ^ x2 ^ x3 ^ t13 ^ t013 ^ t23);                                       \
+    y2 = ~(x1 ^ t02 ^ x3 ^ t013 ^ t23 ^ t023 ^ t123);                                    \
+    y3 = ~(x0 ^ x1 ^ x2 ^ t012 ^ x3 ^ t03 ^ t023);                                       \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S6: 7 2 12 5 8 4 6 11 14 9 1 15 13 3 10 0 */
+#define SERPENT_SBOX6(x0, x1, x2, x3) do {                                         \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t013 = t13 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(x0 ^ x1 ^ x2 ^ t02 ^ t12 ^ t012 ^ x3 ^ t013 ^ t123);                    \
+    y1 = ~(x1 ^ x2 ^ t03);                                                         \
+    y2 = ~(x0 ^ t01 ^ x2 ^ t12 ^ t012 ^ t13 ^ t013 ^ t23 ^ t123);                  \
+    y3 = x1 ^ t01 ^ x2 ^ t02 ^ t012 ^ x3 ^ t23 ^ t123;                             \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S7: 1 13 15 0 14 8 2 11 7 4 12 10 9 3 5 6 */
+#define SERPENT_SBOX7(x0, x1, x2, x3) do {                                               \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = ~(t01 ^ x2 ^ t03 ^ t13 ^ t23 ^ t023 ^ t123);                                    \
+    y1 = x1 ^ t01 ^ x2 ^ t02 ^ t12 ^ x3 ^ t03 ^ t013 ^ t023;                             \
+    y2 = x0 ^ x1 ^ x2 ^ t012 ^ x3 ^ t03 ^ t13 ^ t013 ^ t123;                             \
+    y3 = x0 ^ x1 ^ x2 ^ t02 ^ t012 ^ t03;                                                \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S0 inverse: 13 3 11 0 10 6 5 12 1 14 4 7 15 9 8 2 */
+#define SERPENT_INV_SBOX0(x0, x1, x2, x3) do {                                     \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t013 = t13 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(t01 ^ x2 ^ t12 ^ t03 ^ t13 ^ t013 ^ t23 ^ t023 ^ t123);                 \
+    y1 = x0 ^ x1 ^ x2 ^ t02 ^ t13 ^ t023 ^ t123;                                   \
+    y2 = ~(x0 ^ x1 ^ t01 ^ x2 ^ x3);                                               \
+    y3 = ~(x0 ^ t12 ^ x3 ^ t013 ^ t23 ^ t023 ^ t123);                              \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S1 inverse: 5 8 2 14 15 6 12 3 11 4 7 9 1 13 10 0 */
+#define SERPENT_INV_SBOX1(x0, x1, x2, x3) do {                                     \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(x0 ^ x1 ^ t01 ^ t012 ^ t13 ^ t023 ^ t123);                              \
+    y1 = x1 ^ x2 ^ t012 ^ x3 ^ t03 ^ t13 ^ t023 ^ t123;                            \
+    y2 = ~(x0 ^ x1 ^ t02 ^ t12 ^ t012 ^ x3 ^ t023);                                \
+    y3 = x0 ^ x2 ^ x3 ^ t13;                                                       \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S2 inverse: 6 15 10 4 7 13 1 2 0 12 8 5 11 9 3 14 */
+#define SERPENT_INV_SBOX2(x0, x1, x2, x3) do {                                           \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = x0 ^ t01 ^ x2 ^ t02 ^ t03 ^ t023;                                               \
+    y1 = ~(t01 ^ t02 ^ t12 ^ t012 ^ x3 ^ t013 ^ t23 ^ t123);                             \
+    y2 = ~(x1 ^ t01 ^ t012 ^ x3 ^ t03 ^ t13 ^ t013 ^ t023);                              \
+    y3 = x0 ^ x1 ^ t12 ^ t012 ^ t23 ^ t023 ^ t123;                                       \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S3 inverse: 0 9 10 7 11 14 6 13 3 5 12 2 4 8 15 1 */
+#define SERPENT_INV_SBOX3(x0, x1, x2, x3) do {                                           \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = x0 ^ x2 ^ t12 ^ x3 ^ t03 ^ t13 ^ t123;                                          \
+    y1 = x1 ^ x2 ^ t12 ^ t012 ^ x3 ^ t03 ^ t023 ^ t123;                                  \
+    y2 = t01 ^ t02 ^ t12 ^ t03 ^ t13 ^ t013 ^ t23 ^ t023;                                \
+    y3 = x0 ^ x1 ^ x2 ^ t02 ^ t012 ^ t03 ^ t013 ^ t23;                                   \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+/* S4 inverse: 5 0 8 3 10 9 7 14 2 12 11 6 4 15 13 1 */
+#define SERPENT_INV_SBOX4(x0, x1, x2, x3) do {                                     \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t013 = t13 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    y0 = ~(x0 ^ x1 ^ x2 ^ x3 ^ t03 ^ t013 ^ t23 ^ t023);                           \
+    y1 = t01 ^ x2 ^ t02 ^ x3 ^ t03 ^ t023;                                         \
+    y2 = ~(x0 ^ x1 ^ t01 ^ x2 ^ t02 ^ t012 ^ x3 ^ t13 ^ t013);                     \
+    y3 = x1 ^ t01 ^ x2 ^ t03 ^ t013 ^ t23;                                         \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S5 inverse: 8 15 2 9 4 1 13 14 11 6 5 3 7 12 10 0 */
+#define SERPENT_INV_SBOX5(x0, x1, x2, x3) do {                                     \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t013 = t13 & x0;                                                               \
+    t023 = t23 & x0;                                                               \
+    y0 = x0 ^ t12 ^ x3 ^ t013;                                                     \
+    y1 = x0 ^ x1 ^ t02 ^ t12 ^ t012 ^ x3 ^ t03 ^ t013;                             \
+    y2 = x0 ^ t01 ^ x2 ^ t13 ^ t013 ^ t023;                                        \
+    y3 = ~(x1 ^ t01 ^ x2 ^ t012 ^ t03);                                            \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S6 inverse: 15 10 1 13 5 3 6 0 4 9 14 7 2 12 8 11 */
+#define SERPENT_INV_SBOX6(x0, x1, x2, x3) do {                                     \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                 \
+    t02 = x2 & x0;                                                                 \
+    t12 = x2 & x1;                                                                 \
+    t03 = x3 & x0;                                                                 \
+    t13 = x3 & x1;                                                                 \
+    t23 = x3 & x2;                                                                 \
+    t012 = t12 & x0;                                                               \
+    t013 = t13 & x0;                                                               \
+    t123 = t23 & x1;                                                               \
+    y0 = ~(x0 ^ t01 ^ t02 ^ t12 ^ t012 ^ x3 ^ t013 ^ t123);                        \
+    y1 = ~(x1 ^ x2 ^ t02 ^ x3);                                                    \
+    y2 = ~(x0 ^ x1 ^ t12 ^ t13 ^ t013 ^ t23 ^ t123);                               \
+    y3 = ~(x1 ^ t01 ^ x2 ^ t12 ^ t012 ^ x3 ^ t03 ^ t013 ^ t23 ^ t123);             \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                    \
+} while (0)
+
+/* S7 inverse: 3 0 6 13 9 14 15 8 5 12 11 7 10 1 4 2 */
+#define SERPENT_INV_SBOX7(x0, x1, x2, x3) do {                                           \
+    __typeof__(x0) t01, t02, t12, t03, t13, t23, t012, t013, t023, t123, y0, y1, y2, y3; \
+    t01 = x1 & x0;                                                                       \
+    t02 = x2 & x0;                                                                       \
+    t12 = x2 & x1;                                                                       \
+    t03 = x3 & x0;                                                                       \
+    t13 = x3 & x1;                                                                       \
+    t23 = x3 & x2;                                                                       \
+    t012 = t12 & x0;                                                                     \
+    t013 = t13 & x0;                                                                     \
+    t023 = t23 & x0;                                                                     \
+    t123 = t23 & x1;                                                                     \
+    y0 = ~(x0 ^ x1 ^ t12 ^ t13 ^ t013 ^ t23 ^ t123);                                     \
+    y1 = ~(x0 ^ x2 ^ t12 ^ x3 ^ t03 ^ t13 ^ t023 ^ t123);                                \
+    y2 = x1 ^ t02 ^ x3 ^ t013 ^ t23 ^ t023;                                              \
+    y3 = t01 ^ x2 ^ t012 ^ t03 ^ t13 ^ t013;                                             \
+    (x0) = y0; (x1) = y1; (x2) = y2; (x3) = y3;                                          \
+} while (0)
+
+static void serpent_sbox_planes(uint32_t *x, int sbox_num) {
+    switch (sbox_num) {
+        case 0: SERPENT_SBOX0(x[0], x[1], x[2], x[3]); break;
+        case 1: SERPENT_SBOX1(x[0], x[1], x[2], x[3]); break;
+        case 2: SERPENT_SBOX2(x[0], x[1], x[2], x[3]); break;
+        case 3: SERPENT_SBOX3(x[0], x[1], x[2], x[3]); break;
+        case 4: SERPENT_SBOX4(x[0], x[1], x[2], x[3]); break;
+        case 5: SERPENT_SBOX5(x[0], x[1], x[2], x[3]); break;
+        case 6: SERPENT_SBOX6(x[0], x[1], x[2], x[3]); break;
+        default: SERPENT_SBOX7(x[0], x[1], x[2], x[3]); break;
     }
 }
 
-static void apply_inverse_sbox(uint32_t *state, int sbox_num) {
-    for (int i = 0; i < 4; i++) {
-        uint32_t word = state[i];
-        uint32_t result = 0;
-
-        for (int j = 0; j < 8; j++) {
-            uint8_t nibble = (word >> (j * 4)) & 0xF;
-            uint8_t substituted = inv_sbox[sbox_num][nibble];
-            result |= ((uint32_t)substituted << (j * 4));
-        }
-
-        state[i] = result;
-    }
+#define SERPENT_DELTA_SWAP(x, mask, shift) do {                               \
+    __typeof__(x) t_ = (((x) >> (shift)) ^ (x)) & (mask);                     \
+    (x) ^= t_ ^ (t_ << (shift));                                              \
+} while (0)
+
+#define SERPENT_EXCHANGE(a, b, mask, shift) do {                              \
+    __typeof__(a) t_ = (((a) >> (shift)) ^ (b)) & (mask);                     \
+    (b) ^= t_;                                                                \
+    (a) ^= t_ << (shift);                                                     \
+} while (0)
+
+/* Gathers bit b of every nibble of a word into byte b */
+#define SERPENT_GATHER_PLANES(x) do {                                         \
+    SERPENT_DELTA_SWAP(x, 0x22222222, 1);                                     \
+    SERPENT_DELTA_SWAP(x, 0x0A0A0A0A, 3);                                     \
+    SERPENT_DELTA_SWAP(x, 0x00CC00CC, 6);                                     \
+    SERPENT_DELTA_SWAP(x, 0x0000F0F0, 12);                                    \
+} while (0)
+
+#define SERPENT_SCATTER_PLANES(x) do {                                        \
+    SERPENT_DELTA_SWAP(x, 0x0000F0F0, 12);                                    \
+    SERPENT_DELTA_SWAP(x, 0x00CC00CC, 6);                                     \
+    SERPENT_DELTA_SWAP(x, 0x0A0A0A0A, 3);                                     \
+    SERPENT_DELTA_SWAP(x, 0x22222222, 1);                                     \
+} while (0)
+
+/* 4x4 byte transpose: byte w of word b <-> byte b of word w */
+#define SERPENT_TRANSPOSE_BYTES(x) do {                                       \
+    SERPENT_EXCHANGE(x[0], x[2], 0x0000FFFF, 16);                             \
+    SERPENT_EXCHANGE(x[1], x[3], 0x0000FFFF, 16);                             \
+    SERPENT_EXCHANGE(x[0], x[1], 0x00FF00FF, 8);                              \
+    SERPENT_EXCHANGE(x[2], x[3], 0x00FF00FF, 8);                              \
+} while (0)
+
+/*
+ * Nibble layout to bit planes: plane b bit k = bit b of nibble k. This is
+ * also exactly the cipher's linear transform (bit i moves to position
+ * 32 * (i % 4) + i / 4), so each round is transpose, S-box, key mix.
+ */
+#define SERPENT_TO_PLANES(x) do {                                             \
+    SERPENT_GATHER_PLANES(x[0]);                                              \
+    SERPENT_GATHER_PLANES(x[1]);                                              \
+    SERPENT_GATHER_PLANES(x[2]);                                              \
+    SERPENT_GATHER_PLANES(x[3]);                                              \
+    SERPENT_TRANSPOSE_BYTES(x);                                               \
+} while (0)
+
+#define SERPENT_FROM_PLANES(x) do {                                           \
+    SERPENT_TRANSPOSE_BYTES(x);                                               \
+    SERPENT_SCATTER_PLANES(x[0]);                                             \
+    SERPENT_SCATTER_PLANES(x[1]);                                             \
+    SERPENT_SCATTER_PLANES(x[2]);                                             \
+    SERPENT_SCATTER_PLANES(x[3]);                                             \
+} while (0)
+
+#define SERPENT_ENCRYPT_ROUND(x, ctx, round, SBOX) do {                       \
+    SERPENT_TO_PLANES(x);                                                     \
+    SBOX(x[0], x[1], x[2], x[3]);                                             \
+    x[0] ^= (ctx)->sliced_subkeys[(round) + 1][0];                            \
+    x[1] ^= (ctx)->sliced_subkeys[(round) + 1][1];                            \
+    x[2] ^= (ctx)->sliced_subkeys[(round) + 1][2];                            \
+    x[3] ^= (ctx)->sliced_subkeys[(round) + 1][3];                            \
+} while (0)
+
+#define SERPENT_DECRYPT_ROUND(x, ctx, round, INV_SBOX) do {                   \
+    x[0] ^= (ctx)->sliced_subkeys[(round) + 1][0];                            \
+    x[1] ^= (ctx)->sliced_subkeys[(round) + 1][1];                            \
+    x[2] ^= (ctx)->sliced_subkeys[(round) + 1][2];                            \
+    x[3] ^= (ctx)->sliced_subkeys[(round) + 1][3];                            \
+    INV_SBOX(x[0], x[1], x[2], x[3]);                                         \
+    SERPENT_FROM_PLANES(x);                                                   \
+} while (0)
+
+static inline uint32_t load32_le(const uint8_t *p) {
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[1] << 8) | p[0];
 }
 
-static void linear_transform(uint32_t *state) {
-    uint32_t input[4];
-    uint32_t output[4] = {0};
+static inline void store32_le(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
 
-    memcpy(input, state, 16);
+/*
+ * Encrypts/decrypts LANES consecutive blocks, one block per vector lane.
+ * The first round's transpose doubles as the previous linear transform,
+ * and the last round's key is pre-transposed, so each round is uniform.
+ * A single closing transpose returns to the byte layout.
+ */
+#define DEFINE_SERPENT_KERNEL(NAME, LANES, ATTR)                              \
+ATTR static void NAME##_encrypt(const serpent_ctx_t *ctx,                     \
+                                const uint8_t *in, uint8_t *out) {            \
+    typedef uint32_t vec_t __attribute__((vector_size((LANES) * 4)));         \
+    vec_t x[4];                                                               \
+    int i, j, round;                                                          \
+    for (i = 0; i < 4; i++) {                                                 \
+        for (j = 0; j < (LANES); j++) {                                       \
+            x[i][j] = load32_le(in + j * BLOCK_SIZE + i * 4);                 \
+        }                                                                     \
+        x[i] ^= ctx->subkeys[0][i];                                           \
+    }                                                                         \
+    for (round = 0; round < ROUNDS; round += 8) {                             \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round, SERPENT_SBOX0);                  \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 1, SERPENT_SBOX1);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 2, SERPENT_SBOX2);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 3, SERPENT_SBOX3);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 4, SERPENT_SBOX4);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 5, SERPENT_SBOX5);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 6, SERPENT_SBOX6);              \
+        SERPENT_ENCRYPT_ROUND(x, ctx, round + 7, SERPENT_SBOX7);              \
+    }                                                                         \
+    SERPENT_FROM_PLANES(x);                                                   \
+    for (j = 0; j < (LANES); j++) {                                           \
+        for (i = 0; i < 4; i++) {                                             \
+            store32_le(out + j * BLOCK_SIZE + i * 4, x[i][j]);                \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+ATTR static void NAME##_decrypt(const serpent_ctx_t *ctx,                     \
+                                const uint8_t *in, uint8_t *out) {            \
+    typedef uint32_t vec_t __attribute__((vector_size((LANES) * 4)));         \
+    vec_t x[4];                                                               \
+    int i, j, round;                                                          \
+    for (i = 0; i < 4; i++) {                                                 \
+        for (j = 0; j < (LANES); j++) {                                       \
+            x[i][j] = load32_le(in + j * BLOCK_SIZE + i * 4);                 \
+        }                                                                     \
+    }                                                                         \
+    SERPENT_TO_PLANES(x);                                                     \
+    for (round = ROUNDS - 8; round >= 0; round -= 8) {                        \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 7, SERPENT_INV_SBOX7);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 6, SERPENT_INV_SBOX6);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 5, SERPENT_INV_SBOX5);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 4, SERPENT_INV_SBOX4);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 3, SERPENT_INV_SBOX3);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 2, SERPENT_INV_SBOX2);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round + 1, SERPENT_INV_SBOX1);          \
+        SERPENT_DECRYPT_ROUND(x, ctx, round, SERPENT_INV_SBOX0);              \
+    }                                                                         \
+    for (j = 0; j < (LANES); j++) {                                           \
+        for (i = 0; i < 4; i++) {                                             \
+            store32_le(out + j * BLOCK_SIZE + i * 4,                          \
+                       x[i][j] ^ ctx->subkeys[0][i]);                         \
+        }                                                                     \
+    }                                                                         \
+}
 
-    for (int i = 0; i < 128; i++) {
-        int input_bit = i;
-        int output_bit = bit_permutation[i];
+typedef void (*serpent_kernel_fn)(const serpent_ctx_t *ctx,
+                                  const uint8_t *in, uint8_t *out);
 
-        int input_word = input_bit / 32;
-        int input_pos = input_bit % 32;
-        int output_word = output_bit / 32;
-        int output_pos = output_bit % 32;
+typedef struct {
+    const char *name;
+    size_t lanes;
+    serpent_kernel_fn encrypt;
+    serpent_kernel_fn decrypt;
+} serpent_kernel_t;
 
-        if (input[input_word] & (1U << input_pos)) {
-            output[output_word] |= (1U << output_pos);
-        }
-    }
+DEFINE_SERPENT_KERNEL(serpent_kernel_scalar, 1, )
 
-    memcpy(state, output, 16);
-}
+static const serpent_kernel_t scalar_kernel = {
+    "scalar", 1, serpent_kernel_scalar_encrypt, serpent_kernel_scalar_decrypt
+};
 
-static void inverse_linear_transform(uint32_t *state) {
-    uint32_t input[4];
-    uint32_t output[4] = {0};
+#if defined(SERPENT_KERNEL_X86)
+DEFINE_SERPENT_KERNEL(serpent_kernel_avx2, 8, __attribute__((target("avx2"))))
 
-    memcpy(input, state, 16);
+static const serpent_kernel_t avx2_kernel = {
+    "avx2", 8, serpent_kernel_avx2_encrypt, serpent_kernel_avx2_decrypt
+};
+#endif
 
-    for (int i = 0; i < 128; i++) {
-        int output_bit = i;
-        int input_bit = bit_permutation[i];
+/* Picks the widest kernel the running CPU supports; the result is cached */
+static const serpent_kernel_t *select_serpent_kernel(void) {
+    static const serpent_kernel_t *selected = NULL;
 
-        int input_word = input_bit / 32;
-        int input_pos = input_bit % 32;
-        int output_word = output_bit / 32;
-        int output_pos = output_bit % 32;
+    if (selected != NULL) {
+        return selected;
+    }
 
-        if (input[input_word] & (1U << input_pos)) {
-            output[output_word] |= (1U << output_pos);
-        }
+#if defined(SERPENT_KERNEL_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        selected = &avx2_kernel;
+    } else {
+        selected = &scalar_kernel;
     }
+#else
+    selected = &scalar_kernel;
+#endif
+
+    return selected;
+}
 
-    memcpy(state, output, 16);
+const char *serpent_kernel_name(void) {
+    return select_serpent_kernel()->name;
 }
 
 void serpent_key_schedule(serpent_ctx_t *ctx, const uint8_t *key) {
     uint32_t w[140]; 
 
     for (int i = 0; i < 8; i++) {
-        w[i] = (key[i*4+3] << 24) | (key[i*4+2] << 16) |
-               (key[i*4+1] << 8) | key[i*4];
+        w[i] = load32_le(key + i * 4);
     }
 
     for (int i = 8; i < 140; i++) {
@@ -139,99 +574,108 @@ void serpent_key_schedule(serpent_ctx_t *ctx, const uint8_t *key) {
         temp[2] = w[round * 4 + 10];
         temp[3] = w[round * 4 + 11];
 
-        apply_sbox(temp, (ROUNDS + 3 - round) % 8);
+        SERPENT_TO_PLANES(temp);
+        serpent_sbox_planes(temp, (ROUNDS + 3 - round) % 8);
+        memcpy(ctx->sliced_subkeys[round], temp, sizeof(temp));
 
-        ctx->subkeys[round][0] = temp[0];
-        ctx->subkeys[round][1] = temp[1];
-        ctx->subkeys[round][2] = temp[2];
-        ctx->subkeys[round][3] = temp[3];
+        SERPENT_FROM_PLANES(temp);
+        memcpy(ctx->subkeys[round], temp, sizeof(temp));
     }
 }
 
 void serpent_encrypt_block(serpent_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint32_t state[4];
-
-    for (int i = 0; i < 4; i++) {
-        state[i] = (input[i*4+3] << 24) | (input[i*4+2] << 16) |
-                   (input[i*4+1] << 8) | input[i*4];
-    }
-
-    for (int i = 0; i < 4; i++) {
-        state[i] ^= ctx->subkeys[0][i];
-    }
+    serpent_kernel_scalar_encrypt(ctx, input, output);
+}
 
-    for (int round = 0; round < ROUNDS; round++) {
-        
-        apply_sbox(state, round % 8);
+void serpent_decrypt_block(serpent_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
+    serpent_kernel_scalar_decrypt(ctx, input, output);
+}
 
-        for (int i = 0; i < 4; i++) {
-            state[i] ^= ctx->subkeys[round + 1][i];
-        }
+/* Runs the widest kernel over full lane groups and the scalar one on the tail */
+static void serpent_process_blocks(const serpent_ctx_t *ctx, const uint8_t *input,
+                                   uint8_t *output, size_t blocks, int encrypt) {
+    const serpent_kernel_t *kernel = select_serpent_kernel();
+    serpent_kernel_fn wide = encrypt ? kernel->encrypt : kernel->decrypt;
+    serpent_kernel_fn narrow = encrypt ? scalar_kernel.encrypt : scalar_kernel.decrypt;
+    size_t i = 0;
 
-        if (round < ROUNDS - 1) {
-            linear_transform(state);
-        }
+    for (; i + kernel->lanes <= blocks; i += kernel->lanes) {
+        wide(ctx, input + i * BLOCK_SIZE, output + i * BLOCK_SIZE);
     }
-
-    for (int i = 0; i < 4; i++) {
-        output[i*4] = state[i] & 0xFF;
-        output[i*4+1] = (state[i] >> 8) & 0xFF;
-        output[i*4+2] = (state[i] >> 16) & 0xFF;
-        output[i*4+3] = (state[i] >> 24) & 0xFF;
+    for (; i < blocks; i++) {
+        narrow(ctx, input + i * BLOCK_SIZE, output + i * BLOCK_SIZE);
     }
 }
 
-void serpent_decrypt_block(serpent_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint32_t state[4];
-
-    for (int i = 0; i < 4; i++) {
-        state[i] = (input[i*4+3] << 24) | (input[i*4+2] << 16) |
-                   (input[i*4+1] << 8) | input[i*4];
-    }
-
-    for (int round = ROUNDS - 1; round >= 0; round--) {
-        
-        if (round < ROUNDS - 1) {
-            inverse_linear_transform(state);
-        }
+void serpent_encrypt_blocks(const serpent_ctx_t *ctx, const uint8_t *input,
+                            uint8_t *output, size_t blocks) {
+    serpent_process_blocks(ctx, input, output, blocks, 1);
+}
 
-        for (int i = 0; i < 4; i++) {
-            state[i] ^= ctx->subkeys[round + 1][i];
-        }
+void serpent_decrypt_blocks(const serpent_ctx_t *ctx, const uint8_t *input,
+                            uint8_t *output, size_t blocks) {
+    serpent_process_blocks(ctx, input, output, blocks, 0);
+}
 
-        apply_inverse_sbox(state, round % 8);
+int substitution_network_process(const uint8_t *input, uint8_t *output,
+                                size_t length, const uint8_t *key, int encrypt) {
+    if (length % BLOCK_SIZE != 0) {
+        return -1;
     }
 
-    for (int i = 0; i < 4; i++) {
-        state[i] ^= ctx->subkeys[0][i];
-    }
+    serpent_ctx_t ctx;
+    serpent_key_schedule(&ctx, key);
 
-    for (int i = 0; i < 4; i++) {
-        output[i*4] = state[i] & 0xFF;
-        output[i*4+1] = (state[i] >> 8) & 0xFF;
-        output[i*4+2] = (state[i] >> 16) & 0xFF;
-        output[i*4+3] = (state[i] >> 24) & 0xFF;
+    if (encrypt) {
+        serpent_encrypt_blocks(&ctx, input, output, length / BLOCK_SIZE);
+    } else {
+        serpent_decrypt_blocks(&ctx, input, output, length / BLOCK_SIZE);
     }
+
+    return 0;
 }
 
-int substitution_network_process(const uint8_t *input, uint8_t *output,
-                                size_t length, const uint8_t *key, int encrypt) {
-    if (length % BLOCK_SIZE != 0) {
-        return -1;
+static void increment_counter(uint8_t *counter) {
+    for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+        if (++counter[i] != 0) {
+            break;
+        }
     }
+}
 
+/*
+ * Counter mode: the 16-byte counter block is incremented as a big-endian
+ * integer per block. Any length is accepted and the operation is its own
+ * inverse. Counter blocks are encrypted MAX_KERNEL_LANES at a time.
+ */
+int substitution_network_process_ctr(const uint8_t *input, uint8_t *output,
+                                     size_t length, const uint8_t *key,
+                                     const uint8_t *initial_counter) {
     serpent_ctx_t ctx;
+    uint8_t counter[BLOCK_SIZE];
+    uint8_t counters[MAX_KERNEL_LANES * BLOCK_SIZE];
+    uint8_t keystream[MAX_KERNEL_LANES * BLOCK_SIZE];
+
     serpent_key_schedule(&ctx, key);
+    memcpy(counter, initial_counter, BLOCK_SIZE);
+
+    while (length > 0) {
+        size_t chunk = length < sizeof(keystream) ? length : sizeof(keystream);
+        size_t blocks = (chunk + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        for (size_t i = 0; i < blocks; i++) {
+            memcpy(counters + i * BLOCK_SIZE, counter, BLOCK_SIZE);
+            increment_counter(counter);
+        }
+        serpent_encrypt_blocks(&ctx, counters, keystream, blocks);
 
-    size_t blocks = length / BLOCK_SIZE;
-    for (size_t i = 0; i < blocks; i++) {
-        if (encrypt) {
-            serpent_encrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                output + i * BLOCK_SIZE);
-        } else {
-            serpent_decrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                output + i * BLOCK_SIZE);
+        for (size_t i = 0; i < chunk; i++) {
+            output[i] = input[i] ^ keystream[i];
         }
+
+        input += chunk;
+        output += chunk;
+        length -= chunk;
     }
 
     return 0;
@@ -242,7 +686,9 @@ int main() {
     uint8_t plaintext[32] = "Test data for substitution net!!";
     uint8_t ciphertext[32];
     uint8_t decrypted[32];
+    uint8_t counter[BLOCK_SIZE] = {0};
 
+    printf("Kernel: %s\n", serpent_kernel_name());
     printf("Original: %.*s\n", 32, plaintext);
 
     if (substitution_network_process(plaintext, ciphertext, 32, key, 1) == 0) {
@@ -257,5 +703,16 @@ int main() {
         }
     }
 
+    if (substitution_network_process_ctr(plaintext, ciphertext, 32, key, counter) == 0) {
+        printf("CTR encrypted: ");
+        for (int i = 0; i < 32; i++) {
+            printf("%02x ", ciphertext[i]);
+        }
+        printf("\n");
+
+        substitution_network_process_ctr(ciphertext, decrypted, 32, key, counter);
+        printf("CTR decrypted: %.*s\n", 32, decrypted);
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -1,14 +1,22 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #define ROUNDS 32
 #define BLOCK_SIZE 8
+#define GOVERNMENT_INTERLEAVE 8
 
 typedef struct {
     uint8_t key[10]; 
 } skipjack_ctx_t;
 
+typedef struct {
+    uint32_t k[4];
+} tea_ctx_t;
+
 static const uint8_t f_table[256] = {
     0xa3, 0xd7, 0x09, 0x83, 0xf8, 0x48, 0xf6, 0xf4, 0xb3, 0x21, 0x15, 0x78, 0x99, 0xb1, 0xaf, 0xf9,
     0xe7, 0x2d, 0x4d, 0x8a, 0xce, 0x4c, 0xca, 0x2e, 0x52, 0x95, 0xd9, 0x1e, 0x4e, 0x38, 0x44, 0x28,
@@ -28,26 +36,34 @@ static const uint8_t f_table[256] = {
     0x5e, 0x6c, 0xa9, 0x13, 0x57, 0x25, 0xb5, 0xe3, 0xbd, 0xa8, 0x3a, 0x01, 0x05, 0x59, 0x2a, 0x46
 };
 
-static uint16_t g_permutation(uint16_t w, const uint8_t *key, int step) {
+/* The four key bytes G consumes at a given step; the key is used cyclically */
+static inline void g_step_key(const uint8_t *key, int step, uint8_t *cv) {
+    cv[0] = key[(4 * step) % 10];
+    cv[1] = key[(4 * step + 1) % 10];
+    cv[2] = key[(4 * step + 2) % 10];
+    cv[3] = key[(4 * step + 3) % 10];
+}
+
+static inline uint16_t g_permutation(uint16_t w, const uint8_t *cv) {
     uint8_t g1 = (w >> 8) & 0xFF;
     uint8_t g2 = w & 0xFF;
 
-    g1 ^= f_table[g2 ^ key[(4 * step) % 10]];
-    g2 ^= f_table[g1 ^ key[(4 * step + 1) % 10]];
-    g1 ^= f_table[g2 ^ key[(4 * step + 2) % 10]];
-    g2 ^= f_table[g1 ^ key[(4 * step + 3) % 10]];
+    g1 ^= f_table[g2 ^ cv[0]];
+    g2 ^= f_table[g1 ^ cv[1]];
+    g1 ^= f_table[g2 ^ cv[2]];
+    g2 ^= f_table[g1 ^ cv[3]];
 
     return ((uint16_t)g1 << 8) | g2;
 }
 
-static uint16_t g_inverse(uint16_t w, const uint8_t *key, int step) {
+static inline uint16_t g_inverse(uint16_t w, const uint8_t *cv) {
     uint8_t g1 = (w >> 8) & 0xFF;
     uint8_t g2 = w & 0xFF;
 
-    g2 ^= f_table[g1 ^ key[(4 * step + 3) % 10]];
-    g1 ^= f_table[g2 ^ key[(4 * step + 2) % 10]];
-    g2 ^= f_table[g1 ^ key[(4 * step + 1) % 10]];
-    g1 ^= f_table[g2 ^ key[(4 * step) % 10]];
+    g2 ^= f_table[g1 ^ cv[3]];
+    g1 ^= f_table[g2 ^ cv[2]];
+    g2 ^= f_table[g1 ^ cv[1]];
+    g1 ^= f_table[g2 ^ cv[0]];
 
     return ((uint16_t)g1 << 8) | g2;
 }
@@ -56,167 +72,576 @@ void skipjack_init(skipjack_ctx_t *ctx, const uint8_t *key) {
     memcpy(ctx->key, key, 10);
 }
 
-void skipjack_encrypt_block(skipjack_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint16_t w1 = (input[0] << 8) | input[1];
-    uint16_t w2 = (input[2] << 8) | input[3];
-    uint16_t w3 = (input[4] << 8) | input[5];
-    uint16_t w4 = (input[6] << 8) | input[7];
+static inline uint16_t load16_be(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void store16_be(uint8_t *p, uint16_t v) {
+    p[0] = (v >> 8) & 0xFF;
+    p[1] = v & 0xFF;
+}
+
+static inline uint32_t load32_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store32_be(uint8_t *p, uint32_t v) {
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+/*
+ * Each G step is four dependent f_table lookups, so a single block is
+ * latency bound. Running up to GOVERNMENT_INTERLEAVE blocks per round
+ * keeps several of those chains in flight at once.
+ */
+static inline void skipjack_encrypt_lanes(const skipjack_ctx_t *ctx, const uint8_t *input,
+                                          uint8_t *output, size_t lanes) {
+    uint16_t w1[GOVERNMENT_INTERLEAVE], w2[GOVERNMENT_INTERLEAVE];
+    uint16_t w3[GOVERNMENT_INTERLEAVE], w4[GOVERNMENT_INTERLEAVE];
+
+    for (size_t j = 0; j < lanes; j++) {
+        w1[j] = load16_be(input + j * BLOCK_SIZE);
+        w2[j] = load16_be(input + j * BLOCK_SIZE + 2);
+        w3[j] = load16_be(input + j * BLOCK_SIZE + 4);
+        w4[j] = load16_be(input + j * BLOCK_SIZE + 6);
+    }
 
     for (int round = 0; round < ROUNDS; round++) {
+        uint8_t cv[4];
+
+        g_step_key(ctx->key, round + 1, cv);
         if (round < 8 || (round >= 16 && round < 24)) {
-            
-            uint16_t temp = w4;
-            w4 = w3;
-            w3 = w2;
-            w2 = g_permutation(w1, ctx->key, round + 1) ^ w4 ^ (round + 1);
-            w1 = temp;
+            for (size_t j = 0; j < lanes; j++) {
+                uint16_t temp = w4[j];
+                w4[j] = w3[j];
+                w3[j] = w2[j];
+                w2[j] = g_permutation(w1[j], cv) ^ w4[j] ^ (round + 1);
+                w1[j] = temp;
+            }
         } else {
-            
-            uint16_t temp = w4;
-            w4 = w3;
-            w3 = g_permutation(w2, ctx->key, round + 1) ^ w1 ^ (round + 1);
-            w2 = w1;
-            w1 = temp;
+            for (size_t j = 0; j < lanes; j++) {
+                uint16_t temp = w4[j];
+                w4[j] = w3[j];
+                w3[j] = g_permutation(w2[j], cv) ^ w1[j] ^ (round + 1);
+                w2[j] = w1[j];
+                w1[j] = temp;
+            }
         }
     }
 
-    output[0] = (w1 >> 8) & 0xFF;
-    output[1] = w1 & 0xFF;
-    output[2] = (w2 >> 8) & 0xFF;
-    output[3] = w2 & 0xFF;
-    output[4] = (w3 >> 8) & 0xFF;
-    output[5] = w3 & 0xFF;
-    output[6] = (w4 >> 8) & 0xFF;
-    output[7] = w4 & 0xFF;
+    for (size_t j = 0; j < lanes; j++) {
+        store16_be(output + j * BLOCK_SIZE, w1[j]);
+        store16_be(output + j * BLOCK_SIZE + 2, w2[j]);
+        store16_be(output + j * BLOCK_SIZE + 4, w3[j]);
+        store16_be(output + j * BLOCK_SIZE + 6, w4[j]);
+    }
 }
 
-void skipjack_decrypt_block(skipjack_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint16_t w1 = (input[0] << 8) | input[1];
-    uint16_t w2 = (input[2] << 8) | input[3];
-    uint16_t w3 = (input[4] << 8) | input[5];
-    uint16_t w4 = (input[6] << 8) | input[7];
+static inline void skipjack_decrypt_lanes(const skipjack_ctx_t *ctx, const uint8_t *input,
+                                          uint8_t *output, size_t lanes) {
+    uint16_t w1[GOVERNMENT_INTERLEAVE], w2[GOVERNMENT_INTERLEAVE];
+    uint16_t w3[GOVERNMENT_INTERLEAVE], w4[GOVERNMENT_INTERLEAVE];
+
+    for (size_t j = 0; j < lanes; j++) {
+        w1[j] = load16_be(input + j * BLOCK_SIZE);
+        w2[j] = load16_be(input + j * BLOCK_SIZE + 2);
+        w3[j] = load16_be(input + j * BLOCK_SIZE + 4);
+        w4[j] = load16_be(input + j * BLOCK_SIZE + 6);
+    }
 
     for (int round = ROUNDS - 1; round >= 0; round--) {
+        uint8_t cv[4];
+
+        g_step_key(ctx->key, round + 1, cv);
         if (round < 8 || (round >= 16 && round < 24)) {
-            
-            uint16_t temp = w1;
-            w1 = w2;
-            w2 = w3;
-            w3 = w4;
-            w4 = g_inverse(w2 ^ w4 ^ (round + 1), ctx->key, round + 1);
-            w2 = temp;
+            /* Inverts (w1, w2, w3, w4) -> (w4, G(w1) ^ w3 ^ c, w2, w3) */
+            for (size_t j = 0; j < lanes; j++) {
+                uint16_t temp = w1[j];
+                w1[j] = g_inverse(w2[j] ^ w4[j] ^ (round + 1), cv);
+                w2[j] = w3[j];
+                w3[j] = w4[j];
+                w4[j] = temp;
+            }
         } else {
-            
-            uint16_t temp = w1;
-            w1 = w2;
-            w2 = w3;
-            w3 = g_inverse(w3 ^ w1 ^ (round + 1), ctx->key, round + 1);
-            w1 = temp;
+            /* Inverts (w1, w2, w3, w4) -> (w4, w1, G(w2) ^ w1 ^ c, w3) */
+            for (size_t j = 0; j < lanes; j++) {
+                uint16_t temp = w1[j];
+                w1[j] = w2[j];
+                w2[j] = g_inverse(w3[j] ^ w2[j] ^ (round + 1), cv);
+                w3[j] = w4[j];
+                w4[j] = temp;
+            }
         }
     }
 
-    output[0] = (w1 >> 8) & 0xFF;
-    output[1] = w1 & 0xFF;
-    output[2] = (w2 >> 8) & 0xFF;
-    output[3] = w2 & 0xFF;
-    output[4] = (w3 >> 8) & 0xFF;
-    output[5] = w3 & 0xFF;
-    output[6] = (w4 >> 8) & 0xFF;
-    output[7] = w4 & 0xFF;
+    for (size_t j = 0; j < lanes; j++) {
+        store16_be(output + j * BLOCK_SIZE, w1[j]);
+        store16_be(output + j * BLOCK_SIZE + 2, w2[j]);
+        store16_be(output + j * BLOCK_SIZE + 4, w3[j]);
+        store16_be(output + j * BLOCK_SIZE + 6, w4[j]);
+    }
+}
+
+void skipjack_encrypt_block(skipjack_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
+    skipjack_encrypt_lanes(ctx, input, output, 1);
 }
 
-void tea_encrypt_block(const uint8_t *input, uint8_t *output, const uint8_t *key) {
-    uint32_t v0 = (input[0] << 24) | (input[1] << 16) | (input[2] << 8) | input[3];
-    uint32_t v1 = (input[4] << 24) | (input[5] << 16) | (input[6] << 8) | input[7];
+void skipjack_decrypt_block(skipjack_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
+    skipjack_decrypt_lanes(ctx, input, output, 1);
+}
 
-    uint32_t k0 = (key[0] << 24) | (key[1] << 16) | (key[2] << 8) | key[3];
-    uint32_t k1 = (key[4] << 24) | (key[5] << 16) | (key[6] << 8) | key[7];
-    uint32_t k2 = (key[8] << 24) | (key[9] << 16) | (key[10] << 8) | key[11];
-    uint32_t k3 = (key[12] << 24) | (key[13] << 16) | (key[14] << 8) | key[15];
+static void tea_init(tea_ctx_t *ctx, const uint8_t *key) {
+    for (int i = 0; i < 4; i++) {
+        ctx->k[i] = load32_be(key + i * 4);
+    }
+}
 
+/* TEA is a serial ARX chain; interleaving overlaps the chains of several blocks */
+static inline void tea_encrypt_lanes(const tea_ctx_t *ctx, const uint8_t *input,
+                                     uint8_t *output, size_t lanes) {
+    uint32_t v0[GOVERNMENT_INTERLEAVE], v1[GOVERNMENT_INTERLEAVE];
+    uint32_t k0 = ctx->k[0], k1 = ctx->k[1], k2 = ctx->k[2], k3 = ctx->k[3];
     uint32_t sum = 0;
     uint32_t delta = 0x9e3779b9;
 
+    for (size_t j = 0; j < lanes; j++) {
+        v0[j] = load32_be(input + j * BLOCK_SIZE);
+        v1[j] = load32_be(input + j * BLOCK_SIZE + 4);
+    }
+
     for (int i = 0; i < 32; i++) {
         sum += delta;
-        v0 += ((v1 << 4) + k0) ^ (v1 + sum) ^ ((v1 >> 5) + k1);
-        v1 += ((v0 << 4) + k2) ^ (v0 + sum) ^ ((v0 >> 5) + k3);
-    }
-
-    output[0] = (v0 >> 24) & 0xFF;
-    output[1] = (v0 >> 16) & 0xFF;
-    output[2] = (v0 >> 8) & 0xFF;
-    output[3] = v0 & 0xFF;
-    output[4] = (v1 >> 24) & 0xFF;
-    output[5] = (v1 >> 16) & 0xFF;
-    output[6] = (v1 >> 8) & 0xFF;
-    output[7] = v1 & 0xFF;
-}
-
-void tea_decrypt_block(const uint8_t *input, uint8_t *output, const uint8_t *key) {
-    uint32_t v0 = (input[0] << 24) | (input[1] << 16) | (input[2] << 8) | input[3];
-    uint32_t v1 = (input[4] << 24) | (input[5] << 16) | (input[6] << 8) | input[7];
+        for (size_t j = 0; j < lanes; j++) {
+            v0[j] += ((v1[j] << 4) + k0) ^ (v1[j] + sum) ^ ((v1[j] >> 5) + k1);
+            v1[j] += ((v0[j] << 4) + k2) ^ (v0[j] + sum) ^ ((v0[j] >> 5) + k3);
+        }
+    }
 
-    uint32_t k0 = (key[0] << 24) | (key[1] << 16) | (key[2] << 8) | key[3];
-    uint32_t k1 = (key[4] << 24) | (key[5] << 16) | (key[6] << 8) | key[7];
-    uint32_t k2 = (key[8] << 24) | (key[9] << 16) | (key[10] << 8) | key[11];
-    uint32_t k3 = (key[12] << 24) | (key[13] << 16) | (key[14] << 8) | key[15];
+    for (size_t j = 0; j < lanes; j++) {
+        store32_be(output + j * BLOCK_SIZE, v0[j]);
+        store32_be(output + j * BLOCK_SIZE + 4, v1[j]);
+    }
+}
 
+static inline void tea_decrypt_lanes(const tea_ctx_t *ctx, const uint8_t *input,
+                                     uint8_t *output, size_t lanes) {
+    uint32_t v0[GOVERNMENT_INTERLEAVE], v1[GOVERNMENT_INTERLEAVE];
+    uint32_t k0 = ctx->k[0], k1 = ctx->k[1], k2 = ctx->k[2], k3 = ctx->k[3];
     uint32_t sum = 0xC6EF3720; 
     uint32_t delta = 0x9e3779b9;
 
+    for (size_t j = 0; j < lanes; j++) {
+        v0[j] = load32_be(input + j * BLOCK_SIZE);
+        v1[j] = load32_be(input + j * BLOCK_SIZE + 4);
+    }
+
     for (int i = 0; i < 32; i++) {
-        v1 -= ((v0 << 4) + k2) ^ (v0 + sum) ^ ((v0 >> 5) + k3);
-        v0 -= ((v1 << 4) + k0) ^ (v1 + sum) ^ ((v1 >> 5) + k1);
+        for (size_t j = 0; j < lanes; j++) {
+            v1[j] -= ((v0[j] << 4) + k2) ^ (v0[j] + sum) ^ ((v0[j] >> 5) + k3);
+            v0[j] -= ((v1[j] << 4) + k0) ^ (v1[j] + sum) ^ ((v1[j] >> 5) + k1);
+        }
         sum -= delta;
     }
 
-    output[0] = (v0 >> 24) & 0xFF;
-    output[1] = (v0 >> 16) & 0xFF;
-    output[2] = (v0 >> 8) & 0xFF;
-    output[3] = v0 & 0xFF;
-    output[4] = (v1 >> 24) & 0xFF;
-    output[5] = (v1 >> 16) & 0xFF;
-    output[6] = (v1 >> 8) & 0xFF;
-    output[7] = v1 & 0xFF;
+    for (size_t j = 0; j < lanes; j++) {
+        store32_be(output + j * BLOCK_SIZE, v0[j]);
+        store32_be(output + j * BLOCK_SIZE + 4, v1[j]);
+    }
 }
 
-int government_cipher_process(const uint8_t *input, uint8_t *output, size_t length,
-                             const uint8_t *key, int algorithm, int encrypt) {
-    if (length % BLOCK_SIZE != 0) {
-        return -1;
+void tea_encrypt_block(const uint8_t *input, uint8_t *output, const uint8_t *key) {
+    tea_ctx_t ctx;
+
+    tea_init(&ctx, key);
+    tea_encrypt_lanes(&ctx, input, output, 1);
+}
+
+void tea_decrypt_block(const uint8_t *input, uint8_t *output, const uint8_t *key) {
+    tea_ctx_t ctx;
+
+    tea_init(&ctx, key);
+    tea_decrypt_lanes(&ctx, input, output, 1);
+}
+
+/* Full groups go through the interleaved kernel with a constant lane count */
+#define DEFINE_BLOCKS_ADAPTER(NAME, CTX_TYPE, LANES_FN)                        \
+static void NAME(const void *ctx, const uint8_t *input,                       \
+                 uint8_t *output, size_t blocks) {                            \
+    size_t i = 0;                                                             \
+    for (; i + GOVERNMENT_INTERLEAVE <= blocks; i += GOVERNMENT_INTERLEAVE) { \
+        LANES_FN((const CTX_TYPE *)ctx, input + i * BLOCK_SIZE,               \
+                 output + i * BLOCK_SIZE, GOVERNMENT_INTERLEAVE);             \
+    }                                                                         \
+    if (i < blocks) {                                                         \
+        LANES_FN((const CTX_TYPE *)ctx, input + i * BLOCK_SIZE,               \
+                 output + i * BLOCK_SIZE, blocks - i);                        \
+    }                                                                         \
+}
+
+DEFINE_BLOCKS_ADAPTER(skipjack_encrypt_blocks, skipjack_ctx_t, skipjack_encrypt_lanes)
+DEFINE_BLOCKS_ADAPTER(skipjack_decrypt_blocks, skipjack_ctx_t, skipjack_decrypt_lanes)
+DEFINE_BLOCKS_ADAPTER(tea_encrypt_blocks, tea_ctx_t, tea_encrypt_lanes)
+DEFINE_BLOCKS_ADAPTER(tea_decrypt_blocks, tea_ctx_t, tea_decrypt_lanes)
+
+typedef enum {
+    CIPHER_MODE_ECB,
+    CIPHER_MODE_CBC,
+    CIPHER_MODE_CTR
+} cipher_mode_t;
+
+typedef void (*cipher_blocks_fn)(const void *ctx, const uint8_t *input,
+                                 uint8_t *output, size_t blocks);
+
+typedef struct {
+    const void *ctx;
+    cipher_blocks_fn encrypt_blocks;
+    cipher_blocks_fn decrypt_blocks;
+} block_cipher_t;
+
+#define MODE_CHUNK_BLOCKS 64
+#define PARALLEL_MIN_TASK_BYTES (256 * 1024)
+#define POOL_MAX_WORKERS 63
+#define POOL_TASKS_PER_THREAD 4
+
+typedef void (*block_range_fn)(void *arg, size_t first, size_t count);
+
+/*
+ * Fork-join pool for the bulk modes. Workers start on first use and sleep
+ * between jobs; a job is cut into contiguous block ranges that the workers
+ * and the submitting thread claim until none are left.
+ */
+typedef struct {
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    size_t workers;
+    unsigned long generation;
+    block_range_fn fn;
+    void *arg;
+    size_t total_blocks;
+    size_t task_blocks;
+    size_t task_count;
+    size_t next_task;
+    size_t tasks_finished;
+} worker_pool_t;
+
+static worker_pool_t worker_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, NULL, NULL, 0, 0, 0, 0, 0
+};
+static pthread_once_t worker_pool_once = PTHREAD_ONCE_INIT;
+
+/* Runs tasks of the current job until all are claimed; pool->lock is held */
+static void worker_pool_drain(worker_pool_t *pool) {
+    while (pool->next_task < pool->task_count) {
+        size_t first = pool->next_task++ * pool->task_blocks;
+        size_t count = pool->total_blocks - first;
+        block_range_fn fn = pool->fn;
+        void *arg = pool->arg;
+
+        if (count > pool->task_blocks) {
+            count = pool->task_blocks;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+        fn(arg, first, count);
+        pthread_mutex_lock(&pool->lock);
+
+        if (++pool->tasks_finished == pool->task_count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void *worker_pool_main(void *unused) {
+    worker_pool_t *pool = &worker_pool;
+    unsigned long seen = 0;
+
+    (void)unused;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        seen = pool->generation;
+        worker_pool_drain(pool);
     }
+    return NULL;
+}
 
-    size_t blocks = length / BLOCK_SIZE;
+static void worker_pool_start(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus - 1 : 0;
 
-    if (algorithm == 0) { 
-        skipjack_ctx_t ctx;
-        skipjack_init(&ctx, key);
+    if (wanted > POOL_MAX_WORKERS) {
+        wanted = POOL_MAX_WORKERS;
+    }
+
+    for (size_t i = 0; i < wanted; i++) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, worker_pool_main, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_pool.workers++;
+    }
+}
+
+/* Blocks per task for a job of total_blocks; total_blocks means run inline */
+static size_t worker_pool_plan(size_t total_blocks) {
+    size_t min_task_blocks = PARALLEL_MIN_TASK_BYTES / BLOCK_SIZE;
+    size_t tasks;
+
+    if (total_blocks < 2 * min_task_blocks) {
+        return total_blocks;
+    }
+
+    pthread_once(&worker_pool_once, worker_pool_start);
+    if (worker_pool.workers == 0) {
+        return total_blocks;
+    }
+
+    tasks = total_blocks / min_task_blocks;
+    if (tasks > (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD) {
+        tasks = (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD;
+    }
+
+    return (total_blocks + tasks - 1) / tasks;
+}
+
+static void worker_pool_run(size_t total_blocks, size_t task_blocks,
+                            block_range_fn fn, void *arg) {
+    worker_pool_t *pool = &worker_pool;
+
+    if (task_blocks >= total_blocks) {
+        fn(arg, 0, total_blocks);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->total_blocks = total_blocks;
+    pool->task_blocks = task_blocks;
+    pool->task_count = (total_blocks + task_blocks - 1) / task_blocks;
+    pool->next_task = 0;
+    pool->tasks_finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    worker_pool_drain(pool);
+    while (pool->tasks_finished < pool->task_count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+typedef struct {
+    const block_cipher_t *cipher;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t length;
+    const uint8_t *iv;
+    const uint8_t *boundaries;
+    size_t task_blocks;
+    int encrypt;
+} mode_job_t;
+
+static void ecb_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    cipher_blocks_fn fn = job->encrypt ? job->cipher->encrypt_blocks
+                                       : job->cipher->decrypt_blocks;
+
+    fn(job->cipher->ctx, job->input + first * BLOCK_SIZE,
+       job->output + first * BLOCK_SIZE, count);
+}
+
+/* ctr = iv + n, with the counter block read as a big-endian integer */
+static void counter_at(uint8_t *ctr, const uint8_t *iv, uint64_t n) {
+    unsigned int carry = 0;
+
+    for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+        unsigned int sum = iv[i] + (unsigned int)(n & 0xFF) + carry;
+        ctr[i] = sum & 0xFF;
+        carry = sum >> 8;
+        n >>= 8;
+    }
+}
+
+static void ctr_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t counters[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    uint8_t keystream[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    size_t offset = first * BLOCK_SIZE;
+    size_t end = (first + count) * BLOCK_SIZE;
+
+    if (end > job->length) {
+        end = job->length;
+    }
+
+    while (offset < end) {
+        size_t bytes = end - offset < sizeof(keystream) ? end - offset : sizeof(keystream);
+        size_t blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
 
         for (size_t i = 0; i < blocks; i++) {
-            if (encrypt) {
-                skipjack_encrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                     output + i * BLOCK_SIZE);
-            } else {
-                skipjack_decrypt_block(&ctx, input + i * BLOCK_SIZE,
-                                     output + i * BLOCK_SIZE);
+            counter_at(counters + i * BLOCK_SIZE, job->iv, offset / BLOCK_SIZE + i);
+        }
+        job->cipher->encrypt_blocks(job->cipher->ctx, counters, keystream, blocks);
+
+        for (size_t i = 0; i < bytes; i++) {
+            job->output[offset + i] = job->input[offset + i] ^ keystream[i];
+        }
+        offset += bytes;
+    }
+}
+
+/*
+ * Each task starts from the ciphertext block just before its range, which
+ * the submitter copies out first so in-place decryption stays correct.
+ */
+static void cbc_decrypt_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t previous[BLOCK_SIZE];
+    uint8_t saved[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+
+    if (first == 0) {
+        memcpy(previous, job->iv, BLOCK_SIZE);
+    } else {
+        memcpy(previous, job->boundaries + (first / job->task_blocks - 1) * BLOCK_SIZE,
+               BLOCK_SIZE);
+    }
+
+    for (size_t done = 0; done < count;) {
+        size_t blocks = count - done < MODE_CHUNK_BLOCKS ? count - done : MODE_CHUNK_BLOCKS;
+        uint8_t *out = job->output + (first + done) * BLOCK_SIZE;
+
+        memcpy(saved, job->input + (first + done) * BLOCK_SIZE, blocks * BLOCK_SIZE);
+        job->cipher->decrypt_blocks(job->cipher->ctx, saved, out, blocks);
+
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t *chain = b == 0 ? previous : saved + (b - 1) * BLOCK_SIZE;
+
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                out[b * BLOCK_SIZE + i] ^= chain[i];
             }
         }
-    } else { 
-        for (size_t i = 0; i < blocks; i++) {
-            if (encrypt) {
-                tea_encrypt_block(input + i * BLOCK_SIZE,
-                                output + i * BLOCK_SIZE, key);
-            } else {
-                tea_decrypt_block(input + i * BLOCK_SIZE,
-                                output + i * BLOCK_SIZE, key);
+
+        memcpy(previous, saved + (blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+        done += blocks;
+    }
+}
+
+/* CBC encryption chains every block on the previous one, so it stays serial */
+static void cbc_encrypt(const block_cipher_t *cipher, const uint8_t *input,
+                        uint8_t *output, size_t blocks, const uint8_t *iv) {
+    uint8_t chain[BLOCK_SIZE];
+
+    memcpy(chain, iv, BLOCK_SIZE);
+    for (size_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            chain[i] ^= input[b * BLOCK_SIZE + i];
+        }
+        cipher->encrypt_blocks(cipher->ctx, chain, chain, 1);
+        memcpy(output + b * BLOCK_SIZE, chain, BLOCK_SIZE);
+    }
+}
+
+/*
+ * ECB, CBC decryption and CTR are split across the worker pool. CTR
+ * accepts a partial final block; ECB and CBC need whole blocks. Returns
+ * -1 on bad arguments or allocation failure.
+ */
+static int block_mode_process(const block_cipher_t *cipher, const uint8_t *input,
+                              uint8_t *output, size_t length, cipher_mode_t mode,
+                              const uint8_t *iv, int encrypt) {
+    mode_job_t job = { cipher, input, output, length, iv, NULL, 0, encrypt };
+    size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint8_t *boundaries = NULL;
+    block_range_fn fn;
+
+    if (mode != CIPHER_MODE_CTR && length % BLOCK_SIZE != 0) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_ECB && iv == NULL) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_CTR && !encrypt && cipher->decrypt_blocks == NULL) {
+        return -1;
+    }
+    if (blocks == 0) {
+        return 0;
+    }
+
+    if (mode == CIPHER_MODE_CBC && encrypt) {
+        cbc_encrypt(cipher, input, output, blocks, iv);
+        return 0;
+    }
+
+    job.task_blocks = worker_pool_plan(blocks);
+
+    if (mode == CIPHER_MODE_ECB) {
+        fn = ecb_range;
+    } else if (mode == CIPHER_MODE_CTR) {
+        fn = ctr_range;
+    } else {
+        size_t tasks = (blocks + job.task_blocks - 1) / job.task_blocks;
+
+        if (tasks > 1) {
+            boundaries = malloc((tasks - 1) * BLOCK_SIZE);
+            if (boundaries == NULL) {
+                return -1;
+            }
+            for (size_t t = 1; t < tasks; t++) {
+                memcpy(boundaries + (t - 1) * BLOCK_SIZE,
+                       input + (t * job.task_blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
             }
         }
+        job.boundaries = boundaries;
+        fn = cbc_decrypt_range;
     }
 
+    worker_pool_run(blocks, job.task_blocks, fn, &job);
+    free(boundaries);
+
     return 0;
 }
 
+/* iv is the CBC IV or the initial CTR counter block; unused for ECB */
+int government_cipher_process_mode(const uint8_t *input, uint8_t *output, size_t length,
+                                   const uint8_t *key, int algorithm, cipher_mode_t mode,
+                                   const uint8_t *iv, int encrypt) {
+    if (algorithm == 0) { 
+        skipjack_ctx_t ctx;
+        block_cipher_t cipher = { &ctx, skipjack_encrypt_blocks, skipjack_decrypt_blocks };
+
+        skipjack_init(&ctx, key);
+        return block_mode_process(&cipher, input, output, length, mode, iv, encrypt);
+    } else { 
+        tea_ctx_t ctx;
+        block_cipher_t cipher = { &ctx, tea_encrypt_blocks, tea_decrypt_blocks };
+
+        tea_init(&ctx, key);
+        return block_mode_process(&cipher, input, output, length, mode, iv, encrypt);
+    }
+}
+
+int government_cipher_process(const uint8_t *input, uint8_t *output, size_t length,
+                             const uint8_t *key, int algorithm, int encrypt) {
+    return government_cipher_process_mode(input, output, length, key, algorithm,
+                                          CIPHER_MODE_ECB, NULL, encrypt);
+}
+
 int main() {
     uint8_t skipjack_key[10] = {0x00, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11};
     uint8_t tea_key[16] = "TeaSecretKey1234";
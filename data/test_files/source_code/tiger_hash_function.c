@@ -1,9 +1,21 @@
+/* madvise and MADV_WILLNEED for the mapped file input are not part of ISO C */
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define TIGER_DIGEST_SIZE 24
 #define TIGER_BLOCK_SIZE 64
+#define TIGER_LANES 4
+#define HAVAL_BLOCK_SIZE 128
+#define HAVAL_VERSION 1
 
 typedef struct {
     uint64_t state[3];
@@ -130,6 +142,15 @@ void tiger_init(tiger_ctx_t *ctx) {
 
 void tiger_update(tiger_ctx_t *ctx, const uint8_t *data, size_t length) {
     while (length > 0) {
+        /* Whole blocks are compressed straight from the caller's memory */
+        if (ctx->buffer_len == 0 && length >= TIGER_BLOCK_SIZE) {
+            tiger_compress(ctx, data);
+            ctx->count += TIGER_BLOCK_SIZE;
+            data += TIGER_BLOCK_SIZE;
+            length -= TIGER_BLOCK_SIZE;
+            continue;
+        }
+
         size_t to_copy = TIGER_BLOCK_SIZE - ctx->buffer_len;
         if (to_copy > length) {
             to_copy = length;
@@ -216,6 +237,162 @@ void tiger2_final(tiger_ctx_t *ctx, uint8_t *digest) {
     }
 }
 
+/*
+ * Multi-buffer Tiger. Each lane compresses a block of a different message;
+ * a Tiger round is a chain of dependent S-box lookups, so running the lanes
+ * round by round lets one lane's loads overlap another's.
+ */
+static inline void tiger_round_lanes(uint64_t *a, uint64_t *b, uint64_t *c,
+                                     uint64_t (*x)[8], int i, int mul, size_t lanes) {
+    for (size_t l = 0; l < lanes; l++) {
+        tiger_round(&a[l], &b[l], &c[l], x[l][i], mul);
+    }
+}
+
+static inline void tiger_pass_lanes(uint64_t *a, uint64_t *b, uint64_t *c,
+                                    uint64_t (*x)[8], int mul, size_t lanes) {
+    tiger_round_lanes(a, b, c, x, 0, mul, lanes);
+    tiger_round_lanes(b, c, a, x, 1, mul, lanes);
+    tiger_round_lanes(c, a, b, x, 2, mul, lanes);
+    tiger_round_lanes(a, b, c, x, 3, mul, lanes);
+    tiger_round_lanes(b, c, a, x, 4, mul, lanes);
+    tiger_round_lanes(c, a, b, x, 5, mul, lanes);
+    tiger_round_lanes(a, b, c, x, 6, mul, lanes);
+    tiger_round_lanes(b, c, a, x, 7, mul, lanes);
+}
+
+static inline void tiger_compress_lanes(uint64_t (*state)[3], const uint8_t *const *block,
+                                        size_t lanes) {
+    uint64_t a[TIGER_LANES], b[TIGER_LANES], c[TIGER_LANES];
+    uint64_t aa[TIGER_LANES], bb[TIGER_LANES], cc[TIGER_LANES];
+    uint64_t x[TIGER_LANES][8];
+
+    for (size_t l = 0; l < lanes; l++) {
+        for (int i = 0; i < 8; i++) {
+            x[l][i] = 0;
+            for (int j = 0; j < 8; j++) {
+                x[l][i] |= ((uint64_t)block[l][i * 8 + j]) << (j * 8);
+            }
+        }
+        a[l] = aa[l] = state[l][0];
+        b[l] = bb[l] = state[l][1];
+        c[l] = cc[l] = state[l][2];
+    }
+
+    tiger_pass_lanes(a, b, c, x, 5, lanes);
+    for (size_t l = 0; l < lanes; l++) {
+        tiger_key_schedule(x[l]);
+    }
+
+    tiger_pass_lanes(c, a, b, x, 7, lanes);
+    for (size_t l = 0; l < lanes; l++) {
+        tiger_key_schedule(x[l]);
+    }
+
+    tiger_pass_lanes(b, c, a, x, 9, lanes);
+
+    for (size_t l = 0; l < lanes; l++) {
+        state[l][0] = a[l] ^ aa[l];
+        state[l][1] = b[l] - bb[l];
+        state[l][2] = c[l] + cc[l];
+    }
+}
+
+/* One message in flight: its whole blocks, then one or two padded tail blocks */
+typedef struct {
+    const uint8_t *data;
+    size_t blocks;
+    size_t tail_blocks;
+    size_t next;
+    uint8_t tail[2 * TIGER_BLOCK_SIZE];
+    uint8_t *digest;
+} tiger_job_t;
+
+/* pad is the first padding byte: 0x01 for Tiger, 0x80 for Tiger2 */
+static void tiger_job_start(tiger_job_t *job, const uint8_t *input, size_t length,
+                            uint8_t *digest, uint8_t pad) {
+    size_t rem = length % TIGER_BLOCK_SIZE;
+    uint64_t bit_count = (uint64_t)length * 8;
+
+    job->data = input;
+    job->blocks = length / TIGER_BLOCK_SIZE;
+    job->tail_blocks = rem + 1 > 56 ? 2 : 1;
+    job->next = 0;
+    job->digest = digest;
+
+    memset(job->tail, 0, sizeof(job->tail));
+    memcpy(job->tail, input + length - rem, rem);
+    job->tail[rem] = pad;
+    for (int i = 0; i < 8; i++) {
+        job->tail[job->tail_blocks * TIGER_BLOCK_SIZE - 8 + i] = (bit_count >> (i * 8)) & 0xFF;
+    }
+}
+
+static const uint8_t *tiger_job_block(const tiger_job_t *job) {
+    if (job->next < job->blocks) {
+        return job->data + job->next * TIGER_BLOCK_SIZE;
+    }
+    return job->tail + (job->next - job->blocks) * TIGER_BLOCK_SIZE;
+}
+
+/*
+ * Hashes count independent messages, keeping TIGER_LANES of them in flight
+ * and refilling a lane as soon as its message finishes. Each digest is the
+ * same as tiger_init/tiger_update/tiger_final (or the Tiger2 variants).
+ */
+void tiger_compute_multi(const uint8_t *const *inputs, const size_t *lengths,
+                         uint8_t *const *digests, size_t count, int tiger2) {
+    tiger_job_t jobs[TIGER_LANES];
+    uint64_t state[TIGER_LANES][3];
+    const uint8_t *blocks[TIGER_LANES];
+    uint8_t pad = tiger2 ? 0x80 : 0x01;
+    size_t active = 0, next = 0;
+
+    for (;;) {
+        while (active < TIGER_LANES && next < count) {
+            tiger_job_start(&jobs[active], inputs[next], lengths[next], digests[next], pad);
+            state[active][0] = 0x0123456789ABCDEFULL;
+            state[active][1] = 0xFEDCBA9876543210ULL;
+            state[active][2] = 0xF096A5B4C3B2E187ULL;
+            active++;
+            next++;
+        }
+        if (active == 0) {
+            break;
+        }
+
+        for (size_t l = 0; l < active; l++) {
+            blocks[l] = tiger_job_block(&jobs[l]);
+        }
+        if (active == TIGER_LANES) {
+            tiger_compress_lanes(state, blocks, TIGER_LANES);
+        } else {
+            tiger_compress_lanes(state, blocks, active);
+        }
+
+        for (size_t l = 0; l < active;) {
+            tiger_job_t *job = &jobs[l];
+
+            if (++job->next < job->blocks + job->tail_blocks) {
+                l++;
+                continue;
+            }
+
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 8; j++) {
+                    job->digest[i * 8 + j] = (state[l][i] >> (j * 8)) & 0xFF;
+                }
+            }
+
+            active--;
+            if (l != active) {
+                jobs[l] = jobs[active];
+                memcpy(state[l], state[active], sizeof(state[l]));
+            }
+        }
+    }
+}
+
 typedef struct {
     uint32_t state[8];
     uint64_t count;
@@ -225,17 +402,151 @@ typedef struct {
     int hash_size;
 } haval_ctx_t;
 
-static uint32_t haval_f(int pass, uint32_t x, uint32_t y, uint32_t z) {
-    switch (pass) {
-        case 0: return (z ^ (x & (y ^ z)));
-        case 1: return ((x ^ y) ^ z);
-        case 2: return ((x & y) | (z & (x ^ y)));
-        case 3: return ((x & z) | (y & (~z)));
-        case 4: return (x ^ (y | (~z)));
-        default: return 0;
+/* Message word order of each pass; pass 1 takes the words in order */
+static const uint8_t haval_word_order[5][32] = {
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+     16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31},
+    { 5, 14, 26, 18, 11, 28,  7, 16,  0, 23, 20, 22,  1, 10,  4,  8,
+     30,  3, 21,  9, 17, 24, 29,  6, 19, 12, 15, 13,  2, 25, 31, 27},
+    {19,  9,  4, 20, 28, 17,  8, 22, 29, 14, 25, 12, 24, 30, 16, 26,
+     31, 15,  7,  3,  1,  0, 18, 27, 13,  6, 21, 10, 23, 11,  5,  2},
+    {24,  4,  0, 14,  2,  7, 28, 23, 26,  6, 30, 20, 18, 25, 19,  3,
+     22, 11, 31, 21,  8, 27, 12,  9,  1, 29,  5, 15, 17, 10, 16, 13},
+    {27,  3, 21, 26, 17, 11, 20, 29, 19,  0, 12,  7, 13,  8, 31, 10,
+      5,  9, 14, 30, 18,  6, 28, 24,  2, 23, 16, 22,  4,  1, 25, 15}
+};
+
+/* Additive constants of passes 2 to 5: the fraction of pi following the IV */
+static const uint32_t haval_constants[5][32] = {
+    {0},
+    {
+        0x452821E6, 0x38D01377, 0xBE5466CF, 0x34E90C6C,
+        0xC0AC29B7, 0xC97C50DD, 0x3F84D5B5, 0xB5470917,
+        0x9216D5D9, 0x8979FB1B, 0xD1310BA6, 0x98DFB5AC,
+        0x2FFD72DB, 0xD01ADFB7, 0xB8E1AFED, 0x6A267E96,
+        0xBA7C9045, 0xF12C7F99, 0x24A19947, 0xB3916CF7,
+        0x0801F2E2, 0x858EFC16, 0x636920D8, 0x71574E69,
+        0xA458FEA3, 0xF4933D7E, 0x0D95748F, 0x728EB658,
+        0x718BCD58, 0x82154AEE, 0x7B54A41D, 0xC25A59B5
+    },
+    {
+        0x9C30D539, 0x2AF26013, 0xC5D1B023, 0x286085F0,
+        0xCA417918, 0xB8DB38EF, 0x8E79DCB0, 0x603A180E,
+        0x6C9E0E8B, 0xB01E8A3E, 0xD71577C1, 0xBD314B27,
+        0x78AF2FDA, 0x55605C60, 0xE65525F3, 0xAA55AB94,
+        0x57489862, 0x63E81440, 0x55CA396A, 0x2AAB10B6,
+        0xB4CC5C34, 0x1141E8CE, 0xA15486AF, 0x7C72E993,
+        0xB3EE1411, 0x636FBC2A, 0x2BA9C55D, 0x741831F6,
+        0xCE5C3E16, 0x9B87931E, 0xAFD6BA33, 0x6C24CF5C
+    },
+    {
+        0x7A325381, 0x28958677, 0x3B8F4898, 0x6B4BB9AF,
+        0xC4BFE81B, 0x66282193, 0x61D809CC, 0xFB21A991,
+        0x487CAC60, 0x5DEC8032, 0xEF845D5D, 0xE98575B1,
+        0xDC262302, 0xEB651B88, 0x23893E81, 0xD396ACC5,
+        0x0F6D6FF3, 0x83F44239, 0x2E0B4482, 0xA4842004,
+        0x69C8F04A, 0x9E1F9B5E, 0x21C66842, 0xF6E96C9A,
+        0x670C9C61, 0xABD388F0, 0x6A51A0D2, 0xD8542F68,
+        0x960FA728, 0xAB5133A3, 0x6EEF0B6C, 0x137A3BE4
+    },
+    {
+        0xBA3BF050, 0x7EFB2A98, 0xA1F1651D, 0x39AF0176,
+        0x66CA593E, 0x82430E88, 0x8CEE8619, 0x456F9FB4,
+        0x7D84A5C3, 0x3B8B5EBE, 0xE06F75D8, 0x85C12073,
+        0x401A449F, 0x56C16AA6, 0x4ED3AA62, 0x363F7706,
+        0x1BFEDF72, 0x429B023D, 0x37D0D724, 0xD00A1248,
+        0xDB0FEAD3, 0x49F1C09B, 0x075372C9, 0x80991B7B,
+        0x25D479D8, 0xF6E8DEF7, 0xE3FE501A, 0xB6794C3B,
+        0x976CE0BD, 0x04C006BA, 0xC1A94FB6, 0x409F60C4
+    }
+};
+
+static inline uint32_t haval_rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+/* The five boolean functions F1..F5 */
+#define HAVAL_F1(x6, x5, x4, x3, x2, x1, x0) \
+    (((x1) & ((x0) ^ (x4))) ^ ((x2) & (x5)) ^ ((x3) & (x6)) ^ (x0))
+#define HAVAL_F2(x6, x5, x4, x3, x2, x1, x0) \
+    (((x2) & (((x1) & ~(x3)) ^ ((x4) & (x5)) ^ (x6) ^ (x0))) ^ \
+     ((x4) & ((x1) ^ (x5))) ^ ((x3) & (x5)) ^ (x0))
+#define HAVAL_F3(x6, x5, x4, x3, x2, x1, x0) \
+    (((x3) & (((x1) & (x2)) ^ (x6) ^ (x0))) ^ ((x1) & (x4)) ^ ((x2) & (x5)) ^ (x0))
+#define HAVAL_F4(x6, x5, x4, x3, x2, x1, x0) \
+    (((x4) & (((x5) & ~(x2)) ^ ((x3) & ~(x6)) ^ (x1) ^ (x6) ^ (x0))) ^ \
+     ((x3) & (((x1) & (x2)) ^ (x5) ^ (x6))) ^ ((x2) & (x6)) ^ (x0))
+#define HAVAL_F5(x6, x5, x4, x3, x2, x1, x0) \
+    (((x0) & (((x1) & (x2) & (x3)) ^ ~(x5))) ^ ((x1) & (x4)) ^ ((x2) & (x5)) ^ ((x3) & (x6)))
+
+/* Phi_{p,r}: F_r with the input permutation used when hashing with p passes */
+#define HAVAL_PHI_3_1(x6, x5, x4, x3, x2, x1, x0) HAVAL_F1(x1, x0, x3, x5, x6, x2, x4)
+#define HAVAL_PHI_3_2(x6, x5, x4, x3, x2, x1, x0) HAVAL_F2(x4, x2, x1, x0, x5, x3, x6)
+#define HAVAL_PHI_3_3(x6, x5, x4, x3, x2, x1, x0) HAVAL_F3(x6, x1, x2, x3, x4, x5, x0)
+
+#define HAVAL_PHI_4_1(x6, x5, x4, x3, x2, x1, x0) HAVAL_F1(x2, x6, x1, x4, x5, x3, x0)
+#define HAVAL_PHI_4_2(x6, x5, x4, x3, x2, x1, x0) HAVAL_F2(x3, x5, x2, x0, x1, x6, x4)
+#define HAVAL_PHI_4_3(x6, x5, x4, x3, x2, x1, x0) HAVAL_F3(x1, x4, x3, x6, x0, x2, x5)
+#define HAVAL_PHI_4_4(x6, x5, x4, x3, x2, x1, x0) HAVAL_F4(x6, x4, x0, x5, x2, x1, x3)
+
+#define HAVAL_PHI_5_1(x6, x5, x4, x3, x2, x1, x0) HAVAL_F1(x3, x4, x1, x0, x5, x2, x6)
+#define HAVAL_PHI_5_2(x6, x5, x4, x3, x2, x1, x0) HAVAL_F2(x6, x2, x1, x0, x3, x4, x5)
+#define HAVAL_PHI_5_3(x6, x5, x4, x3, x2, x1, x0) HAVAL_F3(x2, x6, x0, x4, x3, x1, x5)
+#define HAVAL_PHI_5_4(x6, x5, x4, x3, x2, x1, x0) HAVAL_F4(x1, x5, x3, x2, x0, x4, x6)
+#define HAVAL_PHI_5_5(x6, x5, x4, x3, x2, x1, x0) HAVAL_F5(x2, x5, x0, x6, x4, x3, x1)
+
+#define HAVAL_FF(PHI, x7, x6, x5, x4, x3, x2, x1, x0, w, k) \
+    ((x7) = haval_rotr(PHI(x6, x5, x4, x3, x2, x1, x0), 7) + haval_rotr((x7), 11) + (w) + (k))
+
+/* One pass of 32 steps; every eight steps the registers return to their roles */
+#define HAVAL_PASS(PHI, pass) do {                                                      \
+    const uint8_t *order_ = haval_word_order[(pass) - 1];                               \
+    const uint32_t *k_ = haval_constants[(pass) - 1];                                   \
+    for (int q_ = 0; q_ < 32; q_ += 8) {                                                \
+        HAVAL_FF(PHI, t7, t6, t5, t4, t3, t2, t1, t0, w[order_[q_]], k_[q_]);           \
+        HAVAL_FF(PHI, t6, t5, t4, t3, t2, t1, t0, t7, w[order_[q_ + 1]], k_[q_ + 1]);   \
+        HAVAL_FF(PHI, t5, t4, t3, t2, t1, t0, t7, t6, w[order_[q_ + 2]], k_[q_ + 2]);   \
+        HAVAL_FF(PHI, t4, t3, t2, t1, t0, t7, t6, t5, w[order_[q_ + 3]], k_[q_ + 3]);   \
+        HAVAL_FF(PHI, t3, t2, t1, t0, t7, t6, t5, t4, w[order_[q_ + 4]], k_[q_ + 4]);   \
+        HAVAL_FF(PHI, t2, t1, t0, t7, t6, t5, t4, t3, w[order_[q_ + 5]], k_[q_ + 5]);   \
+        HAVAL_FF(PHI, t1, t0, t7, t6, t5, t4, t3, t2, w[order_[q_ + 6]], k_[q_ + 6]);   \
+        HAVAL_FF(PHI, t0, t7, t6, t5, t4, t3, t2, t1, w[order_[q_ + 7]], k_[q_ + 7]);   \
+    }                                                                                   \
+} while (0)
+
+static void haval_compress(haval_ctx_t *ctx, const uint8_t *block) {
+    uint32_t w[32];
+
+    for (int i = 0; i < 32; i++) {
+        w[i] = (uint32_t)block[i * 4] | ((uint32_t)block[i * 4 + 1] << 8) |
+               ((uint32_t)block[i * 4 + 2] << 16) | ((uint32_t)block[i * 4 + 3] << 24);
+    }
+
+    uint32_t t0 = ctx->state[0], t1 = ctx->state[1], t2 = ctx->state[2], t3 = ctx->state[3];
+    uint32_t t4 = ctx->state[4], t5 = ctx->state[5], t6 = ctx->state[6], t7 = ctx->state[7];
+
+    if (ctx->passes == 3) {
+        HAVAL_PASS(HAVAL_PHI_3_1, 1);
+        HAVAL_PASS(HAVAL_PHI_3_2, 2);
+        HAVAL_PASS(HAVAL_PHI_3_3, 3);
+    } else if (ctx->passes == 4) {
+        HAVAL_PASS(HAVAL_PHI_4_1, 1);
+        HAVAL_PASS(HAVAL_PHI_4_2, 2);
+        HAVAL_PASS(HAVAL_PHI_4_3, 3);
+        HAVAL_PASS(HAVAL_PHI_4_4, 4);
+    } else {
+        HAVAL_PASS(HAVAL_PHI_5_1, 1);
+        HAVAL_PASS(HAVAL_PHI_5_2, 2);
+        HAVAL_PASS(HAVAL_PHI_5_3, 3);
+        HAVAL_PASS(HAVAL_PHI_5_4, 4);
+        HAVAL_PASS(HAVAL_PHI_5_5, 5);
     }
+
+    ctx->state[0] += t0; ctx->state[1] += t1; ctx->state[2] += t2; ctx->state[3] += t3;
+    ctx->state[4] += t4; ctx->state[5] += t5; ctx->state[6] += t6; ctx->state[7] += t7;
 }
 
+/* passes is 3, 4 or 5; hash_bits is 128, 160, 192, 224 or 256 */
 void haval_init(haval_ctx_t *ctx, int passes, int hash_bits) {
     ctx->state[0] = 0x243F6A88;
     ctx->state[1] = 0x85A308D3;
@@ -252,36 +563,339 @@ void haval_init(haval_ctx_t *ctx, int passes, int hash_bits) {
     ctx->hash_size = hash_bits / 8;
 }
 
-int hash_function_compute(const uint8_t *input, size_t length, uint8_t *output, int algorithm) {
-    if (algorithm == 0) { 
+void haval_update(haval_ctx_t *ctx, const uint8_t *data, size_t length) {
+    ctx->count += length;
+
+    if (ctx->buffer_len > 0) {
+        size_t to_copy = HAVAL_BLOCK_SIZE - ctx->buffer_len;
+        if (to_copy > length) {
+            to_copy = length;
+        }
+
+        memcpy(ctx->buffer + ctx->buffer_len, data, to_copy);
+        ctx->buffer_len += to_copy;
+        data += to_copy;
+        length -= to_copy;
+
+        if (ctx->buffer_len < HAVAL_BLOCK_SIZE) {
+            return;
+        }
+        haval_compress(ctx, ctx->buffer);
+        ctx->buffer_len = 0;
+    }
+
+    while (length >= HAVAL_BLOCK_SIZE) {
+        haval_compress(ctx, data);
+        data += HAVAL_BLOCK_SIZE;
+        length -= HAVAL_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer, data, length);
+    ctx->buffer_len = (int)length;
+}
+
+/* Folds the 256-bit state down to hash_size bytes */
+static void haval_tailor(uint32_t *fp, int hash_bits) {
+    uint32_t temp;
+
+    switch (hash_bits) {
+        case 128:
+            temp = (fp[7] & 0x000000FF) | (fp[6] & 0xFF000000) |
+                   (fp[5] & 0x00FF0000) | (fp[4] & 0x0000FF00);
+            fp[0] += haval_rotr(temp, 8);
+            temp = (fp[7] & 0x0000FF00) | (fp[6] & 0x000000FF) |
+                   (fp[5] & 0xFF000000) | (fp[4] & 0x00FF0000);
+            fp[1] += haval_rotr(temp, 16);
+            temp = (fp[7] & 0x00FF0000) | (fp[6] & 0x0000FF00) |
+                   (fp[5] & 0x000000FF) | (fp[4] & 0xFF000000);
+            fp[2] += haval_rotr(temp, 24);
+            temp = (fp[7] & 0xFF000000) | (fp[6] & 0x00FF0000) |
+                   (fp[5] & 0x0000FF00) | (fp[4] & 0x000000FF);
+            fp[3] += temp;
+            break;
+        case 160:
+            temp = (fp[7] & 0x3F) | (fp[6] & (0x7FU << 25)) | (fp[5] & (0x3FU << 19));
+            fp[0] += haval_rotr(temp, 19);
+            temp = (fp[7] & (0x3FU << 6)) | (fp[6] & 0x3F) | (fp[5] & (0x7FU << 25));
+            fp[1] += haval_rotr(temp, 25);
+            temp = (fp[7] & (0x7FU << 12)) | (fp[6] & (0x3FU << 6)) | (fp[5] & 0x3F);
+            fp[2] += temp;
+            temp = (fp[7] & (0x3FU << 19)) | (fp[6] & (0x7FU << 12)) | (fp[5] & (0x3FU << 6));
+            fp[3] += temp >> 6;
+            temp = (fp[7] & (0x7FU << 25)) | (fp[6] & (0x3FU << 19)) | (fp[5] & (0x7FU << 12));
+            fp[4] += temp >> 12;
+            break;
+        case 192:
+            temp = (fp[7] & 0x1F) | (fp[6] & (0x3FU << 26));
+            fp[0] += haval_rotr(temp, 26);
+            temp = (fp[7] & (0x1FU << 5)) | (fp[6] & 0x1F);
+            fp[1] += temp;
+            temp = (fp[7] & (0x3FU << 10)) | (fp[6] & (0x1FU << 5));
+            fp[2] += temp >> 5;
+            temp = (fp[7] & (0x1FU << 16)) | (fp[6] & (0x3FU << 10));
+            fp[3] += temp >> 10;
+            temp = (fp[7] & (0x1FU << 21)) | (fp[6] & (0x1FU << 16));
+            fp[4] += temp >> 16;
+            temp = (fp[7] & (0x3FU << 26)) | (fp[6] & (0x1FU << 21));
+            fp[5] += temp >> 21;
+            break;
+        case 224:
+            fp[0] += (fp[7] >> 27) & 0x1F;
+            fp[1] += (fp[7] >> 22) & 0x1F;
+            fp[2] += (fp[7] >> 18) & 0x0F;
+            fp[3] += (fp[7] >> 13) & 0x1F;
+            fp[4] += (fp[7] >> 9) & 0x0F;
+            fp[5] += (fp[7] >> 4) & 0x1F;
+            fp[6] += fp[7] & 0x0F;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Writes ctx->hash_size bytes to digest and returns that size */
+int haval_final(haval_ctx_t *ctx, uint8_t *digest) {
+    int hash_bits = ctx->hash_size * 8;
+    uint64_t bit_count = ctx->count * 8;
+    uint8_t trailer[10];
+
+    trailer[0] = (uint8_t)(((hash_bits & 0x3) << 6) | ((ctx->passes & 0x7) << 3) | HAVAL_VERSION);
+    trailer[1] = (uint8_t)(hash_bits >> 2);
+    for (int i = 0; i < 8; i++) {
+        trailer[2 + i] = (bit_count >> (i * 8)) & 0xFF;
+    }
+
+    ctx->buffer[ctx->buffer_len++] = 0x01;
+    if (ctx->buffer_len > HAVAL_BLOCK_SIZE - 10) {
+        memset(ctx->buffer + ctx->buffer_len, 0, HAVAL_BLOCK_SIZE - ctx->buffer_len);
+        haval_compress(ctx, ctx->buffer);
+        ctx->buffer_len = 0;
+    }
+    memset(ctx->buffer + ctx->buffer_len, 0, HAVAL_BLOCK_SIZE - 10 - ctx->buffer_len);
+    memcpy(ctx->buffer + HAVAL_BLOCK_SIZE - 10, trailer, 10);
+    haval_compress(ctx, ctx->buffer);
+
+    haval_tailor(ctx->state, hash_bits);
+    for (int i = 0; i < ctx->hash_size / 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            digest[i * 4 + j] = (ctx->state[i] >> (j * 8)) & 0xFF;
+        }
+    }
+    return ctx->hash_size;
+}
+
+/*
+ * Tree hash for large inputs. The input is cut into TREE_LEAF_SIZE leaves
+ * that are hashed in parallel, and the root hashes the leaf size, the total
+ * length and the leaf digests in order. Leaves and root start with distinct
+ * domain bytes, so a tree digest never equals the plain digest of the same
+ * input. Identical for any thread count.
+ */
+#define TREE_LEAF_SIZE (1024 * 1024)
+#define TREE_MAX_THREADS 64
+#define TREE_LEAF_DOMAIN 0x00
+#define TREE_ROOT_DOMAIN 0x01
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t leaves;
+    uint8_t *leaf_digests;
+    size_t next_leaf;
+} tiger_tree_job_t;
+
+/* Threads claim leaves from a shared counter, so faster threads take more */
+static void *tiger_tree_worker(void *arg) {
+    tiger_tree_job_t *job = arg;
+    static const uint8_t domain = TREE_LEAF_DOMAIN;
+    size_t leaf;
+
+    while ((leaf = __atomic_fetch_add(&job->next_leaf, 1, __ATOMIC_RELAXED)) < job->leaves) {
+        size_t offset = leaf * TREE_LEAF_SIZE;
+        size_t length = job->length - offset < TREE_LEAF_SIZE ? job->length - offset : TREE_LEAF_SIZE;
         tiger_ctx_t ctx;
+
         tiger_init(&ctx);
+        tiger_update(&ctx, &domain, 1);
+        tiger_update(&ctx, job->data + offset, length);
+        tiger_final(&ctx, job->leaf_digests + leaf * TIGER_DIGEST_SIZE);
+    }
+    return NULL;
+}
+
+/* Writes a TIGER_DIGEST_SIZE-byte tree digest; returns -1 if allocation fails */
+int tiger_tree_hash(const uint8_t *data, size_t length, uint8_t *digest) {
+    tiger_tree_job_t job;
+    pthread_t threads[TREE_MAX_THREADS];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus : 1;
+    size_t started = 0;
+    uint8_t header[17];
+    tiger_ctx_t ctx;
+
+    job.data = data;
+    job.length = length;
+    job.leaves = length == 0 ? 1 : (length + TREE_LEAF_SIZE - 1) / TREE_LEAF_SIZE;
+    job.next_leaf = 0;
+    job.leaf_digests = malloc(job.leaves * TIGER_DIGEST_SIZE);
+    if (job.leaf_digests == NULL) {
+        return -1;
+    }
+
+    if (wanted > job.leaves) {
+        wanted = job.leaves;
+    }
+    if (wanted > TREE_MAX_THREADS) {
+        wanted = TREE_MAX_THREADS;
+    }
+
+    /* The calling thread is one of the workers */
+    while (started + 1 < wanted &&
+           pthread_create(&threads[started], NULL, tiger_tree_worker, &job) == 0) {
+        started++;
+    }
+    tiger_tree_worker(&job);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    header[0] = TREE_ROOT_DOMAIN;
+    for (int i = 0; i < 8; i++) {
+        header[1 + i] = ((uint64_t)TREE_LEAF_SIZE >> (i * 8)) & 0xFF;
+        header[9 + i] = ((uint64_t)length >> (i * 8)) & 0xFF;
+    }
+
+    tiger_init(&ctx);
+    tiger_update(&ctx, header, sizeof(header));
+    tiger_update(&ctx, job.leaf_digests, job.leaves * TIGER_DIGEST_SIZE);
+    tiger_final(&ctx, digest);
+
+    free(job.leaf_digests);
+    return 0;
+}
+
+/*
+ * Tree-hashes a file straight from the page cache through a read-only
+ * mapping. Returns -1 if the file cannot be opened or mapped.
+ */
+int tiger_tree_hash_file(const char *path, uint8_t *digest) {
+    struct stat st;
+    void *map;
+    int fd, status;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return tiger_tree_hash(NULL, 0, digest);
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    status = tiger_tree_hash(map, (size_t)st.st_size, digest);
+    munmap(map, (size_t)st.st_size);
+
+    return status;
+}
+
+/*
+ * Reusable hashing context. The initialised state for the chosen algorithm
+ * is kept as a template and copied for every message, so the handle stays
+ * read-only and can be shared between threads.
+ */
+typedef struct {
+    int algorithm;
+    union {
+        tiger_ctx_t tiger;
+        haval_ctx_t haval;
+    } initial;
+} hash_function_ctx_t;
+
+static void hash_function_setup(hash_function_ctx_t *ctx, int algorithm) {
+    ctx->algorithm = algorithm;
+    if (algorithm == 0) {
+        tiger_init(&ctx->initial.tiger);
+    } else if (algorithm == 1) {
+        tiger2_init(&ctx->initial.tiger);
+    } else {
+        haval_init(&ctx->initial.haval, 3, 256);
+    }
+}
+
+hash_function_ctx_t *hash_function_create(int algorithm) {
+    hash_function_ctx_t *ctx = malloc(sizeof(*ctx));
+
+    if (ctx != NULL) {
+        hash_function_setup(ctx, algorithm);
+    }
+    return ctx;
+}
+
+void hash_function_destroy(hash_function_ctx_t *ctx) {
+    free(ctx);
+}
+
+int hash_function_compute_with_ctx(const hash_function_ctx_t *hctx, const uint8_t *input,
+                                   size_t length, uint8_t *output) {
+    if (hctx == NULL) {
+        return -1;
+    }
+
+    if (hctx->algorithm == 0) { 
+        tiger_ctx_t ctx = hctx->initial.tiger;
         tiger_update(&ctx, input, length);
         tiger_final(&ctx, output);
         return TIGER_DIGEST_SIZE;
-    } else if (algorithm == 1) { 
-        tiger_ctx_t ctx;
-        tiger2_init(&ctx);
+    } else if (hctx->algorithm == 1) { 
+        tiger_ctx_t ctx = hctx->initial.tiger;
         tiger_update(&ctx, input, length);
         tiger2_final(&ctx, output);
         return TIGER_DIGEST_SIZE;
     } else { 
-        haval_ctx_t ctx;
-        haval_init(&ctx, 3, 256); 
-
-        uint32_t hash = 0x12345678;
-        for (size_t i = 0; i < length; i++) {
-            hash ^= input[i];
-            hash = (hash << 1) | (hash >> 31);
-            hash += 0x9e3779b9;
-        }
+        haval_ctx_t ctx = hctx->initial.haval;
+        haval_update(&ctx, input, length);
+        return haval_final(&ctx, output);
+    }
+}
 
-        for (int i = 0; i < 32; i++) {
-            output[i] = (hash >> (8 * (i % 4))) & 0xFF;
-            if (i % 4 == 3) hash += 0x12345678;
-        }
-        return 32;
+/*
+ * Hashes count independent messages with one algorithm and returns the
+ * digest size. Tiger and Tiger2 go through the multi-buffer path.
+ */
+int hash_function_compute_multi(const uint8_t *const *inputs, const size_t *lengths,
+                                uint8_t *const *outputs, size_t count, int algorithm) {
+    hash_function_ctx_t ctx;
+    int digest_size = algorithm == 0 || algorithm == 1 ? TIGER_DIGEST_SIZE : 32;
+
+    if (algorithm == 0 || algorithm == 1) {
+        tiger_compute_multi(inputs, lengths, outputs, count, algorithm == 1);
+        return digest_size;
+    }
+
+    hash_function_setup(&ctx, algorithm);
+    for (size_t i = 0; i < count; i++) {
+        hash_function_compute_with_ctx(&ctx, inputs[i], lengths[i], outputs[i]);
     }
+    return digest_size;
+}
+
+int hash_function_compute(const uint8_t *input, size_t length, uint8_t *output, int algorithm) {
+    hash_function_ctx_t ctx;
+
+    hash_function_setup(&ctx, algorithm);
+    return hash_function_compute_with_ctx(&ctx, input, length, output);
 }
 
 int main() {
@@ -1,15 +1,28 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #define BLOCK_SIZE 16
 #define KEY_SCHEDULE_SIZE 40
 #define ROUNDS 16
-
+#define TWOFISH_INTERLEAVE 4
+
+/*
+ * Default is full-key mode: the key schedule folds the key-dependent S-boxes
+ * and the MDS multiply into four 256-entry tables (4 KB per context), so g()
+ * is four lookups and three XORs. Define TWOFISH_ZERO_KEY for constrained
+ * targets to keep the table-free path that recomputes both on every call.
+ */
 typedef struct {
     uint32_t subkeys[KEY_SCHEDULE_SIZE];
     uint32_t sbox_keys[4];
     uint8_t key_length;
+#ifndef TWOFISH_ZERO_KEY
+    uint32_t mds_tables[4][256];
+#endif
 } twofish_ctx_t;
 
 static const uint8_t mds_matrix[4][4] = {
@@ -67,7 +80,8 @@ static uint32_t mds_column_mix(uint32_t input) {
     return (result[3] << 24) | (result[2] << 16) | (result[1] << 8) | result[0];
 }
 
-static uint32_t g_function(uint32_t x, const uint32_t *sbox_keys, int key_length) {
+/* Key-dependent S-box layer of g(), before the MDS multiply */
+static uint32_t key_dependent_sbox(uint32_t x, const uint32_t *sbox_keys, int key_length) {
     uint8_t a = x & 0xFF;
     uint8_t b = (x >> 8) & 0xFF;
     uint8_t c = (x >> 16) & 0xFF;
@@ -92,8 +106,40 @@ static uint32_t g_function(uint32_t x, const uint32_t *sbox_keys, int key_length
     c = q1[q1[q0[c] ^ ((sbox_keys[1] >> 8) & 0xFF)] ^ ((sbox_keys[0] >> 8) & 0xFF)];
     d = q0[q1[q1[d] ^ (sbox_keys[1] & 0xFF)] ^ (sbox_keys[0] & 0xFF)];
 
-    uint32_t result = (d << 24) | (c << 16) | (b << 8) | a;
-    return mds_column_mix(result);
+    return ((uint32_t)d << 24) | ((uint32_t)c << 16) | ((uint32_t)b << 8) | a;
+}
+
+#ifdef TWOFISH_ZERO_KEY
+static uint32_t g_function(uint32_t x, const uint32_t *sbox_keys, int key_length) {
+    return mds_column_mix(key_dependent_sbox(x, sbox_keys, key_length));
+}
+#else
+/*
+ * mds_column_mix is linear over GF(2), so g(x) is the XOR of each byte's
+ * MDS column. Substituting x replicated in all four byte positions yields
+ * every position's S-box output for x in one pass.
+ */
+static void build_mds_tables(twofish_ctx_t *ctx) {
+    for (int x = 0; x < 256; x++) {
+        uint32_t s = key_dependent_sbox((uint32_t)x * 0x01010101u,
+                                        ctx->sbox_keys, ctx->key_length);
+
+        for (int j = 0; j < 4; j++) {
+            ctx->mds_tables[j][x] = mds_column_mix(s & (0xFFu << (j * 8)));
+        }
+    }
+}
+#endif
+
+static inline uint32_t twofish_g(const twofish_ctx_t *ctx, uint32_t x) {
+#ifndef TWOFISH_ZERO_KEY
+    return ctx->mds_tables[0][x & 0xFF] ^
+           ctx->mds_tables[1][(x >> 8) & 0xFF] ^
+           ctx->mds_tables[2][(x >> 16) & 0xFF] ^
+           ctx->mds_tables[3][x >> 24];
+#else
+    return g_function(x, ctx->sbox_keys, ctx->key_length);
+#endif
 }
 
 void twofish_key_schedule(twofish_ctx_t *ctx, const uint8_t *key, int key_length) {
@@ -104,9 +150,13 @@ void twofish_key_schedule(twofish_ctx_t *ctx, const uint8_t *key, int key_length
                            (key[i*8+1] << 8) | key[i*8];
     }
 
+#ifndef TWOFISH_ZERO_KEY
+    build_mds_tables(ctx);
+#endif
+
     for (int i = 0; i < KEY_SCHEDULE_SIZE; i += 2) {
-        uint32_t A = g_function(i * 0x02020202, ctx->sbox_keys, key_length);
-        uint32_t B = g_function((i + 1) * 0x02020202, ctx->sbox_keys, key_length);
+        uint32_t A = twofish_g(ctx, i * 0x02020202);
+        uint32_t B = twofish_g(ctx, (i + 1) * 0x02020202);
         B = (B << 8) | (B >> 24); 
 
         ctx->subkeys[i] = A + B;
@@ -114,67 +164,427 @@ void twofish_key_schedule(twofish_ctx_t *ctx, const uint8_t *key, int key_length
     }
 }
 
-void twofish_encrypt_block(twofish_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
-    uint32_t blocks[4];
+static inline uint32_t load32_le(const uint8_t *p) {
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[1] << 8) | p[0];
+}
 
-    for (int i = 0; i < 4; i++) {
-        blocks[i] = (input[i*4+3] << 24) | (input[i*4+2] << 16) |
-                   (input[i*4+1] << 8) | input[i*4];
-        blocks[i] ^= ctx->subkeys[i];
+static inline void store32_le(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+/*
+ * Encrypts up to TWOFISH_INTERLEAVE blocks round by round together; each
+ * round's eight table lookups per block are independent across lanes.
+ */
+static inline void twofish_encrypt_lanes(const twofish_ctx_t *ctx, const uint8_t *input,
+                                         uint8_t *output, size_t lanes) {
+    uint32_t b0[TWOFISH_INTERLEAVE], b1[TWOFISH_INTERLEAVE];
+    uint32_t b2[TWOFISH_INTERLEAVE], b3[TWOFISH_INTERLEAVE];
+
+    for (size_t j = 0; j < lanes; j++) {
+        b0[j] = load32_le(input + j * BLOCK_SIZE) ^ ctx->subkeys[0];
+        b1[j] = load32_le(input + j * BLOCK_SIZE + 4) ^ ctx->subkeys[1];
+        b2[j] = load32_le(input + j * BLOCK_SIZE + 8) ^ ctx->subkeys[2];
+        b3[j] = load32_le(input + j * BLOCK_SIZE + 12) ^ ctx->subkeys[3];
     }
 
     for (int round = 0; round < ROUNDS; round++) {
-        uint32_t t0 = g_function(blocks[0], ctx->sbox_keys, ctx->key_length);
-        uint32_t t1 = g_function((blocks[1] << 8) | (blocks[1] >> 24), ctx->sbox_keys, ctx->key_length);
+        uint32_t k0 = ctx->subkeys[round * 2 + 8];
+        uint32_t k1 = ctx->subkeys[round * 2 + 9];
+
+        for (size_t j = 0; j < lanes; j++) {
+            uint32_t t0 = twofish_g(ctx, b0[j]);
+            uint32_t t1 = twofish_g(ctx, (b1[j] << 8) | (b1[j] >> 24));
+            uint32_t x2 = b2[j] ^ (t0 + t1 + k0);
+            uint32_t x3 = ((b3[j] << 1) | (b3[j] >> 31)) ^ (t0 + 2 * t1 + k1);
+
+            b2[j] = b0[j];
+            b3[j] = b1[j];
+            b0[j] = (x2 >> 1) | (x2 << 31);
+            b1[j] = x3;
+        }
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+        store32_le(output + j * BLOCK_SIZE, b2[j] ^ ctx->subkeys[4]);
+        store32_le(output + j * BLOCK_SIZE + 4, b3[j] ^ ctx->subkeys[5]);
+        store32_le(output + j * BLOCK_SIZE + 8, b0[j] ^ ctx->subkeys[6]);
+        store32_le(output + j * BLOCK_SIZE + 12, b1[j] ^ ctx->subkeys[7]);
+    }
+}
 
-        blocks[2] ^= (t0 + t1 + ctx->subkeys[round * 2 + 8]);
-        blocks[2] = (blocks[2] >> 1) | (blocks[2] << 31); 
+void twofish_encrypt_block(twofish_ctx_t *ctx, const uint8_t *input, uint8_t *output) {
+    twofish_encrypt_lanes(ctx, input, output, 1);
+}
 
-        blocks[3] = ((blocks[3] << 1) | (blocks[3] >> 31)) ^ 
-                   (t0 + 2 * t1 + ctx->subkeys[round * 2 + 9]);
+static void twofish_encrypt_blocks(const void *ctx, const uint8_t *input,
+                                   uint8_t *output, size_t blocks) {
+    size_t i = 0;
 
-        uint32_t temp = blocks[0];
-        blocks[0] = blocks[2];
-        blocks[2] = temp;
-        temp = blocks[1];
-        blocks[1] = blocks[3];
-        blocks[3] = temp;
+    for (; i + TWOFISH_INTERLEAVE <= blocks; i += TWOFISH_INTERLEAVE) {
+        twofish_encrypt_lanes(ctx, input + i * BLOCK_SIZE, output + i * BLOCK_SIZE,
+                              TWOFISH_INTERLEAVE);
     }
+    if (i < blocks) {
+        twofish_encrypt_lanes(ctx, input + i * BLOCK_SIZE, output + i * BLOCK_SIZE,
+                              blocks - i);
+    }
+}
 
-    uint32_t temp = blocks[0];
-    blocks[0] = blocks[2];
-    blocks[2] = temp;
-    temp = blocks[1];
-    blocks[1] = blocks[3];
-    blocks[3] = temp;
+typedef enum {
+    CIPHER_MODE_ECB,
+    CIPHER_MODE_CBC,
+    CIPHER_MODE_CTR
+} cipher_mode_t;
 
-    for (int i = 0; i < 4; i++) {
-        blocks[i] ^= ctx->subkeys[i + 4];
-        output[i*4] = blocks[i] & 0xFF;
-        output[i*4+1] = (blocks[i] >> 8) & 0xFF;
-        output[i*4+2] = (blocks[i] >> 16) & 0xFF;
-        output[i*4+3] = (blocks[i] >> 24) & 0xFF;
+typedef void (*cipher_blocks_fn)(const void *ctx, const uint8_t *input,
+                                 uint8_t *output, size_t blocks);
+
+typedef struct {
+    const void *ctx;
+    cipher_blocks_fn encrypt_blocks;
+    cipher_blocks_fn decrypt_blocks;
+} block_cipher_t;
+
+#define MODE_CHUNK_BLOCKS 64
+#define PARALLEL_MIN_TASK_BYTES (256 * 1024)
+#define POOL_MAX_WORKERS 63
+#define POOL_TASKS_PER_THREAD 4
+
+typedef void (*block_range_fn)(void *arg, size_t first, size_t count);
+
+/*
+ * Fork-join pool for the bulk modes. Workers start on first use and sleep
+ * between jobs; a job is cut into contiguous block ranges that the workers
+ * and the submitting thread claim until none are left.
+ */
+typedef struct {
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    size_t workers;
+    unsigned long generation;
+    block_range_fn fn;
+    void *arg;
+    size_t total_blocks;
+    size_t task_blocks;
+    size_t task_count;
+    size_t next_task;
+    size_t tasks_finished;
+} worker_pool_t;
+
+static worker_pool_t worker_pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, NULL, NULL, 0, 0, 0, 0, 0
+};
+static pthread_once_t worker_pool_once = PTHREAD_ONCE_INIT;
+
+/* Runs tasks of the current job until all are claimed; pool->lock is held */
+static void worker_pool_drain(worker_pool_t *pool) {
+    while (pool->next_task < pool->task_count) {
+        size_t first = pool->next_task++ * pool->task_blocks;
+        size_t count = pool->total_blocks - first;
+        block_range_fn fn = pool->fn;
+        void *arg = pool->arg;
+
+        if (count > pool->task_blocks) {
+            count = pool->task_blocks;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+        fn(arg, first, count);
+        pthread_mutex_lock(&pool->lock);
+
+        if (++pool->tasks_finished == pool->task_count) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
     }
 }
 
-int advanced_symmetric_encrypt(const uint8_t *plaintext, uint8_t *ciphertext,
-                              size_t length, const uint8_t *key, int key_length) {
-    if (length % BLOCK_SIZE != 0) {
-        return -1; 
+static void *worker_pool_main(void *unused) {
+    worker_pool_t *pool = &worker_pool;
+    unsigned long seen = 0;
+
+    (void)unused;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        seen = pool->generation;
+        worker_pool_drain(pool);
     }
+    return NULL;
+}
 
-    twofish_ctx_t ctx;
-    twofish_key_schedule(&ctx, key, key_length);
+static void worker_pool_start(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus - 1 : 0;
 
-    size_t blocks = length / BLOCK_SIZE;
-    for (size_t i = 0; i < blocks; i++) {
-        twofish_encrypt_block(&ctx, plaintext + i * BLOCK_SIZE,
-                             ciphertext + i * BLOCK_SIZE);
+    if (wanted > POOL_MAX_WORKERS) {
+        wanted = POOL_MAX_WORKERS;
     }
 
+    for (size_t i = 0; i < wanted; i++) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, worker_pool_main, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        worker_pool.workers++;
+    }
+}
+
+/* Blocks per task for a job of total_blocks; total_blocks means run inline */
+static size_t worker_pool_plan(size_t total_blocks) {
+    size_t min_task_blocks = PARALLEL_MIN_TASK_BYTES / BLOCK_SIZE;
+    size_t tasks;
+
+    if (total_blocks < 2 * min_task_blocks) {
+        return total_blocks;
+    }
+
+    pthread_once(&worker_pool_once, worker_pool_start);
+    if (worker_pool.workers == 0) {
+        return total_blocks;
+    }
+
+    tasks = total_blocks / min_task_blocks;
+    if (tasks > (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD) {
+        tasks = (worker_pool.workers + 1) * POOL_TASKS_PER_THREAD;
+    }
+
+    return (total_blocks + tasks - 1) / tasks;
+}
+
+static void worker_pool_run(size_t total_blocks, size_t task_blocks,
+                            block_range_fn fn, void *arg) {
+    worker_pool_t *pool = &worker_pool;
+
+    if (task_blocks >= total_blocks) {
+        fn(arg, 0, total_blocks);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->total_blocks = total_blocks;
+    pool->task_blocks = task_blocks;
+    pool->task_count = (total_blocks + task_blocks - 1) / task_blocks;
+    pool->next_task = 0;
+    pool->tasks_finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    worker_pool_drain(pool);
+    while (pool->tasks_finished < pool->task_count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+typedef struct {
+    const block_cipher_t *cipher;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t length;
+    const uint8_t *iv;
+    const uint8_t *boundaries;
+    size_t task_blocks;
+    int encrypt;
+} mode_job_t;
+
+static void ecb_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    cipher_blocks_fn fn = job->encrypt ? job->cipher->encrypt_blocks
+                                       : job->cipher->decrypt_blocks;
+
+    fn(job->cipher->ctx, job->input + first * BLOCK_SIZE,
+       job->output + first * BLOCK_SIZE, count);
+}
+
+/* ctr = iv + n, with the counter block read as a big-endian integer */
+static void counter_at(uint8_t *ctr, const uint8_t *iv, uint64_t n) {
+    unsigned int carry = 0;
+
+    for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+        unsigned int sum = iv[i] + (unsigned int)(n & 0xFF) + carry;
+        ctr[i] = sum & 0xFF;
+        carry = sum >> 8;
+        n >>= 8;
+    }
+}
+
+static void ctr_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t counters[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    uint8_t keystream[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+    size_t offset = first * BLOCK_SIZE;
+    size_t end = (first + count) * BLOCK_SIZE;
+
+    if (end > job->length) {
+        end = job->length;
+    }
+
+    while (offset < end) {
+        size_t bytes = end - offset < sizeof(keystream) ? end - offset : sizeof(keystream);
+        size_t blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        for (size_t i = 0; i < blocks; i++) {
+            counter_at(counters + i * BLOCK_SIZE, job->iv, offset / BLOCK_SIZE + i);
+        }
+        job->cipher->encrypt_blocks(job->cipher->ctx, counters, keystream, blocks);
+
+        for (size_t i = 0; i < bytes; i++) {
+            job->output[offset + i] = job->input[offset + i] ^ keystream[i];
+        }
+        offset += bytes;
+    }
+}
+
+/*
+ * Each task starts from the ciphertext block just before its range, which
+ * the submitter copies out first so in-place decryption stays correct.
+ */
+static void cbc_decrypt_range(void *arg, size_t first, size_t count) {
+    const mode_job_t *job = arg;
+    uint8_t previous[BLOCK_SIZE];
+    uint8_t saved[MODE_CHUNK_BLOCKS * BLOCK_SIZE];
+
+    if (first == 0) {
+        memcpy(previous, job->iv, BLOCK_SIZE);
+    } else {
+        memcpy(previous, job->boundaries + (first / job->task_blocks - 1) * BLOCK_SIZE,
+               BLOCK_SIZE);
+    }
+
+    for (size_t done = 0; done < count;) {
+        size_t blocks = count - done < MODE_CHUNK_BLOCKS ? count - done : MODE_CHUNK_BLOCKS;
+        uint8_t *out = job->output + (first + done) * BLOCK_SIZE;
+
+        memcpy(saved, job->input + (first + done) * BLOCK_SIZE, blocks * BLOCK_SIZE);
+        job->cipher->decrypt_blocks(job->cipher->ctx, saved, out, blocks);
+
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t *chain = b == 0 ? previous : saved + (b - 1) * BLOCK_SIZE;
+
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                out[b * BLOCK_SIZE + i] ^= chain[i];
+            }
+        }
+
+        memcpy(previous, saved + (blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+        done += blocks;
+    }
+}
+
+/* CBC encryption chains every block on the previous one, so it stays serial */
+static void cbc_encrypt(const block_cipher_t *cipher, const uint8_t *input,
+                        uint8_t *output, size_t blocks, const uint8_t *iv) {
+    uint8_t chain[BLOCK_SIZE];
+
+    memcpy(chain, iv, BLOCK_SIZE);
+    for (size_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            chain[i] ^= input[b * BLOCK_SIZE + i];
+        }
+        cipher->encrypt_blocks(cipher->ctx, chain, chain, 1);
+        memcpy(output + b * BLOCK_SIZE, chain, BLOCK_SIZE);
+    }
+}
+
+/*
+ * ECB, CBC decryption and CTR are split across the worker pool. CTR
+ * accepts a partial final block; ECB and CBC need whole blocks. Returns
+ * -1 on bad arguments or allocation failure.
+ */
+static int block_mode_process(const block_cipher_t *cipher, const uint8_t *input,
+                              uint8_t *output, size_t length, cipher_mode_t mode,
+                              const uint8_t *iv, int encrypt) {
+    mode_job_t job = { cipher, input, output, length, iv, NULL, 0, encrypt };
+    size_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint8_t *boundaries = NULL;
+    block_range_fn fn;
+
+    if (mode != CIPHER_MODE_CTR && length % BLOCK_SIZE != 0) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_ECB && iv == NULL) {
+        return -1;
+    }
+    if (mode != CIPHER_MODE_CTR && !encrypt && cipher->decrypt_blocks == NULL) {
+        return -1;
+    }
+    if (blocks == 0) {
+        return 0;
+    }
+
+    if (mode == CIPHER_MODE_CBC && encrypt) {
+        cbc_encrypt(cipher, input, output, blocks, iv);
+        return 0;
+    }
+
+    job.task_blocks = worker_pool_plan(blocks);
+
+    if (mode == CIPHER_MODE_ECB) {
+        fn = ecb_range;
+    } else if (mode == CIPHER_MODE_CTR) {
+        fn = ctr_range;
+    } else {
+        size_t tasks = (blocks + job.task_blocks - 1) / job.task_blocks;
+
+        if (tasks > 1) {
+            boundaries = malloc((tasks - 1) * BLOCK_SIZE);
+            if (boundaries == NULL) {
+                return -1;
+            }
+            for (size_t t = 1; t < tasks; t++) {
+                memcpy(boundaries + (t - 1) * BLOCK_SIZE,
+                       input + (t * job.task_blocks - 1) * BLOCK_SIZE, BLOCK_SIZE);
+            }
+        }
+        job.boundaries = boundaries;
+        fn = cbc_decrypt_range;
+    }
+
+    worker_pool_run(blocks, job.task_blocks, fn, &job);
+    free(boundaries);
+
     return 0;
 }
 
+/*
+ * Only the encryption direction exists here, so ECB and CBC decryption
+ * are rejected; CTR works both ways.
+ */
+int advanced_symmetric_encrypt_mode(const uint8_t *input, uint8_t *output,
+                                    size_t length, const uint8_t *key, int key_length,
+                                    cipher_mode_t mode, const uint8_t *iv, int encrypt) {
+    twofish_ctx_t ctx;
+    block_cipher_t cipher = { &ctx, twofish_encrypt_blocks, NULL };
+
+    twofish_key_schedule(&ctx, key, key_length);
+    return block_mode_process(&cipher, input, output, length, mode, iv, encrypt);
+}
+
+int advanced_symmetric_encrypt(const uint8_t *plaintext, uint8_t *ciphertext,
+                              size_t length, const uint8_t *key, int key_length) {
+    return advanced_symmetric_encrypt_mode(plaintext, ciphertext, length, key, key_length,
+                                           CIPHER_MODE_ECB, NULL, 1);
+}
+
 int main() {
     uint8_t key[32] = "This is a 32-byte secret key!!!!";
     uint8_t plaintext[32] = "Hello, this is test data!!!!!!!!";
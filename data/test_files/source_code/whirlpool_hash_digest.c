@@ -1,6 +1,15 @@
+/* Exposes madvise() to strict -std=c11 builds of the mmap file path */
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define WHIRLPOOL_DIGEST_SIZE 64
 #define WHIRLPOOL_BLOCK_SIZE 64
@@ -13,23 +22,80 @@ typedef struct {
     int buffer_len;
 } whirlpool_ctx_t;
 
-static const uint8_t whirlpool_sbox[256] = {
-    0x18, 0x23, 0xc6, 0xe8, 0x87, 0xb8, 0x01, 0x4f, 0x36, 0xa6, 0xd2, 0xf5, 0x79, 0x6f, 0x91, 0x52,
-    0x60, 0xbc, 0x9b, 0x8e, 0xa3, 0x0c, 0x7b, 0x35, 0x1d, 0xe0, 0xd7, 0xc2, 0x2e, 0x4b, 0xfe, 0x57,
-    0x15, 0x77, 0x37, 0xe5, 0x9f, 0xf0, 0x4a, 0xda, 0x58, 0xc9, 0x29, 0x0a, 0xb1, 0xa0, 0x6b, 0x85,
-    0xbd, 0x5d, 0x10, 0xf4, 0xcb, 0x3e, 0x05, 0x67, 0xe4, 0x27, 0x41, 0x8b, 0xa7, 0x7d, 0x95, 0xd8,
-    0xfb, 0xee, 0x7c, 0x66, 0xdd, 0x17, 0x47, 0x9e, 0xca, 0x2d, 0xbf, 0x07, 0xad, 0x5a, 0x83, 0x33,
-    0x63, 0x02, 0xaa, 0x71, 0xc8, 0x19, 0x49, 0xd9, 0xf2, 0xe3, 0x5b, 0x88, 0x9a, 0x26, 0x32, 0xb0,
-    0xe9, 0x0f, 0xd5, 0x80, 0xbe, 0xcd, 0x34, 0x48, 0xff, 0x7a, 0x90, 0x5f, 0x20, 0x68, 0x1a, 0xae,
-    0xb4, 0x54, 0x93, 0x22, 0x64, 0xf1, 0x73, 0x12, 0x40, 0x08, 0xc3, 0xec, 0xdb, 0xa1, 0x8d, 0x3d,
-    0x97, 0x00, 0xcf, 0x2b, 0x76, 0x82, 0xd6, 0x1b, 0xb5, 0xaf, 0x6a, 0x50, 0x45, 0xf3, 0x30, 0xef,
-    0x3f, 0x55, 0xa2, 0xea, 0x65, 0xba, 0x2f, 0xc0, 0xde, 0x1c, 0xfd, 0x4d, 0x92, 0x75, 0x06, 0x8a,
-    0xb2, 0xe6, 0x0e, 0x1f, 0x62, 0xd4, 0xa8, 0x96, 0xf9, 0xc5, 0x25, 0x59, 0x84, 0x72, 0x39, 0x4c,
-    0x5e, 0x78, 0x38, 0x8c, 0xd1, 0xa5, 0xe2, 0x61, 0xb3, 0x21, 0x9c, 0x1e, 0x43, 0xc7, 0xfc, 0x04,
-    0x51, 0x99, 0x6d, 0x0d, 0xfa, 0xdf, 0x7e, 0x24, 0x3b, 0xab, 0xce, 0x11, 0x8f, 0x4e, 0xb7, 0xeb,
-    0x3c, 0x81, 0x94, 0xf7, 0xb9, 0x13, 0x2c, 0xd3, 0xe7, 0x6e, 0xc4, 0x03, 0x56, 0x44, 0x7f, 0xa9,
-    0x2a, 0xbb, 0xc1, 0x53, 0xdc, 0x0b, 0x9d, 0x6c, 0x31, 0x74, 0xf6, 0x46, 0xac, 0x89, 0x14, 0xe1,
-    0x16, 0x3a, 0x69, 0x09, 0x70, 0xb6, 0xd0, 0xed, 0xcc, 0x42, 0x98, 0xa4, 0x28, 0x5c, 0xf8, 0x86
+/*
+ * Combined SubBytes + MixRows table: entry x is S[x] multiplied by the
+ * MixRows coefficient row (01 01 04 01 08 05 02 09) over GF(2^8) mod 0x11d.
+ * The low byte of each entry is S[x] itself.
+ *
+ * The mix layer applies the same coefficient row to every input row, so the
+ * eight per-position circulant tables of reference Whirlpool would all be
+ * identical here; this single 2 KB table serves every position.
+ */
+static const uint64_t whirlpool_table[256] = {
+    0xd83078c018601818, 0x2646af05238c2323, 0xb891f97ec63fc6c6, 0xfbcd6f13e887e8e8,
+    0xcb13a14c87268787, 0x116d62a9b8dab8b8, 0x0902050801040101, 0x0d9e6e424f214f4f,
+    0x9b6ceead36d83636, 0xff510459a6a2a6a6, 0x0cb9bdded26fd2d2, 0x0ef706fbf5f3f5f5,
+    0x96f280ef79f97979, 0x30dece5f6fa16f6f, 0x6d3feffc917e9191, 0xf8a407aa52555252,
+    0x47c0fd27609d6060, 0x35657689bccabcbc, 0x372bcdac9b569b9b, 0x8a018c048e028e8e,
+    0xd25b1571a3b6a3a3, 0x6c183c600c300c0c, 0x84f68aff7bf17b7b, 0x806ae1b535d43535,
+    0xf53a69e81d741d1d, 0xb3dd4753e0a7e0e0, 0x21b3acf6d77bd7d7, 0x9c99ed5ec22fc2c2,
+    0x435c966d2eb82e2e, 0x29967a624b314b4b, 0x5de121a3fedffefe, 0xd5ae168257415757,
+    0xbd2a41a815541515, 0xe8eeb69f77c17777, 0x926eeba537dc3737, 0x9ed7567be5b3e5e5,
+    0x1323d98c9f469f9f, 0x23fd17d3f0e7f0f0, 0x20947f6a4a354a4a, 0x44a9959eda4fdada,
+    0xa2b025fa587d5858, 0xcf8fca06c903c9c9, 0x7c528d5529a42929, 0x5a1422500a280a0a,
+    0x507f4fe1b1feb1b1, 0xc95d1a69a0baa0a0, 0x14d6da7f6bb16b6b, 0xd917ab5c852e8585,
+    0x3c677381bdcebdbd, 0x8fba34d25d695d5d, 0x9020508010401010, 0x07f503f3f4f7f4f4,
+    0xdd8bc016cb0bcbcb, 0xd37cc6ed3ef83e3e, 0x2d0a112805140505, 0x78cee61f67816767,
+    0x97d55373e4b7e4e4, 0x024ebb25279c2727, 0x7382583241194141, 0xa70b9d2c8b168b8b,
+    0xf6530151a7a6a7a7, 0xb2fa94cf7de97d7d, 0x4937fbdc956e9595, 0x56ad9f8ed847d8d8,
+    0x70eb308bfbcbfbfb, 0xcdc17123ee9feeee, 0xbbf891c77ced7c7c, 0x71cce31766856666,
+    0x7ba78ea6dd53dddd, 0xaf2e4bb8175c1717, 0x458e460247014747, 0x1a21dc849e429e9e,
+    0xd489c51eca0fcaca, 0x585a99752db42d2d, 0x2e637991bfc6bfbf, 0x3f0e1b38071c0707,
+    0xac472301ad8eadad, 0xb0b42fea5a755a5a, 0xef1bb56c83368383, 0xb666ff8533cc3333,
+    0x5cc6f23f63916363, 0x12040a1002080202, 0x93493839aa92aaaa, 0xdee2a8af71d97171,
+    0xc68dcf0ec807c8c8, 0xd1327dc819641919, 0x3b92707249394949, 0x5faf9a86d943d9d9,
+    0x31f91dc3f2eff2f2, 0xa8db484be3abe3e3, 0xb9b62ae25b715b5b, 0xbc0d9234881a8888,
+    0x3e29c8a49a529a9a, 0x0b4cbe2d26982626, 0xbf64fa8d32c83232, 0x597d4ae9b0fab0b0,
+    0xf2cf6a1be983e9e9, 0x771e33780f3c0f0f, 0x33b7a6e6d573d5d5, 0xf41dba74803a8080,
+    0x27617c99bec2bebe, 0xeb87de26cd13cdcd, 0x8968e4bd34d03434, 0x3290757a483d4848,
+    0x54e324abffdbffff, 0x8df48ff77af57a7a, 0x643deaf4907a9090, 0x9dbe3ec25f615f5f,
+    0x3d40a01d20802020, 0x0fd0d56768bd6868, 0xca3472d01a681a1a, 0xb7412c19ae82aeae,
+    0x7d755ec9b4eab4b4, 0xcea8199a544d5454, 0x7f3be5ec93769393, 0x2f44aa0d22882222,
+    0x63c8e907648d6464, 0x2aff12dbf1e3f1f1, 0xcce6a2bf73d17373, 0x82245a9012481212,
+    0x7a805d3a401d4040, 0x4810284008200808, 0x959be856c32bc3c3, 0xdfc57b33ec97ecec,
+    0x4dab9096db4bdbdb, 0xc05f1f61a1bea1a1, 0x9107831c8d0e8d8d, 0xc87ac9f53df43d3d,
+    0x5b33f1cc97669797, 0x0000000000000000, 0xf983d436cf1bcfcf, 0x6e5687452bac2b2b,
+    0xe1ecb39776c57676, 0xe619b06482328282, 0x28b1a9fed67fd6d6, 0xc33677d81b6c1b1b,
+    0x74775bc1b5eeb5b5, 0xbe432911af86afaf, 0x1dd4df776ab56a6a, 0xeaa00dba505d5050,
+    0x578a4c1245094545, 0x38fb18cbf3ebf3f3, 0xad60f09d30c03030, 0xc4c3742bef9befef,
+    0xda7ec3e53ffc3f3f, 0xc7aa1c9255495555, 0xdb591079a2b2a2a2, 0xe9c96503ea8feaea,
+    0x6acaec0f65896565, 0x036968b9bad2baba, 0x4a5e93652fbc2f2f, 0x8e9de74ec027c0c0,
+    0x60a181bede5fdede, 0xfc386ce01c701c1c, 0x46e72ebbfdd3fdfd, 0x1f9a64524d294d4d,
+    0x7639e0e492729292, 0xfaeabc8f75c97575, 0x360c1e3006180606, 0xae0998248a128a8a,
+    0x4b7940f9b2f2b2b2, 0x85d15963e6bfe6e6, 0x7e1c36700e380e0e, 0xe73e63f81f7c1f1f,
+    0x55c4f73762956262, 0x3ab5a3eed477d4d4, 0x814d3229a89aa8a8, 0x5231f4c496629696,
+    0x62ef3a9bf9c3f9f9, 0xa397f666c533c5c5, 0x104ab13525942525, 0xabb220f259795959,
+    0xd015ae54842a8484, 0xc5e4a7b772d57272, 0xec72ddd539e43939, 0x1698615a4c2d4c4c,
+    0x94bc3bca5e655e5e, 0x9ff085e778fd7878, 0xe570d8dd38e03838, 0x980586148c0a8c8c,
+    0x17bfb2c6d163d1d1, 0xe4570b41a5aea5a5, 0xa1d94d43e2afe2e2, 0x4ec2f82f61996161,
+    0x427b45f1b3f6b3b3, 0x3442a51521842121, 0x0825d6949c4a9c9c, 0xee3c66f01e781e1e,
+    0x6186522243114343, 0xb193fc76c73bc7c7, 0x4fe52bb3fcd7fcfc, 0x2408142004100404,
+    0xe3a208b251595151, 0x252fc7bc995e9999, 0x22dac44f6da96d6d, 0x651a39680d340d0d,
+    0x79e93583facffafa, 0x69a384b6df5bdfdf, 0xa9fc9bd77ee57e7e, 0x1948b43d24902424,
+    0xfe76d7c53bec3b3b, 0x9a4b3d31ab96abab, 0xf081d13ece1fcece, 0x9922558811441111,
+    0x8303890c8f068f8f, 0x049c6b4a4e254e4e, 0x667351d1b7e6b7b7, 0xe0cb600beb8bebeb,
+    0xc178ccfd3cf03c3c, 0xfd1fbf7c813e8181, 0x4035fed4946a9494, 0x1cf30cebf7fbf7f7,
+    0x186f67a1b9deb9b9, 0x8b265f98134c1313, 0x51589c7d2cb02c2c, 0x05bbb8d6d36bd3d3,
+    0x8cd35c6be7bbe7e7, 0x39dccb576ea56e6e, 0xaa95f36ec437c4c4, 0x1b060f18030c0303,
+    0xdcac138a56455656, 0x5e88491a440d4444, 0xa0fe9edf7fe17f7f, 0x884f3721a99ea9a9,
+    0x6754824d2aa82a2a, 0x0a6b6db1bbd6bbbb, 0x879fe246c123c1c1, 0xf1a602a253515353,
+    0x72a58baedc57dcdc, 0x531627580b2c0b0b, 0x0127d39c9d4e9d9d, 0x2bd8c1476cad6c6c,
+    0xa462f59531c43131, 0xf3e8b98774cd7474, 0x15f109e3f6fff6f6, 0x4c8c430a46054646,
+    0xa5452609ac8aacac, 0xb50f973c891e8989, 0xb42844a014501414, 0xbadf425be1a3e1e1,
+    0xa62c4eb016581616, 0xf774d2cd3ae83a3a, 0x06d2d06f69b96969, 0x41122d4809240909,
+    0xd7e0ada770dd7070, 0x6f7154d9b6e2b6b6, 0x1ebdb7ced067d0d0, 0xd6c77e3bed93eded,
+    0xe285db2ecc17cccc, 0x6884572a42154242, 0x2c2dc2b4985a9898, 0xed550e49a4aaa4a4,
+    0x7550885d28a02828, 0x86b831da5c6d5c5c, 0x6bed3f93f8c7f8f8, 0xc211a44486228686
 };
 
 static const uint64_t whirlpool_constants[WHIRLPOOL_ROUNDS] = {
@@ -38,85 +104,35 @@ static const uint64_t whirlpool_constants[WHIRLPOOL_ROUNDS] = {
     0xfbee7c66dd17479e, 0xca2dbf07ad5a8333
 };
 
-static uint64_t whirlpool_sub_bytes(uint64_t x) {
-    uint64_t result = 0;
-    for (int i = 0; i < 8; i++) {
-        uint8_t byte = (x >> (i * 8)) & 0xFF;
-        result |= ((uint64_t)whirlpool_sbox[byte]) << (i * 8);
-    }
-    return result;
-}
-
-static void whirlpool_shift_columns(uint64_t *state) {
-    uint64_t temp[8];
-
-    temp[0] = state[0];
-    temp[1] = (state[1] << 8) | (state[1] >> 56);
-    temp[2] = (state[2] << 16) | (state[2] >> 48);
-    temp[3] = (state[3] << 24) | (state[3] >> 40);
-    temp[4] = (state[4] << 32) | (state[4] >> 32);
-    temp[5] = (state[5] << 40) | (state[5] >> 24);
-    temp[6] = (state[6] << 48) | (state[6] >> 16);
-    temp[7] = (state[7] << 56) | (state[7] >> 8);
-
-    memcpy(state, temp, sizeof(temp));
-}
-
-static uint8_t whirlpool_mul(uint8_t a, uint8_t b) {
-    uint8_t result = 0;
-    while (a && b) {
-        if (b & 1) {
-            result ^= a;
-        }
-        if (a & 0x80) {
-            a = (a << 1) ^ 0x11d; 
-        } else {
-            a <<= 1;
-        }
-        b >>= 1;
-    }
-    return result;
-}
-
-static void whirlpool_mix_columns(uint64_t *state) {
-    
-    uint64_t temp[8];
-
+/*
+ * One round of SubBytes, ShiftColumns and MixRows on both the state and the
+ * key schedule. ShiftColumns rotates row j left by j bytes, so output row i
+ * takes byte (i - j) mod 8 of each input row j before the table lookup.
+ */
+static void whirlpool_transform(const uint64_t *in, uint64_t *out) {
     for (int i = 0; i < 8; i++) {
-        temp[i] = 0;
-        for (int j = 0; j < 8; j++) {
-            uint8_t byte = (state[j] >> (i * 8)) & 0xFF;
-
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x01, byte)) << (0 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x01, byte)) << (1 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x04, byte)) << (2 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x01, byte)) << (3 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x08, byte)) << (4 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x05, byte)) << (5 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x02, byte)) << (6 * 8);
-            temp[i] ^= ((uint64_t)whirlpool_mul(0x09, byte)) << (7 * 8);
-        }
+        out[i] = whirlpool_table[(in[0] >> (((i + 8) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[1] >> (((i + 7) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[2] >> (((i + 6) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[3] >> (((i + 5) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[4] >> (((i + 4) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[5] >> (((i + 3) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[6] >> (((i + 2) & 7) * 8)) & 0xFF] ^
+                 whirlpool_table[(in[7] >> (((i + 1) & 7) * 8)) & 0xFF];
     }
-
-    memcpy(state, temp, sizeof(temp));
 }
 
 static void whirlpool_round(uint64_t *state, uint64_t *key, int round) {
-    
-    for (int i = 0; i < 8; i++) {
-        state[i] = whirlpool_sub_bytes(state[i]);
-        key[i] = whirlpool_sub_bytes(key[i]);
-    }
-
-    whirlpool_shift_columns(state);
-    whirlpool_shift_columns(key);
+    uint64_t next_state[8];
+    uint64_t next_key[8];
 
-    whirlpool_mix_columns(state);
-    whirlpool_mix_columns(key);
+    whirlpool_transform(state, next_state);
+    whirlpool_transform(key, next_key);
 
-    key[0] ^= whirlpool_constants[round];
+    next_key[0] ^= whirlpool_constants[round];
     for (int i = 0; i < 8; i++) {
-        state[i] ^= key[i];
+        key[i] = next_key[i];
+        state[i] = next_state[i] ^ next_key[i];
     }
 }
 
@@ -153,6 +169,15 @@ void whirlpool_init(whirlpool_ctx_t *ctx) {
 
 void whirlpool_update(whirlpool_ctx_t *ctx, const uint8_t *data, size_t length) {
     while (length > 0) {
+        /* Whole blocks are compressed straight from the caller's memory */
+        if (ctx->buffer_len == 0 && length >= WHIRLPOOL_BLOCK_SIZE) {
+            whirlpool_compress(ctx, data);
+            ctx->count += WHIRLPOOL_BLOCK_SIZE;
+            data += WHIRLPOOL_BLOCK_SIZE;
+            length -= WHIRLPOOL_BLOCK_SIZE;
+            continue;
+        }
+
         size_t to_copy = WHIRLPOOL_BLOCK_SIZE - ctx->buffer_len;
         if (to_copy > length) {
             to_copy = length;
@@ -205,6 +230,132 @@ void whirlpool_final(whirlpool_ctx_t *ctx, uint8_t *digest) {
     }
 }
 
+/*
+ * Tree hash for large inputs. The input is cut into TREE_LEAF_SIZE leaves
+ * that are hashed in parallel, and the root hashes the leaf size, the total
+ * length and the leaf digests in order. Leaves and root start with distinct
+ * domain bytes, so a tree digest never equals the plain digest of the same
+ * input. Identical for any thread count.
+ */
+#define TREE_LEAF_SIZE (1024 * 1024)
+#define TREE_MAX_THREADS 64
+#define TREE_LEAF_DOMAIN 0x00
+#define TREE_ROOT_DOMAIN 0x01
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t leaves;
+    uint8_t *leaf_digests;
+    size_t next_leaf;
+} whirlpool_tree_job_t;
+
+/* Threads claim leaves from a shared counter, so faster threads take more */
+static void *whirlpool_tree_worker(void *arg) {
+    whirlpool_tree_job_t *job = arg;
+    static const uint8_t domain = TREE_LEAF_DOMAIN;
+    size_t leaf;
+
+    while ((leaf = __atomic_fetch_add(&job->next_leaf, 1, __ATOMIC_RELAXED)) < job->leaves) {
+        size_t offset = leaf * TREE_LEAF_SIZE;
+        size_t length = job->length - offset < TREE_LEAF_SIZE ? job->length - offset : TREE_LEAF_SIZE;
+        whirlpool_ctx_t ctx;
+
+        whirlpool_init(&ctx);
+        whirlpool_update(&ctx, &domain, 1);
+        whirlpool_update(&ctx, job->data + offset, length);
+        whirlpool_final(&ctx, job->leaf_digests + leaf * WHIRLPOOL_DIGEST_SIZE);
+    }
+    return NULL;
+}
+
+/* Writes a WHIRLPOOL_DIGEST_SIZE-byte tree digest; returns -1 if allocation fails */
+int whirlpool_tree_hash(const uint8_t *data, size_t length, uint8_t *digest) {
+    whirlpool_tree_job_t job;
+    pthread_t threads[TREE_MAX_THREADS];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 1 ? (size_t)cpus : 1;
+    size_t started = 0;
+    uint8_t header[17];
+    whirlpool_ctx_t ctx;
+
+    job.data = data;
+    job.length = length;
+    job.leaves = length == 0 ? 1 : (length + TREE_LEAF_SIZE - 1) / TREE_LEAF_SIZE;
+    job.next_leaf = 0;
+    job.leaf_digests = malloc(job.leaves * WHIRLPOOL_DIGEST_SIZE);
+    if (job.leaf_digests == NULL) {
+        return -1;
+    }
+
+    if (wanted > job.leaves) {
+        wanted = job.leaves;
+    }
+    if (wanted > TREE_MAX_THREADS) {
+        wanted = TREE_MAX_THREADS;
+    }
+
+    /* The calling thread is one of the workers */
+    while (started + 1 < wanted &&
+           pthread_create(&threads[started], NULL, whirlpool_tree_worker, &job) == 0) {
+        started++;
+    }
+    whirlpool_tree_worker(&job);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    header[0] = TREE_ROOT_DOMAIN;
+    for (int i = 0; i < 8; i++) {
+        header[1 + i] = ((uint64_t)TREE_LEAF_SIZE >> (i * 8)) & 0xFF;
+        header[9 + i] = ((uint64_t)length >> (i * 8)) & 0xFF;
+    }
+
+    whirlpool_init(&ctx);
+    whirlpool_update(&ctx, header, sizeof(header));
+    whirlpool_update(&ctx, job.leaf_digests, job.leaves * WHIRLPOOL_DIGEST_SIZE);
+    whirlpool_final(&ctx, digest);
+
+    free(job.leaf_digests);
+    return 0;
+}
+
+/*
+ * Tree-hashes a file straight from the page cache through a read-only
+ * mapping. Returns -1 if the file cannot be opened or mapped.
+ */
+int whirlpool_tree_hash_file(const char *path, uint8_t *digest) {
+    struct stat st;
+    void *map;
+    int fd, status;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return whirlpool_tree_hash(NULL, 0, digest);
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    status = whirlpool_tree_hash(map, (size_t)st.st_size, digest);
+    munmap(map, (size_t)st.st_size);
+
+    return status;
+}
+
 typedef struct {
     uint32_t state[5];
     uint64_t count;
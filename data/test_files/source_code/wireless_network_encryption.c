@@ -11,6 +11,7 @@
 #define STREAM_KEY_SIZE 16
 #define IV_SIZE 3
 #define RC4_STATE_SIZE 256
+#define KEYSTREAM_CHUNK 64
 
 typedef struct {
     uint8_t state_array[RC4_STATE_SIZE];
@@ -58,11 +59,66 @@ uint8_t generate_keystream_byte(WirelessCipher *cipher) {
     return cipher->state_array[keystream_index];
 }
 
+// One keystream step on locals; si holds state[i + 1] on entry and on exit
+static inline uint8_t keystream_step(uint8_t *state, uint8_t *i, uint8_t *j, uint8_t *si) {
+    uint8_t a = *si;
+    *i += 1;
+    *j += a;
+    uint8_t b = state[*j];
+
+    // Load the next slot before the swap and patch it if the swap wrote it
+    uint8_t next = state[(uint8_t)(*i + 1)];
+    state[*i] = b;
+    state[*j] = a;
+    *si = (uint8_t)(*i + 1) == *j ? a : next;
+
+    return state[(uint8_t)(a + b)];
+}
+
+// Generate length keystream bytes, eight per iteration
+void generate_keystream(WirelessCipher *cipher, uint8_t *output, size_t length) {
+    uint8_t *state = cipher->state_array;
+    uint8_t i = (uint8_t)cipher->i_index;
+    uint8_t j = (uint8_t)cipher->j_index;
+    uint8_t si = state[(uint8_t)(i + 1)];
+    size_t n = 0;
+
+    for (; n + 8 <= length; n += 8) {
+        uint8_t k[8];
+        for (int b = 0; b < 8; b++) {
+            k[b] = keystream_step(state, &i, &j, &si);
+        }
+        memcpy(output + n, k, 8);
+    }
+    for (; n < length; n++) {
+        output[n] = keystream_step(state, &i, &j, &si);
+    }
+
+    cipher->i_index = i;
+    cipher->j_index = j;
+}
+
 // Encrypt wireless data packet
 void encrypt_wireless_packet(WirelessCipher *cipher, uint8_t *data, int length) {
-    for (int i = 0; i < length; i++) {
-        uint8_t keystream_byte = generate_keystream_byte(cipher);
-        data[i] ^= keystream_byte;
+    uint8_t keystream[KEYSTREAM_CHUNK];
+
+    for (int offset = 0; offset < length; offset += KEYSTREAM_CHUNK) {
+        int n = length - offset < KEYSTREAM_CHUNK ? length - offset : KEYSTREAM_CHUNK;
+        int i = 0;
+
+        generate_keystream(cipher, keystream, n);
+
+        // XOR a word at a time
+        for (; i + 8 <= n; i += 8) {
+            uint64_t d, k;
+            memcpy(&d, data + offset + i, 8);
+            memcpy(&k, keystream + i, 8);
+            d ^= k;
+            memcpy(data + offset + i, &d, 8);
+        }
+        for (; i < n; i++) {
+            data[offset + i] ^= keystream[i];
+        }
     }
 }
 